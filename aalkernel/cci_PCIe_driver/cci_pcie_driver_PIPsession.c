@@ -241,8 +241,7 @@ int UnbindSession(struct aaldev_ownerSession *pownerSess)
 // Description: Frees all workspaces allocated for this session
 // Interface: private
 // Inputs: sessp - session
-// Comments: This function should be called during cleanup.  It does not
-//           protect session queue access
+// Comments: This function should be called during cleanup.
 //=============================================================================
 void
 cci_flush_all_wsids(struct cci_PIPsession *psess)
@@ -265,6 +264,7 @@ cci_flush_all_wsids(struct cci_PIPsession *psess)
 
    PVERBOSE("Freeing allocated workspaces.\n");
 
+   kosal_sem_get_krnl( cci_PIPsessionp_semaphore(psess) );
    kosal_list_for_each_entry_safe( wsidp, tmp, &pownerSess->m_wshead, m_list, struct aal_wsid) {
       if( WSM_TYPE_VIRTUAL == wsidp->m_type){
          if( NULL== cci_aaldev_pci_dev(pdev) ) {
@@ -275,12 +275,64 @@ cci_flush_all_wsids(struct cci_PIPsession *psess)
 
          // remove the wsid from the device and destroy
          PVERBOSE("Done Freeing PWS with id 0x%llx.\n",pwsid_to_wsidHandle(wsidp));
+      }else if( WSM_TYPE_PINNED == wsidp->m_type ){
+         kosal_unpin_user_mem((struct kosal_pinned_mem *)wsidp->m_id);
+         PVERBOSE("Done Unpinning WS with id 0x%llx.\n",pwsid_to_wsidHandle(wsidp));
       }
 
       kosal_list_del_init(&wsidp->m_list);
 
       ccidrv_freewsid(wsidp);
    } // end list_for_each_entry
+   kosal_sem_put( cci_PIPsessionp_semaphore(psess) );
    PTRACEOUT;
 }
 
+//=============================================================================
+// Name: cci_PIPsession_add_ws
+// Description: Adds a workspace to the session
+// Interface: public
+// Inputs: psess - session
+//         wsidp - workspace, not on any session
+// Comments: Commands on a session may run concurrently, so its workspace
+//           list is only changed under the session semaphore.
+//=============================================================================
+void
+cci_PIPsession_add_ws(struct cci_PIPsession *psess, struct aal_wsid *wsidp)
+{
+   kosal_sem_get_krnl( cci_PIPsessionp_semaphore(psess) );
+   aalsess_add_ws(cci_PIPsessionp_to_ownerSession(psess), wsidp->m_list);
+   kosal_sem_put( cci_PIPsessionp_semaphore(psess) );
+}
+
+//=============================================================================
+// Name: cci_PIPsession_claim_ws
+// Description: Takes a workspace off the session, so that it can be freed
+// Interface: public
+// Inputs: psess - session
+//         wsidHandle - workspace to claim
+// Outputs: the workspace, or NULL if it is not on the session.
+// Comments: Of several concurrent claims of one workspace, only one gets it.
+//           Only the session's own list is searched, so the workspace found
+//           cannot be in the middle of being freed by another command.
+//=============================================================================
+struct aal_wsid *
+cci_PIPsession_claim_ws(struct cci_PIPsession *psess, btWSID wsidHandle)
+{
+   struct aaldev_ownerSession *pownerSess = cci_PIPsessionp_to_ownerSession(psess);
+   struct aal_wsid            *wsidp;
+
+   kosal_sem_get_krnl( cci_PIPsessionp_semaphore(psess) );
+   kosal_list_for_each_entry( wsidp, &pownerSess->m_wshead, m_list, struct aal_wsid) {
+      if ( pwsid_to_wsidHandle(wsidp) == wsidHandle ) {
+         kosal_list_del_init(&wsidp->m_list);
+         kosal_sem_put( cci_PIPsessionp_semaphore(psess) );
+         return wsidp;
+      }
+   }
+   kosal_sem_put( cci_PIPsessionp_semaphore(psess) );
+
+   PINFO("wsid %llx not on session\n", wsidHandle);
+   return NULL;
+}
+
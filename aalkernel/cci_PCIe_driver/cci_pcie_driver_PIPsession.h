@@ -105,6 +105,8 @@ int BindSession(struct aaldev_ownerSession *pownerSess);
 int session_destroy(struct cci_PIPsession *sess);
 int UnbindSession(struct aaldev_ownerSession *pownerSess);
 void cci_flush_all_wsids( struct cci_PIPsession *);
+void cci_PIPsession_add_ws( struct cci_PIPsession *, struct aal_wsid *);
+struct aal_wsid *cci_PIPsession_claim_ws( struct cci_PIPsession *, btWSID);
 
 #endif // __AALKERNEL_CCIV4_PIP_SESSION_H__
 
@@ -88,6 +88,14 @@
 #define CCI_MMIO_SIZE       ( 0x40000 )                   /// Size of AFU MMIO space
 #define CCI_UMSG_SIZE       ( 0x5000 )                    /// Size of uMsg space
 
+// Workspaces backed by huge blocks are mapped into the process with PMD (and,
+//  where the architecture allows, PUD) entries. Huge PFN mappings of driver
+//  memory are only safe to fault in from 6.12.
+#if defined( __AAL_LINUX__ ) && defined( CONFIG_TRANSPARENT_HUGEPAGE ) && \
+    defined( CONFIG_ARCH_SUPPORTS_PMD_PFNMAP ) && ( LINUX_VERSION_CODE >= KERNEL_VERSION(6,12,0) )
+# define CCI_WKSP_HUGE_MAP 1
+#endif
+
 // PCI device IDs
 #define PCIe_DEVICE_ID_RCiEP0        0xBCBD ///< Primary port with FIU
 #define PCIe_DEVICE_ID_RCiEP1        0xBCBE ///< Null device for data transport
@@ -382,6 +390,8 @@ extern void cci_remove_device(struct ccip_device *);
 extern void cci_release_device(pkosal_os_dev pdev);
 extern void ccidrv_exitDriver(void);
 
+extern btWSSize cci_mmap_pgsize(btWSSize blkpgsize);
+
 extern struct ccidrv_session * ccidrv_session_create(btPID );
 extern btInt ccidrv_session_destroy(struct ccidrv_session * );
 extern struct aal_wsid *find_wsid( const struct ccidrv_session *,
@@ -335,8 +335,17 @@ ccidrv_messageHandler( struct ccidrv_session  *psess,
       // the pending queue
       //----------------------------------------------------
       UIDRV_IOCTL_CASE(AALUID_IOCTL_GETMSG) {
+         // The queue is shared with ccidrv_sendevent(), which enqueues under the
+         //  session semaphore.
+         if ( kosal_sem_get_user_alertable(&psess->m_sem) ) {
+            PDEBUG("kosal_sem_get_user_alertable interrupted\n");
+            PTRACEOUT_INT(-EIO);
+            return -EIO;
+         }
+
          // Make sure there is a message to be had
          if ( _aal_q_empty(&psess->m_eventq) ) {
+            kosal_sem_put(&psess->m_sem);
             PERR("No Message available\n");
             PTRACEOUT_INT(-EAGAIN);
             return -EAGAIN;
@@ -346,6 +355,7 @@ ccidrv_messageHandler( struct ccidrv_session  *psess,
          // Get the request message
          //------------------------
          pqitem = _aal_q_dequeue(&psess->m_eventq);
+         kosal_sem_put(&psess->m_sem);
          if ( NULL == pqitem ) {
             PERR("Invalid or corrupted request\n");
             PTRACEOUT_INT(-EFAULT);
@@ -361,6 +371,69 @@ ccidrv_messageHandler( struct ccidrv_session  *psess,
       } break; // case  AALUID_IOCTL_GETMSG:
 
 
+      // Get as many queued messages as fit in the response payload
+      // Saves the application a poll and two ioctls per message when
+      // events arrive in bursts.
+      //----------------------------------------------------------
+      UIDRV_IOCTL_CASE(AALUID_IOCTL_GETMSG_BATCH) {
+         btWSSize Used   = 0;
+         btWSSize RecLen = 0;
+
+         presp->errcode = uid_errnumOK;
+
+         // ccidrv_sendevent() enqueues under the session semaphore, so take it
+         //  for each peek and dequeue. Marshaling is done without it.
+         for ( ; ; ) {
+            struct ccipui_ioctlreq *prec = NULL;
+            btWSSize                RecPayloadSize;
+
+            if ( kosal_sem_get_user_alertable(&psess->m_sem) ) {
+               break;
+            }
+
+            if ( _aal_q_empty(&psess->m_eventq) ) {
+               kosal_sem_put(&psess->m_sem);
+               break;
+            }
+
+            pqitem = _aal_q_peek(&psess->m_eventq);
+            if ( NULL == pqitem ) {
+               kosal_sem_put(&psess->m_sem);
+               PERR("Corrupt event queue\n");
+               break;
+            }
+
+            RecLen = aalui_ioctlBatchRecLen(QI_LEN(pqitem));
+            if ( Used + RecLen > OutbufSize ) {
+               kosal_sem_put(&psess->m_sem);
+               if ( 0 == Used ) {
+                  // Too large for this buffer. Leave it for AALUID_IOCTL_GETMSG.
+                  presp->errcode = uid_errnumNoMem;
+               }
+               break;
+            }
+
+            pqitem = _aal_q_dequeue(&psess->m_eventq);
+            kosal_sem_put(&psess->m_sem);
+
+            prec           = (struct ccipui_ioctlreq *)(presp->payload + Used);
+            RecPayloadSize = QI_LEN(pqitem);
+            if ( 0 != ccidrv_marshal_upstream_message(preq, pqitem, prec, &RecPayloadSize) ) {
+               // The event has been destroyed. Nothing else to do.
+               PERR("Failed to marshal batched event\n");
+               continue;
+            }
+            Used += RecLen;
+         }
+
+         PVERBOSE("Returning message batch of %" PRIu64 " bytes\n", Used);
+
+         presp->size  = Used;
+         *pOutbufSize = Used;
+         PTRACEOUT_INT(0);
+      } return 0; // case AALUID_IOCTL_GETMSG_BATCH:
+
+
       // Send the message to the device or PIP (SW driver)
       //-------------------------------------------------
       UIDRV_IOCTL_CASE(AALUID_IOCTL_SENDMSG) {
@@ -951,6 +1024,7 @@ struct aal_wsid* ccidrv_getwsid(struct aal_device *pdev,
    pwsid->m_device = pdev;
    pwsid->m_handle = wsid_to_wsidHandle(nextWSID);
    pwsid->m_id = id;
+   pwsid->m_pgsize = 0;
    kosal_list_init(&pwsid->m_list);
    kosal_list_init(&pwsid->m_alloc_list);
 
@@ -100,6 +100,10 @@ btInt ccidrv_close(struct inode *, struct file *);
 
 btInt ccidrv_mmap(struct file *, struct vm_area_struct *);
 btUnsignedInt ccidrv_poll(struct file *, poll_table *);
+#if defined( CCI_WKSP_HUGE_MAP )
+unsigned long ccidrv_get_unmapped_area(struct file *, unsigned long, unsigned long,
+                                       unsigned long, unsigned long);
+#endif
 
 #if HAVE_UNLOCKED_IOCTL
 long ccidrv_ioctl(struct file *file,
@@ -151,6 +155,9 @@ struct um_APIdriver thisDriver = {
          .ioctl          = ccidrv_ioctl,  // Deprecated in 2.6.36
 #endif
          .mmap           = ccidrv_mmap,
+#if defined( CCI_WKSP_HUGE_MAP )
+         .get_unmapped_area = ccidrv_get_unmapped_area,
+#endif
          .open           = ccidrv_open,
          .release        = ccidrv_close,
       },
@@ -603,3 +610,42 @@ failed:
 
 }
 
+#if defined( CCI_WKSP_HUGE_MAP )
+//=============================================================================
+// Name: ccidrv_get_unmapped_area
+// Description: get_unmapped_area file operation
+// Interface: public
+// Inputs: file, addr, len, pgoff, flags - as for mmap().
+// Outputs: user virtual address for the mapping, or an error value.
+// Comments: Places a workspace backed by huge pages so that cci_mmap() can
+//           map it with huge entries. Workspace offsets are 2M aligned, so
+//           thp_get_unmapped_area() already aligns for PMDs. For PUDs, the
+//           area is padded by a page and the start rounded up to it.
+//=============================================================================
+unsigned long
+ccidrv_get_unmapped_area(struct file *file, unsigned long addr, unsigned long len,
+                         unsigned long pgoff, unsigned long flags)
+{
+   struct ccidrv_session *psess = (struct ccidrv_session *) file->private_data;
+   struct aal_wsid       *wsidp = NULL;
+   btWSSize               align = PAGE_SIZE;
+   unsigned long          area  = 0;
+
+   if ( ( NULL != psess ) && ( 0 != pgoff ) && ( 0 == addr ) && !( flags & MAP_FIXED ) ) {
+      wsidp = find_wsid(psess, pgoff_to_wsidHandle(pgoff));
+      if ( ( NULL != wsidp ) && ( WSM_TYPE_VIRTUAL == wsidp->m_type ) ) {
+         align = cci_mmap_pgsize(wsidp->m_pgsize);
+      }
+   }
+
+   if ( ( PMD_SIZE < align ) && ( len + align > len ) ) {
+      area = thp_get_unmapped_area(file, 0, len + align, pgoff, flags);
+      if ( !IS_ERR_VALUE(area) ) {
+         return ALIGN(area, align);
+      }
+   }
+
+   return thp_get_unmapped_area(file, addr, len, pgoff, flags);
+}
+#endif // CCI_WKSP_HUGE_MAP
+
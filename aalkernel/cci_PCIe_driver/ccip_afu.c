@@ -93,6 +93,7 @@ static int CommandHandler( struct aaldev_ownerSession *,
 extern int cci_mmap(struct aaldev_ownerSession *pownerSess,
                            struct aal_wsid *wsidp,
                            btAny os_specific);
+extern btWSSize cci_mmap_pgsize(btWSSize blkpgsize);
 
 
 //=============================================================================
@@ -241,6 +242,66 @@ struct cci_aal_device   *
    return pcci_aaldev;
 }
 
+//=============================================================================
+// Name: ccip_wksp_alloc
+// Description: Allocates the memory backing a workspace
+// Interface: private
+// Inputs: pdev - device the workspace is for
+//         psize - [IN] requested size [OUT] allocated size
+//         ppgsize - [IN] preferred page size, 0 for the default
+//                   [OUT] page size backing the workspace
+//         piova - [OUT] DMA address, when the device has a pci_dev
+// Outputs: kernel virtual address of the workspace, NULL on failure.
+// Comments: A huge page size is satisfied with one physically contiguous block,
+//           rounded up to a multiple of the page size. Blocks come from the
+//           buddy allocator, so they are naturally aligned to it as well. If
+//           no such block is available, the next smaller page size is tried,
+//           and finally the default allocation.
+//=============================================================================
+static btVirtAddr ccip_wksp_alloc(struct cci_aal_device *pdev,
+                                  btWSSize              *psize,
+                                  btWSSize              *ppgsize,
+                                  btHANDLE              *piova)
+{
+   btWSSize   pgsize    = *ppgsize;
+   btWSSize   size      = 0;
+   btVirtAddr krnl_virt = NULL;
+
+   for ( ;; ) {
+      if ( pgsize >= CCIP_WKSP_PGSIZE_1G ) {
+         pgsize = CCIP_WKSP_PGSIZE_1G;
+      } else if ( pgsize >= CCIP_WKSP_PGSIZE_2M ) {
+         pgsize = CCIP_WKSP_PGSIZE_2M;
+      } else {
+         pgsize = PAGE_SIZE;
+      }
+      size = (*psize + pgsize - 1) & ~(pgsize - 1);
+
+      if( NULL== cci_aaldev_pci_dev(pdev) ) {
+         // Simulated device
+         krnl_virt = (btVirtAddr)kosal_alloc_contiguous_mem_nocache(size);
+      }else{
+         krnl_virt = kosal_alloc_dma_coherent( ccip_dev_pci_dev(pdev), size, piova);
+      }
+
+      if ( ( NULL != krnl_virt ) || ( PAGE_SIZE == pgsize ) ) {
+         break;
+      }
+
+      PINFO("No %" PRIu64 " byte pages for a %" PRIu64 " byte workspace, trying smaller pages\n",
+               pgsize, *psize);
+      pgsize >>= 1;
+   }
+
+   if ( NULL == krnl_virt ) {
+      return NULL;
+   }
+
+   *psize   = size;
+   *ppgsize = pgsize;
+   return krnl_virt;
+}
+
 //=============================================================================
 // Name: CommandHandler
 // Description: Implements the PIP command handler
@@ -391,7 +452,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
       } break;
 
@@ -402,21 +463,22 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          struct aal_wsid     *wsidp       = NULL;
          struct aalui_WSMEvent WSID;
          btHANDLE             iova        = NULL;;
+         btWSSize             size        = preq->ahmreq.u.wksp.m_size;
+         btWSSize             pgsize      = preq->ahmreq.u.wksp.m_pgsize;
 
-         PDEBUG( "Allocating %lu bytes \n", (unsigned long)preq->ahmreq.u.wksp.m_size);
-         if( NULL== cci_aaldev_pci_dev(pdev) ) {
-            // Normal flow -- create the needed workspace.
-            krnl_virt = (btVirtAddr)kosal_alloc_contiguous_mem_nocache(preq->ahmreq.u.wksp.m_size);
-            if (NULL == krnl_virt) {
-               Message->m_errcode = uid_errnumNoMem;
-               break;
-            }
-         }else{
-            krnl_virt = kosal_alloc_dma_coherent( ccip_dev_pci_dev(pdev), preq->ahmreq.u.wksp.m_size, &iova);
-            if (NULL == krnl_virt) {
-               Message->m_errcode = uid_errnumNoMem;
-               break;
-            }
+         // An older library has a shorter aalui_WSMEvent. Check for room before
+         //  allocating rather than succeed without returning the WSID.
+         if ( respBufSize < sizeof(struct aalui_WSMEvent) ) {
+            PERR("No room to return WSID. Required sized %ld but size provided %ld\n", sizeof(struct aalui_WSMEvent), (long int)respBufSize);
+            Message->m_errcode = uid_errnumNoMem;
+            break;
+         }
+
+         PDEBUG( "Allocating %lu bytes, page size %lu\n", (unsigned long)size, (unsigned long)pgsize);
+         krnl_virt = ccip_wksp_alloc(pdev, &size, &pgsize, &iova);
+         if (NULL == krnl_virt) {
+            Message->m_errcode = uid_errnumNoMem;
+            break;
          }
          //------------------------------------------------------------
          // Create the WSID object and add to the list for this session
@@ -429,12 +491,13 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             goto ERROR;
          }
 
-         wsidp->m_size = preq->ahmreq.u.wksp.m_size;
-         wsidp->m_type = WSM_TYPE_VIRTUAL;
+         wsidp->m_size   = size;
+         wsidp->m_pgsize = pgsize;
+         wsidp->m_type   = WSM_TYPE_VIRTUAL;
          PDEBUG("Creating Physical WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
          PINFO("CCI WS alloc wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -452,18 +515,86 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             WSID.wsParms.physptr = (btWSID)iova;
             wsidp->m_dmahandle = iova;
          }
-         WSID.wsParms.size    = preq->ahmreq.u.wksp.m_size;
+         WSID.wsParms.size    = size;
+         // The size of the pages cci_mmap() will map the block with.
+         WSID.wsParms.pgsize  = cci_mmap_pgsize(pgsize);
 
-         // Make this atomic. Check the original response buffer size for room
-         if(respBufSize >= sizeof(struct aalui_WSMEvent)){
-            *((struct aalui_WSMEvent*)Message->m_response) = WSID;
-            Message->m_respbufSize = sizeof(struct aalui_WSMEvent);
-         }
+         // Room was checked above
+         *((struct aalui_WSMEvent*)Message->m_response) = WSID;
+         Message->m_respbufSize = sizeof(struct aalui_WSMEvent);
          PDEBUG("Buf size =  %u Returning WSID %llx\n",(unsigned int)Message->m_respbufSize, WSID.wsParms.wsid  );
          Message->m_errcode = uid_errnumOK;
 
       } break; // case fappip_afucmdWKSP_VALLOC
 
+      //============================
+      //  Pin user memory
+      //============================
+      AFU_COMMAND_CASE(ccipdrv_afucmdWKSP_PIN)
+      {
+         struct ccidrvreq        *preq    = (struct ccidrvreq *)pmsg->payload;
+         struct kosal_pinned_mem *ppinned = NULL;
+         struct aal_wsid         *wsidp   = NULL;
+         struct aalui_WSMEvent    WSID;
+         btPhysAddr               iova    = 0;
+         btVirtAddr               uvirt   = preq->ahmreq.u.wksp_pin.m_ptr;
+         btWSSize                 size    = preq->ahmreq.u.wksp_pin.m_size;
+
+         if ( ( NULL == uvirt ) || ( 0 == size ) ) {
+            Message->m_errcode = uid_errnumBadParameter;
+            break;
+         }
+
+         if ( respBufSize < sizeof(struct aalui_WSMEvent) ) {
+            PERR("No room to return WSID. Required sized %ld but size provided %ld\n", sizeof(struct aalui_WSMEvent), (long int)respBufSize);
+            Message->m_errcode = uid_errnumNoMem;
+            break;
+         }
+
+         PDEBUG( "Pinning %lu bytes at %p\n", (unsigned long)size, uvirt);
+         if( NULL== cci_aaldev_pci_dev(pdev) ) {
+            ppinned = kosal_pin_user_mem(NULL, uvirt, size, &iova);
+         }else{
+            ppinned = kosal_pin_user_mem(ccip_dev_pci_dev(pdev), uvirt, size, &iova);
+         }
+         if ( NULL == ppinned ) {
+            Message->m_errcode = uid_errnumNoMap;
+            break;
+         }
+
+         //------------------------------------------------------------
+         // Create the WSID object and add to the list for this session
+         //------------------------------------------------------------
+         wsidp = ccidrv_getwsid(pownerSess->m_device, (btWSID)ppinned);
+         if ( NULL == wsidp ) {
+            PERR("Couldn't allocate pinned workspace\n");
+            kosal_unpin_user_mem(ppinned);
+            Message->m_errcode = uid_errnumNoMem;
+            break;
+         }
+
+         wsidp->m_size      = size;
+         wsidp->m_type      = WSM_TYPE_PINNED;
+         wsidp->m_dmahandle = (btHANDLE)iova;
+
+         // Add the new wsid onto the session. Session teardown unpins it.
+         cci_PIPsession_add_ws(pSess, wsidp);
+
+         // Set up the return payload
+         WSID.evtID           = uid_wseventAllocate;
+         WSID.wsParms.wsid    = pwsid_to_wsidHandle(wsidp);
+         WSID.wsParms.ptr     = uvirt;
+         WSID.wsParms.physptr = iova;
+         WSID.wsParms.size    = size;
+         WSID.wsParms.pgsize  = PAGE_SIZE;
+
+         // Room was checked above
+         *((struct aalui_WSMEvent*)Message->m_response) = WSID;
+         Message->m_respbufSize = sizeof(struct aalui_WSMEvent);
+         Message->m_errcode = uid_errnumOK;
+
+      } break; // case ccipdrv_afucmdWKSP_PIN
+
 
       //============================
       //  Free Workspace
@@ -480,8 +611,9 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             break;
          }
 
-         // Get the workspace ID object
-         wsidp = ccidrv_valwsid(preq->ahmreq.u.wksp.m_wsid);
+         // Take the workspace ID object off the session. Frees run
+         //  concurrently, and only one of them gets a given workspace.
+         wsidp = cci_PIPsession_claim_ws(pSess, preq->ahmreq.u.wksp.m_wsid);
 
          ASSERT(wsidp);
          if ( NULL == wsidp ) {
@@ -490,23 +622,27 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          }
 
          // Free the buffer
-         if(  WSM_TYPE_VIRTUAL != wsidp->m_type ) {
+         if( WSM_TYPE_PINNED == wsidp->m_type ) {
+            // Pinned user memory. Unpin it; the memory itself belongs to the user.
+            kosal_unpin_user_mem((struct kosal_pinned_mem *)wsidp->m_id);
+         }else if(  WSM_TYPE_VIRTUAL != wsidp->m_type ) {
             PDEBUG( "Workspace free failed due to bad WS type. Should be %d but received %d\n",WSM_TYPE_VIRTUAL,
                   wsidp->m_type);
 
+            // Not ours to free. Give it back to the session.
+            cci_PIPsession_add_ws(pSess, wsidp);
             Message->m_errcode = uid_errnumBadParameter;
             break;
-         }
-
-         krnl_virt = (btVirtAddr)wsidp->m_id;
-         if( NULL== cci_aaldev_pci_dev(pdev) ) {
-            kosal_free_contiguous_mem(krnl_virt, wsidp->m_size);
          }else{
-            kosal_free_dma_coherent( ccip_dev_pci_dev(pdev), krnl_virt, wsidp->m_size, wsidp->m_dmahandle);
+            krnl_virt = (btVirtAddr)wsidp->m_id;
+            if( NULL== cci_aaldev_pci_dev(pdev) ) {
+               kosal_free_contiguous_mem(krnl_virt, wsidp->m_size);
+            }else{
+               kosal_free_dma_coherent( ccip_dev_pci_dev(pdev), krnl_virt, wsidp->m_size, wsidp->m_dmahandle);
+            }
          }
 
-         // remove the wsid from the device and destroy
-         kosal_list_del_init(&wsidp->m_list);
+         // destroy the wsid, already off the session
          ccidrv_freewsid(wsidp);
 
          PVERBOSE("Sending the WKSP Free event.\n");
@@ -654,7 +790,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          PDEBUG("Creating uMSG WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
          PINFO("CCI uMSG wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -229,12 +229,17 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          if(respBufSize >= sizeof(struct aalui_WSMEvent)){
             *((struct aalui_WSMEvent*)Message->m_response) = WSID;
             Message->m_respbufSize = sizeof(struct aalui_WSMEvent);
+         }else{
+            PERR("No room to return WSID. Required sized %ld but size provided %ld\n", sizeof(struct aalui_WSMEvent), (long int)respBufSize);
+            Message->m_errcode = uid_errnumNoMem;
+            ccidrv_freewsid(wsidp);
+            break;
          }
          PDEBUG("Buf size =  %u Returning WSID %llx\n",(unsigned int)Message->m_respbufSize, WSID.wsParms.wsid  );
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
       } break;
 
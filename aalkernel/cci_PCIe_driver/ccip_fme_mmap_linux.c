@@ -133,6 +133,114 @@ static struct vm_operations_struct csr_vm_ops =
 };
 #endif
 
+#if defined( CCI_WKSP_HUGE_MAP )
+
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(6,17,0)
+#  define wksp_pfn(pfn)  ( pfn )
+# else
+#  include <linux/pfn_t.h>
+#  define wksp_pfn(pfn)  __pfn_to_pfn_t(pfn, PFN_DEV)
+# endif
+
+//=============================================================================
+// Name: wksp_vmapfn
+// Description: Returns the page frame backing an address of a workspace vma
+// Interface: private
+// Inputs: pvma - the vma
+//         addr - user virtual address within it
+// Outputs: page frame number.
+// Comments: cci_mmap() sets vm_pgoff to the first page frame of the workspace.
+//           The kernel keeps vm_pgoff in step when it splits the vma.
+//=============================================================================
+static unsigned long wksp_vmapfn(struct vm_area_struct *pvma, unsigned long addr)
+{
+   return pvma->vm_pgoff + ( (addr - pvma->vm_start) >> PAGE_SHIFT );
+}
+
+//=============================================================================
+// Name: wksp_vmafault
+// Description: Maps one base page of a workspace
+// Interface: private
+// Inputs: vmf - fault description
+// Outputs: VM_FAULT_* code.
+// Comments: Used where wksp_vmahuge_fault() falls back.
+//=============================================================================
+static vm_fault_t wksp_vmafault(struct vm_fault *vmf)
+{
+   return vmf_insert_pfn(vmf->vma, vmf->address, wksp_vmapfn(vmf->vma, vmf->address));
+}
+
+//=============================================================================
+// Name: wksp_vmahuge_fault
+// Description: Maps one PMD or PUD sized page of a workspace
+// Interface: private
+// Inputs: vmf - fault description
+//         order - page order the fault wants
+// Outputs: VM_FAULT_* code.
+// Comments: The block is aligned to its page size, so this only falls back
+//           where the vma does not cover the whole huge page.
+//=============================================================================
+static vm_fault_t wksp_vmahuge_fault(struct vm_fault *vmf, unsigned int order)
+{
+   struct vm_area_struct *pvma  = vmf->vma;
+   unsigned long          size  = PAGE_SIZE << order;
+   unsigned long          addr  = vmf->address & ~(size - 1);
+   unsigned long          pfn   = 0;
+   bool                   write = !!( vmf->flags & FAULT_FLAG_WRITE );
+
+   if ( ( addr < pvma->vm_start ) || ( addr + size > pvma->vm_end ) ) {
+      return VM_FAULT_FALLBACK;
+   }
+
+   pfn = wksp_vmapfn(pvma, addr);
+   if ( 0 != ( pfn & ( (1UL << order) - 1 ) ) ) {
+      return VM_FAULT_FALLBACK;
+   }
+
+   switch ( order ) {
+      case PMD_ORDER :
+         return vmf_insert_pfn_pmd(vmf, wksp_pfn(pfn), write);
+# if defined( CONFIG_ARCH_SUPPORTS_PUD_PFNMAP )
+      case PUD_ORDER :
+         return vmf_insert_pfn_pud(vmf, wksp_pfn(pfn), write);
+# endif
+      default :
+         return VM_FAULT_FALLBACK;
+   }
+}
+
+static const struct vm_operations_struct wksp_vm_ops =
+{
+   .fault      = wksp_vmafault,
+   .huge_fault = wksp_vmahuge_fault,
+};
+
+#endif // CCI_WKSP_HUGE_MAP
+
+//=============================================================================
+// Name: cci_mmap_pgsize
+// Description: Returns the page size a workspace is mapped into the process with
+// Interface: public
+// Inputs: blkpgsize - page size of the block backing the workspace
+// Outputs: page size of the process mapping.
+// Comments: Assumes the driver places the mapping (no MAP_FIXED) and that
+//           transparent huge pages are not disabled.
+//=============================================================================
+btWSSize cci_mmap_pgsize(btWSSize blkpgsize)
+{
+#if defined( CCI_WKSP_HUGE_MAP )
+# if defined( CONFIG_ARCH_SUPPORTS_PUD_PFNMAP )
+   if ( blkpgsize >= PUD_SIZE ) {
+      return PUD_SIZE;
+   }
+# endif
+   if ( blkpgsize >= PMD_SIZE ) {
+      return PMD_SIZE;
+   }
+#endif // CCI_WKSP_HUGE_MAP
+   return PAGE_SIZE;
+}
+
 
 //=============================================================================
 // Name: cci_mmap
@@ -283,10 +391,33 @@ cci_mmap(struct aaldev_ownerSession *pownerSess,
       goto ERROR;
    }
 
+   // Pinned user memory is already mapped where it came from.
+   if ( WSM_TYPE_PINNED == wsidp->m_type ) {
+      PERR("Attempt to map pinned user memory WSID 0x%llx\n", wsidp->m_id);
+      goto ERROR;
+   }
+
    //------------------------
    // Map normal workspace
    //------------------------
 
+#if defined( CCI_WKSP_HUGE_MAP )
+   // A block of huge pages is mapped on demand, a huge page per fault. Private
+   //  or oversized mappings keep the base page mapping below.
+   if ( ( PAGE_SIZE < cci_mmap_pgsize(wsidp->m_pgsize) ) &&
+        ( pvma->vm_flags & VM_SHARED ) &&
+        ( (btWSSize)(pvma->vm_end - pvma->vm_start) <= wsidp->m_size ) ) {
+
+      PVERBOSE( "MMAP: start 0x%lx, end 0x%lx, KVP 0x%p, size=%" PRIu64 " page size=%" PRIu64 " on demand\n",
+         pvma->vm_start, pvma->vm_end, (btVirtAddr)wsidp->m_id, wsidp->m_size, cci_mmap_pgsize(wsidp->m_pgsize));
+
+      vm_flags_set(pvma, VM_IO | VM_PFNMAP | VM_DONTEXPAND | VM_DONTDUMP | VM_HUGEPAGE);
+      pvma->vm_pgoff = kosal_virt_to_phys((btVirtAddr) wsidp->m_id) >> PAGE_SHIFT;
+      pvma->vm_ops   = &wksp_vm_ops;
+      return 0;
+   }
+#endif // CCI_WKSP_HUGE_MAP
+
    max_length = min(wsidp->m_size, (btWSSize)(pvma->vm_end - pvma->vm_start));
 
    PVERBOSE( "MMAP: start 0x%lx, end 0x%lx, KVP 0x%p, size=%" PRIu64 " 0x%" PRIx64 " max_length=%ld flags=0x%lx\n",
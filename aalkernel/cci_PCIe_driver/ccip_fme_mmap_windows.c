@@ -231,3 +231,17 @@ cci_mmap(struct aaldev_ownerSession *pownerSess,
 ERROR:
    return res;
 }
+
+//=============================================================================
+// Name: cci_mmap_pgsize
+// Description: Returns the page size a workspace is mapped into the process with
+// Interface: public
+// Inputs: blkpgsize - page size of the block backing the workspace
+// Outputs: page size of the process mapping.
+// Comments: Workspaces are always mapped with base pages here.
+//=============================================================================
+btWSSize cci_mmap_pgsize( btWSSize blkpgsize )
+{
+   UNREFERENCED_PARAMETER( blkpgsize );
+   return PAGE_SIZE;
+}
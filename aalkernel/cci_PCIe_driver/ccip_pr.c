@@ -2403,12 +2403,17 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          if(respBufSize >= sizeof(struct aalui_WSMEvent)){
             *((struct aalui_WSMEvent*)Message->m_response) = WSID;
             Message->m_respbufSize = sizeof(struct aalui_WSMEvent);
+         }else{
+            PERR("No room to return WSID. Required sized %ld but size provided %ld\n", sizeof(struct aalui_WSMEvent), (long int)respBufSize);
+            Message->m_errcode = uid_errnumNoMem;
+            ccidrv_freewsid(wsidp);
+            break;
          }
          PDEBUG("Buf size =  %u Returning WSID %llx\n",(unsigned int)Message->m_respbufSize, WSID.wsParms.wsid  );
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
          goto CLEANUP;
       } break;
@@ -2456,7 +2461,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          PDEBUG("Creating Physical WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         cci_PIPsession_add_ws(pSess, wsidp);
 
          PINFO("CCI WS alloc wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -2509,8 +2514,9 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             goto ERROR;
          }
 
-         // Get the workspace ID object
-         wsidp = ccidrv_valwsid(preq->ahmreq.u.wksp.m_wsid);
+         // Take the workspace ID object off the session, so that only one of
+         //  several concurrent frees gets it
+         wsidp = cci_PIPsession_claim_ws(pSess, preq->ahmreq.u.wksp.m_wsid);
 
          ASSERT(wsidp);
          if ( NULL == wsidp ) {
@@ -2534,6 +2540,9 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             PDEBUG( "Workspace free failed due to bad WS type. Should be %d but received %d\n",WSM_TYPE_VIRTUAL,
                   wsidp->m_type);
 
+            // Not ours to free. Give it back to the session.
+            cci_PIPsession_add_ws(pSess, wsidp);
+
             pafuws_evt = ccipdrv_event_afu_afufreecws_create(pownerSess->m_device,
                                                            Message->m_tranID,
                                                            Message->m_context,
@@ -2549,8 +2558,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
 
          kosal_free_contiguous_mem(krnl_virt, wsidp->m_size);
 
-         // remove the wsid from the device and destroy
-         kosal_list_del_init(&wsidp->m_list);
+         // destroy the wsid, already off the session
          ccidrv_freewsid(wsidp);
 
          // Create the  event
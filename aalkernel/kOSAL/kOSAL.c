@@ -74,12 +74,34 @@
 # include <linux/delay.h>
 #include <linux/dma-mapping.h>
 #include <linux/rtc.h>
+#include <linux/mm.h>
+#include <linux/scatterlist.h>
+#include <linux/sched.h>
+#include <linux/capability.h>
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(4,11,0)
+#  include <linux/sched/mm.h>
+# endif
 #endif // __AAL_LINUX__
 
 #if defined( __AAL_UNKNOWN_OS__ )
 # error Implement kOSAL for unknown OS.
 #endif // __AAL_UNKNOWN_OS__
 
+#if defined( __AAL_LINUX__ )
+// Largest order the page allocator serves. Larger requests always fail there
+//  (dma_alloc_coherent() may still satisfy them from CMA), so callers that try
+//  them with a fallback in hand should not get an allocation failure warning.
+# if defined( MAX_PAGE_ORDER )
+#  define KOSAL_MAX_PAGE_ORDER MAX_PAGE_ORDER
+# elif LINUX_VERSION_CODE >= KERNEL_VERSION(6,4,0)
+#  define KOSAL_MAX_PAGE_ORDER MAX_ORDER
+# else
+#  define KOSAL_MAX_PAGE_ORDER (MAX_ORDER - 1)
+# endif
+# define KOSAL_GFP_FOR_ORDER(__order) \
+   ( ( (__order) > KOSAL_MAX_PAGE_ORDER ) ? ( GFP_KERNEL | __GFP_NOWARN ) : GFP_KERNEL )
+#endif // __AAL_LINUX__
+
 //=============================================================================
 /// kosal_pci_read_config_dword
 /// @brief     Read a dword from PCIe device Config space
@@ -366,7 +388,7 @@ btVirtAddr _kosal_alloc_contiguous_mem_nocache(__ASSERT_HERE_PROTO btWSSize size
 
 #if   defined( __AAL_LINUX__ )
 
-   krnl_virt = (btVirtAddr)__get_free_pages(GFP_KERNEL, get_order(size_in_bytes));
+   krnl_virt = (btVirtAddr)__get_free_pages(KOSAL_GFP_FOR_ORDER(get_order(size_in_bytes)), get_order(size_in_bytes));
    __ASSERT_HERE_IN_FN(NULL != krnl_virt);
    if ( NULL == krnl_virt ) {
       return NULL;
@@ -487,7 +509,10 @@ btVirtAddr _kosal_alloc_dma_coherent( __ASSERT_HERE_PROTO btHANDLE devhandle,
 
 #if   defined( __AAL_LINUX__ )
 
-   krnl_virt = (btVirtAddr)dma_alloc_coherent(&((struct pci_dev*)devhandle)->dev, size_in_bytes, (dma_addr_t*)pdma_handle, GFP_KERNEL);
+   krnl_virt = (btVirtAddr)dma_alloc_coherent(&((struct pci_dev*)devhandle)->dev,
+                                              size_in_bytes,
+                                              (dma_addr_t*)pdma_handle,
+                                              KOSAL_GFP_FOR_ORDER(get_order(size_in_bytes)));
    __ASSERT_HERE_IN_FN(NULL != krnl_virt);
    if ( NULL == krnl_virt ) {
       return NULL;
@@ -568,6 +593,251 @@ void _kosal_free_dma_coherent( __ASSERT_HERE_PROTO btHANDLE devhandle,
 #endif // OS
 }
 
+//=============================================================================
+/// kosal_pinned_mem
+/// @brief     Bookkeeping for user memory pinned by kosal_pin_user_mem
+//=============================================================================
+struct kosal_pinned_mem
+{
+#if   defined( __AAL_LINUX__ )
+   struct page    **m_pages;   // The pinned pages
+   unsigned long    m_npages;
+   struct sg_table  m_sgt;     // DMA mapping of m_pages, if m_dev
+   struct device   *m_dev;     // Device the pages are mapped for, NULL if none
+   struct mm_struct *m_mm;     // Address space charged for the pages, NULL if none
+#endif // __AAL_LINUX__
+   btWSSize         m_size;
+};
+
+#if   defined( __AAL_LINUX__ )
+//=============================================================================
+/// kosal_account_locked_vm
+/// @brief     Charge (or uncharge) pinned pages to the locked_vm of an address space
+/// @param[in] mm Address space
+///            npages Number of pages
+///            inc true to charge, false to uncharge
+/// @return    0 on success, -ENOMEM if charging would exceed RLIMIT_MEMLOCK
+///            and the caller does not have CAP_IPC_LOCK.
+/// @note      Charging checks the limit of the current task, so it must be
+///            done in the context of the process that owns mm.
+//=============================================================================
+static int kosal_account_locked_vm(struct mm_struct *mm, unsigned long npages, bool inc)
+{
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(5,3,0)
+   return account_locked_vm(mm, npages, inc);
+# else
+   int ret = 0;
+
+   down_write(&mm->mmap_sem);
+   if ( inc ) {
+      if ( ( mm->locked_vm + npages > ( rlimit(RLIMIT_MEMLOCK) >> PAGE_SHIFT ) ) &&
+           !capable(CAP_IPC_LOCK) ) {
+         ret = -ENOMEM;
+      } else {
+         mm->locked_vm += npages;
+      }
+   } else {
+      mm->locked_vm -= min(npages, mm->locked_vm);
+   }
+   up_write(&mm->mmap_sem);
+
+   return ret;
+# endif
+}
+
+static void kosal_put_user_pages(struct page **pages, unsigned long npages)
+{
+   // The device may have written them.
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(5,6,0)
+   unpin_user_pages_dirty_lock(pages, npages, true);
+# else
+   unsigned long i;
+   for ( i = 0 ; i < npages ; ++i ) {
+      set_page_dirty_lock(pages[i]);
+      put_page(pages[i]);
+   }
+# endif
+}
+#endif // __AAL_LINUX__
+
+//=============================================================================
+/// _kosal_pin_user_mem
+/// @brief     Pin existing user memory of the current process for device access
+/// @param[in] devhandle OS specific device to map the memory for. NULL for none.
+///            uvirt User virtual address of the memory
+///            size in bytes
+///            piova Address to return the address at which the device sees uvirt
+/// @return    Pinned memory object, to be passed to kosal_unpin_user_mem. NULL if
+///            the memory could not be pinned, or if the device would not see it as
+///            one contiguous range.
+/// @note      With an IOMMU the pages are mapped into one contiguous IO virtual
+///            range. Without one (and for devhandle NULL), the pages must happen
+///            to be physically contiguous.
+//=============================================================================
+struct kosal_pinned_mem * _kosal_pin_user_mem( __ASSERT_HERE_PROTO btHANDLE devhandle,
+                                               btVirtAddr uvirt,
+                                               btWSSize size_in_bytes,
+                                               btPhysAddr *piova)
+{
+   struct kosal_pinned_mem *ppinned = NULL;
+#if   defined( __AAL_LINUX__ )
+   unsigned long start  = ((unsigned long)uvirt) & PAGE_MASK;
+   unsigned long offset = ((unsigned long)uvirt) & ~PAGE_MASK;
+   unsigned long npages = PAGE_ALIGN(offset + size_in_bytes) >> PAGE_SHIFT;
+   unsigned long i;
+   long          pinned;
+   int           nents;
+   btPhysAddr    next;
+   struct scatterlist *sg;
+#endif // __AAL_LINUX__
+
+   __ASSERT_HERE_IN_FN(NULL != uvirt);
+   __ASSERT_HERE_IN_FN(size_in_bytes > 0);
+
+#if   defined( __AAL_LINUX__ )
+
+   ppinned = (struct kosal_pinned_mem *)kzalloc(sizeof(struct kosal_pinned_mem), GFP_KERNEL);
+   if ( NULL == ppinned ) {
+      return NULL;
+   }
+   ppinned->m_size = size_in_bytes;
+
+   ppinned->m_pages = (struct page **)vmalloc(npages * sizeof(struct page *));
+   if ( NULL == ppinned->m_pages ) {
+      kfree(ppinned);
+      return NULL;
+   }
+
+   // Pinned pages count against the memlock limit, like mlock()ed ones. Keep a
+   //  reference to the address space; the pages may be unpinned after it exits.
+   if ( 0 != kosal_account_locked_vm(current->mm, npages, true) ) {
+      PERR("kosal_pin_user_mem: %lu pages at 0x%lx exceed RLIMIT_MEMLOCK\n", npages, start);
+      vfree(ppinned->m_pages);
+      kfree(ppinned);
+      return NULL;
+   }
+   ppinned->m_mm = current->mm;
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(4,11,0)
+   mmgrab(ppinned->m_mm);
+# else
+   atomic_inc(&ppinned->m_mm->mm_count);
+# endif
+
+# if LINUX_VERSION_CODE >= KERNEL_VERSION(5,6,0)
+   // The pin lasts until the workspace is freed. FOLL_LONGTERM first moves the
+   //  pages out of movable zones and CMA, so they do not block migration.
+   pinned = pin_user_pages_fast(start, (int)npages, FOLL_WRITE | FOLL_LONGTERM, ppinned->m_pages);
+# elif LINUX_VERSION_CODE >= KERNEL_VERSION(5,2,0)
+   pinned = get_user_pages_fast(start, (int)npages, FOLL_WRITE, ppinned->m_pages);
+# else
+   pinned = get_user_pages_fast(start, (int)npages, 1, ppinned->m_pages);
+# endif
+   if ( pinned < 0 ) {
+      pinned = 0;
+   }
+   ppinned->m_npages = (unsigned long)pinned;
+   if ( ppinned->m_npages != npages ) {
+      PERR("kosal_pin_user_mem: pinned %lu of %lu pages at 0x%lx\n", ppinned->m_npages, npages, start);
+      goto ERROR;
+   }
+
+   if ( NULL != devhandle ) {
+      // Map through the IOMMU (if any) into one IO virtual range.
+      ppinned->m_dev = &((struct pci_dev *)devhandle)->dev;
+      if ( 0 != sg_alloc_table_from_pages(&ppinned->m_sgt, ppinned->m_pages, (unsigned int)npages,
+                                          (unsigned int)offset, (unsigned long)size_in_bytes, GFP_KERNEL) ) {
+         ppinned->m_dev = NULL;
+         goto ERROR;
+      }
+      nents = dma_map_sg(ppinned->m_dev, ppinned->m_sgt.sgl, ppinned->m_sgt.orig_nents, DMA_BIDIRECTIONAL);
+      if ( 0 == nents ) {
+         sg_free_table(&ppinned->m_sgt);
+         ppinned->m_dev = NULL;
+         goto ERROR;
+      }
+
+      // The device addresses a workspace as one range, so the mapped segments must abut.
+      *piova = (btPhysAddr)sg_dma_address(ppinned->m_sgt.sgl);
+      next   = *piova;
+      for_each_sg(ppinned->m_sgt.sgl, sg, nents, i) {
+         if ( (btPhysAddr)sg_dma_address(sg) != next ) {
+            PERR("kosal_pin_user_mem: 0x%lx does not map to one contiguous IO virtual range\n", start);
+            dma_unmap_sg(ppinned->m_dev, ppinned->m_sgt.sgl, ppinned->m_sgt.orig_nents, DMA_BIDIRECTIONAL);
+            sg_free_table(&ppinned->m_sgt);
+            ppinned->m_dev = NULL;
+            goto ERROR;
+         }
+         next += sg_dma_len(sg);
+      }
+   } else {
+      for ( i = 1 ; i < npages ; ++i ) {
+         if ( page_to_pfn(ppinned->m_pages[i]) != page_to_pfn(ppinned->m_pages[0]) + i ) {
+            PERR("kosal_pin_user_mem: 0x%lx is not physically contiguous\n", start);
+            goto ERROR;
+         }
+      }
+      *piova = (btPhysAddr)page_to_phys(ppinned->m_pages[0]) + offset;
+   }
+
+   PMEMORY_HERE("kosal_pin_user_mem(uvirt=0x%" PRIxUINTPTR_T ", bytes=%llu [0x%llx]) = 0x%" PRIxUINTPTR_T " [iova=0x%" PRIxPHYS_ADDR "]\n",
+                   __UINTPTR_T_CAST(uvirt),
+                   size_in_bytes, size_in_bytes,
+                   __UINTPTR_T_CAST(ppinned),
+                   *piova);
+
+   return ppinned;
+
+ERROR:
+   kosal_put_user_pages(ppinned->m_pages, ppinned->m_npages);
+   kosal_account_locked_vm(ppinned->m_mm, npages, false);
+   mmdrop(ppinned->m_mm);
+   vfree(ppinned->m_pages);
+   kfree(ppinned);
+   return NULL;
+
+#elif defined( __AAL_WINDOWS__ )
+   UNREFERENCED_PARAMETER(devhandle);
+   UNREFERENCED_PARAMETER(uvirt);
+   UNREFERENCED_PARAMETER(size_in_bytes);
+   UNREFERENCED_PARAMETER(piova);
+
+   // Not implemented.
+   return ppinned;
+#endif // OS
+}
+
+//=============================================================================
+/// _kosal_unpin_user_mem
+/// @brief     Release user memory pinned by kosal_pin_user_mem
+/// @param[in] ppinned Pinned memory object
+/// @return    void
+//=============================================================================
+void _kosal_unpin_user_mem(__ASSERT_HERE_PROTO struct kosal_pinned_mem *ppinned)
+{
+   __ASSERT_HERE_IN_FN(NULL != ppinned);
+   if ( NULL == ppinned ) {
+      return;
+   }
+
+   PMEMORY_HERE("kosal_unpin_user_mem(0x%" PRIxUINTPTR_T ", bytes=%llu [0x%llx])\n",
+                   __UINTPTR_T_CAST(ppinned),
+                   ppinned->m_size, ppinned->m_size);
+
+#if   defined( __AAL_LINUX__ )
+   if ( NULL != ppinned->m_dev ) {
+      dma_unmap_sg(ppinned->m_dev, ppinned->m_sgt.sgl, ppinned->m_sgt.orig_nents, DMA_BIDIRECTIONAL);
+      sg_free_table(&ppinned->m_sgt);
+   }
+   kosal_put_user_pages(ppinned->m_pages, ppinned->m_npages);
+   if ( NULL != ppinned->m_mm ) {
+      kosal_account_locked_vm(ppinned->m_mm, ppinned->m_npages, false);
+      mmdrop(ppinned->m_mm);
+   }
+   vfree(ppinned->m_pages);
+   kfree(ppinned);
+#endif // __AAL_LINUX__
+}
+
 #if   defined( __AAL_LINUX__ )
 
 void task_poller(struct work_struct *work)
@@ -64,12 +64,18 @@ BEGIN_NAMESPACE(AAL)
 /// @{
 
 _MessageDelivery::_MessageDelivery() :
-   m_Dispatcher() // Default is a simple single threaded scheduler.
+   m_Dispatchers(),
+   m_Placement(ThreadPlacement::SDKDefault())
 {
    if ( EObjOK != SetInterface(iidMDS,
                                dynamic_cast<IMessageDeliveryService *>(this)) ) {
       m_bIsOK = false;
    }
+
+   // Default is a simple single threaded scheduler.
+   if ( !SetDeliveryThreads(1) ) {
+      m_bIsOK = false;
+   }
 }
 
 //=============================================================================
@@ -81,6 +87,12 @@ _MessageDelivery::_MessageDelivery() :
 _MessageDelivery::~_MessageDelivery()
 {
    StopMessageDelivery();
+
+   dispatcher_vector::iterator iter;
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      delete *iter;
+   }
+   m_Dispatchers.clear();
 }
 
 //=============================================================================
@@ -92,7 +104,11 @@ _MessageDelivery::~_MessageDelivery()
 void _MessageDelivery::StartMessageDelivery()
 {
    AutoLock(this);
-   m_Dispatcher.Start();
+
+   dispatcher_vector::iterator iter;
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      (*iter)->Start();
+   }
 }
 
 //=============================================================================
@@ -104,8 +120,14 @@ void _MessageDelivery::StartMessageDelivery()
 void _MessageDelivery::StopMessageDelivery()
 {
    AutoLock(this);
-   m_Dispatcher.Drain();
-   m_Dispatcher.Stop();
+
+   dispatcher_vector::iterator iter;
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      (*iter)->Drain();
+   }
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      (*iter)->Stop();
+   }
 }
 
 //=============================================================================
@@ -115,9 +137,114 @@ void _MessageDelivery::StopMessageDelivery()
 // Comments:
 //=============================================================================
 btBool _MessageDelivery::scheduleMessage(IDispatchable *pDispatchable)
+{
+   ASSERT(NULL != pDispatchable);
+   if ( NULL == pDispatchable ) {
+      return false;
+   }
+
+   const btObjectType Target = pDispatchable->DeliveryTarget();
+
+   AutoLock(this);
+   return m_Dispatchers[Dispatcher(Target)]->Add(pDispatchable);
+}
+
+//=============================================================================
+// Name: SetDeliveryThreads
+// Description: Set the number of message delivery threads
+// Interface: public
+// Comments: The dispatcher for a target depends on the number of threads, so
+//           the current dispatchers are drained before the threads change.
+//=============================================================================
+btBool _MessageDelivery::SetDeliveryThreads(btUnsignedInt NumThreads)
+{
+   if ( ( 0 == NumThreads ) || ( NumThreads > MaxDeliveryThreads ) ) {
+      AAL_ERR(LM_AAS, "_MessageDelivery::SetDeliveryThreads() " << NumThreads <<
+                      " is not in 1 .. " << MaxDeliveryThreads << std::endl);
+      return false;
+   }
+
+   AutoLock(this);
+
+   if ( NumThreads == (btUnsignedInt)m_Dispatchers.size() ) {
+      return true;
+   }
+
+   dispatcher_vector::iterator iter;
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      (*iter)->Drain();
+   }
+
+   while ( NumThreads < (btUnsignedInt)m_Dispatchers.size() ) {
+      delete m_Dispatchers.back();
+      m_Dispatchers.pop_back();
+   }
+
+   while ( NumThreads > (btUnsignedInt)m_Dispatchers.size() ) {
+      OSLThreadGroup *pDispatcher = new(std::nothrow) OSLThreadGroup(1,
+                                                                     1,
+                                                                     OSLThread::THREADPRIORITY_NORMAL,
+                                                                     AAL_INFINITE_WAIT,
+                                                                     OSLThreadGroup::SharedQueue,
+                                                                     m_Placement);
+      if ( ( NULL == pDispatcher ) || !pDispatcher->IsOK() ) {
+         AAL_ERR(LM_AAS, "_MessageDelivery::SetDeliveryThreads() failed to create dispatcher " <<
+                         m_Dispatchers.size() << std::endl);
+         if ( NULL != pDispatcher ) {
+            delete pDispatcher;
+         }
+         return m_Dispatchers.size() > 0;
+      }
+      m_Dispatchers.push_back(pDispatcher);
+   }
+
+   return true;
+}
+
+//=============================================================================
+// Name: SetDeliveryPlacement
+// Description: Set the placement of the message delivery threads
+// Interface: public
+// Comments: Threads can't be moved once running, so the dispatchers are
+//           drained and replaced.
+//=============================================================================
+btBool _MessageDelivery::SetDeliveryPlacement(const ThreadPlacement &Placement)
 {
    AutoLock(this);
-   return m_Dispatcher.Add(pDispatchable);
+
+   m_Placement = Placement;
+
+   const btUnsignedInt NumThreads = (btUnsignedInt)m_Dispatchers.size();
+
+   dispatcher_vector::iterator iter;
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      (*iter)->Drain();
+   }
+   for ( iter = m_Dispatchers.begin() ; m_Dispatchers.end() != iter ; ++iter ) {
+      delete *iter;
+   }
+   m_Dispatchers.clear();
+
+   return SetDeliveryThreads(( 0 == NumThreads ) ? 1 : NumThreads);
+}
+
+btUnsignedInt _MessageDelivery::DeliveryThreads() const
+{
+   AutoLock(this);
+   return (btUnsignedInt)m_Dispatchers.size();
+}
+
+btUnsignedInt _MessageDelivery::Dispatcher(btObjectType Target) const
+{
+   const btUnsignedInt n = (btUnsignedInt)m_Dispatchers.size();
+
+   if ( ( NULL == Target ) || ( n < 2 ) ) {
+      return 0;
+   }
+
+   // Fibonacci hash of the target address - the low bits are mostly alignment.
+   const btUnsigned64bitInt h = (btUnsigned64bitInt)(btUIntPtr)Target * 0x9e3779b97f4a7c15ULL;
+   return (btUnsignedInt)( (h >> 32) % n );
 }
 
 /// @}
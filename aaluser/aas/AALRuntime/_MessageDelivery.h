@@ -73,8 +73,34 @@ public:
    virtual btBool    scheduleMessage(IDispatchable * );
    // </IMessageDeliveryService>
 
+   enum { MaxDeliveryThreads = 64 };
+
+   /// Deliver on NumThreads threads (1 .. MaxDeliveryThreads). Dispatchables with the same
+   ///  IDispatchable::DeliveryTarget() are always delivered by the same thread, in the order
+   ///  scheduled; dispatchables with no target are delivered in order by the first thread.
+   /// Messages already scheduled are delivered before this returns.
+   btBool SetDeliveryThreads(btUnsignedInt NumThreads);
+   btUnsignedInt DeliveryThreads() const;
+
+   /// Recreate the delivery threads with Placement. Messages already scheduled are
+   ///  delivered before this returns.
+   btBool SetDeliveryPlacement(const ThreadPlacement &Placement);
+
 protected:
-   OSLThreadGroup m_Dispatcher;
+   /// The index of the dispatcher for Target.
+   btUnsignedInt Dispatcher(btObjectType Target) const;
+
+   typedef std::vector<OSLThreadGroup *> dispatcher_vector;
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif // _MSC_VER
+   dispatcher_vector m_Dispatchers;  // Each a simple single threaded scheduler.
+   ThreadPlacement   m_Placement;    // Of the dispatcher threads.
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif // _MSC_VER
 };
 
 END_NAMESPACE(AAL)
@@ -263,6 +263,45 @@ btBool _runtime::start(Runtime             *pProxy,
 
    }
 
+   // Place and size message delivery before the default Services start using it.
+   {
+      INamedValueSet const *pConfigRecord = NULL;
+      btUnsigned32bitInt    MDSThreads    = 0;
+      btcString             sPlacement    = NULL;
+      ThreadPlacement       Placement;
+
+      if ( ( ENamedValuesOK == rConfigParms.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) &&
+           ( ENamedValuesOK == pConfigRecord->Get(AALRUNTIME_CONFIG_THREAD_PLACEMENT, &sPlacement) ) ) {
+         if ( !Placement.FromString(sPlacement) ) {
+            pDisp = new RuntimeStartFailed(m_pOwnerClient,
+                                           new CExceptionTransactionEvent(pProxy,
+                                                                          exttranevtSystemStart,
+                                                                          TransactionID(),
+                                                                          errSysSystemStarted,
+                                                                          reasParameterValueInvalid,
+                                                                          "Invalid " AALRUNTIME_CONFIG_THREAD_PLACEMENT));
+            goto _DISP;
+         }
+
+         // The Services started from here on place their threads with it, too.
+         ThreadPlacement::SDKDefault(Placement);
+         m_MDS.SetDeliveryPlacement(Placement);
+      }
+
+      if ( ( ENamedValuesOK == rConfigParms.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) &&
+           ( ENamedValuesOK == pConfigRecord->Get(AALRUNTIME_CONFIG_MDS_THREADS, &MDSThreads) ) &&
+           !m_MDS.SetDeliveryThreads(MDSThreads) ) {
+         pDisp = new RuntimeStartFailed(m_pOwnerClient,
+                                        new CExceptionTransactionEvent(pProxy,
+                                                                       exttranevtSystemStart,
+                                                                       TransactionID(),
+                                                                       errSysSystemStarted,
+                                                                       reasParameterValueInvalid,
+                                                                       "Invalid " AALRUNTIME_CONFIG_MDS_THREADS));
+         goto _DISP;
+      }
+   }
+
    // InstallDefaults() will wait for a notification. Don't wait while locked..
    if ( !InstallDefaults() ) {
       // Fire the event and wait for it to be dispatched.
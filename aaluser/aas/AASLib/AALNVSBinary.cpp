@@ -0,0 +1,961 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file AALNVSBinary.cpp
+/// @brief Binary wire format for NamedValueSets, and an in-place read-only view.
+/// @ingroup BasicTypes
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/AALNVSBinary.h"  // This module's definitions
+#include "aalsdk/osal/Env.h"
+
+#include <string.h>
+#include <new>
+
+
+BEGIN_NAMESPACE(AAL)
+
+
+// Sizes and field offsets of the wire structures. See AALNVSBinary.h.
+enum NVSBinaryLayout
+{
+   HdrSize         = 16,
+   HdrMagic        = 0,
+   HdrVersion      = 4,
+   HdrHeaderSize   = 6,
+   HdrLength       = 8,
+
+   SetSize         = 8,
+   SetCount        = 0,
+   SetBytes        = 4,
+
+   EntSize         = 16,
+   EntBytes        = 0,
+   EntNameType     = 4,
+   EntType         = 6,
+   EntKeyLen       = 8,
+   EntElements     = 12,
+
+   SlotSize        = 8
+};
+
+static inline btUnsigned64bitInt Align8(btUnsigned64bitInt n) { return (n + 7) & ~(btUnsigned64bitInt)7; }
+
+// Field access through memcpy(), so that none of it depends on the alignment of the buffer.
+static inline btUnsigned16bitInt Rd16(const btByte *p) { btUnsigned16bitInt v; memcpy(&v, p, sizeof(v)); return v; }
+static inline btUnsigned32bitInt Rd32(const btByte *p) { btUnsigned32bitInt v; memcpy(&v, p, sizeof(v)); return v; }
+static inline btUnsigned64bitInt Rd64(const btByte *p) { btUnsigned64bitInt v; memcpy(&v, p, sizeof(v)); return v; }
+static inline void Wr16(btByte *p, btUnsigned16bitInt v) { memcpy(p, &v, sizeof(v)); }
+static inline void Wr32(btByte *p, btUnsigned32bitInt v) { memcpy(p, &v, sizeof(v)); }
+static inline void Wr64(btByte *p, btUnsigned64bitInt v) { memcpy(p, &v, sizeof(v)); }
+
+// Size of one element of an array type, 0 for anything that is not a fixed-size array.
+static btUnsigned32bitInt ElementSize(btUnsigned16bitInt Type)
+{
+   switch ( Type ) {
+      case btByteArray_t             : return sizeof(btByte);
+      case bt32bitIntArray_t         : return sizeof(bt32bitInt);
+      case btUnsigned32bitIntArray_t : return sizeof(btUnsigned32bitInt);
+      case bt64bitIntArray_t         : return sizeof(bt64bitInt);
+      case btUnsigned64bitIntArray_t : return sizeof(btUnsigned64bitInt);
+      case btFloatArray_t            : return sizeof(btFloat);
+      case btObjectArray_t           : return sizeof(btUnsigned64bitInt);
+      default                        : return 0;
+   }
+}
+
+static btBool IsScalar(btUnsigned16bitInt Type)
+{
+   switch ( Type ) {
+      case btBool_t             :
+      case btByte_t             :
+      case bt32bitInt_t         :
+      case btUnsigned32bitInt_t :
+      case bt64bitInt_t         :
+      case btUnsigned64bitInt_t :
+      case btFloat_t            :
+      case btObjectType_t       : return true;
+      default                   : return false;
+   }
+}
+
+
+//=============================================================================
+// Name:        NVSBinaryWriter
+// Description: Appends the encoding of an NVS to a buffer. With a NULL buffer,
+//              or once the buffer is full, it only counts the bytes that the
+//              encoding needs.
+//=============================================================================
+class NVSBinaryWriter
+{
+public:
+   NVSBinaryWriter(btByte *pBuf, btWSSize Len) :
+      m_pBuf(pBuf),
+      m_Len(Len),
+      m_Pos(0),
+      m_bFull(NULL == pBuf),
+      m_bBad(false)
+   {}
+
+   btWSSize Pos()  const { return m_Pos;   }
+   btBool   Full() const { return m_bFull; }
+   btBool   Bad()  const { return m_bBad;  }
+   void     Fail()       { m_bBad = true;  }
+
+   // Returns the next Bytes bytes of the buffer, zeroed, or NULL if only counting.
+   btByte * Take(btWSSize Bytes)
+   {
+      btByte *p = NULL;
+      if ( !m_bFull && ( m_Len - m_Pos >= Bytes ) ) {
+         p = m_pBuf + m_Pos;
+         memset(p, 0, (size_t)Bytes);
+      } else {
+         m_bFull = true;
+      }
+      m_Pos += Bytes;
+      return p;
+   }
+
+   void Put(const void *pSrc, btWSSize Bytes)
+   {
+      btByte *p = Take(Bytes);
+      if ( NULL != p ) {
+         memcpy(p, pSrc, (size_t)Bytes);
+      }
+   }
+
+   void Pad() { Take(Align8(m_Pos) - m_Pos); }
+
+   void Set(btUnsignedInt Depth, const INamedValueSet &rNVS);
+
+private:
+   template <typename K>
+   void Entry(btUnsignedInt Depth, const INamedValueSet &rNVS, eNameTypes NameType, K Name);
+
+   void Key(btNumberKey Name) { Put(&Name, sizeof(Name)); }
+   void Key(btStringKey Name) { Put(Name, strlen(Name) + 1); }
+
+   static btUnsigned32bitInt KeyLen(btNumberKey )     { return sizeof(btNumberKey); }
+   static btUnsigned32bitInt KeyLen(btStringKey Name) { return (btUnsigned32bitInt)strlen(Name); }
+
+   btByte   *m_pBuf;
+   btWSSize  m_Len;
+   btWSSize  m_Pos;
+   btBool    m_bFull;
+   btBool    m_bBad;
+};
+
+void NVSBinaryWriter::Set(btUnsignedInt Depth, const INamedValueSet &rNVS)
+{
+   if ( Depth > NVS_BINARY_MAX_DEPTH ) {
+      Fail();
+      return;
+   }
+
+   btUnsignedInt Count = 0;
+   btUnsignedInt i;
+   eNameTypes    NameType;
+   btNumberKey   iName;
+   btStringKey   sName;
+
+   rNVS.GetNumNames(&Count);
+
+   const btWSSize Start = m_Pos;
+   btByte        *pHdr  = Take(SetSize);
+
+   for ( i = 0 ; ( i < Count ) && !m_bBad ; ++i ) {
+      rNVS.GetNameType(i, &NameType);
+      if ( btNumberKey_t == NameType ) {
+         rNVS.GetName(i, &iName);
+         Entry(Depth, rNVS, NameType, iName);
+      } else if ( btStringKey_t == NameType ) {
+         rNVS.GetName(i, &sName);
+         Entry(Depth, rNVS, NameType, sName);
+      } else {
+         Fail();
+      }
+   }
+
+   if ( m_Pos - Start > 0xffffffff ) {
+      Fail();
+   } else if ( NULL != pHdr ) {
+      Wr32(pHdr + SetCount, Count);
+      Wr32(pHdr + SetBytes, (btUnsigned32bitInt)(m_Pos - Start));
+   }
+}
+
+#define NVSBINARY_SCALAR_CASE(__t) case __t##_t : { \
+   __t __val;                                        \
+   rNVS.Get(Name, &__val);                           \
+   Put(&__val, sizeof(__val));                       \
+} break
+
+#define NVSBINARY_ARRAY_CASE(__t) case __t##Array_t : { \
+   __t     *__val = NULL;                                \
+   rNVS.Get(Name, &__val);                               \
+   Put(__val, Elements * sizeof(__t));                   \
+} break
+
+template <typename K>
+void NVSBinaryWriter::Entry(btUnsignedInt Depth, const INamedValueSet &rNVS, eNameTypes NameType, K Name)
+{
+   eBasicTypes Type  = btUnknownType_t;
+   btWSSize    Size  = 0;
+   rNVS.Type(Name, &Type);
+   rNVS.GetSize(Name, &Size);
+
+   btUnsigned32bitInt Elements = (btUnsigned32bitInt)Size;
+   const btWSSize     Start    = m_Pos;
+   btByte            *pHdr     = Take(EntSize);
+
+   Key(Name);
+   Pad();
+
+   switch ( Type ) {
+      NVSBINARY_SCALAR_CASE(btBool);
+      NVSBINARY_SCALAR_CASE(btByte);
+      NVSBINARY_SCALAR_CASE(bt32bitInt);
+      NVSBINARY_SCALAR_CASE(btUnsigned32bitInt);
+      NVSBINARY_SCALAR_CASE(bt64bitInt);
+      NVSBINARY_SCALAR_CASE(btUnsigned64bitInt);
+      NVSBINARY_SCALAR_CASE(btFloat);
+
+      case btObjectType_t : {
+         btObjectType val = NULL;
+         rNVS.Get(Name, &val);
+         btUnsigned64bitInt u64 = static_cast<btUnsigned64bitInt>(reinterpret_cast<btUIntPtr>(val));
+         Put(&u64, sizeof(u64));
+      } break;
+
+      case btString_t : {
+         btcString val = NULL;
+         rNVS.Get(Name, &val);
+         Elements = (btUnsigned32bitInt)strlen(val);
+         Put(val, Elements + 1);
+      } break;
+
+      case btNamedValueSet_t : {
+         INamedValueSet const *pval = NULL;
+         rNVS.Get(Name, &pval);
+         Elements = 1;
+         Set(Depth + 1, *pval);
+      } break;
+
+      NVSBINARY_ARRAY_CASE(btByte);
+      NVSBINARY_ARRAY_CASE(bt32bitInt);
+      NVSBINARY_ARRAY_CASE(btUnsigned32bitInt);
+      NVSBINARY_ARRAY_CASE(bt64bitInt);
+      NVSBINARY_ARRAY_CASE(btUnsigned64bitInt);
+      NVSBINARY_ARRAY_CASE(btFloat);
+
+      case btObjectArray_t : {
+         btObjectType *val = NULL;
+         rNVS.Get(Name, &val);
+         btUnsigned32bitInt i;
+         for ( i = 0 ; i < Elements ; ++i ) {
+            btUnsigned64bitInt u64 = static_cast<btUnsigned64bitInt>(reinterpret_cast<btUIntPtr>(val[i]));
+            Put(&u64, sizeof(u64));
+         }
+      } break;
+
+      case btStringArray_t : {
+         btString *val = NULL;
+         rNVS.Get(Name, &val);
+
+         const btWSSize Value   = m_Pos;
+         btByte        *pOffset = Take(Elements * sizeof(btUnsigned32bitInt));
+         btUnsigned32bitInt i;
+         for ( i = 0 ; i < Elements ; ++i ) {
+            if ( NULL != pOffset ) {
+               Wr32(pOffset + i * sizeof(btUnsigned32bitInt), (btUnsigned32bitInt)(m_Pos - Value));
+            }
+            Put(val[i], strlen(val[i]) + 1);
+         }
+      } break;
+
+      default : {
+         Fail();
+      } return;
+   }
+
+   Pad();
+
+   if ( m_Pos - Start > 0xffffffff ) {
+      Fail();
+   } else if ( NULL != pHdr ) {
+      Wr32(pHdr + EntBytes,    (btUnsigned32bitInt)(m_Pos - Start));
+      Wr16(pHdr + EntNameType, (btUnsigned16bitInt)NameType);
+      Wr16(pHdr + EntType,     (btUnsigned16bitInt)Type);
+      Wr32(pHdr + EntKeyLen,   KeyLen(Name));
+      Wr32(pHdr + EntElements, Elements);
+   }
+}
+
+static void NVSBinaryEncode(NVSBinaryWriter &w, const INamedValueSet &rNVS)
+{
+   btByte *pHdr = w.Take(HdrSize);
+   w.Set(0, rNVS);
+
+   if ( w.Pos() > 0xffffffff ) {
+      w.Fail();
+   } else if ( NULL != pHdr ) {
+      Wr32(pHdr + HdrMagic,      NVS_BINARY_MAGIC);
+      Wr16(pHdr + HdrVersion,    NVS_BINARY_VERSION);
+      Wr16(pHdr + HdrHeaderSize, HdrSize);
+      Wr32(pHdr + HdrLength,     (btUnsigned32bitInt)w.Pos());
+   }
+}
+
+
+//=============================================================================
+// Validation. Each function checks one structure at byte offset Off of pBuf,
+//    none of whose bytes may lie at or beyond Limit. All arithmetic is 64-bit,
+//    on 32-bit quantities, so none of it can overflow.
+//=============================================================================
+static btBool NVSBinaryValidSet(const btByte *pBuf, btUnsigned64bitInt Off, btUnsigned64bitInt Limit, btUnsignedInt Depth);
+
+static btBool NVSBinaryValidEntry(const btByte *pBuf, btUnsigned64bitInt Off, btUnsigned64bitInt End, btUnsignedInt Depth)
+{
+   const btByte            *p        = pBuf + Off;
+   const btUnsigned16bitInt NameType = Rd16(p + EntNameType);
+   const btUnsigned16bitInt Type     = Rd16(p + EntType);
+   const btUnsigned32bitInt KeyLen   = Rd32(p + EntKeyLen);
+   const btUnsigned32bitInt Elements = Rd32(p + EntElements);
+
+   btUnsigned64bitInt Key = Off + EntSize;
+   btUnsigned64bitInt KeyBytes;
+
+   if ( btNumberKey_t == NameType ) {
+      if ( sizeof(btNumberKey) != KeyLen ) {
+         return false;
+      }
+      KeyBytes = KeyLen;
+   } else if ( btStringKey_t == NameType ) {
+      KeyBytes = (btUnsigned64bitInt)KeyLen + 1;
+   } else {
+      return false;
+   }
+
+   if ( Key + KeyBytes > End ) {
+      return false;
+   }
+   if ( ( btStringKey_t == NameType ) &&
+        ( ( 0 != pBuf[Key + KeyLen] ) || ( NULL != memchr(pBuf + Key, 0, KeyLen) ) ) ) {
+      return false;
+   }
+
+   const btUnsigned64bitInt Value = Align8(Key + KeyBytes);
+   btUnsigned64bitInt       ValueBytes;
+
+   if ( Value > End ) {
+      return false;
+   }
+
+   if ( IsScalar(Type) ) {
+
+      if ( 1 != Elements ) {
+         return false;
+      }
+      ValueBytes = SlotSize;
+
+   } else if ( btString_t == Type ) {
+
+      ValueBytes = (btUnsigned64bitInt)Elements + 1;
+      if ( ( Value + ValueBytes > End ) ||
+           ( 0 != pBuf[Value + Elements] ) ||
+           ( NULL != memchr(pBuf + Value, 0, Elements) ) ) {
+         return false;
+      }
+
+   } else if ( btNamedValueSet_t == Type ) {
+
+      if ( ( 1 != Elements ) || !NVSBinaryValidSet(pBuf, Value, End, Depth + 1) ) {
+         return false;
+      }
+      ValueBytes = Rd32(pBuf + Value + SetBytes);
+
+   } else if ( btStringArray_t == Type ) {
+
+      if ( 0 == Elements ) {
+         return false;
+      }
+      ValueBytes = (btUnsigned64bitInt)Elements * sizeof(btUnsigned32bitInt);
+      if ( Value + ValueBytes > End ) {
+         return false;
+      }
+      btUnsigned32bitInt i;
+      for ( i = 0 ; i < Elements ; ++i ) {
+         if ( Rd32(pBuf + Value + i * sizeof(btUnsigned32bitInt)) != ValueBytes ) {
+            return false;
+         }
+         const btByte *pStr = pBuf + Value + ValueBytes;
+         const btByte *pNUL = static_cast<const btByte *>(memchr(pStr, 0, (size_t)(End - (Value + ValueBytes))));
+         if ( NULL == pNUL ) {
+            return false;
+         }
+         ValueBytes += (pNUL - pStr) + 1;
+      }
+
+   } else if ( 0 != ElementSize(Type) ) {
+
+      if ( 0 == Elements ) {
+         return false;
+      }
+      ValueBytes = (btUnsigned64bitInt)Elements * ElementSize(Type);
+
+   } else {
+      return false;
+   }
+
+   // The entry ends exactly at its value, padded.
+   return Align8(Value + ValueBytes) == End;
+}
+
+static btBool NVSBinaryValidSet(const btByte *pBuf, btUnsigned64bitInt Off, btUnsigned64bitInt Limit, btUnsignedInt Depth)
+{
+   if ( ( Depth > NVS_BINARY_MAX_DEPTH ) || ( Off + SetSize > Limit ) ) {
+      return false;
+   }
+
+   const btUnsigned32bitInt Count = Rd32(pBuf + Off + SetCount);
+   const btUnsigned64bitInt End   = Off + Rd32(pBuf + Off + SetBytes);
+
+   if ( ( End < Off + SetSize ) || ( End > Limit ) ) {
+      return false;
+   }
+
+   btUnsigned64bitInt Pos = Off + SetSize;
+   btUnsigned32bitInt i;
+
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( Pos + EntSize > End ) {
+         return false;
+      }
+      const btUnsigned32bitInt Bytes = Rd32(pBuf + Pos + EntBytes);
+      if ( ( Bytes < EntSize ) || ( 0 != ( Bytes & 7 ) ) || ( Pos + Bytes > End ) ||
+           !NVSBinaryValidEntry(pBuf, Pos, Pos + Bytes, Depth) ) {
+         return false;
+      }
+      Pos += Bytes;
+   }
+
+   return Pos == End;
+}
+
+// Returns the byte length of the binary NVS at pBuf, or 0 if it is not well-formed.
+static btUnsigned32bitInt NVSBinaryValidate(const btByte *pBuf, btWSSize Len)
+{
+   if ( !IsNVSBinary(pBuf, Len) ) {
+      return 0;
+   }
+
+   const btUnsigned32bitInt Length = Rd32(pBuf + HdrLength);
+
+   if ( ( Length > Len ) ||
+        ( HdrSize != Rd16(pBuf + HdrHeaderSize) ) ||
+        !NVSBinaryValidSet(pBuf, HdrSize, Length, 0) ||
+        ( HdrSize + Rd32(pBuf + HdrSize + SetBytes) != Length ) ) {
+      return 0;
+   }
+
+   return Length;
+}
+
+
+//=============================================================================
+// Name:        NVSBinaryOnWire
+// Description: The binary form is opt-in on the wire, until every peer reads it.
+//=============================================================================
+btBool NVSBinaryOnWire()
+{
+   std::string val;
+   Environment *pEnv = Environment::GetObj();
+   return ( NULL != pEnv ) && pEnv->Get("AAL_NVS_WIRE", val) && ( "binary" == val );
+}
+
+//=============================================================================
+// Name:        IsNVSBinary
+// Description: Checks the header of a binary NVS.
+//=============================================================================
+btBool IsNVSBinary(const void *pBuf, btWSSize Len)
+{
+   const btByte *p = static_cast<const btByte *>(pBuf);
+   return ( NULL != p ) &&
+          ( Len >= HdrSize ) &&
+          ( NVS_BINARY_MAGIC == Rd32(p + HdrMagic) ) &&
+          ( NVS_BINARY_VERSION == Rd16(p + HdrVersion) );
+}
+
+//=============================================================================
+// Name:        NVSBinarySize
+// Description: Measures the encoding of rNVS.
+//=============================================================================
+btWSSize NVSBinarySize(const INamedValueSet &rNVS)
+{
+   NVSBinaryWriter w(NULL, 0);
+   NVSBinaryEncode(w, rNVS);
+   return w.Bad() ? 0 : w.Pos();
+}
+
+//=============================================================================
+// Name:        NVSToBinary
+// Description: Encodes rNVS into a caller's buffer.
+// Returns:     ENamedValuesIndexOutOfRange if the buffer is too small, with the
+//              size needed in *pUsed.
+//=============================================================================
+ENamedValues NVSToBinary(const INamedValueSet &rNVS, void *pBuf, btWSSize Len, btWSSize *pUsed)
+{
+   if ( ( NULL == pBuf ) || ( NULL == pUsed ) ) {
+      return ENamedValuesNullPointerArgument;
+   }
+
+   NVSBinaryWriter w(static_cast<btByte *>(pBuf), Len);
+   NVSBinaryEncode(w, rNVS);
+
+   if ( w.Bad() ) {
+      *pUsed = 0;
+      return ENamedValuesNotSupported;
+   }
+
+   *pUsed = w.Pos();
+   return w.Full() ? ENamedValuesIndexOutOfRange : ENamedValuesOK;
+}
+
+//=============================================================================
+// Name:        NVSFromBinary
+// Description: Decodes a binary NVS of any alignment into rNVS.
+//=============================================================================
+ENamedValues NVSFromBinary(INamedValueSet &rNVS, const void *pBuf, btWSSize Len)
+{
+   if ( NULL == pBuf ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+
+   if ( 0 == ( reinterpret_cast<btUIntPtr>(pBuf) & 7 ) ) {
+      NVSView v(pBuf, Len);
+      return v.IsOK() ? v.CopyTo(rNVS) : ENamedValuesBadType;
+   }
+
+   // Give the view an aligned copy.
+   const btUnsigned32bitInt Length = NVSBinaryValidate(static_cast<const btByte *>(pBuf), Len);
+   if ( 0 == Length ) {
+      return ENamedValuesBadType;
+   }
+
+   btUnsigned64bitInt *pCopy = new(std::nothrow) btUnsigned64bitInt[(Length + 7) / 8];
+   if ( NULL == pCopy ) {
+      return ENamedValuesOutOfMemory;
+   }
+   memcpy(pCopy, pBuf, Length);
+
+   NVSView      v(pCopy, Length);
+   ENamedValues res = v.IsOK() ? v.CopyTo(rNVS) : ENamedValuesBadType;
+
+   delete[] pCopy;
+   return res;
+}
+
+
+//=============================================================================
+// Name:        NVSView
+//=============================================================================
+NVSView::NVSView() :
+   m_pSet(NULL)
+{}
+
+NVSView::NVSView(const void *pBuf, btWSSize Len) :
+   m_pSet(NULL)
+{
+   const btByte *p = static_cast<const btByte *>(pBuf);
+   if ( ( 0 == ( reinterpret_cast<btUIntPtr>(p) & 7 ) ) && ( 0 != NVSBinaryValidate(p, Len) ) ) {
+      m_pSet = p + HdrSize;
+   }
+}
+
+NVSView::NVSView(const btByte *pSet) :
+   m_pSet(pSet)
+{}
+
+const btByte * NVSView::Entry(btUnsignedInt index) const
+{
+   if ( ( NULL == m_pSet ) || ( index >= Rd32(m_pSet + SetCount) ) ) {
+      return NULL;
+   }
+   const btByte *p = m_pSet + SetSize;
+   while ( index-- ) {
+      p += Rd32(p + EntBytes);
+   }
+   return p;
+}
+
+const btByte * NVSView::Find(btNumberKey Name) const
+{
+   if ( NULL == m_pSet ) {
+      return NULL;
+   }
+   btUnsigned32bitInt Count = Rd32(m_pSet + SetCount);
+   const btByte      *p     = m_pSet + SetSize;
+   while ( Count-- ) {
+      if ( ( btNumberKey_t == Rd16(p + EntNameType) ) && ( Name == Rd64(p + EntSize) ) ) {
+         return p;
+      }
+      p += Rd32(p + EntBytes);
+   }
+   return NULL;
+}
+
+const btByte * NVSView::Find(btStringKey Name) const
+{
+   if ( ( NULL == m_pSet ) || ( NULL == Name ) ) {
+      return NULL;
+   }
+   btUnsigned32bitInt Count = Rd32(m_pSet + SetCount);
+   const btByte      *p     = m_pSet + SetSize;
+   while ( Count-- ) {
+      if ( ( btStringKey_t == Rd16(p + EntNameType) ) &&
+           ( 0 == strcmp(Name, reinterpret_cast<btcString>(p + EntSize)) ) ) {
+         return p;
+      }
+      p += Rd32(p + EntBytes);
+   }
+   return NULL;
+}
+
+ENamedValues NVSView::GetNumNames(btUnsignedInt *pNum) const
+{
+   if ( NULL == pNum ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pNum = ( NULL == m_pSet ) ? 0 : Rd32(m_pSet + SetCount);
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::GetNameType(btUnsignedInt index, eNameTypes *pType) const
+{
+   const btByte *p = Entry(index);
+   if ( NULL == p ) {
+      return ENamedValuesIndexOutOfRange;
+   }
+   if ( NULL == pType ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pType = static_cast<eNameTypes>(Rd16(p + EntNameType));
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::GetName(btUnsignedInt index, btNumberKey *pName) const
+{
+   const btByte *p = Entry(index);
+   if ( NULL == p ) {
+      return ENamedValuesIndexOutOfRange;
+   }
+   if ( btNumberKey_t != Rd16(p + EntNameType) ) {
+      return ENamedValuesBadType;
+   }
+   if ( NULL == pName ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pName = Rd64(p + EntSize);
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::GetName(btUnsignedInt index, btStringKey *pName) const
+{
+   const btByte *p = Entry(index);
+   if ( NULL == p ) {
+      return ENamedValuesIndexOutOfRange;
+   }
+   if ( btStringKey_t != Rd16(p + EntNameType) ) {
+      return ENamedValuesBadType;
+   }
+   if ( NULL == pName ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pName = reinterpret_cast<btcString>(p + EntSize);
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::TypeOf(const btByte *pEntry, eBasicTypes *pType) const
+{
+   if ( NULL == pEntry ) {
+      return ENamedValuesNameNotFound;
+   }
+   if ( NULL == pType ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pType = static_cast<eBasicTypes>(Rd16(pEntry + EntType));
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::SizeOf(const btByte *pEntry, btWSSize *pSize) const
+{
+   if ( NULL == pEntry ) {
+      return ENamedValuesNameNotFound;
+   }
+   if ( NULL == pSize ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   // As INamedValueSet::GetSize(): the element count of arrays, and 1 for everything else.
+   const btUnsigned16bitInt Type = Rd16(pEntry + EntType);
+   if ( ( btStringArray_t == Type ) || ( 0 != ElementSize(Type) ) ) {
+      *pSize = Rd32(pEntry + EntElements);
+   } else {
+      *pSize = 1;
+   }
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::Value(const btByte *pEntry, eBasicTypes Type, const btByte **ppValue) const
+{
+   if ( NULL == pEntry ) {
+      return ENamedValuesNameNotFound;
+   }
+   if ( Type != Rd16(pEntry + EntType) ) {
+      return ENamedValuesBadType;
+   }
+   if ( NULL == ppValue ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+
+   btUnsigned64bitInt Key = ( btNumberKey_t == Rd16(pEntry + EntNameType) ) ?
+                               sizeof(btNumberKey) : (btUnsigned64bitInt)Rd32(pEntry + EntKeyLen) + 1;
+
+   *ppValue = pEntry + EntSize + Align8(Key);
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::Copy(const btByte *pEntry, eBasicTypes Type, void *pValue, btWSSize Size) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, Type, &p);
+   if ( ( ENamedValuesOK == e ) && ( NULL == pValue ) ) {
+      e = ENamedValuesInvalidReadToNull;
+   }
+   if ( ENamedValuesOK == e ) {
+      memcpy(pValue, p, (size_t)Size);
+   }
+   return e;
+}
+
+ENamedValues NVSView::Object(const btByte *pEntry, btObjectType *pValue) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, btObjectType_t, &p);
+   if ( ( ENamedValuesOK == e ) && ( NULL == pValue ) ) {
+      e = ENamedValuesInvalidReadToNull;
+   }
+   if ( ENamedValuesOK == e ) {
+      *pValue = reinterpret_cast<btObjectType>(static_cast<btUIntPtr>(Rd64(p)));
+   }
+   return e;
+}
+
+ENamedValues NVSView::String(const btByte *pEntry, btcString *pValue) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, btString_t, &p);
+   if ( ( ENamedValuesOK == e ) && ( NULL == pValue ) ) {
+      e = ENamedValuesInvalidReadToNull;
+   }
+   if ( ENamedValuesOK == e ) {
+      *pValue = reinterpret_cast<btcString>(p);
+   }
+   return e;
+}
+
+ENamedValues NVSView::Nested(const btByte *pEntry, NVSView *pValue) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, btNamedValueSet_t, &p);
+   if ( ( ENamedValuesOK == e ) && ( NULL == pValue ) ) {
+      e = ENamedValuesInvalidReadToNull;
+   }
+   if ( ENamedValuesOK == e ) {
+      *pValue = NVSView(p);
+   }
+   return e;
+}
+
+ENamedValues NVSView::StringAt(const btByte *pEntry, btUnsignedInt i, btcString *pValue) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, btStringArray_t, &p);
+   if ( ENamedValuesOK != e ) {
+      return e;
+   }
+   if ( i >= Rd32(pEntry + EntElements) ) {
+      return ENamedValuesIndexOutOfRange;
+   }
+   if ( NULL == pValue ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pValue = reinterpret_cast<btcString>(p + Rd32(p + i * sizeof(btUnsigned32bitInt)));
+   return ENamedValuesOK;
+}
+
+ENamedValues NVSView::ObjectAt(const btByte *pEntry, btUnsignedInt i, btObjectType *pValue) const
+{
+   const btByte *p = NULL;
+   ENamedValues  e = Value(pEntry, btObjectArray_t, &p);
+   if ( ENamedValuesOK != e ) {
+      return e;
+   }
+   if ( i >= Rd32(pEntry + EntElements) ) {
+      return ENamedValuesIndexOutOfRange;
+   }
+   if ( NULL == pValue ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+   *pValue = reinterpret_cast<btObjectType>(static_cast<btUIntPtr>(Rd64(p + i * sizeof(btUnsigned64bitInt))));
+   return ENamedValuesOK;
+}
+
+
+#define NVSVIEW_COPY_SCALAR_CASE(__t) case __t##_t : { \
+   __t __val;                                           \
+   rView.Get(Name, &__val);                             \
+   return rNVS.Add(Name, __val);                        \
+}
+
+#define NVSVIEW_COPY_ARRAY_CASE(__t) case __t##Array_t : {                  \
+   const __t *__val = NULL;                                                  \
+   rView.GetArray(Name, &__val);                                             \
+   return rNVS.Add(Name, const_cast<__t *>(__val), (btUnsigned32bitInt)Num); \
+}
+
+template <typename K>
+static ENamedValues NVSViewCopyValue(const NVSView &rView, K Name, INamedValueSet &rNVS)
+{
+   eBasicTypes Type = btUnknownType_t;
+   btWSSize    Num  = 0;
+   rView.Type(Name, &Type);
+   rView.GetSize(Name, &Num);
+
+   switch ( Type ) {
+      NVSVIEW_COPY_SCALAR_CASE(btBool);
+      NVSVIEW_COPY_SCALAR_CASE(btByte);
+      NVSVIEW_COPY_SCALAR_CASE(bt32bitInt);
+      NVSVIEW_COPY_SCALAR_CASE(btUnsigned32bitInt);
+      NVSVIEW_COPY_SCALAR_CASE(bt64bitInt);
+      NVSVIEW_COPY_SCALAR_CASE(btUnsigned64bitInt);
+      NVSVIEW_COPY_SCALAR_CASE(btFloat);
+      NVSVIEW_COPY_SCALAR_CASE(btObjectType);
+
+      case btString_t : {
+         btcString val = NULL;
+         rView.Get(Name, &val);
+         return rNVS.Add(Name, val);
+      }
+
+      case btNamedValueSet_t : {
+         NVSView       view;
+         NamedValueSet nvs;
+         rView.Get(Name, &view);
+         ENamedValues e = view.CopyTo(nvs);
+         return ( ENamedValuesOK == e ) ? rNVS.Add(Name, &nvs) : e;
+      }
+
+      NVSVIEW_COPY_ARRAY_CASE(btByte);
+      NVSVIEW_COPY_ARRAY_CASE(bt32bitInt);
+      NVSVIEW_COPY_ARRAY_CASE(btUnsigned32bitInt);
+      NVSVIEW_COPY_ARRAY_CASE(bt64bitInt);
+      NVSVIEW_COPY_ARRAY_CASE(btUnsigned64bitInt);
+      NVSVIEW_COPY_ARRAY_CASE(btFloat);
+
+      case btStringArray_t : {
+         btString *val = new(std::nothrow) btString[(size_t)Num];
+         if ( NULL == val ) {
+            return ENamedValuesOutOfMemory;
+         }
+         btUnsignedInt i;
+         for ( i = 0 ; i < Num ; ++i ) {
+            btcString s = NULL;
+            rView.GetElement(Name, i, &s);
+            val[i] = const_cast<btString>(s);
+         }
+         ENamedValues e = rNVS.Add(Name, val, (btUnsigned32bitInt)Num);
+         delete[] val;
+         return e;
+      }
+
+      case btObjectArray_t : {
+         btObjectType *val = new(std::nothrow) btObjectType[(size_t)Num];
+         if ( NULL == val ) {
+            return ENamedValuesOutOfMemory;
+         }
+         btUnsignedInt i;
+         for ( i = 0 ; i < Num ; ++i ) {
+            rView.GetElement(Name, i, &val[i]);
+         }
+         ENamedValues e = rNVS.Add(Name, val, (btUnsigned32bitInt)Num);
+         delete[] val;
+         return e;
+      }
+
+      default : return ENamedValuesBadType;
+   }
+}
+
+ENamedValues NVSView::CopyTo(INamedValueSet &rNVS) const
+{
+   if ( NULL == m_pSet ) {
+      return ENamedValuesBadType;
+   }
+
+   btUnsignedInt Count = 0;
+   btUnsignedInt i;
+   ENamedValues  e     = ENamedValuesOK;
+
+   GetNumNames(&Count);
+
+   for ( i = 0 ; ( i < Count ) && ( ENamedValuesOK == e ) ; ++i ) {
+      eNameTypes NameType;
+      GetNameType(i, &NameType);
+      if ( btNumberKey_t == NameType ) {
+         btNumberKey Name = 0;
+         GetName(i, &Name);
+         e = NVSViewCopyValue(*this, Name, rNVS);
+      } else {
+         btStringKey Name = NULL;
+         GetName(i, &Name);
+         e = NVSViewCopyValue(*this, Name, rNVS);
+      }
+   }
+
+   return e;
+}
+
+END_NAMESPACE(AAL)
+
@@ -363,7 +363,8 @@ btBool ServiceBase::startMDS()
    m_runMDT = true;
    m_pMDT   = new(std::nothrow) OSLThread(ServiceBase::_MessageDeliveryThread,
                                           OSLThread::THREADPRIORITY_ABOVE_NORMAL,
-                                          this);
+                                          this,
+                                          ThreadPlacement::SDKDefault());
    if ( NULL == m_pMDT ) {
       m_runMDT = false;
       return false;
@@ -63,6 +63,10 @@
 #include "aalsdk/AALBase.h"
 #include "aalsdk/AALTransactionID.h"
 
+#if defined( _MSC_VER )
+# include <intrin.h>
+#endif // _MSC_VER
+
 BEGIN_NAMESPACE(AAL)
 
 //=============================================================================
@@ -116,14 +120,6 @@ TransactionID::TransactionID(btID                 intID,
    m_tid.m_intID   = intID;
 }
 
-//=============================================================================
-// Name: TransactionID
-// Description: Copy constructor
-//=============================================================================
-TransactionID::TransactionID(const TransactionID &rOther) :
-   m_tid(rOther.m_tid)
-{}
-
 //=============================================================================
 // Name: TransactionID
 // Description: Constructor for Application specified ID
@@ -326,14 +322,6 @@ void   TransactionID::Ibase(IBase               *pIBase)  { m_tid.m_IBase   = pI
 void  TransactionID::Filter(btBool               Filter)  { m_tid.m_Filter  = Filter;  }
 void      TransactionID::ID(btID                 intID)   { m_tid.m_intID   = intID;   }
 
-TransactionID & TransactionID::operator = (const TransactionID &rOther)
-{
-   if ( &rOther != this ) {
-      m_tid = rOther.m_tid;
-   }
-   return *this;
-}
-
 TransactionID & TransactionID::operator = (const stTransactionID_t &tid)
 {
    if ( &tid != &m_tid ) {
@@ -347,30 +335,29 @@ TransactionID::operator stTransactionID_t &       ()       { return m_tid; }
 
 btBool TransactionID::operator == (const TransactionID &rhs) const
 {
+   // Compare the plain data members first - the ID is the one most likely to differ,
+   //  and all of them are cheaper than comparing two IBase's.
+   if ( ( m_tid.m_intID   != rhs.m_tid.m_intID   ) ||
+        ( m_tid.m_Context != rhs.m_tid.m_Context ) ||
+        ( m_tid.m_Handler != rhs.m_tid.m_Handler ) ||
+        ( m_tid.m_Filter  != rhs.m_tid.m_Filter  ) ) {
+      return false;
+   }
+
    const IBase *pMyIBase  = m_tid.m_IBase;
    const IBase *pRHSIBase = rhs.m_tid.m_IBase;
 
-   if ( ( NULL == pMyIBase ) && ( NULL != pRHSIBase ) ) {
-      return false;
-   }
-   if ( ( NULL != pMyIBase ) && ( NULL == pRHSIBase ) ) {
-      return false;
+   if ( pMyIBase == pRHSIBase ) {
+      // Both NULL, or the same object.
+      return true;
    }
 
-   if ( NULL != pMyIBase ) {
-      // We have an IBase * for both lhs and rhs.
-      ASSERT(NULL != pRHSIBase);
-
-      if ( pMyIBase->operator != (*pRHSIBase) ) {
-         return false;
-      }
+   if ( ( NULL == pMyIBase ) || ( NULL == pRHSIBase ) ) {
+      return false;
    }
 
-   // compare the other data members.
-   return m_tid.m_Context == rhs.m_tid.m_Context &&
-          m_tid.m_Handler == rhs.m_tid.m_Handler &&
-          m_tid.m_Filter  == rhs.m_tid.m_Filter  &&
-          m_tid.m_intID   == rhs.m_tid.m_intID;
+   // We have an IBase * for both lhs and rhs.
+   return ! pMyIBase->operator != (*pRHSIBase);
 }
 
 //=============================================================================
@@ -393,13 +380,15 @@ std::ostream & operator << (std::ostream &s, const TransactionID &TranID)
    return s;
 }
 
-btID            TransactionID::sm_NextUniqueID = 0;
-CriticalSection TransactionID::sm_CS;
+volatile btID TransactionID::sm_NextUniqueID = 0;
 
 btID TransactionID::NextUniqueID()
 {
-   AutoLock(&TransactionID::sm_CS);
-   return TransactionID::sm_NextUniqueID++;
+#if defined( _MSC_VER )
+   return (btID)_InterlockedExchangeAdd64(reinterpret_cast<volatile __int64 *>(&TransactionID::sm_NextUniqueID), 1);
+#else
+   return __sync_fetch_and_add(&TransactionID::sm_NextUniqueID, 1);
+#endif // _MSC_VER
 }
 
 END_NAMESPACE(AAL)
@@ -65,6 +65,8 @@
 #include "aalsdk/CAALBase.h"
 #include "aalsdk/INTCDefs.h"
 
+#include <new>
+
 
 BEGIN_NAMESPACE(AAL)
 
@@ -73,6 +75,83 @@ BEGIN_NAMESPACE(AAL)
 // Typedefs and Constants
 //=============================================================================
 
+// Orders the stores that fill an InterfaceTable before the store that publishes it.
+static inline void InterfaceTableBarrier()
+{
+#if defined( _MSC_VER )
+   MemoryBarrier();
+#else
+   __sync_synchronize();
+#endif // _MSC_VER
+}
+
+// The entries of m_InterfaceMap, in the map's (ascending btID) order, allocated as one
+// block so that a lookup touches a single contiguous run of memory.
+struct CAASBase::InterfaceTable
+{
+   struct Entry
+   {
+      btID               m_IID;
+      btGenericInterface m_pInterface;
+   };
+
+   static InterfaceTable * Create(iidInterfaceMap_t const &Map, InterfaceTable *pNext)
+   {
+      const btUnsignedInt Count = (btUnsignedInt)Map.size();
+      const size_t        Size  = sizeof(InterfaceTable) +
+                                     ( Count > 0 ? (Count - 1) * sizeof(Entry) : 0 );
+
+      InterfaceTable *pTable = reinterpret_cast<InterfaceTable *>(::operator new(Size));
+
+      pTable->m_pNext = pNext;
+      pTable->m_Count = Count;
+
+      btUnsignedInt     i = 0;
+      IIDINTERFACE_CITR itr;
+      for ( itr = Map.begin() ; Map.end() != itr ; ++itr, ++i ) {
+         pTable->m_Entries[i].m_IID        = (*itr).first;
+         pTable->m_Entries[i].m_pInterface = (*itr).second;
+      }
+
+      return pTable;
+   }
+
+   static void Destroy(InterfaceTable *pTable)
+   {
+      while ( NULL != pTable ) {
+         InterfaceTable *pNext = pTable->m_pNext;
+         ::operator delete(pTable);
+         pTable = pNext;
+      }
+   }
+
+   // Binary search of the sorted entries.
+   btGenericInterface Find(btIID Interface) const
+   {
+      btUnsignedInt lo = 0;
+      btUnsignedInt hi = m_Count;
+
+      while ( lo < hi ) {
+         const btUnsignedInt mid = lo + ((hi - lo) >> 1);
+         const btID          iid = m_Entries[mid].m_IID;
+
+         if ( iid == Interface ) {
+            return m_Entries[mid].m_pInterface;
+         } else if ( iid < Interface ) {
+            lo = mid + 1;
+         } else {
+            hi = mid;
+         }
+      }
+
+      return NULL;
+   }
+
+   InterfaceTable *m_pNext;      // Next older retired table, for the destructor.
+   btUnsignedInt   m_Count;
+   Entry           m_Entries[1];
+};
+
 
 //=============================================================================
 //
@@ -90,7 +169,9 @@ BEGIN_NAMESPACE(AAL)
 CAASBase::CAASBase() :
    CriticalSection(),
    m_bIsOK(false),
-   m_InterfaceMap()
+   m_InterfaceMap(),
+   m_pTable(NULL),
+   m_pRetired(NULL)
 {
    // Add the public interfaces
    if ( SetInterface(iidCBase, dynamic_cast<CAASBase *>(this)) != EObjOK ) {
@@ -112,7 +193,65 @@ CAASBase::CAASBase() :
 // Outputs: none.
 // Comments:
 //=============================================================================
-CAASBase::~CAASBase() {/*empty*/}
+CAASBase::~CAASBase()
+{
+   InterfaceTable::Destroy(m_pTable);
+   InterfaceTable::Destroy(m_pRetired);
+}
+
+//=============================================================================
+// Name: CAASBase::Freeze
+// Description: Returns the published interface table, building it on first use.
+// Interface: private
+// Inputs: none.
+// Outputs: The current InterfaceTable.
+// Comments: Interfaces are normally all set during construction, so the table
+//           is built once, by the first lookup. Tables are never modified once
+//           published, so readers need no lock.
+//=============================================================================
+CAASBase::InterfaceTable * CAASBase::Freeze() const
+{
+   InterfaceTable *pTable = m_pTable;
+   if ( NULL != pTable ) {
+      return pTable;
+   }
+
+   AutoLock(this);
+
+   if ( NULL == m_pTable ) {
+      pTable = InterfaceTable::Create(m_InterfaceMap, NULL);
+      InterfaceTableBarrier();
+      m_pTable = pTable;
+   }
+
+   return m_pTable;
+}
+
+//=============================================================================
+// Name: CAASBase::Publish
+// Description: Copy-on-write: replaces a frozen interface table with one that
+//              reflects the current m_InterfaceMap.
+// Interface: private
+// Inputs: none.
+// Outputs: none.
+// Comments: Must be called with the lock held. A reader may still be searching
+//           the old table, so it is kept on the retired list until destruction.
+//=============================================================================
+void CAASBase::Publish()
+{
+   InterfaceTable *pOld = m_pTable;
+   if ( NULL == pOld ) {
+      // Not frozen yet - the first lookup will build the table.
+      return;
+   }
+
+   InterfaceTable *pNew = InterfaceTable::Create(m_InterfaceMap, NULL);
+   InterfaceTableBarrier();
+   m_pTable = pNew;
+
+   pOld->m_pNext = m_pRetired;
+   m_pRetired    = pOld;
+}
 
 //=============================================================================
 // Name: CAASBase::Interface
@@ -124,15 +263,7 @@ CAASBase::~CAASBase() {/*empty*/}
 //=============================================================================
 btGenericInterface CAASBase::Interface(btIID Interface) const
 {
-   AutoLock(this);
-
-   IIDINTERFACE_CITR itr = m_InterfaceMap.find(Interface);
-
-   if ( m_InterfaceMap.end() == itr ) {
-      return NULL;
-   }
-
-   return (*itr).second;
+   return Freeze()->Find(Interface);
 }
 
 //=============================================================================
@@ -145,8 +276,9 @@ btGenericInterface CAASBase::Interface(btIID Interface) const
 //=============================================================================
 btBool CAASBase::Has(btIID Interface) const
 {
-   AutoLock(this);
-   return m_InterfaceMap.end() != m_InterfaceMap.find(Interface);
+   // NULL interfaces are never stored (SetInterface() rejects them, and
+   //  ReplaceInterface() treats NULL as removal).
+   return NULL != Freeze()->Find(Interface);
 }
 
 //=============================================================================
@@ -238,12 +370,13 @@ EOBJECT CAASBase::SetInterface(btIID              Interface,
    AutoLock(this);
 
    // Make sure there is not an implementation already.
-   if ( Has(Interface) ) {
+   if ( m_InterfaceMap.end() != m_InterfaceMap.find(Interface) ) {
       return EObjDuplicateName;
    }
 
    //Add the interface
    m_InterfaceMap[Interface] = pInterface;
+   Publish();
 
    return EObjOK;
 }
@@ -273,8 +406,9 @@ EOBJECT CAASBase::ReplaceInterface(btIID              Interface,
       m_InterfaceMap.erase(iter);
    } else {
       // Replace the existing Interface entry.
-      m_InterfaceMap[Interface] = pInterface;
+      (*iter).second = pInterface;
    }
+   Publish();
 
    return EObjOK;
 }
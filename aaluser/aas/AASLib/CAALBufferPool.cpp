@@ -0,0 +1,665 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file CAALBufferPool.cpp
+/// @brief Sub-allocating buffer pool layered on IALIBuffer.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/utils/AALBufferPool.h"  // This class' definition
+#include "aalsdk/AALLogger.h"
+
+#if defined( __AAL_LINUX__ )
+# include <pthread.h>
+#endif // __AAL_LINUX__
+
+
+BEGIN_NAMESPACE(AAL)
+
+
+// The free lists of one pool in one thread. Valid only while the pool with id m_Owner
+//    exists: a pool that is destroyed or Release()'d no longer answers to the id, and
+//    its blocks are then simply forgotten by the threads that cached them.
+struct BufferPoolThreadCache
+{
+   btUnsigned64bitInt m_Owner;
+   btVirtAddr         m_Head[BufferPool::NumClasses];
+   btUnsigned32bitInt m_Count[BufferPool::NumClasses];
+};
+
+// Each thread keeps the free lists of up to this many pools at once, so that a thread
+//    using several pools does not trade blocks with them on every call.
+#define BUFPOOL_THREAD_POOLS 4
+
+struct BufferPoolThreadCaches
+{
+   BufferPoolThreadCache m_Pool[BUFPOOL_THREAD_POOLS];
+   btBool                m_ExitHook;   // The thread's caches are flushed when it exits.
+};
+
+static __AAL_THREAD_LOCAL BufferPoolThreadCaches gBufPoolCaches = { { { 0, { NULL, }, { 0, } }, }, false };
+
+// Every live pool, by id. Lock order is gBufPoolRegLock, then the pool.
+typedef std::map<btUnsigned64bitInt, BufferPool *> BufferPoolRegistry;
+
+static CriticalSection    gBufPoolRegLock;
+static BufferPoolRegistry gBufPoolRegistry;
+static btUnsigned64bitInt gBufPoolNextId = 1;
+
+// Returns a thread's cached blocks to their pools when the thread exits. Created on
+//    first use, under gBufPoolRegLock.
+#if   defined( __AAL_WINDOWS__ )
+static DWORD         gBufPoolExitKey     = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI BufferPoolThreadExit(PVOID )
+{
+   BufferPool::FlushThreadCache();
+}
+#elif defined( __AAL_LINUX__ )
+static pthread_key_t gBufPoolExitKey;
+static btBool        gBufPoolExitKeyValid = false;
+
+static void BufferPoolThreadExit(void * )
+{
+   BufferPool::FlushThreadCache();
+}
+#endif // OS
+
+// The next block on a free list is stored in the first bytes of the block.
+#define BUFPOOL_NEXT(__blk) ( *reinterpret_cast<btVirtAddr *>(__blk) )
+
+static inline btUnsigned32bitInt BufferPoolClass(btWSSize Length)
+{
+   btUnsigned32bitInt c = 0;
+   while ( ( (btWSSize)BufferPool::MinBlockSize << c ) < Length ) {
+      ++c;
+   }
+   return c;
+}
+
+static inline btWSSize BufferPoolClassSize(btUnsigned32bitInt Class)
+{
+   return (btWSSize)BufferPool::MinBlockSize << Class;
+}
+
+// Each thread caches at most one slab's worth of each size class, and no more than
+//    64 blocks. Half of that is moved to or from the pool at a time.
+static inline btUnsigned32bitInt BufferPoolCacheDepth(btUnsigned32bitInt Class)
+{
+   btUnsigned32bitInt d = (btUnsigned32bitInt)( BufferPool::SlabSize >> ( BufferPool::MinBlockShift + Class ) );
+   return ( d > 64 ) ? 64 : d;
+}
+
+static inline btUnsigned32bitInt BufferPoolBatch(btUnsigned32bitInt Class)
+{
+   btUnsigned32bitInt b = BufferPoolCacheDepth(Class) / 2;
+   return ( 0 == b ) ? 1 : b;
+}
+
+// The first slot of the arena table to probe for a granule.
+static inline btUnsigned32bitInt BufferPoolSlot(btUnsigned64bitInt Granule)
+{
+   return (btUnsigned32bitInt)( ( Granule * 0x9E3779B97F4A7C15ULL ) >> ( 64 - BufferPool::ArenaSlotShift ) );
+}
+
+// Orders the stores that fill an arena table slot before the store that publishes it.
+static inline void BufferPoolBarrier()
+{
+#if defined( _MSC_VER )
+   MemoryBarrier();
+#else
+   __sync_synchronize();
+#endif // _MSC_VER
+}
+
+
+// The calling thread's free lists for this pool.
+inline BufferPoolThreadCache & BufferPool::ThreadCache()
+{
+   btUnsigned32bitInt t;
+   for ( t = 0 ; t < BUFPOOL_THREAD_POOLS ; ++t ) {
+      if ( gBufPoolCaches.m_Pool[t].m_Owner == m_Id ) {
+         return gBufPoolCaches.m_Pool[t];
+      }
+   }
+   return AdoptThreadCache(this);
+}
+
+BufferPool::BufferPool(IALIBuffer *pBuffer) :
+   m_pBuffer(pBuffer),
+   m_ArenaSize(DefaultArenaSize),
+   m_Id(0),
+   m_NumArenas(0),
+   m_Index(),
+   m_Large()
+{
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < MaxArenas ; ++i ) {
+      m_Arenas[i].m_ptr       = NULL;
+      m_Arenas[i].m_iova      = 0;
+      m_Arenas[i].m_Slabs     = 0;
+      m_Arenas[i].m_SlabsUsed = 0;
+      m_Arenas[i].m_SlabClass = NULL;
+   }
+   for ( i = 0 ; i < NumClasses ; ++i ) {
+      m_FreeHead[i]  = NULL;
+      m_FreeCount[i] = 0;
+   }
+   UnmapArenas();
+
+   AutoLock(&gBufPoolRegLock);
+   m_Id = gBufPoolNextId++;
+   gBufPoolRegistry[m_Id] = this;
+}
+
+BufferPool::~BufferPool()
+{
+   Release();
+
+   AutoLock(&gBufPoolRegLock);
+   gBufPoolRegistry.erase(m_Id);
+}
+
+btBool BufferPool::Configure(btWSSize ArenaSize)
+{
+   if ( ( 0 == ArenaSize ) || ( 0 != ( ArenaSize & ( SlabSize - 1 ) ) ) ) {
+      return false;
+   }
+
+   AutoLock(this);
+
+   if ( ( 0 != m_NumArenas ) || !m_Large.empty() ) {
+      return false;
+   }
+
+   m_ArenaSize = ArenaSize;
+   return true;
+}
+
+btBool BufferPool::Configure(NamedValueSet const &rArgs)
+{
+   if ( !rArgs.Has(ALI_BUFFPOOL_ARENA_SIZE_KEY) ) {
+      return true;
+   }
+
+   ALI_BUFFPOOL_ARENA_SIZE_DATATYPE ArenaSize = 0;
+   if ( ENamedValuesOK != rArgs.Get(ALI_BUFFPOOL_ARENA_SIZE_KEY, &ArenaSize) ) {
+      return false;
+   }
+
+   return Configure((btWSSize)ArenaSize);
+}
+
+void BufferPool::Release()
+{
+   {
+      // Retire the current id first, so that no thread can hand blocks back to the
+      //    arenas being freed below.
+      AutoLock(&gBufPoolRegLock);
+      gBufPoolRegistry.erase(m_Id);
+      btUnsigned32bitInt t;
+      for ( t = 0 ; t < BUFPOOL_THREAD_POOLS ; ++t ) {
+         if ( gBufPoolCaches.m_Pool[t].m_Owner == m_Id ) {
+            gBufPoolCaches.m_Pool[t].m_Owner = 0;
+         }
+      }
+      m_Id = gBufPoolNextId++;
+      gBufPoolRegistry[m_Id] = this;
+   }
+
+   AutoLock(this);
+
+   UnmapArenas();
+
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < m_NumArenas ; ++i ) {
+      m_Index.Remove(m_Arenas[i].m_ptr);
+      m_pBuffer->bufferFree(m_Arenas[i].m_ptr);
+      delete[] m_Arenas[i].m_SlabClass;
+
+      m_Arenas[i].m_ptr       = NULL;
+      m_Arenas[i].m_iova      = 0;
+      m_Arenas[i].m_Slabs     = 0;
+      m_Arenas[i].m_SlabsUsed = 0;
+      m_Arenas[i].m_SlabClass = NULL;
+   }
+   m_NumArenas = 0;
+
+   std::map<btVirtAddr, btWSSize>::iterator itr;
+   for ( itr = m_Large.begin() ; itr != m_Large.end() ; ++itr ) {
+      m_Index.Remove((*itr).first);
+      m_pBuffer->bufferFree((*itr).first);
+   }
+   m_Large.clear();
+
+   for ( i = 0 ; i < NumClasses ; ++i ) {
+      m_FreeHead[i]  = NULL;
+      m_FreeCount[i] = 0;
+   }
+}
+
+AAL::ali_errnum_e BufferPool::poolAllocate(btWSSize    Length,
+                                           btVirtAddr *pBufferptr)
+{
+   if ( NULL == pBufferptr ) {
+      return ali_errnumBadParameter;
+   }
+   *pBufferptr = NULL;
+
+   if ( 0 == Length ) {
+      return ali_errnumBadParameter;
+   }
+   if ( Length > (btWSSize)SlabSize ) {
+      return AllocateLarge(Length, pBufferptr);
+   }
+
+   const btUnsigned32bitInt c  = BufferPoolClass(Length);
+   BufferPoolThreadCache   &tc = ThreadCache();
+
+   if ( 0 == tc.m_Count[c] ) {
+      if ( !Refill(c, BufferPoolBatch(c), &tc.m_Head[c], &tc.m_Count[c]) ) {
+         return ali_errnumNoMem;
+      }
+   }
+
+   btVirtAddr blk = tc.m_Head[c];
+   tc.m_Head[c] = BUFPOOL_NEXT(blk);
+   --tc.m_Count[c];
+
+   *pBufferptr = blk;
+   return ali_errnumOK;
+}
+
+AAL::ali_errnum_e BufferPool::poolFree(btVirtAddr Address)
+{
+   const Arena *pa = FindArena(Address);
+   if ( NULL == pa ) {
+      // A large block, or not one of ours.
+      return FreeLarge(Address);
+   }
+
+   // The blocks of a slab were carved, and its size class recorded, before any of them
+   //    was handed out, so these are stable for any Address that came from the pool.
+   const Arena             &a    = *pa;
+   const btWSSize           off  = (btWSSize)( Address - a.m_ptr );
+   const btUnsigned32bitInt slab = (btUnsigned32bitInt)( off >> SlabShift );
+
+   if ( slab >= a.m_SlabsUsed ) {
+      return ali_errnumBadParameter;
+   }
+
+   const btUnsigned32bitInt c = (btUnsigned32bitInt)a.m_SlabClass[slab];
+
+   if ( 0 != ( off & ( BufferPoolClassSize(c) - 1 ) ) ) {
+      return ali_errnumBadParameter;
+   }
+
+   BufferPoolThreadCache &tc = ThreadCache();
+
+   BUFPOOL_NEXT(Address) = tc.m_Head[c];
+   tc.m_Head[c] = Address;
+   ++tc.m_Count[c];
+
+   if ( tc.m_Count[c] > BufferPoolCacheDepth(c) ) {
+      // Keep the most recently freed blocks, and give the rest back.
+      btUnsigned32bitInt keep = tc.m_Count[c] - BufferPoolBatch(c);
+      btVirtAddr         last = tc.m_Head[c];
+      btUnsigned32bitInt i;
+
+      for ( i = 1 ; i < keep ; ++i ) {
+         last = BUFPOOL_NEXT(last);
+      }
+
+      btVirtAddr head = BUFPOOL_NEXT(last);
+      btVirtAddr tail = head;
+      for ( i = 1 ; i < tc.m_Count[c] - keep ; ++i ) {
+         tail = BUFPOOL_NEXT(tail);
+      }
+
+      BUFPOOL_NEXT(last) = NULL;
+      ReturnBlocks(c, head, tail, tc.m_Count[c] - keep);
+      tc.m_Count[c] = keep;
+   }
+
+   return ali_errnumOK;
+}
+
+btPhysAddr BufferPool::poolGetIOVA(btVirtAddr Address)
+{
+   const Arena *pa = FindArena(Address);
+   if ( NULL != pa ) {
+      return pa->m_iova + (btPhysAddr)( Address - pa->m_ptr );
+   }
+   // Large blocks are rare, and big enough that the index lookup is not the cost.
+   return m_Index.GetIOVA(Address);
+}
+
+btUnsigned32bitInt BufferPool::Arenas() const
+{
+   AutoLock(this);
+   return m_NumArenas;
+}
+
+btUnsigned32bitInt BufferPool::LargeBlocks() const
+{
+   AutoLock(this);
+   return (btUnsigned32bitInt)m_Large.size();
+}
+
+void BufferPool::FlushThreadCache()
+{
+   AutoLock(&gBufPoolRegLock);
+
+   btUnsigned32bitInt t;
+   for ( t = 0 ; t < BUFPOOL_THREAD_POOLS ; ++t ) {
+      ReturnThreadCache(gBufPoolCaches.m_Pool[t]);
+   }
+
+   // Another thread exit handler may yet use a pool, and register the hook again.
+   gBufPoolCaches.m_ExitHook = false;
+}
+
+BufferPoolThreadCache & BufferPool::AdoptThreadCache(BufferPool *pPool)
+{
+   AutoLock(&gBufPoolRegLock);
+
+   if ( !gBufPoolCaches.m_ExitHook ) {
+#if   defined( __AAL_WINDOWS__ )
+      if ( FLS_OUT_OF_INDEXES == gBufPoolExitKey ) {
+         gBufPoolExitKey = FlsAlloc(BufferPoolThreadExit);
+      }
+      gBufPoolCaches.m_ExitHook = ( FLS_OUT_OF_INDEXES != gBufPoolExitKey ) &&
+                                  FlsSetValue(gBufPoolExitKey, &gBufPoolCaches);
+#elif defined( __AAL_LINUX__ )
+      if ( !gBufPoolExitKeyValid ) {
+         gBufPoolExitKeyValid = ( 0 == pthread_key_create(&gBufPoolExitKey, BufferPoolThreadExit) );
+      }
+      gBufPoolCaches.m_ExitHook = gBufPoolExitKeyValid &&
+                                  ( 0 == pthread_setspecific(gBufPoolExitKey, &gBufPoolCaches) );
+#endif // OS
+      if ( !gBufPoolCaches.m_ExitHook ) {
+         AAL_WARNING(LM_AAS, "BufferPool::AdoptThreadCache() no thread exit hook, cached blocks will be lost on exit" << std::endl);
+      }
+   }
+
+   // Take a free slot, or one whose pool is gone. Failing that, evict one.
+   BufferPoolThreadCache *pVictim = &gBufPoolCaches.m_Pool[pPool->m_Id % BUFPOOL_THREAD_POOLS];
+
+   btUnsigned32bitInt t;
+   for ( t = 0 ; t < BUFPOOL_THREAD_POOLS ; ++t ) {
+      BufferPoolThreadCache &tc = gBufPoolCaches.m_Pool[t];
+      if ( ( 0 == tc.m_Owner ) || ( gBufPoolRegistry.end() == gBufPoolRegistry.find(tc.m_Owner) ) ) {
+         pVictim = &tc;
+         break;
+      }
+   }
+
+   ReturnThreadCache(*pVictim);
+   pVictim->m_Owner = pPool->m_Id;
+   return *pVictim;
+}
+
+void BufferPool::ReturnThreadCache(BufferPoolThreadCache &tc)
+{
+   BufferPoolRegistry::iterator itr = ( 0 == tc.m_Owner ) ? gBufPoolRegistry.end() :
+                                                            gBufPoolRegistry.find(tc.m_Owner);
+
+   btUnsigned32bitInt c;
+   for ( c = 0 ; c < NumClasses ; ++c ) {
+      if ( ( itr != gBufPoolRegistry.end() ) && ( tc.m_Count[c] > 0 ) ) {
+         btVirtAddr tail = tc.m_Head[c];
+         while ( NULL != BUFPOOL_NEXT(tail) ) {
+            tail = BUFPOOL_NEXT(tail);
+         }
+         (*itr).second->ReturnBlocks(c, tc.m_Head[c], tail, tc.m_Count[c]);
+      }
+      tc.m_Head[c]  = NULL;
+      tc.m_Count[c] = 0;
+   }
+
+   tc.m_Owner = 0;
+}
+
+btBool BufferPool::Refill(btUnsigned32bitInt  Class,
+                          btUnsigned32bitInt  Count,
+                          btVirtAddr         *pHead,
+                          btUnsigned32bitInt *pGot)
+{
+   AutoLock(this);
+
+   while ( m_FreeCount[Class] < Count ) {
+      if ( !CarveSlab(Class) ) {
+         break;
+      }
+   }
+
+   if ( 0 == m_FreeCount[Class] ) {
+      return false;
+   }
+   if ( Count > m_FreeCount[Class] ) {
+      Count = m_FreeCount[Class];
+   }
+
+   btVirtAddr         head = m_FreeHead[Class];
+   btVirtAddr         tail = head;
+   btUnsigned32bitInt i;
+   for ( i = 1 ; i < Count ; ++i ) {
+      tail = BUFPOOL_NEXT(tail);
+   }
+
+   m_FreeHead[Class]   = BUFPOOL_NEXT(tail);
+   m_FreeCount[Class] -= Count;
+   BUFPOOL_NEXT(tail)  = NULL;
+
+   *pHead = head;
+   *pGot  = Count;
+   return true;
+}
+
+void BufferPool::ReturnBlocks(btUnsigned32bitInt Class,
+                              btVirtAddr         Head,
+                              btVirtAddr         Tail,
+                              btUnsigned32bitInt Count)
+{
+   AutoLock(this);
+   BUFPOOL_NEXT(Tail)  = m_FreeHead[Class];
+   m_FreeHead[Class]   = Head;
+   m_FreeCount[Class] += Count;
+}
+
+// Dedicates the next unused slab to Class, and puts its blocks on the free list.
+//    Slabs are used in order, so only the newest arena can have one.
+btBool BufferPool::CarveSlab(btUnsigned32bitInt Class)
+{
+   if ( ( 0 == m_NumArenas ) ||
+        ( m_Arenas[m_NumArenas - 1].m_SlabsUsed == m_Arenas[m_NumArenas - 1].m_Slabs ) ) {
+      if ( !AddArena() ) {
+         return false;
+      }
+   }
+
+   Arena &a = m_Arenas[m_NumArenas - 1];
+
+   const btWSSize     size = BufferPoolClassSize(Class);
+   const btVirtAddr   slab = a.m_ptr + ( (btWSSize)a.m_SlabsUsed << SlabShift );
+   btUnsigned32bitInt n    = (btUnsigned32bitInt)( SlabSize / size );
+
+   a.m_SlabClass[a.m_SlabsUsed] = (btByte)Class;
+   ++a.m_SlabsUsed;
+
+   // Link the blocks in address order.
+   while ( n-- > 0 ) {
+      btVirtAddr blk = slab + n * size;
+      BUFPOOL_NEXT(blk) = m_FreeHead[Class];
+      m_FreeHead[Class] = blk;
+      ++m_FreeCount[Class];
+   }
+
+   return true;
+}
+
+btBool BufferPool::AddArena()
+{
+   if ( MaxArenas == m_NumArenas ) {
+      AAL_ERR(LM_AAS, "BufferPool::AddArena() all " << MaxArenas << " arenas in use" << std::endl);
+      return false;
+   }
+
+   btVirtAddr ptr = NULL;
+   if ( ali_errnumOK != m_pBuffer->bufferAllocate(m_ArenaSize, &ptr) ) {
+      return false;
+   }
+
+   const btUnsigned32bitInt slabs = (btUnsigned32bitInt)( m_ArenaSize >> SlabShift );
+
+   btByte *pClass = new(std::nothrow) btByte[slabs];
+   if ( NULL == pClass ) {
+      m_pBuffer->bufferFree(ptr);
+      return false;
+   }
+
+   Arena &a = m_Arenas[m_NumArenas];
+   a.m_ptr       = ptr;
+   a.m_iova      = m_pBuffer->bufferGetIOVA(ptr);
+   a.m_Slabs     = slabs;
+   a.m_SlabsUsed = 0;
+   a.m_SlabClass = pClass;
+
+   if ( !m_Index.Add(ptr, m_ArenaSize, a.m_iova, m_NumArenas) ) {
+      AAL_ERR(LM_AAS, "BufferPool::AddArena() overlapping workspace at " << (void *)ptr << std::endl);
+      delete[] pClass;
+      a.m_ptr       = NULL;
+      a.m_iova      = 0;
+      a.m_Slabs     = 0;
+      a.m_SlabClass = NULL;
+      m_pBuffer->bufferFree(ptr);
+      return false;
+   }
+
+   // The arena is complete before it is published in the table, so that whoever finds
+   //    it there also sees it in m_Arenas[].
+   MapArena(m_NumArenas);
+
+   ++m_NumArenas;
+   return true;
+}
+
+void BufferPool::MapArena(btUnsigned32bitInt Index)
+{
+   const btUnsigned64bitInt base = (btUnsigned64bitInt)m_Arenas[Index].m_ptr;
+   btUnsigned64bitInt       g;
+
+   for ( g = base / m_ArenaSize ; g <= ( base + m_ArenaSize - 1 ) / m_ArenaSize ; ++g ) {
+      // The table is never more than half full, so there is always a free slot.
+      btUnsigned32bitInt s = BufferPoolSlot(g);
+      while ( 0 != m_ArenaSlots[s].m_Granule ) {
+         s = ( s + 1 ) & ( ArenaSlots - 1 );
+      }
+      m_ArenaSlots[s].m_Arena = Index;
+      BufferPoolBarrier();
+      m_ArenaSlots[s].m_Granule = g + 1;
+   }
+}
+
+void BufferPool::UnmapArenas()
+{
+   btUnsigned32bitInt s;
+   for ( s = 0 ; s < ArenaSlots ; ++s ) {
+      m_ArenaSlots[s].m_Granule = 0;
+      m_ArenaSlots[s].m_Arena   = 0;
+   }
+}
+
+// Slots are only ever filled while the pool is in use, each one before any block of its
+//    arena is handed out, so a lookup needs no lock. A granule shared by two arenas has
+//    a slot for each.
+const BufferPool::Arena * BufferPool::FindArena(btVirtAddr Address) const
+{
+   const btUnsigned64bitInt g = (btUnsigned64bitInt)Address / m_ArenaSize;
+   btUnsigned32bitInt       s = BufferPoolSlot(g);
+   btUnsigned32bitInt       n;
+
+   for ( n = 0 ; n < ArenaSlots ; ++n ) {
+      const btUnsigned64bitInt key = m_ArenaSlots[s].m_Granule;
+      if ( 0 == key ) {
+         break;
+      }
+      if ( g + 1 == key ) {
+         const Arena &a = m_Arenas[m_ArenaSlots[s].m_Arena];
+         if ( ( Address >= a.m_ptr ) && ( Address < a.m_ptr + m_ArenaSize ) ) {
+            return &a;
+         }
+      }
+      s = ( s + 1 ) & ( ArenaSlots - 1 );
+   }
+
+   return NULL;
+}
+
+AAL::ali_errnum_e BufferPool::AllocateLarge(btWSSize    Length,
+                                            btVirtAddr *pBufferptr)
+{
+   btVirtAddr        ptr = NULL;
+   AAL::ali_errnum_e res = m_pBuffer->bufferAllocate(Length, &ptr);
+   if ( ali_errnumOK != res ) {
+      return res;
+   }
+
+   AutoLock(this);
+
+   if ( !m_Index.Add(ptr, Length, m_pBuffer->bufferGetIOVA(ptr), LargeBlock) ) {
+      m_pBuffer->bufferFree(ptr);
+      return ali_errnumSystem;
+   }
+   m_Large[ptr] = Length;
+
+   *pBufferptr = ptr;
+   return ali_errnumOK;
+}
+
+AAL::ali_errnum_e BufferPool::FreeLarge(btVirtAddr Address)
+{
+   AutoLock(this);
+
+   if ( 0 == m_Large.erase(Address) ) {
+      return ali_errnumBadParameter;
+   }
+
+   m_Index.Remove(Address);
+   return m_pBuffer->bufferFree(Address);
+}
+
+
+END_NAMESPACE(AAL)
+
@@ -158,7 +158,7 @@ btGenericInterface CAALEvent::Interface(btIID ID) const
 {
    AutoLock(this);
 
-   IIDINTERFACE_CITR itr = m_InterfaceMap.find(ID);
+   EVENTINTERFACE_CITR itr = m_InterfaceMap.find(ID);
    if ( m_InterfaceMap.end() == itr ) { // not found
       return NULL;
    }
@@ -240,8 +240,8 @@ btBool CAALEvent::operator == (const IEvent &rOther) const
          return false;
       }
 
-      IIDINTERFACE_CITR l;
-      IIDINTERFACE_CITR r;
+      EVENTINTERFACE_CITR l;
+      EVENTINTERFACE_CITR r;
 
       for ( l = m_InterfaceMap.begin(), r = pOther->m_InterfaceMap.begin() ;
                l != m_InterfaceMap.end() ;
@@ -372,6 +372,22 @@ void CAALEvent::operator()()
    }
 }
 
+//=============================================================================
+// Name: DeliveryTarget
+// Description: The client operator() delivers to, if any. The IServiceClient
+//              and IRuntimeClient of one object are the same client.
+//=============================================================================
+btObjectType CAALEvent::DeliveryTarget() const
+{
+   if ( NULL != m_pServiceClient ) {
+      return dynamic_cast<void *>(m_pServiceClient);
+   }
+   if ( NULL != m_pRuntimeClient ) {
+      return dynamic_cast<void *>(m_pRuntimeClient);
+   }
+   return NULL;
+}
+
 //=============================================================================
 // Name: CAALEvent
 // Description: Destructor
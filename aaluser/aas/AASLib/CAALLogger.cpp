@@ -80,6 +80,9 @@
 #include "aalsdk/utils/Utilities.h"    // NUM_ELEMENTS()
 #include "aalsdk/OSAL.h"               // GetThreadID(), FindLowestBitSet64()
 
+#include <cstring>                     // memcpy()
+#include <new>                         // std::nothrow
+
 
 BEGIN_NAMESPACE(AAL)
 
@@ -251,6 +254,320 @@ char * PIDossMap::Getpsz(int index)
    }
 }  // PIDossMap::Getpsz
 
+//=============================================================================
+// Asynchronous mode (SetAsync(true))
+//
+// Each thread formats into its own LogLine, which needs no lock once the thread
+//    has found it. Log() copies the line into a bounded multi-producer, single
+//    consumer ring of fixed-size slots and returns; a line that needs more than
+//    one slot takes consecutive slots. The writer thread drains the ring and
+//    writes what it found in one batch under the Logger lock.
+//
+// Every slot carries a sequence number. The slot for ring position p is free
+//    when its sequence is p, and holds a line when it is p + 1. A producer
+//    claims positions by advancing the head with a compare-and-swap, fills the
+//    slots, and publishes the first slot last. The writer frees each slot for
+//    position p + LOGGER_ASYNC_SLOTS after reading it.
+//
+// Producers do not wake the writer for every line, so that the lines are
+//    written in batches: only when the ring is filling up, or for a line of
+//    LOG_ERR or more severe, which the synchronous mode would flush at once.
+//=============================================================================
+#define LOGGER_ASYNC_SLOTS        1024 // Power of 2. With 128-byte slots, the ring is 128KB.
+#define LOGGER_ASYNC_SLOT_TEXT     112
+#define LOGGER_ASYNC_MAX_LINE     2048 // Longer lines are truncated.
+#define LOGGER_ASYNC_WAIT_MS       100 // Writer thread wakes at least this often.
+#define LOGGER_ASYNC_WAKE_SLOTS    256 // Or when this many slots are in use.
+
+static inline btBool LoggerCompareAndSwap(volatile btUnsigned64bitInt *p,
+                                          btUnsigned64bitInt         Old,
+                                          btUnsigned64bitInt         New)
+{
+#if defined( _MSC_VER )
+   return (__int64)Old == _InterlockedCompareExchange64(reinterpret_cast<volatile __int64 *>(p),
+                                                         (__int64)New,
+                                                         (__int64)Old);
+#else
+   return __sync_bool_compare_and_swap(p, Old, New);
+#endif // _MSC_VER
+}
+
+static inline btBool LoggerCompareAndSwap(volatile btUnsigned32bitInt *p,
+                                          btUnsigned32bitInt         Old,
+                                          btUnsigned32bitInt         New)
+{
+#if defined( _MSC_VER )
+   return (long)Old == _InterlockedCompareExchange(reinterpret_cast<volatile long *>(p),
+                                                    (long)New,
+                                                    (long)Old);
+#else
+   return __sync_bool_compare_and_swap(p, Old, New);
+#endif // _MSC_VER
+}
+
+// Returns the new value.
+static inline btUnsigned64bitInt LoggerAdd(volatile btUnsigned64bitInt *p, btUnsigned64bitInt v)
+{
+#if defined( _MSC_VER )
+   return (btUnsigned64bitInt)_InterlockedExchangeAdd64(reinterpret_cast<volatile __int64 *>(p), (__int64)v) + v;
+#else
+   return __sync_add_and_fetch(p, v);
+#endif // _MSC_VER
+}
+
+static inline void LoggerAdd(volatile btUnsigned32bitInt *p, btUnsigned32bitInt v)
+{
+#if defined( _MSC_VER )
+   _InterlockedExchangeAdd(reinterpret_cast<volatile long *>(p), (long)v);
+#else
+   __sync_fetch_and_add(p, v);
+#endif // _MSC_VER
+}
+
+static inline void LoggerBarrier()
+{
+#if defined( _MSC_VER )
+   MemoryBarrier();
+#else
+   __sync_synchronize();
+#endif // _MSC_VER
+}
+
+// Fixed-size line buffer. Output beyond LOGGER_ASYNC_MAX_LINE is counted and discarded,
+//    so that the stream never goes bad.
+class LogLineBuf : public std::streambuf
+{
+public:
+   LogLineBuf() :
+      m_Truncated(0)
+   {
+      Reset();
+   }
+
+   const char * Text()      const { return pbase();                     }
+   size_t       Length()    const { return (size_t)( pptr() - pbase() ); }
+   size_t       Truncated() const { return m_Truncated;                 }
+
+   // A truncated line loses its end, newline included. Put the newline back.
+   void EndTruncated()
+   {
+      if ( ( m_Truncated > 0 ) && ( pptr() > pbase() ) ) {
+         pptr()[-1] = '\n';
+      }
+   }
+
+   void Reset()
+   {
+      setp(m_Line, m_Line + sizeof(m_Line));
+      m_Truncated = 0;
+   }
+
+protected:
+   virtual int_type overflow(int_type c)
+   {
+      if ( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+         ++m_Truncated;
+      }
+      return traits_type::not_eof(c);
+   }
+
+   char   m_Line[LOGGER_ASYNC_MAX_LINE];
+   size_t m_Truncated;
+};
+
+// A thread's line: a std::ostringstream that writes into a LogLineBuf.
+struct LogLine
+{
+   LogLine()
+   {
+      static_cast<std::ios &>(m_Oss).rdbuf(&m_Buf);
+   }
+
+   LogLineBuf         m_Buf;
+   std::ostringstream m_Oss;
+};
+
+// The LogLineBuf that ross writes into, if it is a LogLine's stream.
+static inline LogLineBuf * LineBufOf(std::ostringstream &ross)
+{
+   return dynamic_cast<LogLineBuf *>(static_cast<std::ios &>(ross).rdbuf());
+}
+
+// Each thread remembers its line in the last asynchronous Logger it used, by id.
+//    Ids are never reused, so the entry can not be mistaken for one of a newer Logger.
+struct LoggerThreadCache
+{
+   btUnsigned64bitInt m_Owner;
+   LogLine           *m_pLine;
+};
+
+static __AAL_THREAD_LOCAL LoggerThreadCache gLoggerCache = { 0, NULL };
+
+static volatile btUnsigned64bitInt gLoggerNextId = 0;
+
+class CLoggerAsync
+{
+public:
+   struct Slot
+   {
+      volatile btUnsigned64bitInt m_Seq;
+      btUnsigned32bitInt          m_Len;    // Length of the whole line, first slot only
+      btInt                       m_Level;  // First slot only
+      char                        m_Text[LOGGER_ASYNC_SLOT_TEXT];
+   };
+
+   CLoggerAsync() :
+      m_Head(0),
+      m_Dropped(0),
+      m_Producers(0),
+      m_WriterWaiting(0),
+      m_pSlots(NULL),
+      m_pStorage(NULL),
+      m_Tail(0),
+      m_Reported(0),
+      m_pWriter(NULL),
+      m_bExit(false),
+      m_Id(0),
+      m_Lines()
+   {
+      m_pStorage = new(std::nothrow) btByte[LOGGER_ASYNC_SLOTS * sizeof(Slot) + 63];
+      if ( NULL != m_pStorage ) {
+         m_pSlots = reinterpret_cast<Slot *>((reinterpret_cast<btUIntPtr>(m_pStorage) + 63) & ~(btUIntPtr)63);
+
+         btUnsigned64bitInt i;
+         for ( i = 0 ; i < LOGGER_ASYNC_SLOTS ; ++i ) {
+            m_pSlots[i].m_Seq = i;
+         }
+      }
+
+      m_Id = LoggerAdd(&gLoggerNextId, 1);
+   }
+
+   ~CLoggerAsync()
+   {
+      std::map<btTID, LogLine *>::iterator itr;
+      for ( itr = m_Lines.begin() ; m_Lines.end() != itr ; ++itr ) {
+         delete (*itr).second;
+      }
+      if ( NULL != m_pStorage ) {
+         delete[] m_pStorage;
+      }
+   }
+
+   btBool IsOK() const { return NULL != m_pSlots; }
+
+   Slot & At(btUnsigned64bitInt Pos) { return m_pSlots[Pos & ( LOGGER_ASYNC_SLOTS - 1 )]; }
+
+   // Copy a line into the ring. Returns false, and counts the line, when there is no room.
+   btBool Push(int errLevel, const char *pText, size_t Len)
+   {
+      // A line may fill at most a quarter of the ring.
+      if ( Len > ( LOGGER_ASYNC_SLOTS / 4 ) * LOGGER_ASYNC_SLOT_TEXT ) {
+         Len = ( LOGGER_ASYNC_SLOTS / 4 ) * LOGGER_ASYNC_SLOT_TEXT;
+      }
+
+      const btUnsigned64bitInt Slots = ( 0 == Len ) ? 1 : ( Len + LOGGER_ASYNC_SLOT_TEXT - 1 ) / LOGGER_ASYNC_SLOT_TEXT;
+      btUnsigned64bitInt       Pos;
+
+      for ( ; ; ) {
+         Pos = m_Head;
+
+         // The writer frees slots in order, so the last slot being free means they all are.
+         const bt64bitInt Diff = (bt64bitInt)( At(Pos + Slots - 1).m_Seq - ( Pos + Slots - 1 ) );
+         if ( Diff < 0 ) {
+            LoggerAdd(&m_Dropped, 1);
+            return false;
+         }
+         if ( ( 0 == Diff ) && LoggerCompareAndSwap(&m_Head, Pos, Pos + Slots) ) {
+            break;
+         }
+      }
+
+      // Fill the slots after the first, then the first, so that the writer finds the
+      //    whole line once the first slot is published.
+      btUnsigned64bitInt i;
+      for ( i = Slots - 1 ; i > 0 ; --i ) {
+         Slot  &s = At(Pos + i);
+         size_t n = Len - (size_t)i * LOGGER_ASYNC_SLOT_TEXT;
+         memcpy(s.m_Text, pText + i * LOGGER_ASYNC_SLOT_TEXT, ( n < LOGGER_ASYNC_SLOT_TEXT ) ? n : LOGGER_ASYNC_SLOT_TEXT);
+         s.m_Seq = Pos + i + 1;
+      }
+
+      Slot &First = At(Pos);
+      First.m_Len   = (btUnsigned32bitInt)Len;
+      First.m_Level = errLevel;
+      memcpy(First.m_Text, pText, ( Len < LOGGER_ASYNC_SLOT_TEXT ) ? Len : LOGGER_ASYNC_SLOT_TEXT);
+      LoggerBarrier();
+      First.m_Seq = Pos + 1;
+
+      // Wake the writer, if it went to sleep on an empty ring and there is enough to do.
+      LoggerBarrier();
+      if ( m_WriterWaiting &&
+           ( ( errLevel <= LOG_ERR ) || ( Pos + Slots - m_Tail >= LOGGER_ASYNC_WAKE_SLOTS ) ) &&
+           LoggerCompareAndSwap(&m_WriterWaiting, 1, 0) ) {
+         m_Event.Post(1);
+      }
+      return true;
+   }
+
+   // Writer thread only.
+   btBool Empty()
+   {
+      const btUnsigned64bitInt Tail = m_Tail;
+      return At(Tail).m_Seq != Tail + 1;
+   }
+
+   // Writer thread only. Append the oldest line to sText and free its slots.
+   btBool Pop(std::string &sText, int &errLevel)
+   {
+      const btUnsigned64bitInt Tail  = m_Tail;
+      Slot                    &First = At(Tail);
+      if ( First.m_Seq != Tail + 1 ) {
+         return false;
+      }
+      LoggerBarrier();
+
+      const size_t             Len   = First.m_Len;
+      const btUnsigned64bitInt Slots = ( 0 == Len ) ? 1 : ( Len + LOGGER_ASYNC_SLOT_TEXT - 1 ) / LOGGER_ASYNC_SLOT_TEXT;
+      btUnsigned64bitInt       i;
+
+      errLevel = First.m_Level;
+      for ( i = 0 ; i < Slots ; ++i ) {
+         size_t n = Len - (size_t)i * LOGGER_ASYNC_SLOT_TEXT;
+         sText.append(At(Tail + i).m_Text, ( n < LOGGER_ASYNC_SLOT_TEXT ) ? n : LOGGER_ASYNC_SLOT_TEXT);
+      }
+
+      LoggerBarrier();
+      for ( i = 0 ; i < Slots ; ++i ) {
+         At(Tail + i).m_Seq = Tail + i + LOGGER_ASYNC_SLOTS;
+      }
+      m_Tail = Tail + Slots;
+      return true;
+   }
+
+   // Producer side, written by many threads. Kept apart from the writer's state.
+   volatile btUnsigned64bitInt m_Head;
+   volatile btUnsigned64bitInt m_Dropped;
+   volatile btUnsigned32bitInt m_Producers;     // Threads inside AsyncLog()
+   volatile btUnsigned32bitInt m_WriterWaiting; // Writer is asleep on m_Event
+   btByte                      m_Pad[64 - 2 * sizeof(btUnsigned64bitInt) - 2 * sizeof(btUnsigned32bitInt)];
+
+   Slot                       *m_pSlots;
+   btByte                     *m_pStorage;
+
+   // Writer thread.
+   volatile btUnsigned64bitInt m_Tail;          // Read by producers, to decide when to wake the writer
+   btUnsigned64bitInt          m_Reported;      // Drops already reported in the log
+   CSemaphore                  m_Event;
+   OSLThread                  *m_pWriter;
+   volatile btBool             m_bExit;
+
+   btUnsigned64bitInt          m_Id;
+   std::map<btTID, LogLine *>  m_Lines;         // Every thread's line, under the Logger lock
+};
+
+static CriticalSection gLoggerAsyncSwitch;    // Serializes SetAsync()
+
 //=============================================================================
 // Name:          CLogger::CLogger
 // Description:   Ctor
@@ -275,7 +592,9 @@ CLogger::CLogger() :
    m_bExitFlushThread(false),
    m_bFlushThreadIsExiting(false),
    m_needFlush(false),
-   m_autoFlushTime(1) // Default auto flush time is 1 second
+   m_autoFlushTime(1), // Default auto flush time is 1 second
+   m_pAsync(NULL),
+   m_bAsync(false)
 {
    //Autolock(this); //compiler says this is out of scope, need to investigate?
 #ifdef __AAL_LINUX__
@@ -298,8 +617,15 @@ CLogger::CLogger() :
 //=============================================================================
 CLogger::~CLogger()
 {
+   SetAsync(false);                    // The writer thread needs the lock to drain
+
    AutoLock(this);
 
+   if ( NULL != m_pAsync ) {
+      delete m_pAsync;
+      m_pAsync = NULL;
+   }
+
    StopFlushThread();
 
    if ( FILE == m_eDest ) {
@@ -342,6 +668,14 @@ btBool CLogger::IfLog(LogMask_t mask, int errlevel) const
 //=============================================================================
 std::ostringstream & CLogger::GetOss(int errLevel)
 {
+   if ( m_bAsync ) {
+      std::ostringstream *poss = AsyncOss();
+      if ( NULL != poss ) {
+         PreloadOss(poss, errLevel);
+         return *poss;
+      }
+   }
+
    AutoLock(this);                     // manipulating the map
    std::ostringstream *poss = m_PIDossMap.GetOss((int)GetThreadID());
    if ( NULL == poss ) {
@@ -353,6 +687,35 @@ std::ostringstream & CLogger::GetOss(int errLevel)
    return *poss;
 } // CLogger::GetOss
 
+//=============================================================================
+// Name:          CLogger::AsyncOss
+// Description:   Return the calling thread's line for the asynchronous mode
+// Comment:       Only the first call from each thread takes the lock.
+//=============================================================================
+std::ostringstream * CLogger::AsyncOss()
+{
+   CLoggerAsync *pAsync = m_pAsync;
+
+   if ( gLoggerCache.m_Owner == pAsync->m_Id ) {
+      return &gLoggerCache.m_pLine->m_Oss;
+   }
+
+   AutoLock(this);                     // manipulating the map
+   LogLine *&pLine = pAsync->m_Lines[GetThreadID()];
+   if ( NULL == pLine ) {
+      pLine = new(std::nothrow) LogLine();
+      if ( NULL == pLine ) {
+         pAsync->m_Lines.erase(GetThreadID());
+         return NULL;
+      }
+   }
+
+   gLoggerCache.m_Owner = pAsync->m_Id;
+   gLoggerCache.m_pLine = pLine;
+
+   return &pLine->m_Oss;
+} // CLogger::AsyncOss
+
 //=============================================================================
 // Name:          CLogger::Getpsz
 // Description:   Return a char* for the client to write upon
@@ -532,6 +895,16 @@ void CLogger::PreloadOss(std::ostringstream *poss, int errLevel)
 //=============================================================================
 void CLogger::Log(int errLevel, const char* psz)
 {
+   if ( m_bAsync ) {
+      std::ostringstream oss;
+
+      PreloadOss(&oss, errLevel);
+      oss << psz;
+
+      Log(errLevel, oss);
+      return;
+   }
+
    AutoLock(this);
 
    std::ostringstream oss;
@@ -549,12 +922,49 @@ void CLogger::Log(int errLevel, const char* psz)
 //=============================================================================
 void CLogger::Log(int errLevel, std::ostringstream& ross)
 {
+   LogLineBuf *pBuf = LineBufOf(ross);
+
+   if ( m_bAsync ) {
+      if ( NULL != pBuf ) {
+         pBuf->EndTruncated();
+         AsyncLog(errLevel, pBuf->Text(), pBuf->Length());
+         pBuf->Reset();
+      } else {
+         const std::string sText(ross.str());
+         AsyncLog(errLevel, sText.data(), sText.length());
+         ross.str("");
+      }
+      return;
+   }
+
    AutoLock(this);
 
+   if ( NULL != pBuf ) {               // line begun before SetAsync(false)
+      pBuf->EndTruncated();
+      Write(errLevel, std::string(pBuf->Text(), pBuf->Length()));
+      pBuf->Reset();
+   } else {
+      Write(errLevel, ross.str());
+      ross.str("");
+   }
+} // CLogger::Log (int errlevel, std::ostringstream& oss)
+
+void CLogger::Log(int errlevel, std::basic_ostream<char, std::char_traits<char> > &rbos)
+{
+   Log(errlevel, static_cast<std::ostringstream &>(rbos));
+}
+
+//=============================================================================
+// Name:          CLogger::Write
+// Description:   Write a line, or a batch of lines, to the destination
+// Comment:       Callers need to be locked.
+//=============================================================================
+void CLogger::Write(int errLevel, const std::string &sText)
+{
    switch ( m_eDest ) {
 
       case FILE : {
-         m_ofstream << ross.str();
+         m_ofstream << sText;
          //if ( m_bFlush || (errLevel <= LOG_ERR) )
          if ( m_bFlush ) {
             m_ofstream.flush();
@@ -564,11 +974,11 @@ void CLogger::Log(int errLevel, std::ostringstream& ross)
       } break;
 
       case CERR : {
-         std::cerr << ross.str();
+         std::cerr << sText;
       } break;
 
       case COUT : {
-         std::cout << ross.str();
+         std::cout << sText;
          if ( m_bFlush || (errLevel <= LOG_ERR) ) {
             std::cout.flush();
          }
@@ -576,18 +986,34 @@ void CLogger::Log(int errLevel, std::ostringstream& ross)
 
       case SYSLOG : {
 #ifdef __AAL_LINUX__
-         syslog( std::min( errLevel, LOG_DEBUG), "%s", ross.str().c_str());
+         syslog( std::min( errLevel, LOG_DEBUG), "%s", sText.c_str());
 #endif // __AAL_LINUX__
       } break;
    }
+} // CLogger::Write
 
-   ross.str("");
-} // CLogger::Log (int errlevel, std::ostringstream& oss)
-
-void CLogger::Log(int errlevel, std::basic_ostream<char, std::char_traits<char> > &rbos)
+//=============================================================================
+// Name:          CLogger::AsyncLog
+// Description:   Hand a line to the writer thread
+// Comment:       Does not block. When the ring is full, the line is dropped and
+//                   counted.
+//=============================================================================
+void CLogger::AsyncLog(int errLevel, const char *pText, size_t Len)
 {
-   Log(errlevel, static_cast<std::ostringstream &>(rbos));
-}
+   CLoggerAsync *pAsync = m_pAsync;
+
+   // SetAsync(false) waits for every thread that finds m_bAsync set here.
+   LoggerAdd(&pAsync->m_Producers, 1);
+   if ( m_bAsync ) {
+      pAsync->Push(errLevel, pText, Len);
+      LoggerAdd(&pAsync->m_Producers, (btUnsigned32bitInt)-1);
+      return;
+   }
+   LoggerAdd(&pAsync->m_Producers, (btUnsigned32bitInt)-1);
+
+   AutoLock(this);
+   Write(errLevel, std::string(pText, Len));
+} // CLogger::AsyncLog
 
 //=============================================================================
 // Name:          CLogger::SetDestination
@@ -876,6 +1302,90 @@ unsigned int CLogger::GetAutoFlushTime() const
 	AutoLock(this);
 	return m_autoFlushTime;
 }
+//=============================================================================
+// Name:          CLogger::SetAsync
+// Description:   Mutator: Set whether Log() hands lines to a writer thread
+// Comment:       Setting false writes every line already handed over before
+//                   returning.
+//=============================================================================
+void CLogger::SetAsync(btBool fAsync)
+{
+   AutoLock(&gLoggerAsyncSwitch);
+
+   if ( fAsync ) {
+      AutoLock(this);
+
+      if ( m_bAsync ) {
+         return;
+      }
+
+      if ( NULL == m_pAsync ) {
+         m_pAsync = new(std::nothrow) CLoggerAsync();
+         if ( ( NULL == m_pAsync ) || !m_pAsync->IsOK() ) {
+            std::cerr << __AAL_FUNC__ << "(): unable to allocate the ring. Logging synchronously." << std::endl;
+            delete m_pAsync;
+            m_pAsync = NULL;
+            return;
+         }
+      }
+
+      m_pAsync->m_Event.Create(0, 1);
+      m_pAsync->m_bExit   = false;
+      m_pAsync->m_pWriter = new(std::nothrow) OSLThread(CLogger::AsyncWriterThread,
+                                                        OSLThread::THREADPRIORITY_NORMAL,
+                                                        this);
+      if ( NULL == m_pAsync->m_pWriter ) {
+         std::cerr << __AAL_FUNC__ << "(): create writer thread failed. Logging synchronously." << std::endl;
+         m_pAsync->m_Event.Destroy();
+         return;
+      }
+
+      m_bAsync = true;
+      return;
+   }
+
+   {
+      AutoLock(this);
+      if ( !m_bAsync ) {
+         return;
+      }
+      m_bAsync = false;
+   }
+
+   // Wait out the threads still handing over lines, then have the writer drain
+   //    the ring and exit.
+   LoggerBarrier();
+   while ( 0 != m_pAsync->m_Producers ) {
+      SleepZero();
+   }
+
+   m_pAsync->m_bExit = true;
+   m_pAsync->m_Event.Post(1);
+   m_pAsync->m_pWriter->Join();
+
+   delete m_pAsync->m_pWriter;
+   m_pAsync->m_pWriter = NULL;
+   m_pAsync->m_Event.Destroy();
+}
+
+//=============================================================================
+// Name:          CLogger::GetAsync
+// Description:   Accessor
+//=============================================================================
+btBool CLogger::GetAsync() const
+{
+   return m_bAsync;
+}
+
+//=============================================================================
+// Name:          CLogger::GetDropped
+// Description:   Accessor: lines dropped because the ring was full
+//=============================================================================
+btUnsigned64bitInt CLogger::GetDropped() const
+{
+   return ( NULL == m_pAsync ) ? 0 : m_pAsync->m_Dropped;
+}
+
 //=============================================================================
 void CLogger::FileFlushThread(OSLThread *pThread, void *pContext)
 {
@@ -903,7 +1413,73 @@ void CLogger::FileFlushThread(OSLThread *pThread, void *pContext)
    }
 }
 
+//=============================================================================
+// Name:          CLogger::AsyncWriterThread
+// Description:   Drain the ring, writing each batch of lines under the lock
+// Comment:       Sleeps on m_Event while the ring is empty. Lines handed over
+//                   before SetAsync(false) are written before it exits.
+//=============================================================================
+void CLogger::AsyncWriterThread(OSLThread *pThread, void *pContext)
+{
+   CLogger *This = static_cast<CLogger *>(pContext);
 
-END_NAMESPACE(AAL)
+   ASSERT(NULL != This);
+   if ( NULL == This ) return;
+
+   CLoggerAsync *pAsync = This->m_pAsync;
+   std::string   sBatch;
+   int           errLevel;
+
+   while ( true ) {
+      const btBool  bExit    = pAsync->m_bExit;
+      btUnsignedInt Lines    = 0;
+      int           MinLevel = LOG_VERBOSE;
+
+      sBatch.clear();
+      while ( ( sBatch.length() < 64 * 1024 ) && pAsync->Pop(sBatch, errLevel) ) {
+         ++Lines;
+         if ( errLevel < MinLevel ) {
+            MinLevel = errLevel;
+         }
+         if ( SYSLOG == This->m_eDest ) { // one record per line
+            AutoLock(This);
+            This->Write(errLevel, sBatch);
+            sBatch.clear();
+         }
+      }
 
+      const btUnsigned64bitInt Dropped = pAsync->m_Dropped;
+      if ( Dropped != pAsync->m_Reported ) {
+         std::ostringstream oss;
+         This->PreloadOss(&oss, LOG_WARNING);
+         oss << "AAL Logger dropped " << ( Dropped - pAsync->m_Reported ) << " lines" << std::endl;
+         pAsync->m_Reported = Dropped;
 
+         sBatch += oss.str();
+         if ( LOG_WARNING < MinLevel ) {
+            MinLevel = LOG_WARNING;
+         }
+      }
+
+      if ( !sBatch.empty() ) {
+         AutoLock(This);
+         This->Write(MinLevel, sBatch);
+      }
+
+      if ( 0 == Lines ) {
+         if ( bExit ) {
+            break;
+         }
+
+         pAsync->m_WriterWaiting = 1;
+         LoggerBarrier();
+         if ( pAsync->Empty() ) {
+            pAsync->m_Event.Wait(LOGGER_ASYNC_WAIT_MS);
+         }
+         pAsync->m_WriterWaiting = 0;
+      }
+   }
+}
+
+
+END_NAMESPACE(AAL)
@@ -240,6 +240,156 @@ std::ostream & operator << (std::ostream &s, const WorkSpaceMapper::eWSM_Ret &e)
 }  // end of operator << for WorkSpaceMapper::WkSp
 
 
+// Per-thread cache of the last WorkSpaceIndex hit. Valid only while its owner is
+//    still at the generation that was current when the hit was recorded.
+struct WorkSpaceIndexLastHit
+{
+   const WorkSpaceIndex *m_pOwner;
+   btUnsigned64bitInt    m_Generation;
+   WorkSpaceIndex::WkSp  m_wksp;
+};
+
+static __AAL_THREAD_LOCAL WorkSpaceIndexLastHit gWkSpIdxLastHit = { NULL, 0, { NULL, 0, 0, 0 } };
+
+static CriticalSection    gWkSpIdxGenLock;
+static btUnsigned64bitInt gWkSpIdxNextGeneration = 1;
+
+btUnsigned64bitInt WorkSpaceIndex::NextGeneration()
+{
+   AutoLock(&gWkSpIdxGenLock);
+   return gWkSpIdxNextGeneration++;
+}
+
+WorkSpaceIndex::WorkSpaceIndex() :
+   m_map(),
+   m_Generation(WorkSpaceIndex::NextGeneration())
+{}
+
+WorkSpaceIndex::~WorkSpaceIndex()
+{
+   AutoLock(this);
+   m_map.clear();
+   m_Generation = WorkSpaceIndex::NextGeneration();
+}
+
+btBool WorkSpaceIndex::Add(btVirtAddr ptr,
+                           btWSSize   len,
+                           btPhysAddr iova,
+                           btWSID     wsid)
+{
+   if ( ( NULL == ptr ) || ( 0 == len ) ) {
+      return false;
+   }
+
+   AutoLock(this);
+
+   // The first workspace beginning after ptr must not begin before ptr + len ..
+   wkspMap_itr_t itr = m_map.upper_bound(ptr);
+   if ( ( itr != m_map.end() ) && ( (*itr).first < ptr + len ) ) {
+      return false;
+   }
+   // .. and the last workspace beginning at or before ptr must end at or before ptr.
+   if ( itr != m_map.begin() ) {
+      --itr;
+      if ( ptr < (*itr).second.m_ptr + (*itr).second.m_len ) {
+         return false;
+      }
+   }
+
+   WkSp wksp;
+   wksp.m_ptr  = ptr;
+   wksp.m_len  = len;
+   wksp.m_iova = iova;
+   wksp.m_wsid = wsid;
+
+   m_map.insert(std::pair<btVirtAddr, WkSp>(ptr, wksp));
+   m_Generation = WorkSpaceIndex::NextGeneration();
+   return true;
+}
+
+btBool WorkSpaceIndex::Remove(btVirtAddr ptr, WkSp *pwksp)
+{
+   AutoLock(this);
+
+   wkspMap_itr_t itr = m_map.find(ptr);
+   if ( itr == m_map.end() ) {
+      return false;
+   }
+
+   if ( NULL != pwksp ) {
+      *pwksp = (*itr).second;
+   }
+
+   m_map.erase(itr);
+   m_Generation = WorkSpaceIndex::NextGeneration();
+   return true;
+}
+
+btBool WorkSpaceIndex::Find(btVirtAddr ptr, WkSp *pwksp) const
+{
+   AutoLock(this);
+
+   wkspMap_citr_t itr = m_map.find(ptr);
+   if ( itr == m_map.end() ) {
+      return false;
+   }
+
+   *pwksp = (*itr).second;
+   return true;
+}
+
+btBool WorkSpaceIndex::Lookup(btVirtAddr ptr, WkSp *pwksp) const
+{
+   WorkSpaceIndexLastHit &hit = gWkSpIdxLastHit;
+
+   if ( ( this == hit.m_pOwner )                               &&
+        ( m_Generation == hit.m_Generation )                   &&
+        ( ptr >= hit.m_wksp.m_ptr )                            &&
+        ( ptr <  hit.m_wksp.m_ptr + hit.m_wksp.m_len ) ) {
+      *pwksp = hit.m_wksp;
+      return true;
+   }
+
+   AutoLock(this);
+
+   // The only candidate is the last workspace whose base is <= ptr.
+   wkspMap_citr_t itr = m_map.upper_bound(ptr);
+   if ( itr == m_map.begin() ) {
+      return false; // ptr is below every workspace.
+   }
+   --itr;
+
+   if ( ptr >= (*itr).second.m_ptr + (*itr).second.m_len ) {
+      return false; // ptr is in the hole after this workspace.
+   }
+
+   *pwksp = (*itr).second;
+
+   hit.m_pOwner     = this;
+   hit.m_Generation = m_Generation;
+   hit.m_wksp       = (*itr).second;
+
+   return true;
+}
+
+btPhysAddr WorkSpaceIndex::GetIOVA(btVirtAddr ptr) const
+{
+   WkSp wksp;
+
+   if ( !Lookup(ptr, &wksp) ) {
+      return 0;
+   }
+
+   return wksp.m_iova + (ptr - wksp.m_ptr);
+}
+
+btUnsigned32bitInt WorkSpaceIndex::Size() const
+{
+   AutoLock(this);
+   return (btUnsigned32bitInt)m_map.size();
+}
+
+
 END_NAMESPACE(AAL)
 
 
@@ -0,0 +1,231 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file CCompletionWaiter.cpp
+/// @brief Spin, back off, then block until a completion flag is set.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/utils/CompletionWaiter.h"  // This class' definition
+#include "aalsdk/osal/Sleep.h"
+#include "aalsdk/osal/Timer.h"
+
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+# include <xmmintrin.h>
+# define COMPLETION_WAITER_PAUSE() _mm_pause()
+#else
+# define COMPLETION_WAITER_PAUSE()
+#endif // x86
+
+// The spin stage reads the clock once per this many polls.
+#define COMPLETION_WAITER_SPINS_PER_CLOCK 64
+
+
+BEGIN_NAMESPACE(AAL)
+
+
+CompletionWaiter::EventBlocker::EventBlocker()
+{
+   // Binary: Signal()'s that find the count already at 1 are dropped.
+   m_Sem.Create(0, 1);
+}
+
+CompletionWaiter::EventBlocker::~EventBlocker() {}
+
+void CompletionWaiter::EventBlocker::Signal()
+{
+   m_Sem.Post(1);
+}
+
+void CompletionWaiter::EventBlocker::Block(btTime TimeoutMillis)
+{
+   m_Sem.Wait(TimeoutMillis);
+}
+
+
+CompletionWaiter::CompletionWaiter(btUnsigned64bitInt SpinNanos,
+                                   btUnsigned32bitInt MaxBackoffMicros,
+                                   IBlocker          *pBlocker) :
+   m_SpinNanos(SpinNanos),
+   m_MaxBackoffMicros(MaxBackoffMicros),
+   m_pBlocker(pBlocker)
+{
+   ResetHistogram();
+}
+
+btBool CompletionWaiter::Wait(volatile btUnsigned32bitInt const *pFlag, btTime TimeoutMillis)
+{
+   if ( 0 != *pFlag ) {
+      Record(StageImmediate, 0);
+      return true;
+   }
+
+   const btBool             Infinite     = ( AAL_INFINITE_WAIT == TimeoutMillis );
+   const btUnsigned64bitInt TimeoutNanos = Infinite ? 0 : TimeoutMillis * 1000000ULL;
+
+   Timer              start;
+   btUnsigned64bitInt elapsed = 0;
+   btUnsignedInt      i;
+
+   // 1) Spin.
+   while ( elapsed < m_SpinNanos ) {
+      for ( i = 0 ; i < COMPLETION_WAITER_SPINS_PER_CLOCK ; ++i ) {
+         if ( 0 != *pFlag ) {
+            (Timer() - start).AsNanoSeconds(elapsed);
+            Record(StageSpin, elapsed);
+            return true;
+         }
+         COMPLETION_WAITER_PAUSE();
+      }
+      (Timer() - start).AsNanoSeconds(elapsed);
+      if ( !Infinite && ( elapsed >= TimeoutNanos ) ) {
+         Record(StageTimeout, elapsed);
+         return false;
+      }
+   }
+
+   // 2) Back off, and 3) block.
+   btUnsigned32bitInt backoff = 1;
+   Stage              stage   = StageBackoff;
+
+   for ( ; ; ) {
+      if ( 0 != *pFlag ) {
+         (Timer() - start).AsNanoSeconds(elapsed);
+         Record(stage, elapsed);
+         return true;
+      }
+
+      (Timer() - start).AsNanoSeconds(elapsed);
+      if ( !Infinite && ( elapsed >= TimeoutNanos ) ) {
+         // One last look, in case the flag was set while we slept.
+         if ( 0 != *pFlag ) {
+            Record(stage, elapsed);
+            return true;
+         }
+         Record(StageTimeout, elapsed);
+         return false;
+      }
+
+      if ( ( backoff < m_MaxBackoffMicros ) || ( NULL == m_pBlocker ) ) {
+         SleepMicro(backoff);
+         if ( backoff < m_MaxBackoffMicros ) {
+            backoff <<= 1;
+            if ( backoff > m_MaxBackoffMicros ) {
+               backoff = m_MaxBackoffMicros;
+            }
+         }
+      } else {
+         btTime slice = BlockSliceMillis;
+         if ( !Infinite ) {
+            btTime remaining = ( TimeoutNanos - elapsed + 999999ULL ) / 1000000ULL;
+            if ( remaining < slice ) {
+               slice = remaining;
+            }
+         }
+         stage = StageBlock;
+         m_pBlocker->Block(slice);
+      }
+   }
+}
+
+void CompletionWaiter::ResetHistogram()
+{
+   btUnsignedInt i;
+
+   m_Waits          = 0;
+   m_TotalWaitNanos = 0;
+   m_MaxWaitNanos   = 0;
+   for ( i = 0 ; i < NumStages ; ++i ) {
+      m_Stages[i] = 0;
+   }
+   for ( i = 0 ; i < NumBuckets ; ++i ) {
+      m_Buckets[i] = 0;
+   }
+}
+
+btUnsignedInt CompletionWaiter::Bucket(btUnsigned64bitInt Nanos)
+{
+   btUnsignedInt b = 0;
+   while ( ( Nanos > 1 ) && ( b < NumBuckets - 1 ) ) {
+      Nanos >>= 1;
+      ++b;
+   }
+   return b;
+}
+
+void CompletionWaiter::Record(Stage s, btUnsigned64bitInt Nanos)
+{
+   ++m_Waits;
+   ++m_Stages[s];
+   ++m_Buckets[Bucket(Nanos)];
+   m_TotalWaitNanos += Nanos;
+   if ( Nanos > m_MaxWaitNanos ) {
+      m_MaxWaitNanos = Nanos;
+   }
+}
+
+void CompletionWaiter::Print(std::ostream &s) const
+{
+   static const char * const StageNames[NumStages] = {
+      "immediate", "spin", "backoff", "block", "timeout"
+   };
+   btUnsignedInt i;
+
+   s << "waits: " << m_Waits;
+   for ( i = 0 ; i < NumStages ; ++i ) {
+      s << ' ' << StageNames[i] << ": " << m_Stages[i];
+   }
+   s << " max: " << m_MaxWaitNanos << " ns";
+   if ( m_Waits > 0 ) {
+      s << " mean: " << m_TotalWaitNanos / m_Waits << " ns";
+   }
+   s << std::endl;
+
+   for ( i = 0 ; i < NumBuckets ; ++i ) {
+      if ( 0 != m_Buckets[i] ) {
+         s << "  >= " << ( 1ULL << i ) << " ns: " << m_Buckets[i] << std::endl;
+      }
+   }
+}
+
+std::ostream & operator << (std::ostream &s, const CompletionWaiter &w)
+{
+   w.Print(s);
+   return s;
+}
+
+
+END_NAMESPACE(AAL)
+
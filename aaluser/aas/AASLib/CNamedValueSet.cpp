@@ -104,6 +104,7 @@
 
 #define NVSFileIO          /* for the time being, leave it in */
 #include "aalsdk/INamedValueSet.h"
+#include "aalsdk/AALNVSBinary.h"
 
 
 #define MAX_VALID_NVS_ARRAY_ENTRIES (1024 * 1024)
@@ -322,6 +323,21 @@ CValue & CValue::operator = (const CValue &rOther)
    return *this;
 }
 
+void CValue::Swap(CValue &rOther)
+{
+   btUnsigned32bitInt Size = m_Size;
+   eBasicTypes        Type = m_Type;
+   Val_t              Val  = m_Val;
+
+   m_Size = rOther.m_Size;
+   m_Type = rOther.m_Type;
+   m_Val  = rOther.m_Val;
+
+   rOther.m_Size = Size;
+   rOther.m_Type = Type;
+   rOther.m_Val  = Val;
+}
+
 void CValue::Put(btBool val)             { m_Type = btBool_t;             m_Val._1b   = val; m_Size = 1; }
 void CValue::Put(btByte val)             { m_Type = btByte_t;             m_Val._8b   = val; m_Size = 1; }
 void CValue::Put(bt32bitInt val)         { m_Type = bt32bitInt_t;         m_Val._32b  = val; m_Size = 1; }
@@ -610,12 +626,325 @@ ENamedValues CValue::Get(btObjectArray *pval) const
 /*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
 /*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
 
+//=============================================================================
+// Name: NVSKeyTraits
+// Description: How TNVSStore holds, orders, and releases the keys of each key
+//              type.
+// Comments: A string key is held as a private copy that is never moved, so
+//           the name returned by GetName() stays valid until that name is
+//           deleted, wherever the entry itself moves to.
+//=============================================================================
+template<typename Kt>
+struct NVSKeyTraits;
+
+template<>
+struct NVSKeyTraits<btNumberKey>
+{
+   static btNumberKey Hold(btNumberKey Key)                   { return Key;       }
+   static void     Release(btNumberKey )                      {                   }
+   static btBool      Less(btNumberKey lhs, btNumberKey rhs)  { return lhs < rhs; }
+};
+
+template<>
+struct NVSKeyTraits<btStringKey>
+{
+   static btStringKey Hold(btStringKey Key)                   { return strdup(Key);              }
+   static void     Release(btStringKey Key)                   { free(const_cast<btString>(Key)); }
+   static btBool      Less(btStringKey lhs, btStringKey rhs)  { return strcmp(lhs, rhs) < 0;     }
+};
+
+template<typename Kt>
+struct NVSKeyLess
+{
+   bool operator() (Kt lhs, Kt rhs) const { return NVSKeyTraits<Kt>::Less(lhs, rhs); }
+};
+
+// Number of names that a TNVSStore keeps in its flat array, and the initial
+//   capacity of the array.
+#define NVS_FLAT_MAX_NAMES    32
+#define NVS_FLAT_MIN_CAPACITY 4
+
+//=============================================================================
+// Name: TNVSStore
+// Description: Key-ordered storage for the name/value pairs of a TNamedValueSet.
+// Comments: Most NVS's hold only a handful of names, so the pairs are kept in
+//           a single array, sorted by key, until there are more than
+//           NVS_FLAT_MAX_NAMES of them. Then the store moves them into a
+//           std::map, where they stay until the store is emptied. Either way,
+//           index i is the i-th name in key order.
+//
+//           The array grows, and entries move within it, by swapping the
+//           values with CValue::Swap(), so no array, string, or embedded NVS
+//           is copied to insert or delete a name.
+//=============================================================================
+template<typename Kt>
+class TNVSStore
+{
+public:
+   TNVSStore() :
+      m_CursorIndex(0),
+      m_CursorValid(false)
+   {}
+
+   TNVSStore(const TNVSStore &rOther) :
+      m_CursorIndex(0),
+      m_CursorValid(false)
+   {
+      *this = rOther;
+   }
+
+   ~TNVSStore() { Clear(); }
+
+   TNVSStore & operator = (const TNVSStore &rOther)
+   {
+      if ( &rOther == this ) {
+         return *this;
+      }
+
+      Clear();
+
+      if ( rOther.m_Map.empty() ) {
+         size_type i;
+
+         m_Flat.reserve(rOther.m_Flat.size());
+         m_Flat.resize(rOther.m_Flat.size());
+         for ( i = 0 ; i < m_Flat.size() ; ++i ) {
+            m_Flat[i].Key = traits::Hold(rOther.m_Flat[i].Key);
+            m_Flat[i].Val = rOther.m_Flat[i].Val;
+         }
+      } else {
+         typename map_type::const_iterator itr;
+
+         for ( itr = rOther.m_Map.begin() ; rOther.m_Map.end() != itr ; ++itr ) {
+            m_Map.insert(m_Map.end(),
+                         typename map_type::value_type(traits::Hold((*itr).first), CValue()))->second = (*itr).second;
+         }
+      }
+
+      return *this;
+   }
+
+   // Number of name/value pairs.
+   btWSSize Size() const { return m_Map.empty() ? m_Flat.size() : m_Map.size(); }
+
+   // Value for Key, or NULL if there is none.
+   const CValue * Find(Kt Key) const
+   {
+      if ( !m_Map.empty() ) {
+         typename map_type::const_iterator itr = m_Map.find(Key);
+         return ( m_Map.end() == itr ) ? NULL : &(*itr).second;
+      }
+
+      size_type i = LowerBound(Key);
+      if ( ( i < m_Flat.size() ) && !traits::Less(Key, m_Flat[i].Key) ) {
+         return &m_Flat[i].Val;
+      }
+      return NULL;
+   }
+
+   // Adds Key with an empty value, and returns the value to be filled in, or
+   //   NULL if Key is already present.
+   CValue * Insert(Kt Key)
+   {
+      if ( m_Map.empty() && ( m_Flat.size() < NVS_FLAT_MAX_NAMES ) ) {
+         size_type i = LowerBound(Key);
+         size_type j;
+
+         if ( ( i < m_Flat.size() ) && !traits::Less(Key, m_Flat[i].Key) ) {
+            return NULL;
+         }
+
+         Grow();
+         m_Flat.push_back(Entry());
+         for ( j = m_Flat.size() - 1 ; j > i ; --j ) {
+            SwapEntries(j, j - 1);
+         }
+
+         m_Flat[i].Key = traits::Hold(Key);
+         return &m_Flat[i].Val;
+      }
+
+      Spill();
+      m_CursorValid = false;
+
+      typename map_type::iterator itr = m_Map.lower_bound(Key);
+      if ( ( m_Map.end() != itr ) && !traits::Less(Key, (*itr).first) ) {
+         return NULL;
+      }
+
+      itr = m_Map.insert(itr, typename map_type::value_type(traits::Hold(Key), CValue()));
+      return &(*itr).second;
+   }
+
+   // Removes Key and its value. Returns false if Key is not present.
+   btBool Erase(Kt Key)
+   {
+      if ( !m_Map.empty() ) {
+         typename map_type::iterator itr = m_Map.find(Key);
+         if ( m_Map.end() == itr ) {
+            return false;
+         }
+
+         Kt Held = (*itr).first;
+         m_Map.erase(itr);
+         traits::Release(Held);
+         m_CursorValid = false;
+         return true;
+      }
+
+      size_type i = LowerBound(Key);
+      if ( ( i >= m_Flat.size() ) || traits::Less(Key, m_Flat[i].Key) ) {
+         return false;
+      }
+
+      traits::Release(m_Flat[i].Key);
+      for ( ; i + 1 < m_Flat.size() ; ++i ) {
+         SwapEntries(i, i + 1);
+      }
+      m_Flat.pop_back();
+      return true;
+   }
+
+   // Removes every name and value.
+   void Clear()
+   {
+      size_type                   i;
+      typename map_type::iterator itr;
+
+      for ( i = 0 ; i < m_Flat.size() ; ++i ) {
+         traits::Release(m_Flat[i].Key);
+      }
+      m_Flat.clear();
+
+      for ( itr = m_Map.begin() ; m_Map.end() != itr ; ++itr ) {
+         traits::Release((*itr).first);
+      }
+      m_Map.clear();
+
+      m_CursorValid = false;
+   }
+
+   // The index-th name in key order. Returns false if index is out of range.
+   btBool NameAt(btUnsignedInt index, Kt *pKey) const
+   {
+      if ( (btWSSize)index >= Size() ) {
+         return false;
+      }
+
+      if ( m_Map.empty() ) {
+         *pKey = m_Flat[index].Key;
+         return true;
+      }
+
+      // Walk on from the name found by the previous call, so that visiting the
+      //   names in index order is linear rather than quadratic.
+      if ( !m_CursorValid || ( index < m_CursorIndex ) ) {
+         m_Cursor      = m_Map.begin();
+         m_CursorIndex = 0;
+         m_CursorValid = true;
+      }
+      while ( m_CursorIndex < index ) {
+         ++m_Cursor;
+         ++m_CursorIndex;
+      }
+
+      *pKey = (*m_Cursor).first;
+      return true;
+   }
+
+private:
+   typedef NVSKeyTraits<Kt> traits;
+
+   struct Entry
+   {
+      Entry() : Key(), Val() {}
+      Kt     Key;
+      CValue Val;
+   };
+
+   typedef std::vector<Entry>                     flat_type;
+   typedef typename flat_type::size_type          size_type;
+   typedef std::map<Kt, CValue, NVSKeyLess<Kt> >  map_type;
+
+   // Index of the first entry whose key is not less than Key.
+   size_type LowerBound(Kt Key) const
+   {
+      size_type lo = 0;
+      size_type hi = m_Flat.size();
+
+      while ( lo < hi ) {
+         size_type mid = lo + ( hi - lo ) / 2;
+         if ( traits::Less(m_Flat[mid].Key, Key) ) {
+            lo = mid + 1;
+         } else {
+            hi = mid;
+         }
+      }
+      return lo;
+   }
+
+   void SwapEntries(size_type a, size_type b)
+   {
+      Kt Key        = m_Flat[a].Key;
+      m_Flat[a].Key = m_Flat[b].Key;
+      m_Flat[b].Key = Key;
+      m_Flat[a].Val.Swap(m_Flat[b].Val);
+   }
+
+   // Makes room for one more entry. The entries are swapped, not copied, into
+   //   the larger array.
+   void Grow()
+   {
+      if ( m_Flat.size() < m_Flat.capacity() ) {
+         return;
+      }
+
+      size_type Capacity = m_Flat.empty() ? NVS_FLAT_MIN_CAPACITY : 2 * m_Flat.size();
+      if ( Capacity > NVS_FLAT_MAX_NAMES ) {
+         Capacity = NVS_FLAT_MAX_NAMES;
+      }
+
+      flat_type Larger;
+      size_type i;
+
+      Larger.reserve(Capacity);
+      Larger.resize(m_Flat.size());
+      for ( i = 0 ; i < m_Flat.size() ; ++i ) {
+         Larger[i].Key = m_Flat[i].Key;
+         Larger[i].Val.Swap(m_Flat[i].Val);
+      }
+      m_Flat.swap(Larger);
+   }
+
+   // Moves the entries from the array into the map.
+   void Spill()
+   {
+      size_type i;
+
+      if ( m_Flat.empty() ) {
+         return;
+      }
+
+      for ( i = 0 ; i < m_Flat.size() ; ++i ) {
+         m_Map.insert(m_Map.end(),
+                      typename map_type::value_type(m_Flat[i].Key, CValue()))->second.Swap(m_Flat[i].Val);
+      }
+      flat_type().swap(m_Flat);
+   }
+
+   flat_type                                  m_Flat;
+   map_type                                   m_Map;
+   mutable typename map_type::const_iterator  m_Cursor;
+   mutable btUnsignedInt                      m_CursorIndex;
+   mutable btBool                             m_CursorValid;
+};
+
 //=============================================================================
 //=============================================================================
 //   This template is used to construct a NVS class specific to a particular
 //   key data type. It is used in the CNamevValueSet  container class to hold
 //   an NVS instance that is specific to a particular key type.
-//   Namely std::string and and btUnsignedInt.  We could have defined a class
+//   Namely btStringKey and btNumberKey.  We could have defined a class
 //   for each type but this allows us to easily create new NVS for any key
 //   type.
 //=============================================================================
@@ -629,10 +958,7 @@ template<typename Kt>
 class TNamedValueSet
 {
 private:
-   typedef typename std::map<Kt, AAL::CValue> map_type;
-   typedef typename map_type::const_iterator  const_iterator;
-
-   map_type m_NVSet;
+   TNVSStore<Kt> m_NVSet;
 
 public:
    //=============================================================================
@@ -707,15 +1033,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btBool Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -730,15 +1056,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btByte Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -753,15 +1079,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, bt32bitInt Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -776,15 +1102,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btUnsigned32bitInt Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -799,15 +1125,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, bt64bitInt Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -822,15 +1148,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btUnsigned64bitInt Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -845,15 +1171,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btFloat Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -868,15 +1194,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btcString Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -891,15 +1217,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, const INamedValueSet *Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -916,15 +1242,15 @@ public:
    ENamedValues Add(Kt Name, btByteArray        Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -940,15 +1266,15 @@ public:
    ENamedValues Add(Kt Name, bt32bitIntArray    Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -964,15 +1290,15 @@ public:
    ENamedValues Add(Kt Name, btUnsigned32bitIntArray Value,
                              btUnsigned32bitInt      NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -988,15 +1314,15 @@ public:
    ENamedValues Add(Kt Name, bt64bitIntArray    Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -1012,15 +1338,15 @@ public:
    ENamedValues Add(Kt Name, btUnsigned64bitIntArray Value,
                              btUnsigned32bitInt      NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -1035,15 +1361,15 @@ public:
    //=============================================================================
    ENamedValues Add(Kt Name, btObjectType Value)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value);
+      pVal->Put(Value);
       return ENamedValuesOK;
    }
 
@@ -1059,15 +1385,15 @@ public:
    ENamedValues Add(Kt Name, btFloatArray       Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -1083,15 +1409,15 @@ public:
    ENamedValues Add(Kt Name, btStringArray      Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -1107,15 +1433,15 @@ public:
    ENamedValues Add(Kt Name, btObjectArray      Value,
                              btUnsigned32bitInt NumElements)
    {
-      const_iterator itr = m_NVSet.end();
+      CValue *pVal = m_NVSet.Insert(Name);
 
       //Check for exclusivity
-      if ( m_NVSet.find(Name) != itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesDuplicateName;
       }
 
       //Store the value
-      m_NVSet[Name].Put(Value, NumElements);
+      pVal->Put(Value, NumElements);
       return ENamedValuesOK;
    }
 
@@ -1130,14 +1456,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btBool *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1150,14 +1476,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btByte *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1170,14 +1496,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, bt32bitInt *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1190,14 +1516,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btUnsigned32bitInt *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1210,14 +1536,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, bt64bitInt *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1230,14 +1556,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btUnsigned64bitInt *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1250,14 +1576,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btFloat *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1270,14 +1596,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btcString *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1290,14 +1616,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, INamedValueSet const **pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1310,14 +1636,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btByteArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1330,14 +1656,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, bt32bitIntArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1350,14 +1676,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btUnsigned32bitIntArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1370,14 +1696,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, bt64bitIntArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1390,14 +1716,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btUnsigned64bitIntArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1410,14 +1736,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btObjectType *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1430,14 +1756,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btFloatArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1450,14 +1776,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btStringArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1470,14 +1796,14 @@ public:
    //=============================================================================
    ENamedValues Get(Kt Name, btObjectArray *pValue) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      return (*itr).second.Get(pValue);
+      return pVal->Get(pValue);
    }
 
    //=============================================================================
@@ -1490,13 +1816,11 @@ public:
    //=============================================================================
    ENamedValues Delete(Kt Name)
    {
-      //Find the named value pair
-      if ( m_NVSet.end() == m_NVSet.find(Name) ) {
+      //Find and remove the named value pair
+      if ( !m_NVSet.Erase(Name) ) {
          return ENamedValuesNameNotFound;
       }
 
-      //Remove the entry from the set
-      m_NVSet.erase(Name);
       return ENamedValuesOK;
    }
 
@@ -1506,25 +1830,11 @@ public:
    // Interface: public
    // Inputs: none.
    // Outputs: none.
-   // Comments: Iterate through list and free all named value sets.
+   // Comments: Frees all of the values, including any embedded NVS's.
    //=============================================================================
    ENamedValues Empty()
    {
-      btUnsignedInt NumNames;
-      Kt            CurrName;
-
-      GetNumNames(&NumNames);
-
-      while ( NumNames-- ) {
-         GetName(NumNames, &CurrName);
-         //Remove it
-         ENamedValues result;
-         result = Delete(CurrName);
-         if ( result != ENamedValuesOK ) {
-            return result;
-         }
-      }
-
+      m_NVSet.Clear();
       return ENamedValuesOK;
    }
 
@@ -1538,14 +1848,14 @@ public:
    //=============================================================================
    ENamedValues     GetSize(Kt Name, btWSSize    *pSize) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
-      *pSize = (*itr).second.Size();
+      *pSize = pVal->Size();
 
       return ENamedValuesOK;
    }
@@ -1560,15 +1870,15 @@ public:
    //=============================================================================
    ENamedValues        Type(Kt Name, eBasicTypes *pType) const
    {
-      const_iterator itr = m_NVSet.find(Name);
+      const CValue *pVal = m_NVSet.Find(Name);
 
       //Find the named value pair
-      if ( m_NVSet.end() == itr ) {
+      if ( NULL == pVal ) {
          return ENamedValuesNameNotFound;
       }
 
       //Return the Type
-      *pType = (*itr).second.Type();
+      *pType = pVal->Type();
       return ENamedValuesOK;
    }
 
@@ -1586,7 +1896,7 @@ public:
 #endif // _MSC_VER
    ENamedValues GetNumNames(btUnsignedInt *pNum) const
    {
-      *pNum = static_cast<btUnsignedInt>(m_NVSet.size());  // size_t truncation to int possible
+      *pNum = static_cast<btUnsignedInt>(m_NVSet.Size());  // size_t truncation to int possible
       return ENamedValuesOK;
    }
 #if defined( _MSC_VER )
@@ -1603,45 +1913,11 @@ public:
    //=============================================================================
    ENamedValues     GetName(btUnsignedInt index, Kt *pName) const
    {
-      const_iterator itr;
-
-      //Find the named value pair
-      if ( m_NVSet.size() < (typename map_type::size_type) index ) {
-         return ENamedValuesNameNotFound;
-      }
-
-      //Get the right entry
-      for ( itr = m_NVSet.begin() ; index != 0 ; index--, itr++ ) {/*empty*/ ; }
-
-      //Return the name
-      *pName = (Kt)(*itr).first;
-
-      return ENamedValuesOK;
-   }
-
-   //=============================================================
-   // Specialized template function for std:string keys
-   // The default GetName implementation will not work for
-   // btcString keys. btcString keys are stored as std:strings in
-   // the map structure. So the normal return won't work.
-   // This specialized template function handles this one
-   // exception case.
-   //=============================================================
-   ENamedValues GetName(btUnsignedInt index, btStringKey *pName) const
-   {
-      std::map<std::string, CValue>::const_iterator itr = m_NVSet.end();
-
-      // Find the named value pair
-      if ( m_NVSet.size() < (std::map<std::string, CValue>::size_type) index ) {
+      //Find the named value pair, and return the name
+      if ( !m_NVSet.NameAt(index, pName) ) {
          return ENamedValuesNameNotFound;
       }
 
-      // Get the right entry
-      for ( itr = m_NVSet.begin() ; index != 0 ; index--, itr++ ) {/*empty*/ ; }
-
-      // Return the name
-      *pName = const_cast<btStringKey>((*itr).first.c_str());
-
       return ENamedValuesOK;
    }
 
@@ -1656,7 +1932,7 @@ public:
    btBool Has(Kt Name) const
    {
       //Find the named value pair
-      return m_NVSet.find(Name) != m_NVSet.end();
+      return NULL != m_NVSet.Find(Name);
    }
 
 }; // End of template<class Kt>  class TNamedValueSet : public CriticalSection
@@ -1666,7 +1942,7 @@ public:
 //   This template is used to construct a NVS class specific to a particular
 //   key data type. It is used in the CNamevValueSet  container class to hold
 //   an NVS instance that is specific to a particular key type.
-//   Namely std::string and and btUnsignedInt.  We could have defined a class
+//   Namely btStringKey and btNumberKey.  We could have defined a class
 //   for each type but this allows us to easily create new NVS for any key
 //   type.
 //=============================================================================
@@ -1675,157 +1951,14 @@ public:
 template<typename Kt>
 TNamedValueSet<Kt> & TNamedValueSet<Kt>::operator = (const TNamedValueSet<Kt> &rOther)
 {
-   btUnsignedInt NumNames;
-   Kt CurrName;
-   eBasicTypes Type;
-
    //Ignore assigning self to self
    if ( &rOther == this ) {
       return *this;
    }
 
-   //Make sure the target is empty
-   Empty();
-
-   //Get the number of entries in source
-   rOther.GetNumNames(&NumNames);
-
-   //Copy one at a time
-   for(btUnsignedInt count=0; count < NumNames; count++) {
-      rOther.GetName(count,&CurrName);
-      rOther.Type(CurrName,&Type);
+   //Copies every value, including any embedded NVS's
+   m_NVSet = rOther.m_NVSet;
 
-      switch(Type) {
-         case btBool_t: {
-            btBool val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btByte_t: {
-            btByte val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case bt32bitInt_t: {
-            bt32bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btUnsigned32bitInt_t: {
-            btUnsigned32bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case bt64bitInt_t: {
-            bt64bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btUnsigned64bitInt_t: {
-            btUnsigned64bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btFloat_t: {
-            btFloat val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btString_t: {
-            btcString val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btNamedValueSet_t: {
-            INamedValueSet const *pval = NULL;
-            rOther.Get(CurrName, &pval);
-            Add(CurrName, pval);
-         }
-         break;
-         case btByteArray_t: {
-            btByte  *val;
-            btWSSize Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case bt32bitIntArray_t: {
-            bt32bitInt *val;
-            btWSSize    Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btUnsigned32bitIntArray_t: {
-            btUnsigned32bitInt *val;
-            btWSSize            Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case bt64bitIntArray_t: {
-            bt64bitInt *val;
-            btWSSize    Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btUnsigned64bitIntArray_t: {
-            btUnsigned64bitInt *val;
-            btWSSize            Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btObjectType_t: {
-            btObjectType val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btFloatArray_t: {
-            btFloat *val;
-            btWSSize Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btStringArray_t: {
-            btString *val;
-            btWSSize  Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btObjectArray_t: {
-            btObjectType *val;
-            btWSSize      Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         default: {
-            break;
-         }
-
-      };
-   }
    return( *this );
 }  // end of operator = (assignment)
 
@@ -2212,7 +2345,7 @@ btBool TNamedValueSet<Kt>::Subset(const TNamedValueSet<Kt> &rOther,
 //=============================================================================
 //   The CNamedValuesSet class is a container class for the specific NVS
 //   instances.  It holds member for each NVS type it supports. Currently
-//   std:string keys and btUnsignedInt keys.  This object is the actual storage
+//   btStringKey keys and btNumberKey keys.  This object is the actual storage
 //   for the NVS used by the application. The application only "sees" the proxy
 //   object called NamedValueSet which simply calls through to this one.
 //=============================================================================
@@ -2231,7 +2364,7 @@ class CNamedValueSet : public INamedValueSet,
 
 private:
    TNamedValueSet<btNumberKey> m_iNVS;
-   TNamedValueSet<std::string> m_sNVS;  // Note that the interface is btStringKey, which is const char*
+   TNamedValueSet<btStringKey> m_sNVS;  // Holds its own copy of each btStringKey
 
 public:
    // CNamedValueSet Default Constructor.
@@ -3115,6 +3248,8 @@ ENamedValues CNamedValueSet::FromStr(const std::string &s)
 //              Note that the string itself may contain embedded nulls; they
 //              do not terminate the string. That is, the char* is not a normal
 //              NULL-terminated string
+//              A buffer that begins with a binary NVS header is decoded as
+//              binary instead; see AALNVSBinary.h.
 // Outputs:     nvs is a non-const reference to the returned NamedValueSet
 //=============================================================================
 ENamedValues CNamedValueSet::FromStr(void *pv, btWSSize len)
@@ -3124,6 +3259,11 @@ ENamedValues CNamedValueSet::FromStr(void *pv, btWSSize len)
       return ENamedValuesInvalidReadToNull;
    }
 
+   if ( IsNVSBinary(pv, len) ) {
+      AutoLock(this);
+      return NVSFromBinary(*this, pv, len);
+   }
+
    std::string s(static_cast<char *>(pv), (size_t)len);   // initializing this way allows embedded nulls
    return FromStr(s);
 }
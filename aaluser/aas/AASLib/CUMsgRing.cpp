@@ -0,0 +1,276 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file CUMsgRing.cpp
+/// @brief Lock-free UMsg doorbell producer layered on IALIUMsg.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/utils/UMsgRing.h"  // This class' definition
+#include "aalsdk/osal/CriticalSection.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+# include <emmintrin.h>
+# define UMSG_RING_STREAM64 1
+#elif defined( __SSE2__ ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+# include <emmintrin.h>
+# define UMSG_RING_STREAM32 1
+#endif // x86
+
+#if defined( _MSC_VER )
+# include <intrin.h>
+#endif // _MSC_VER
+
+
+BEGIN_NAMESPACE(AAL)
+
+
+// Atomic read-modify-writes of the doorbell words. Each returns the previous value.
+static inline btUnsigned32bitInt UMsgRingOr(volatile btUnsigned32bitInt *p, btUnsigned32bitInt v)
+{
+#if defined( _MSC_VER )
+   return (btUnsigned32bitInt)_InterlockedOr(reinterpret_cast<volatile long *>(p), (long)v);
+#else
+   return __sync_fetch_and_or(p, v);
+#endif // _MSC_VER
+}
+
+static inline btUnsigned32bitInt UMsgRingExchange(volatile btUnsigned32bitInt *p, btUnsigned32bitInt v)
+{
+#if defined( _MSC_VER )
+   return (btUnsigned32bitInt)_InterlockedExchange(reinterpret_cast<volatile long *>(p), (long)v);
+#else
+   btUnsigned32bitInt old;
+   do {
+      old = *p;
+   } while ( !__sync_bool_compare_and_swap(p, old, v) );
+   return old;
+#endif // _MSC_VER
+}
+
+static inline btUnsigned32bitInt UMsgRingIncrement(volatile btUnsigned32bitInt *p)
+{
+#if defined( _MSC_VER )
+   return (btUnsigned32bitInt)_InterlockedIncrement(reinterpret_cast<volatile long *>(p)) - 1;
+#else
+   return __sync_fetch_and_add(p, 1);
+#endif // _MSC_VER
+}
+
+static inline void UMsgRingIncrement(volatile btUnsigned64bitInt *p)
+{
+#if defined( _MSC_VER )
+   _InterlockedIncrement64(reinterpret_cast<volatile __int64 *>(p));
+#else
+   __sync_fetch_and_add(p, 1);
+#endif // _MSC_VER
+}
+
+
+// Each thread remembers its doorbell in the last few rings it used, by ring id.
+//    Ring ids are never reused, so an entry can not be mistaken for one of a newer ring.
+#define UMSG_RING_THREAD_CACHE 4
+
+struct UMsgRingThreadCache
+{
+   btUnsigned64bitInt m_Ring;
+   btUnsignedInt      m_Doorbell;
+};
+
+static __AAL_THREAD_LOCAL UMsgRingThreadCache gUMsgRingCache[UMSG_RING_THREAD_CACHE] = { { 0, 0 }, };
+
+static CriticalSection    gUMsgRingIdLock;
+static btUnsigned64bitInt gUMsgRingNextId = 1;
+
+
+UMsgRing::UMsgRing() :
+   m_pUMsg(NULL),
+   m_Direct(false),
+   m_Doorbells(0),
+   m_Id(0),
+   m_NextDoorbell(0),
+   m_pDoorbells(NULL),
+   m_pStorage(NULL)
+{}
+
+UMsgRing::~UMsgRing()
+{
+   if ( NULL != m_pStorage ) {
+      delete[] m_pStorage;
+   }
+}
+
+btBool UMsgRing::Init(IALIUMsg *pUMsg, btUnsignedInt Doorbells)
+{
+   if ( ( NULL == pUMsg ) || IsOK() ) {
+      return false;
+   }
+
+   btUnsignedInt n = pUMsg->umsgGetNumber();
+   if ( ( 0 != Doorbells ) && ( Doorbells < n ) ) {
+      n = Doorbells;
+   }
+   if ( n > MaxDoorbells ) {
+      n = MaxDoorbells;
+   }
+   if ( 0 == n ) {
+      return false;
+   }
+
+   m_pStorage = new(std::nothrow) btByte[n * sizeof(Doorbell) + 63];
+   if ( NULL == m_pStorage ) {
+      return false;
+   }
+   m_pDoorbells = reinterpret_cast<Doorbell *>((reinterpret_cast<btUIntPtr>(m_pStorage) + 63) & ~(btUIntPtr)63);
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < n ; ++i ) {
+      Doorbell &d = m_pDoorbells[i];
+      d.m_pLine    = pUMsg->umsgGetAddress(i);
+      d.m_Pending  = 0;
+      d.m_Sequence = 0;
+      d.m_Posts    = 0;
+      d.m_Rings    = 0;
+      if ( NULL == d.m_pLine ) {
+         delete[] m_pStorage;
+         m_pStorage   = NULL;
+         m_pDoorbells = NULL;
+         return false;
+      }
+   }
+
+   {
+      AutoLock(&gUMsgRingIdLock);
+      m_Id = gUMsgRingNextId++;
+   }
+
+   m_pUMsg     = pUMsg;
+   m_Direct    = pUMsg->umsgIsDirect();
+   m_Doorbells = n;
+   return true;
+}
+
+btUnsignedInt UMsgRing::ThreadDoorbell()
+{
+   UMsgRingThreadCache &c = gUMsgRingCache[m_Id % UMSG_RING_THREAD_CACHE];
+   if ( c.m_Ring != m_Id ) {
+      c.m_Ring     = m_Id;
+      c.m_Doorbell = ( 0 == m_Doorbells ) ? 0 : UMsgRingIncrement(&m_NextDoorbell) % m_Doorbells;
+   }
+   return c.m_Doorbell;
+}
+
+void UMsgRing::Post(btUnsignedInt Doorbell, btUnsigned32bitInt Bits)
+{
+   ASSERT(Doorbell < m_Doorbells);
+   UMsgRing::Doorbell &d = m_pDoorbells[Doorbell];
+   UMsgRingOr(&d.m_Pending, Bits);
+   UMsgRingIncrement(&d.m_Posts);
+}
+
+btBool UMsgRing::Flush(btUnsignedInt Doorbell)
+{
+   ASSERT(Doorbell < m_Doorbells);
+   UMsgRing::Doorbell &d = m_pDoorbells[Doorbell];
+
+   // Bits posted after the exchange are left for the next Flush(). A Flush() that finds
+   //    nothing pending returns false, even if a concurrent Flush() has yet to write the
+   //    bits that it took.
+   btUnsigned32bitInt Bits = UMsgRingExchange(&d.m_Pending, 0);
+   if ( 0 == Bits ) {
+      return false;
+   }
+
+   btUnsigned32bitInt Sequence = UMsgRingIncrement(&d.m_Sequence) + 1;
+   Write(d, LineValue(Sequence, Bits));
+   UMsgRingIncrement(&d.m_Rings);
+   return true;
+}
+
+void UMsgRing::Write(Doorbell &d, btUnsigned64bitInt Value)
+{
+   if ( !m_Direct ) {
+      m_pUMsg->umsgTrigger64(d.m_pLine, Value);
+      return;
+   }
+
+   btUnsignedInt i;
+#if   defined( UMSG_RING_STREAM64 )
+   long long *p = reinterpret_cast<long long *>(d.m_pLine);
+   _mm_stream_si64(p, (long long)Value);
+   for ( i = 1 ; i < LineQWords ; ++i ) {
+      _mm_stream_si64(p + i, 0);
+   }
+   _mm_sfence();
+#elif defined( UMSG_RING_STREAM32 )
+   int *p = reinterpret_cast<int *>(d.m_pLine);
+   _mm_stream_si32(p,     (int)Value);
+   _mm_stream_si32(p + 1, (int)(Value >> 32));
+   for ( i = 2 ; i < 2 * LineQWords ; ++i ) {
+      _mm_stream_si32(p + i, 0);
+   }
+   _mm_sfence();
+#else
+   volatile btUnsigned64bitInt *p = reinterpret_cast<volatile btUnsigned64bitInt *>(d.m_pLine);
+   p[0] = Value;
+   for ( i = 1 ; i < LineQWords ; ++i ) {
+      p[i] = 0;
+   }
+   __sync_synchronize();
+#endif // UMSG_RING_STREAM64
+}
+
+btUnsigned64bitInt UMsgRing::Posts(btUnsignedInt Doorbell) const
+{
+   return ( Doorbell < m_Doorbells ) ? m_pDoorbells[Doorbell].m_Posts : 0;
+}
+
+btUnsigned64bitInt UMsgRing::Rings(btUnsignedInt Doorbell) const
+{
+   return ( Doorbell < m_Doorbells ) ? m_pDoorbells[Doorbell].m_Rings : 0;
+}
+
+void UMsgRing::ResetCounters()
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_Doorbells ; ++i ) {
+      m_pDoorbells[i].m_Posts = 0;
+      m_pDoorbells[i].m_Rings = 0;
+   }
+}
+
+
+END_NAMESPACE(AAL)
+
@@ -50,6 +50,20 @@
 
 BEGIN_NAMESPACE(AAL)
 
+// Dispatchables for one client are delivered in order. Clients are told apart by
+//  object, so that the IServiceClient and IRuntimeClient of one object are one client.
+template <typename I>
+static btObjectType Client(I *p)
+{
+   return ( NULL == p ) ? NULL : dynamic_cast<void *>(p);
+}
+
+template <typename I, typename J>
+static btObjectType Client(I *p, J *q)
+{
+   return ( NULL != p ) ? Client(p) : Client(q);
+}
+
 
 ServiceAllocated::ServiceAllocated(IServiceClient      *pSvcClient,
                                    IRuntimeClient      *pRTClient,
@@ -98,6 +112,11 @@ void ServiceAllocated::operator() ()
    delete this;
 }
 
+btObjectType ServiceAllocated::DeliveryTarget() const
+{
+   return Client(m_pSvcClient, m_pRTClient);
+}
+
 
 ServiceAllocateFailed::ServiceAllocateFailed(IServiceClient *pSvcClient,
                                              IRuntimeClient *pRTClient,
@@ -130,6 +149,11 @@ void ServiceAllocateFailed::operator() ()
    delete this;
 }
 
+btObjectType ServiceAllocateFailed::DeliveryTarget() const
+{
+   return Client(m_pSvcClient, m_pRTClient);
+}
+
 
 DestroyServiceObject::DestroyServiceObject(ISvcsFact *pSvcsFact,
                                            IBase     *pService) :
@@ -189,6 +213,11 @@ void ServiceReleased::operator() ()
    delete this;
 }
 
+btObjectType ServiceReleased::DeliveryTarget() const
+{
+   return Client(m_pSvcClient);
+}
+
 ServiceReleaseFailed::ServiceReleaseFailed(IServiceClient *pSvcClient,
                                            const IEvent   *pEvent) :
    m_pSvcClient(pSvcClient),
@@ -214,6 +243,11 @@ void ServiceReleaseFailed::operator() ()
    delete this;
 }
 
+btObjectType ServiceReleaseFailed::DeliveryTarget() const
+{
+   return Client(m_pSvcClient);
+}
+
 ServiceEvent::ServiceEvent(IServiceClient *pSvcClient,
                            const IEvent   *pEvent) :
    m_pSvcClient(pSvcClient),
@@ -239,6 +273,11 @@ void ServiceEvent::operator() ()
    delete this;
 }
 
+btObjectType ServiceEvent::DeliveryTarget() const
+{
+   return Client(m_pSvcClient);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 RuntimeCreateOrGetProxyFailed::RuntimeCreateOrGetProxyFailed(IRuntimeClient *pRTClient,
@@ -263,6 +302,11 @@ void RuntimeCreateOrGetProxyFailed::operator() ()
    delete this;
 }
 
+btObjectType RuntimeCreateOrGetProxyFailed::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeStarted::RuntimeStarted(IRuntimeClient      *pRTClient,
                                IRuntime            *pRT,
                                const NamedValueSet &rConfigParms) :
@@ -280,6 +324,11 @@ void RuntimeStarted::operator() ()
    delete this;
 }
 
+btObjectType RuntimeStarted::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeStartFailed::RuntimeStartFailed(IRuntimeClient *pRTClient,
                                        const IEvent   *pEvent) :
    m_pRTClient(pRTClient),
@@ -302,6 +351,11 @@ void RuntimeStartFailed::operator() ()
    delete this;
 }
 
+btObjectType RuntimeStartFailed::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeStopped::RuntimeStopped(IRuntimeClient *pRTClient,
                                IRuntime       *pRT) :
    m_pRTClient(pRTClient),
@@ -317,6 +371,11 @@ void RuntimeStopped::operator() ()
    delete this;
 }
 
+btObjectType RuntimeStopped::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeStopFailed::RuntimeStopFailed(IRuntimeClient *pRTClient,
                                      const IEvent   *pEvent) :
    m_pRTClient(pRTClient),
@@ -339,6 +398,11 @@ void RuntimeStopFailed::operator() ()
    delete this;
 }
 
+btObjectType RuntimeStopFailed::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeAllocateServiceSucceeded::RuntimeAllocateServiceSucceeded(IRuntimeClient      *pRTClient,
                                                                  IBase               *pServiceBase,
                                                                  TransactionID const &rTranID) :
@@ -356,6 +420,11 @@ void RuntimeAllocateServiceSucceeded::operator() ()
    delete this;
 }
 
+btObjectType RuntimeAllocateServiceSucceeded::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeAllocateServiceFailed::RuntimeAllocateServiceFailed(IRuntimeClient *pRTClient,
                                                            const IEvent   *pEvent) :
    m_pRTClient(pRTClient),
@@ -378,6 +447,11 @@ void RuntimeAllocateServiceFailed::operator() ()
    delete this;
 }
 
+btObjectType RuntimeAllocateServiceFailed::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 RuntimeEvent::RuntimeEvent(IRuntimeClient *pRTClient,
                            const IEvent   *pEvent) :
    m_pRTClient(pRTClient),
@@ -424,6 +498,11 @@ void RuntimeEvent::operator() ()
    delete this;
 }
 
+btObjectType RuntimeEvent::DeliveryTarget() const
+{
+   return Client(m_pRTClient);
+}
+
 ServiceRevoke::ServiceRevoke(IServiceRevoke *pRevoke)
 : m_pRevoke(pRevoke)
 {
@@ -436,6 +515,11 @@ void ServiceRevoke::operator ()()
    delete this;
 }
 
+btObjectType ServiceRevoke::DeliveryTarget() const
+{
+   return Client(m_pRevoke);
+}
+
 ReleaseServiceRequest::ReleaseServiceRequest(IBase *pServiceBase, const IEvent   *pEvent)
 : m_pSvcBase(pServiceBase),
   m_pEvent(pEvent)
@@ -457,6 +541,11 @@ void ReleaseServiceRequest::operator ()()
 
 }
 
+btObjectType ReleaseServiceRequest::DeliveryTarget() const
+{
+   return Client(m_pSvcBase);
+}
+
 ReleaseServiceRequest::~ReleaseServiceRequest()
 {
    if( NULL != m_pEvent){
@@ -93,6 +93,7 @@
 #include "aalsdk/kernel/KernelStructs.h"   // various operator<<
 #include "aalsdk/utils/ResMgrUtilities.h"  // string, name, and GUID inter-conversion operators
 #include "aalsdk/rm/ResMgrService.h"
+#include "aalsdk/AALNVSBinary.h"           // Goal Record payload
 
 BEGIN_NAMESPACE(AAL)
 
@@ -404,8 +405,9 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
    pIoctlReq->id = rspid_URMS_RequestDevice;
    if (pIoctlReq->size) {   // There is a payload, so retrieve the NVS and take appropriate action
 
-      // Get the Manifest from the IoctlReq
+      // Get the Manifest from the IoctlReq. The reply is in the same form, text or binary.
       NamedValueSet nvsManifest(pIoctlReq->payload, pIoctlReq->size);
+      const btBool  binary = IsNVSBinary(pIoctlReq->payload, pIoctlReq->size);
 
       // Compute the Goal Records, manifest in, list of goal records out
       nvsList listGoalRecords;
@@ -436,11 +438,19 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
             // Clean out the old payload, note that size > 0 or we would not be here
             delete[] pIoctlReq->payload;  // matches allocator in Get_AALRMS_Msg
 
-            // Write in the new payload, which is just a serialized copy of nvsGoal
-            std::string s(nvsGoal);
-            pIoctlReq->size = s.length();
-            pIoctlReq->payload = reinterpret_cast<btVirtAddr>(new btByte[pIoctlReq->size]);
-            BufFromString( pIoctlReq->payload, s);
+            // Write in the new payload, which is just a serialized copy of nvsGoal, in the
+            //    binary form of AALNVSBinary.h if the client sent that
+            btWSSize len = binary ? NVSBinarySize(nvsGoal) : 0;
+            if ( 0 != len ) {
+               pIoctlReq->size = len;
+               pIoctlReq->payload = reinterpret_cast<btVirtAddr>(new btByte[pIoctlReq->size]);
+               NVSToBinary(nvsGoal, pIoctlReq->payload, len, &len);
+            } else {
+               std::string s(nvsGoal);
+               pIoctlReq->size = s.length();
+               pIoctlReq->payload = reinterpret_cast<btVirtAddr>(new btByte[pIoctlReq->size]);
+               BufFromString( pIoctlReq->payload, s);
+            }
          }
          else {
             // Error, no handle found, just return original payload with failure indication
@@ -449,7 +459,7 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
 
          // Show the returned Goal Record
          AAL_DEBUG(LM_ResMgr,"CResMgr::DoRequestDevice: Goal Record being returned:" <<
-               "\nAs a string:\n" << reinterpret_cast<btByte *>(pIoctlReq->payload) );
+               "\n" << NamedValueSet(pIoctlReq->payload, pIoctlReq->size) );
       }
       else {
          // Expecting that ComputeGoalRecords and/or GetPolicyResults will already have issued error messages
@@ -93,6 +93,11 @@ void operator() ()
    delete this;
 }
 
+virtual btObjectType DeliveryTarget() const
+{
+   return dynamic_cast<void *>(m_pClient);
+}
+
 virtual ~AFUProxyCallback() {}
 
 protected:
@@ -100,6 +105,47 @@ protected:
    AAL::IEvent const       *m_pEvent;
 };
 
+//=============================================================================
+// Name: AFUProxyCallbackBatch
+// Description: Runs a sequence of AFUProxyCallbacks for one client, in order,
+//              as a single dispatchable, so that a batch of driver messages
+//              costs one trip through the message delivery queue per client.
+//=============================================================================
+class AFUProxyCallbackBatch : public IDispatchable
+{
+public:
+   AFUProxyCallbackBatch(IAFUProxyClient *pClient) :
+      m_pClient(pClient)
+   {}
+
+   // pCallback must be for Client().
+   void Add(AFUProxyCallback *pCallback) { m_Callbacks.push_back(pCallback); }
+   btUnsignedInt Size() const            { return (btUnsignedInt)m_Callbacks.size(); }
+   IAFUProxyClient * Client() const      { return m_pClient; }
+
+void operator() ()
+{
+   // Each callback deletes itself.
+   std::vector<AFUProxyCallback *>::iterator iter;
+   for ( iter = m_Callbacks.begin() ; iter != m_Callbacks.end() ; ++iter ) {
+      (**iter)();
+   }
+   delete this;
+}
+
+// Same target as each of the callbacks, so that the client's messages stay in order.
+virtual btObjectType DeliveryTarget() const
+{
+   return dynamic_cast<void *>(m_pClient);
+}
+
+virtual ~AFUProxyCallbackBatch() {}
+
+protected:
+   IAFUProxyClient                *m_pClient;
+   std::vector<AFUProxyCallback *> m_Callbacks;
+};
+
 
 //=============================================================================
 // Name: AIAService
@@ -170,7 +170,8 @@ btBool AIAService::init( IBase *pclientBase,
       // Create the Message delivery thread
       m_pMDT = new OSLThread(AIAService::MessageDeliveryThread,
                              OSLThread::THREADPRIORITY_NORMAL,
-                             this);
+                             this,
+                             ThreadPlacement::SDKDefault());
 
       // Make sure that the kernel pipe to the database is open.
       //  The Wait is posted in the AIAService:MessageDeliveryThread
@@ -426,36 +427,77 @@ void AIAService::MessageDeliveryThread(OSLThread *pThread,
 void
 AIAService::Process_Event()
 {
+   std::vector<uidrvMessage *>                    Messages;
+   std::vector<uidrvMessage *>::iterator          iter;
+   std::vector<AFUProxyCallbackBatch *>           Batches;
+   std::vector<AFUProxyCallbackBatch *>::iterator biter;
 
-   uidrvMessage *pMessage = new uidrvMessage;
    AAL_INFO(LM_UAIA, "AIAService::Process_Event. in\n");
 
-   while(m_uida.GetMessage(pMessage) != false) {
-      AAL_DEBUG(LM_UAIA, "AIAService::Process_Event: GetMessage Returned\n");
-      if (pMessage->result_code() != uid_errnumOK) {
-         AAL_WARNING(LM_UAIA, "AIAService::Process_Event: pMessage->result_code() is not uid_errnumOK, but is " <<
-                  pMessage->result_code() << std::endl);
-      }
-
-      if (rspid_UID_Shutdown == pMessage->id()) { // Are we done?
-         AAL_INFO(LM_UAIA, "AIAService::Process_Event: Shutdown Seen\n");
-         delete pMessage;
-         return;
-      }else {
+   while ( m_uida.GetMessages(Messages) != false ) {
+      AAL_DEBUG(LM_UAIA, "AIAService::Process_Event: GetMessages Returned " << Messages.size() << std::endl);
+
+      // The session's queue carries messages for every proxy client. The callbacks
+      //  for each client go to the delivery queue as one dispatchable, in the
+      //  order the messages were read, so that per-client order is kept.
+      btBool bShutdown = false;
+
+      for ( iter = Messages.begin() ; iter != Messages.end() ; ++iter ) {
+         uidrvMessage *pMessage = *iter;
+
+         if ( bShutdown ) {
+            delete pMessage;
+            continue;
+         }
+
+         if (pMessage->result_code() != uid_errnumOK) {
+            AAL_WARNING(LM_UAIA, "AIAService::Process_Event: pMessage->result_code() is not uid_errnumOK, but is " <<
+                     pMessage->result_code() << std::endl);
+         }
+
+         if (rspid_UID_Shutdown == pMessage->id()) { // Are we done?
+            AAL_INFO(LM_UAIA, "AIAService::Process_Event: Shutdown Seen\n");
+            delete pMessage;
+            bShutdown = true;
+            continue;
+         }
+
+         IAFUProxyClient       *pClient = static_cast<IAFUProxyClient *>(pMessage->context());
+         AFUProxyCallbackBatch *pBatch  = NULL;
+
+         // Few clients share a session, so a linear search will do.
+         for ( biter = Batches.begin() ; biter != Batches.end() ; ++biter ) {
+            if ( (*biter)->Client() == pClient ) {
+               pBatch = *biter;
+               break;
+            }
+         }
+         if ( NULL == pBatch ) {
+            pBatch = new AFUProxyCallbackBatch(pClient);
+            Batches.push_back(pBatch);
+         }
 
          // Generate the event - No need to destroy message as it being passed to event and will be
          // destroyed there.  TODO - Object should be Proxy not the AIA
-         AFUProxyCallback *pDisp = new AFUProxyCallback(static_cast<IAFUProxyClient *>(pMessage->context()),
-                                                        new UIDriverEvent(this,pMessage));
-         getRuntime()->schedDispatchable(pDisp);
+         pBatch->Add(new AFUProxyCallback(pClient,
+                                          new UIDriverEvent(this,pMessage)));
+      }
+      Messages.clear();
 
-         pMessage = new uidrvMessage;
+      for ( biter = Batches.begin() ; biter != Batches.end() ; ++biter ) {
+         getRuntime()->schedDispatchable(*biter);
+      }
+      Batches.clear();
 
+      if ( bShutdown ) {
+         return;
       }
    } // while()
 
    // catastrophic failure.  try to clean up after ourself.
-   delete pMessage;
+   for ( iter = Messages.begin() ; iter != Messages.end() ; ++iter ) {
+      delete *iter;
+   }
 
 } // AIAService::Process_Event
 
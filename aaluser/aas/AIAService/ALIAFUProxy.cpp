@@ -62,7 +62,42 @@ BEGIN_NAMESPACE(AAL)
 //=============================================================================
 
 // Destructor
-ALIAFUProxy::~ALIAFUProxy() {}
+ALIAFUProxy::~ALIAFUProxy()
+{
+   if ( NULL != m_pSendThreads ) {
+      delete m_pSendThreads;
+   }
+}
+
+//=============================================================================
+// Name: AsyncTransaction
+// Description: Work item that sends one transaction on a proxy worker thread
+//              and then notifies the submitter.
+// Comments: Deletes itself once the callback returns.
+//=============================================================================
+class ALIAFUProxy::AsyncTransaction : public IDispatchable
+{
+public:
+   AsyncTransaction(ALIAFUProxy             *pProxy,
+                    IAIATransaction         *pAFUmessage,
+                    IAIATransactionCallback *pCallback) :
+      m_pProxy(pProxy),
+      m_pAFUmessage(pAFUmessage),
+      m_pCallback(pCallback)
+   {}
+
+   void operator() ()
+   {
+      m_pProxy->SendTransaction(m_pAFUmessage);
+      m_pCallback->AIATransactionComplete(m_pAFUmessage);
+      delete this;
+   }
+
+protected:
+   ALIAFUProxy             *m_pProxy;
+   IAIATransaction         *m_pAFUmessage;
+   IAIATransactionCallback *m_pCallback;
+};
 
 //=============================================================================
 // Name: init
@@ -141,6 +176,55 @@ btBool ALIAFUProxy::SendTransaction(IAIATransaction *pAFUmessage)
    return true;  /// SendMessage is a void TDO cleanup
 }
 
+//=============================================================================
+// Name: SendTransactionAsync
+// Description: Queue a message to the device
+// Inputs: pAFUmessage - Transaction object, valid until pCallback is called
+//         pCallback - Notified on a worker thread once the message is sent
+// Outputs: true - queued
+// Comments: The driver call itself is synchronous, so transactions are kept
+//           in flight by a small pool of worker threads private to this
+//           proxy. The calling thread holds no lock while they complete.
+//=============================================================================
+btBool ALIAFUProxy::SendTransactionAsync(IAIATransaction         *pAFUmessage,
+                                         IAIATransactionCallback *pCallback)
+{
+   if ( ( NULL == pAFUmessage ) || ( NULL == pCallback ) ) {
+      return false;
+   }
+
+   {
+      AutoLock(this);
+      if ( NULL == m_pSendThreads ) {
+         m_pSendThreads = new(std::nothrow) OSLThreadGroup(MaxAsyncTransactions,
+                                                           MaxAsyncTransactions,
+                                                           OSLThread::THREADPRIORITY_NORMAL,
+                                                           AAL_INFINITE_WAIT,
+                                                           OSLThreadGroup::SharedQueue,
+                                                           ThreadPlacement::SDKDefault());
+         if ( ( NULL == m_pSendThreads ) || !m_pSendThreads->IsOK() ) {
+            AAL_ERR(LM_UAIA, "ALIAFUProxy::SendTransactionAsync failed to create worker threads" << std::endl);
+            if ( NULL != m_pSendThreads ) {
+               delete m_pSendThreads;
+               m_pSendThreads = NULL;
+            }
+            return false;
+         }
+      }
+   }
+
+   AsyncTransaction *pWork = new(std::nothrow) AsyncTransaction(this, pAFUmessage, pCallback);
+   if ( NULL == pWork ) {
+      return false;
+   }
+
+   if ( !m_pSendThreads->Add(pWork) ) {
+      delete pWork;
+      return false;
+   }
+   return true;
+}
+
 
 
 AAL::btBool ALIAFUProxy::MapWSID(AAL::btWSSize Size, AAL::btWSID wsid, AAL::btVirtAddr *pRet, AAL::NamedValueSet const &optArgs)
@@ -211,6 +295,11 @@ void ALIAFUProxy::AFUEvent( AAL::IEvent const &theEvent)
 //=============================================================================
 btBool ALIAFUProxy::Release(AAL::TransactionID const &rtid, AAL::btTime timeout)
 {
+   // Complete any transactions still in flight before the device is unbound.
+   if ( NULL != m_pSendThreads ) {
+      m_pSendThreads->Drain();
+   }
+
    UnBindAFUDevice ReleaseMessage(rtid);
    m_pAIA->SendMessage(m_devHandle, &ReleaseMessage, dynamic_cast<IAFUProxyClient*>(this) );
    return true;
@@ -41,6 +41,7 @@
 #include <aalsdk/aas/AALService.h>
 #include <aalsdk/INTCDefs.h>
 #include <aalsdk/uaia/IAFUProxy.h>
+#include <aalsdk/osal/ThreadGroup.h>
 
 #include "AIA-internal.h"
 
@@ -63,7 +64,8 @@ public:
       m_pClient(NULL),
       m_pAIABase(NULL),
       m_pAIA(NULL),
-      m_devHandle(NULL)
+      m_devHandle(NULL),
+      m_pSendThreads(NULL)
    {
       if ( EObjOK != SetInterface(iidAFUProxy, dynamic_cast<IAFUProxy *>(this)) ) {
          m_bIsOK = false;         // CAASBase set it to true
@@ -83,6 +85,10 @@ public:
    // Send a message to the device
    AAL::btBool SendTransaction( IAIATransaction *pAFUmessage);
 
+   // Queue a message to the device, notifying pCallback once it has been sent
+   AAL::btBool SendTransactionAsync( IAIATransaction         *pAFUmessage,
+                                     IAIATransactionCallback *pCallback);
+
    // Map/Unmap Workspace IDs to virtual memory addresses
    AAL::btBool MapWSID(AAL::btWSSize             Size,
                        AAL::btWSID               wsid,
@@ -94,12 +100,18 @@ public:
 protected:
    void AFUEvent( AAL::IEvent const &theEvent);
 
+   // Number of transactions that may be in flight at once through SendTransactionAsync()
+   enum { MaxAsyncTransactions = 4 };
+
+   class AsyncTransaction;
+
 
    AAL::IServiceClient   *m_pSvcClient;
    IAFUProxyClient       *m_pClient;
    AAL::IBase            *m_pAIABase;
    AIAService            *m_pAIA;
    btHANDLE               m_devHandle;
+   OSLThreadGroup        *m_pSendThreads;    // Created on first SendTransactionAsync()
 };
 
 END_NAMESPACE(AAL)
@@ -140,9 +140,15 @@ UIDriverInterfaceAdapter::UIDriverInterfaceAdapter() :
    m_hClient(INVALID_HANDLE_VALUE),
 #elif defined( __AAL_LINUX__ )
    m_fdClient(-1),
+   m_Batch(),
+   m_bBatchOK(true),
 #endif // OS
-   m_bIsOK(false)
-{}
+   m_bIsOK(false),
+   m_SendsInFlight(0),
+   m_bCloseWaiting(false)
+{
+   m_SendsDone.Create(0, 1);
+}
 
 //==========================================================================
 // Name: ~UIDriverInterfaceAdapter
@@ -326,6 +332,19 @@ void UIDriverInterfaceAdapter::Open(const char *devName)
 // Description: lose the channel to the service
 //==========================================================================
 void UIDriverInterfaceAdapter::Close() {
+   AutoLock(this);
+
+   // Let transactions sent on the handle finish before it goes away. No new
+   //  ones start once m_bIsOK is false.
+   m_bIsOK = false;
+   while ( m_SendsInFlight > 0 ) {
+      m_bCloseWaiting = true;
+      Unlock();
+      m_SendsDone.Wait();
+      Lock();
+   }
+   m_bCloseWaiting = false;
+
 #if   defined( __AAL_WINDOWS__ )
 
    if ( INVALID_HANDLE_VALUE != m_hClient ) {
@@ -509,6 +528,92 @@ FAILED: // If got here then the poll failed
 
 }  // UIDriverInterfaceAdapter::GetMessage
 
+//==========================================================================
+// Name: GetMessages
+// Description: Polls for messages and returns all that are queued once at
+//              least one is available
+// Comment: Uses AALUID_IOCTL_GETMSG_BATCH, so that a burst of events costs
+//          one ioctl rather than two per event. Falls back to GetMessage()
+//          when the driver does not support batches.
+//==========================================================================
+btBool UIDriverInterfaceAdapter::GetMessages(std::vector<uidrvMessage *> &rMessages)
+{
+   if ( !IsOK() ) {
+      return false;
+   }
+
+#if defined( __AAL_LINUX__ )
+
+   btInt         ret = 0;
+   struct pollfd pollfds[1];
+
+   pollfds[0].fd     = m_fdClient;
+   pollfds[0].events = POLLPRI;
+
+   while ( m_bBatchOK ) {
+      btBool bTooLarge = false;
+
+      {
+         AutoLock(this);
+
+         if ( m_Batch.empty() ) {
+            m_Batch.resize(BatchBufferSize / sizeof(btUnsigned64bitInt));
+         }
+
+         struct ccipui_ioctlreq *pBatch = reinterpret_cast<struct ccipui_ioctlreq *>(&m_Batch[0]);
+         memset(pBatch, 0, sizeof(struct ccipui_ioctlreq));
+         pBatch->size = BatchBufferSize - sizeof(struct ccipui_ioctlreq);
+
+         if ( -1 == ioctl(m_fdClient, AALUID_IOCTL_GETMSG_BATCH, pBatch) ) {
+            AAL_INFO(LM_UAIA, "UIDriverInterfaceAdapter::GetMessages: batches not supported by driver\n");
+            m_bBatchOK = false;
+            break;
+         }
+
+         btWSSize offset = 0;
+         while ( offset < pBatch->size ) {
+            struct ccipui_ioctlreq *pRec = reinterpret_cast<struct ccipui_ioctlreq *>(pBatch->payload + offset);
+
+            uidrvMessage *pMessage = new uidrvMessage;
+            pMessage->assign(pRec);
+            rMessages.push_back(pMessage);
+
+            offset += aalui_ioctlBatchRecLen(pRec->size);
+         }
+
+         if ( offset > 0 ) {
+            return true;
+         }
+
+         bTooLarge = ( uid_errnumNoMem == pBatch->errcode );
+      }
+
+      if ( bTooLarge ) {
+         // The message at the head of the queue does not fit in a batch.
+         break;
+      }
+
+      AAL_VERBOSE(LM_UAIA, "UIDriverInterfaceAdapter::GetMessages: About to wait" << std::endl);
+
+      ret = poll(pollfds, 1, -1);
+      if ( ( ret < 0 ) && ( EINTR != errno ) ) {
+         perror("UIDriverInterfaceAdapter::GetMessages:poll");
+         return false;
+      }
+   }
+
+#endif // __AAL_LINUX__
+
+   uidrvMessage *pMessage = new uidrvMessage;
+   if ( !GetMessage(pMessage) ) {
+      delete pMessage;
+      return false;
+   }
+   rMessages.push_back(pMessage);
+   return true;
+
+}  // UIDriverInterfaceAdapter::GetMessages
+
 
 //==========================================================================
 // Name: SendMessage
@@ -520,16 +625,13 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
 {
 
 #if   defined( __AAL_WINDOWS__ )
-   DWORD cmd;
+   DWORD  cmd;
+   HANDLE hClient;
 #elif defined( __AAL_LINUX__ )
-   int cmd;
+   int    cmd;
+   btInt  fdClient;
 #endif
-
-   AutoLock(this);
-
-   if ( !IsOK() ) {
-      return false;
-   }
+   btBool bFailed = false;
 
    // Determine which low-level command should be used to send down the stack
    switch ( pMessage->getMsgID() ) {
@@ -558,6 +660,26 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
          break;
    }
 
+   // The lock guards only the client handle. The ioctl itself runs unlocked so
+   //  that transactions from different threads (and the message delivery
+   //  thread) can be in the driver at the same time. The driver serializes
+   //  its workspace lists per session. Close() waits for the transactions
+   //  counted in m_SendsInFlight, so the handle stays open until they are done.
+   {
+      AutoLock(this);
+
+      if ( !IsOK() ) {
+         return false;
+      }
+
+#if   defined( __AAL_WINDOWS__ )
+      hClient  = m_hClient;
+#elif defined( __AAL_LINUX__ )
+      fdClient = m_fdClient;
+#endif
+      ++m_SendsInFlight;
+   }
+
    // Build the low level message
    struct ccipui_ioctlreq *reqp = reinterpret_cast<struct ccipui_ioctlreq *> (new char[ sizeof(struct ccipui_ioctlreq) + pMessage->getPayloadSize() ]);
 
@@ -579,23 +701,23 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
    memset(&overlappedIO, 0, sizeof(OVERLAPPED));
    hEvent = CreateEvent(NULL, TRUE, FALSE,NULL);
    overlappedIO.hEvent = hEvent;
-   if ( !DeviceIoControl(m_hClient, (DWORD)cmd,
+   if ( !DeviceIoControl(hClient, (DWORD)cmd,
                          reqp, bytes_to_send,
                          reqp, bytes_to_send,
                          &bytes, &overlappedIO) ) {
 
       if ( ERROR_IO_PENDING != GetLastError() ) {
 		  AAL_ERR(LM_UAIA, __AAL_FUNCSIG__ << "failed." << std::endl);
-         m_bIsOK = false;
+         bFailed = true;
       }
 
    }
    CloseHandle(hEvent);
 
 #elif defined( __AAL_LINUX__ )
-   if ( -1 == ioctl(m_fdClient, cmd, reqp) ) {
+   if ( -1 == ioctl(fdClient, cmd, reqp) ) {
       perror("UIDriverInterfaceAdapter::SendMessage");
-      m_bIsOK = false;
+      bFailed = true;
       reqp->errcode = uid_errnumInvalidRequest;
    }
 
@@ -609,6 +731,16 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
 #endif // OS
 
    delete [] reqp;
+
+   {
+      AutoLock(this);
+      if ( bFailed ) {
+         m_bIsOK = false;
+      }
+      if ( ( 0 == --m_SendsInFlight ) && m_bCloseWaiting ) {
+         m_SendsDone.Post(1);
+      }
+   }
    return true;
 }  // UIDriverInterfaceAdapter::SendMessage
 
@@ -43,6 +43,7 @@
 #include <aalsdk/AALTypes.h>
 
 #include <aalsdk/osal/CriticalSection.h>
+#include <aalsdk/osal/OSSemaphore.h>
 #include <aalsdk/CUnCopyable.h>
 
 #include <aalsdk/AALTransactionID.h>
@@ -89,6 +90,11 @@ class AIASERVICE_API UIDriverInterfaceAdapter : private CriticalSection,
       // Polls for messages and returns when one is available
       AAL::btBool GetMessage(uidrvMessage *uidrvMessagep);
 
+      // Polls for messages and returns when at least one is available, appending
+      //  every message queued at that point to rMessages, in order. The caller owns
+      //  the appended messages.
+      AAL::btBool GetMessages(std::vector<uidrvMessage *> &rMessages);
+
       // Sends a message down the UIDriver channel
       AAL::btBool SendMessage( AAL::btHANDLE devHandle,
                                IAIATransaction *pMessage,
@@ -102,10 +108,21 @@ class AIASERVICE_API UIDriverInterfaceAdapter : private CriticalSection,
       HANDLE m_hClient;
       #elif defined( __AAL_LINUX__ )
       AAL::btInt  m_fdClient;
+
+      // Receives AALUID_IOCTL_GETMSG_BATCH. 64-bit elements, for the alignment
+      //  of the records within it.
+      enum { BatchBufferSize = 64 * 1024 };
+      std::vector<AAL::btUnsigned64bitInt> m_Batch;
+      AAL::btBool m_bBatchOK;   // False if the driver does not support batches
       #endif // OS
 
       AAL::btBool m_bIsOK;
 
+      // SendMessage() calls in the driver, which Close() waits for
+      AAL::btUnsignedInt m_SendsInFlight;
+      AAL::btBool        m_bCloseWaiting;
+      CSemaphore         m_SendsDone;
+
 }; // class UIDriverInterfaceAdapter{}
 
 END_NAMESPACE(AAL)
@@ -73,6 +73,13 @@ void uidrvMessage::size(btWSSize PayloadSize)
    m_pmessage->size = PayloadSize;
 }
 
+void uidrvMessage::assign(struct ccipui_ioctlreq const *preq)
+{
+   ASSERT(NULL != preq);
+   size(preq->size);
+   memcpy(m_pmessage, preq, (size_t)m_msgsize);
+}
+
 btVirtAddr  uidrvMessage::payload() const
 { ASSERT(NULL != m_pmessage);
    btVirtAddr ptr = reinterpret_cast<btVirtAddr>(m_pmessage->payload);
@@ -63,6 +63,8 @@ public:
 
    // size mutator (allocates m_payload)
    void size(btWSSize PayloadSize);
+   // Make this message a copy of preq, header and payload.
+   void assign(struct ccipui_ioctlreq const *preq);
    // result_code mutator
    void result_code(uid_errnum_e e) {ASSERT(NULL != m_pmessage); m_pmessage->errcode = e; }
 
@@ -63,9 +63,15 @@
 # error TODO: Semaphore for unknown OS.
 #endif // __AAL_UNKNOWN_OS__
 
-#if defined( __AAL_LINUX__ )
+#if   defined( __AAL_LINUX__ )
 # include <errno.h>
-# include <sys/time.h>
+# include <limits.h>
+# include <time.h>
+# include <unistd.h>
+# include <sys/syscall.h>
+# include <linux/futex.h>
+#elif defined( __AAL_WINDOWS__ )
+# include <intrin.h>
 #endif // OS
 
 #ifdef DBG_CSEMAPHORE
@@ -83,6 +89,73 @@
 
 BEGIN_NAMESPACE(AAL)
 
+// m_WaitCount is read without the lock by the Linux Post(), so waiters are counted
+//  atomically on both OS's.
+static inline btUnsignedInt SemAtomicInc(volatile btUnsignedInt *p)
+{
+#if defined( _MSC_VER )
+   return (btUnsignedInt)_InterlockedIncrement(reinterpret_cast<volatile long *>(p));
+#else
+   return __sync_add_and_fetch(p, 1);
+#endif // _MSC_VER
+}
+
+static inline btUnsignedInt SemAtomicDec(volatile btUnsignedInt *p)
+{
+#if defined( _MSC_VER )
+   return (btUnsignedInt)_InterlockedDecrement(reinterpret_cast<volatile long *>(p));
+#else
+   return __sync_sub_and_fetch(p, 1);
+#endif // _MSC_VER
+}
+
+#if defined( __AAL_LINUX__ )
+
+# ifndef FUTEX_WAIT_PRIVATE
+#    define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#    define FUTEX_WAKE_PRIVATE FUTEX_WAKE
+# endif // FUTEX_WAIT_PRIVATE
+
+// Sleeps on *p unless *p no longer holds Val. pRel is relative, NULL for no timeout.
+//  Returns 0 or an errno value.
+static inline int SemFutexWait(volatile btInt *p, btInt Val, const struct timespec *pRel)
+{
+   if ( 0 == syscall(SYS_futex, p, FUTEX_WAIT_PRIVATE, Val, pRel, NULL, 0) ) {
+      return 0;
+   }
+   return errno;
+}
+
+static inline void SemFutexWake(volatile btInt *p, btInt Waiters)
+{
+   syscall(SYS_futex, p, FUTEX_WAKE_PRIVATE, Waiters, NULL, NULL, 0);
+}
+
+static inline void SemCPURelax()
+{
+# if defined( __i386__ ) || defined( __x86_64__ )
+   __asm__ __volatile__ ("pause" : : : "memory");
+# else
+   __asm__ __volatile__ (""      : : : "memory");
+# endif // arch
+}
+
+// Takes one from *pCount if it is positive.
+static inline btBool SemTryDecrement(volatile btInt *pCount)
+{
+   btInt c = *pCount;
+   while ( c > 0 ) {
+      const btInt prev = __sync_val_compare_and_swap(pCount, c, c - 1);
+      if ( prev == c ) {
+         return true;
+      }
+      c = prev;
+   }
+   return false;
+}
+
+#endif // __AAL_LINUX__
+
 //=============================================================================
 // Name: CSemaphore
 // Description: Constructor
@@ -94,9 +167,12 @@ CSemaphore::CSemaphore() :
    m_MaxCount(0),
    m_CurCount(0),
    m_WaitCount(0),
-   m_UserDefined(NULL)
+   m_UserDefined(NULL),
+   m_Spins(0)
 #if   defined( __AAL_WINDOWS__ )
    , m_hEvent(NULL)
+#elif defined( __AAL_LINUX__ )
+   , m_Futex(0)
 #endif // OS
 {}
 
@@ -142,9 +218,7 @@ btBool CSemaphore::Create(btInt nInitialCount, btUnsignedInt nMaxCount)
       return false;
    }
 #elif defined( __AAL_LINUX__ )
-   if ( pthread_cond_init(&m_condition, NULL) ) {
-      return false;
-   }
+   m_Futex = 0;
 #endif // OS
 
    if ( nInitialCount < 0 ) {
@@ -203,9 +277,6 @@ btBool CSemaphore::Destroy()
       res = ( 0 != CloseHandle(m_hEvent) );
 #elif defined( __AAL_LINUX__ )
       res = true;
-      if ( 0 != pthread_cond_destroy(&m_condition) ) {
-         res = false;
-      }
 #endif // OS
 
       // No longer initialized.
@@ -293,8 +364,50 @@ btBool CSemaphore::CurrCounts(btInt &rcurrCount, btInt &rmaxCount)
 // Interface: public
 // Inputs: none.
 // Outputs:
-// Comments:
+// Comments: On Linux, the count is updated without the lock, and the futex is
+//            only touched when there are sleeping waiters.
 //=============================================================================
+#if   defined( __AAL_LINUX__ )
+btBool CSemaphore::Post(btInt nCount)
+{
+#ifdef DBG_CSEMAPHORE
+   {
+      AutoLock4(this);
+   }
+#endif // DBG_CSEMAPHORE
+
+   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+      // Not initialized.
+      return false;
+   }
+
+   btInt c = m_CurCount;
+   for ( ; ; ) {
+      // Can't post such that you exceed MaxCount
+      if ( ( c + nCount ) > m_MaxCount ) {
+         return false;
+      }
+
+      const btInt prev = __sync_val_compare_and_swap(&m_CurCount, c, c + nCount);
+      if ( prev == c ) {
+         break;
+      }
+      c = prev;
+   }
+
+   c += nCount;
+
+   // The compare-and-swap is a full barrier, so a waiter that found the count at 0 is
+   //  visible in m_WaitCount here, or it will find the new count.
+   if ( ( c > 0 ) && ( m_WaitCount > 0 ) ) {
+      __sync_fetch_and_add(&m_Futex, 1);
+      // Release 1 (or at least minimal) thread, or all waiting threads.
+      SemFutexWake(&m_Futex, ( 1 == c ) ? 1 : INT_MAX);
+   }
+
+   return true;
+}
+#elif defined( __AAL_WINDOWS__ )
 btBool CSemaphore::Post(btInt nCount)
 {
    AutoLock4(this);
@@ -313,28 +426,13 @@ btBool CSemaphore::Post(btInt nCount)
    m_CurCount += nCount;
 
    if ( m_CurCount > 0 ) {
-
-#if   defined( __AAL_LINUX__ )
-
-      if ( 1 == m_CurCount ) {
-         // Release 1 (or at least minimal) thread
-         pthread_cond_signal(&m_condition);      // Signal
-      } else {
-         // Release all waiting threads
-         pthread_cond_broadcast(&m_condition);      // Signal
-      }
-
-#elif defined( __AAL_WINDOWS__ )
-
       // Resume waiters from sleep.
       SetEvent(m_hEvent);
-
-#endif
-
    }
 
    return true;
 }
+#endif // OS
 
 //=============================================================================
 // Name: UnblockAll
@@ -368,9 +466,8 @@ btBool CSemaphore::UnblockAll()
 #if   defined( __AAL_LINUX__ )
 
       // Wake ALL threads
-      if ( 0 != pthread_cond_broadcast(&m_condition) ) {      // Signal
-         res = false;
-      }
+      __sync_fetch_and_add(&m_Futex, 1);
+      SemFutexWake(&m_Futex, INT_MAX);
 
 #elif defined( __AAL_WINDOWS__ )
 
@@ -403,14 +500,28 @@ btUnsignedInt CSemaphore::NumWaiters()
 }
 
 
-#define ADD_WAITER() ++m_WaitCount
-#define DEL_WAITER()                        \
-do                                          \
-{                                           \
-   --m_WaitCount;                           \
-   if ( 0 == m_WaitCount ) {                \
-      flag_clrf(m_State, SEM_ST_UNBLOCKED); \
-   }                                        \
+//=============================================================================
+// Name: SpinBeforeSleep
+// Description: Sets the number of times Wait() polls the count before sleeping.
+// Interface: public
+// Inputs: Spins - 0 to sleep right away.
+// Outputs:
+// Comments:
+//=============================================================================
+void CSemaphore::SpinBeforeSleep(btUnsignedInt Spins)
+{
+   AutoLock(this);
+   m_Spins = Spins;
+}
+
+
+#define ADD_WAITER() SemAtomicInc(&m_WaitCount)
+#define DEL_WAITER()                           \
+do                                             \
+{                                              \
+   if ( 0 == SemAtomicDec(&m_WaitCount) ) {    \
+      flag_clrf(m_State, SEM_ST_UNBLOCKED);    \
+   }                                           \
 }while(0)
 
 
@@ -421,78 +532,20 @@ do                                          \
 // Interface: public
 // Inputs: none.
 // Returns: False if the semaphore is bad or it times out waiting
-// Comments:
+// Comments: Takes the count without the lock when it is positive.
 //=============================================================================
 btBool CSemaphore::Wait(btTime Timeout) // milliseconds
 {
-   if ( AAL_INFINITE_WAIT == Timeout ) {
-      return Wait();
-   }
-
-   {
-      AutoLock(this);
-      if ( flag_is_clr(m_State, SEM_ST_OK) ) {
-         // Not initialized.
-         return false;
-      }
+   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+      // Not initialized.
+      return false;
    }
 
-   // Unlock to allow other waits and posts..
-
-   struct timeval tv;
-   struct timezone tz;
-   gettimeofday(&tv, &tz);
-
-   struct timespec ts;
-
-   ts.tv_sec = tv.tv_sec;
-   ts.tv_nsec = (tv.tv_usec * 1000) + (Timeout * 1000000);
-
-   ts.tv_sec += ts.tv_nsec / 1000000000;
-   ts.tv_nsec = ts.tv_nsec % 1000000000;
-
-   // Protect the predicate check (locks the mutex used in wait)
-   AutoLock7(this);
-
-   ADD_WAITER();
-
-   // Both the comparison of m_CurCount to 0 and the decrement of m_CurCount must occur atomically.
-
-   while ( m_CurCount <= 0 ) {
-      // The pthread cond wait API's work as follows:
-      // * the mutex object guarding the counter predicate must be locked prior to the call.
-      // * when the wait call puts the caller to sleep, it releases the lock prior to doing so.
-      // * when the caller wakes, the lock is guaranteed to be held (locked) by the caller.
-      // In this way, the examination and mutation of the counter predicate occur atomically.
-
-      int WaitRes = EINVAL;
-
-      {
-         _PThreadCondTimedWait wait(this, &m_condition, &ts);
-         WaitRes = wait.Result();
-      }
-
-      if ( ETIMEDOUT == WaitRes ) {
-         DEL_WAITER();
-         // Unlock the mutex locked by the return from wait
-         return false;
-      }
-
-      // If we are being unblocked, then immediately return false and do not
-      //   modify the predicate.
-      if ( flag_is_set(m_State, SEM_ST_UNBLOCKED) ) {
-         DEL_WAITER();
-         return false;
-      }
+   if ( SemTryDecrement(&m_CurCount) ) {
+      return true;
    }
-   // ASSERT(m_CurCount > 0);
-
-   // Decrement count. Note we are still protected by lock from return from wait()
-   m_CurCount--;
 
-   DEL_WAITER();
-
-   return true;
+   return WaitForPost(Timeout);
 }
 
 
@@ -507,43 +560,116 @@ btBool CSemaphore::Wait(btTime Timeout) // milliseconds
 //=============================================================================
 btBool CSemaphore::Wait()
 {
-   AutoLock6(this);
+   return Wait(AAL_INFINITE_WAIT);
+}
 
-   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
-      // Not initialized.
-      return false;
+//=============================================================================
+// Name: WaitForPost
+// Description: Slow path of Wait(), for when the count was not positive.
+// Interface: private
+// Inputs: Timeout - milliseconds, or AAL_INFINITE_WAIT.
+// Returns: False if the semaphore is bad, unblocked, or it times out waiting
+// Comments: Polls the count m_Spins times, then sleeps on m_Futex until a Post()
+//           or UnblockAll() advances it.
+//=============================================================================
+btBool CSemaphore::WaitForPost(btTime Timeout)
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_Spins ; ++i ) {
+      SemCPURelax();
+      if ( SemTryDecrement(&m_CurCount) ) {
+         return true;
+      }
    }
 
-   // Both the comparison of m_CurCount to 0 and the decrement of m_CurCount must occur atomically.
-   //  This is done by assuring that manipulation is always done within a lock()
-   // Protect the predicate check (locks the mutex used in wait)
+   struct timespec deadline;
+   if ( AAL_INFINITE_WAIT != Timeout ) {
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      deadline.tv_sec  += Timeout / 1000;
+      deadline.tv_nsec += ( Timeout % 1000 ) * 1000000;
+      if ( deadline.tv_nsec >= 1000000000 ) {
+         deadline.tv_nsec -= 1000000000;
+         ++deadline.tv_sec;
+      }
+   }
 
-   ADD_WAITER();
+   // The futex word is sampled under the lock, before checking the count. A Post()
+   //  that makes the count positive after the check, or an UnblockAll() that gets the
+   //  lock after us, also advances the word, so the futex wait below then returns
+   //  right away instead of sleeping.
+   btInt seq;
 
-   while ( m_CurCount <= 0 ) {
-      // The pthread cond wait API's work as follows:
-      // * the mutex object guarding the counter predicate must be locked prior to the call.
-      // * when the wait call puts the caller to sleep, it releases the lock prior to doing so.
-      // * when the caller wakes, the lock is guaranteed to be held (locked) by the caller.
-      // In this way, the examination and mutation of the counter predicate occur atomically.
+   if ( AAL_INFINITE_WAIT == Timeout ) {
+      AutoLock6(this);
 
-      {
-         _PThreadCondWait wait(this, &m_condition); // Infinite wait
+      if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+         // Not initialized.
+         return false;
       }
 
+      ADD_WAITER();
+      seq = m_Futex;
+   } else {
+      AutoLock7(this);
+
+      if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+         // Not initialized.
+         return false;
+      }
+
+      ADD_WAITER();
+      seq = m_Futex;
+   }
+
+   for ( ; ; ) {
+      __sync_synchronize();
+
+      if ( SemTryDecrement(&m_CurCount) ) {
+         AutoLock(this);
+         DEL_WAITER();
+         return true;
+      }
+
+      int WaitRes;
+
+      if ( AAL_INFINITE_WAIT == Timeout ) {
+         WaitRes = SemFutexWait(&m_Futex, seq, NULL);
+      } else {
+         struct timespec now;
+         struct timespec rel;
+
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         rel.tv_sec  = deadline.tv_sec  - now.tv_sec;
+         rel.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+         if ( rel.tv_nsec < 0 ) {
+            rel.tv_nsec += 1000000000;
+            --rel.tv_sec;
+         }
+
+         if ( rel.tv_sec < 0 ) {
+            WaitRes = ETIMEDOUT;
+         } else {
+            WaitRes = SemFutexWait(&m_Futex, seq, &rel);
+         }
+      }
+
+      AutoLock(this);
+
       // If we are being unblocked, then immediately return false and do not
       //   modify the predicate.
       if ( flag_is_set(m_State, SEM_ST_UNBLOCKED) ) {
          DEL_WAITER();
          return false;
       }
-   }
-
-   m_CurCount--;
 
-   DEL_WAITER();
+      if ( ETIMEDOUT == WaitRes ) {
+         DEL_WAITER();
+         return false;
+      }
 
-   return true;
+      // Woken, the word had already moved, or interrupted: look at the count again.
+      seq = m_Futex;
+   }
 }
 #elif defined(__AAL_WINDOWS__)
 //=============================================================================
@@ -0,0 +1,336 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ObjectPool.cpp
+/// @brief Thread-caching pools for small, frequently allocated objects.
+/// @ingroup OSAL
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/osal/ObjectPool.h"
+#include "aalsdk/osal/Sleep.h"
+
+#if defined( _MSC_VER )
+# include <intrin.h>
+#endif // _MSC_VER
+
+
+BEGIN_NAMESPACE(AAL)
+
+
+// Per-thread free lists, one per size class.
+struct ObjectPoolThreadCache
+{
+   void              *m_Head[ObjectPool::NumClasses];
+   btUnsigned32bitInt m_Count[ObjectPool::NumClasses];
+   btBool             m_ExitHook;   // Thread exit hook set (or tried, and failed).
+};
+
+static __AAL_THREAD_LOCAL ObjectPoolThreadCache gObjPoolCache = { { NULL, }, { 0, }, false };
+
+// Free lists shared by all threads, each guarded by its own spin lock. The lists are
+//  plain data, so that they are usable before static constructors run and after static
+//  destructors have run, when objects may still be created and destroyed.
+struct ObjectPoolShared
+{
+   volatile long      m_Lock;
+   void              *m_Head;
+   btUnsigned32bitInt m_Count;
+   btUnsigned64bitInt m_HeapAllocs;
+};
+
+static ObjectPoolShared gObjPoolShared[ObjectPool::NumClasses];
+
+// Held only to move a batch of blocks, so waiters spin, yielding the CPU.
+class ObjectPoolLock
+{
+public:
+   ObjectPoolLock(volatile long &Lock) :
+      m_Lock(Lock)
+   {
+#if defined( _MSC_VER )
+      while ( 0 != _InterlockedExchange(&m_Lock, 1) ) {
+#else
+      while ( 0 != __sync_lock_test_and_set(&m_Lock, 1) ) {
+#endif // _MSC_VER
+         SleepZero();
+      }
+   }
+
+   ~ObjectPoolLock()
+   {
+#if defined( _MSC_VER )
+      _InterlockedExchange(&m_Lock, 0);
+#else
+      __sync_lock_release(&m_Lock);
+#endif // _MSC_VER
+   }
+
+private:
+   volatile long &m_Lock;
+};
+
+// Returns a thread's cached blocks to the shared lists when the thread exits, whether
+//  or not it is an OSLThread. Created on first use, under gObjPoolExitLock.
+static volatile long gObjPoolExitLock = 0;
+
+#if   defined( __AAL_WINDOWS__ )
+static DWORD         gObjPoolExitKey  = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI ObjectPoolThreadExit(PVOID )
+{
+   ObjectPool::FlushThreadCache();
+}
+#elif defined( __AAL_LINUX__ )
+static pthread_key_t gObjPoolExitKey;
+static btBool        gObjPoolExitKeyValid = false;
+
+static void ObjectPoolThreadExit(void * )
+{
+   ObjectPool::FlushThreadCache();
+}
+#endif // OS
+
+static void ObjectPoolHookThreadExit(ObjectPoolThreadCache &tc)
+{
+   ObjectPoolLock lock(gObjPoolExitLock);
+
+#if   defined( __AAL_WINDOWS__ )
+   if ( FLS_OUT_OF_INDEXES == gObjPoolExitKey ) {
+      gObjPoolExitKey = FlsAlloc(ObjectPoolThreadExit);
+   }
+   if ( FLS_OUT_OF_INDEXES != gObjPoolExitKey ) {
+      FlsSetValue(gObjPoolExitKey, &tc);
+   }
+#elif defined( __AAL_LINUX__ )
+   if ( !gObjPoolExitKeyValid ) {
+      gObjPoolExitKeyValid = ( 0 == pthread_key_create(&gObjPoolExitKey, ObjectPoolThreadExit) );
+   }
+   if ( gObjPoolExitKeyValid ) {
+      pthread_setspecific(gObjPoolExitKey, &tc);
+   }
+#endif // OS
+
+   // Not retried if it failed; the thread's cache is then lost when it exits.
+   tc.m_ExitHook = true;
+}
+
+// The next block on a free list is stored in the first bytes of the block.
+#define OBJPOOL_NEXT(__blk) ( *reinterpret_cast<void **>(__blk) )
+
+// Blocks are moved between a thread's cache and the shared list this many at a time.
+static const btUnsigned32bitInt ObjectPoolBatch = ObjectPool::ThreadCacheDepth / 2;
+
+static inline btUnsigned32bitInt ObjectPoolClass(size_t Size)
+{
+   return ( 0 == Size ) ? 0 : (btUnsigned32bitInt)( ( Size - 1 ) / ObjectPool::Granule );
+}
+
+static inline size_t ObjectPoolClassSize(btUnsigned32bitInt Class)
+{
+   return (size_t)( Class + 1 ) * ObjectPool::Granule;
+}
+
+// Refills the calling thread's cache for Class from the shared list, or failing that
+//  from the heap. Returns one block for the caller, or NULL if the heap is exhausted.
+static void * ObjectPoolRefill(btUnsigned32bitInt Class)
+{
+   ObjectPoolThreadCache &tc = gObjPoolCache;
+   ObjectPoolShared      &sh = gObjPoolShared[Class];
+   void                  *p  = NULL;
+
+   if ( !tc.m_ExitHook ) {
+      ObjectPoolHookThreadExit(tc);
+   }
+
+   {
+      ObjectPoolLock lock(sh.m_Lock);
+
+      btUnsigned32bitInt n = ( sh.m_Count < ObjectPoolBatch ) ? sh.m_Count : ObjectPoolBatch;
+
+      if ( n > 0 ) {
+         // The first block goes to the caller, the rest to the thread's cache.
+         p         = sh.m_Head;
+         sh.m_Head = OBJPOOL_NEXT(p);
+
+         btUnsigned32bitInt i;
+         for ( i = 1 ; i < n ; ++i ) {
+            void *blk = sh.m_Head;
+            sh.m_Head = OBJPOOL_NEXT(blk);
+
+            OBJPOOL_NEXT(blk) = tc.m_Head[Class];
+            tc.m_Head[Class]  = blk;
+         }
+
+         sh.m_Count       -= n;
+         tc.m_Count[Class] += n - 1;
+         return p;
+      }
+
+      ++sh.m_HeapAllocs;
+   }
+
+   return ::operator new(ObjectPoolClassSize(Class), std::nothrow);
+}
+
+void * ObjectPool::Allocate(size_t Size, std::nothrow_t const &nt) throw()
+{
+   if ( Size > (size_t)MaxObjectSize ) {
+      return ::operator new(Size, nt);
+   }
+
+   const btUnsigned32bitInt Class = ObjectPoolClass(Size);
+   ObjectPoolThreadCache   &tc    = gObjPoolCache;
+
+   void *p = tc.m_Head[Class];
+   if ( NULL != p ) {
+      tc.m_Head[Class] = OBJPOOL_NEXT(p);
+      --tc.m_Count[Class];
+      return p;
+   }
+
+   return ObjectPoolRefill(Class);
+}
+
+void * ObjectPool::Allocate(size_t Size)
+{
+   void *p = Allocate(Size, std::nothrow);
+   if ( NULL == p ) {
+      throw std::bad_alloc();
+   }
+   return p;
+}
+
+void ObjectPool::Free(void *p, size_t Size) throw()
+{
+   if ( NULL == p ) {
+      return;
+   }
+
+   if ( Size > (size_t)MaxObjectSize ) {
+      ::operator delete(p);
+      return;
+   }
+
+   const btUnsigned32bitInt Class = ObjectPoolClass(Size);
+   ObjectPoolThreadCache   &tc    = gObjPoolCache;
+
+   if ( !tc.m_ExitHook ) {
+      ObjectPoolHookThreadExit(tc);
+   }
+
+   OBJPOOL_NEXT(p)  = tc.m_Head[Class];
+   tc.m_Head[Class] = p;
+
+   if ( ++tc.m_Count[Class] <= (btUnsigned32bitInt)ThreadCacheDepth ) {
+      return;
+   }
+
+   // The cache is full. Detach a batch of blocks, and hand it to the shared list, or
+   //  back to the heap if the shared list is full, too.
+   void              *first = tc.m_Head[Class];
+   void              *last  = first;
+   btUnsigned32bitInt i;
+   for ( i = 1 ; i < ObjectPoolBatch ; ++i ) {
+      last = OBJPOOL_NEXT(last);
+   }
+   tc.m_Head[Class]   = OBJPOOL_NEXT(last);
+   tc.m_Count[Class] -= ObjectPoolBatch;
+
+   ObjectPoolShared &sh = gObjPoolShared[Class];
+   {
+      ObjectPoolLock lock(sh.m_Lock);
+
+      if ( sh.m_Count + ObjectPoolBatch <= (btUnsigned32bitInt)SharedDepth ) {
+         OBJPOOL_NEXT(last) = sh.m_Head;
+         sh.m_Head          = first;
+         sh.m_Count        += ObjectPoolBatch;
+         return;
+      }
+   }
+
+   OBJPOOL_NEXT(last) = NULL;
+   while ( NULL != first ) {
+      void *next = OBJPOOL_NEXT(first);
+      ::operator delete(first);
+      first = next;
+   }
+}
+
+void ObjectPool::FlushThreadCache()
+{
+   ObjectPoolThreadCache &tc = gObjPoolCache;
+
+   btUnsigned32bitInt c;
+   for ( c = 0 ; c < (btUnsigned32bitInt)NumClasses ; ++c ) {
+
+      while ( NULL != tc.m_Head[c] ) {
+         void *p = tc.m_Head[c];
+         tc.m_Head[c] = OBJPOOL_NEXT(p);
+
+         ObjectPoolShared &sh = gObjPoolShared[c];
+         {
+            ObjectPoolLock lock(sh.m_Lock);
+            if ( sh.m_Count < (btUnsigned32bitInt)SharedDepth ) {
+               OBJPOOL_NEXT(p) = sh.m_Head;
+               sh.m_Head       = p;
+               ++sh.m_Count;
+               continue;
+            }
+         }
+
+         ::operator delete(p);
+      }
+
+      tc.m_Count[c] = 0;
+   }
+
+   // Another thread exit handler may yet use the pool, and set the hook again.
+   tc.m_ExitHook = false;
+}
+
+btUnsigned64bitInt ObjectPool::HeapAllocations()
+{
+   btUnsigned64bitInt n = 0;
+
+   btUnsigned32bitInt c;
+   for ( c = 0 ; c < (btUnsigned32bitInt)NumClasses ; ++c ) {
+      ObjectPoolLock lock(gObjPoolShared[c].m_Lock);
+      n += gObjPoolShared[c].m_HeapAllocs;
+   }
+
+   return n;
+}
+
+
+END_NAMESPACE(AAL)
+
@@ -65,10 +65,56 @@
 # include <cstdlib>  // int rand_r(unsigned int *seed);
 # include <signal.h>
 # include <unistd.h>
+# include <sched.h>
+# include <sys/syscall.h>
 #endif // OS
 
 BEGIN_NAMESPACE(AAL)
 
+// Binds the calling thread to Cpus and, when Node >= 0, has it prefer memory from Node.
+static void ApplyPlacement(const CpuSet &Cpus, btInt Node)
+{
+   btUnsignedInt i;
+
+#if   defined( __AAL_WINDOWS__ )
+
+   DWORD_PTR Mask = 0;
+   for ( i = 0 ; i < 8 * sizeof(Mask) ; ++i ) {
+      if ( Cpus.Has(i) ) {
+         Mask |= (DWORD_PTR)1 << i;
+      }
+   }
+   if ( 0 != Mask ) {
+      SetThreadAffinityMask(GetCurrentThread(), Mask);
+   }
+
+#elif defined( __AAL_LINUX__ )
+
+   cpu_set_t cs;
+   CPU_ZERO(&cs);
+   for ( i = 0 ; ( i < CpuSet::MaxCpus ) && ( i < CPU_SETSIZE ) ; ++i ) {
+      if ( Cpus.Has(i) ) {
+         CPU_SET(i, &cs);
+      }
+   }
+   pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs);
+
+# ifdef SYS_set_mempolicy
+   if ( ( Node >= 0 ) && ( Node < CpuSet::MaxCpus ) ) {
+      // set_mempolicy(MPOL_PREFERRED, ...), without a dependency on libnuma.
+      const int     MPOL_PREFERRED_ = 1;
+      const size_t  Bits            = 8 * sizeof(unsigned long);
+      unsigned long Nodes[CpuSet::MaxCpus / (8 * sizeof(unsigned long))];
+
+      memset(Nodes, 0, sizeof(Nodes));
+      Nodes[Node / Bits] = 1UL << (Node % Bits);
+      syscall(SYS_set_mempolicy, MPOL_PREFERRED_, Nodes, 8 * sizeof(Nodes));
+   }
+# endif // SYS_set_mempolicy
+
+#endif // OS
+}
+
 const btInt OSLThread::sm_PriorityTranslationTable[(btInt)THREADPRIORITY_COUNT] =
 {
 #if   defined( __AAL_WINDOWS__ )
@@ -114,9 +160,64 @@ OSLThread::OSLThread(ThreadProc                     pProc,
    m_pProc(pProc),
    m_nPriority(THREADPRIORITY_INVALID),
    m_pContext(pContext),
-   m_State(0)
+   m_State(0),
+   m_bPlaced(false),
+   m_Node(-1),
+   m_Cpus()
+{
+   Create(nPriority, ThisThread);
+}
+
+//=============================================================================
+// Name: OSLThread
+// Description: Thread abstraction, with placement
+// Interface: public
+// Inputs: pProc - Pointer to procedure to execute
+//         nPriority - OSAL thread priority
+//         pContext - Context
+//         Placement - CPUs and NUMA node for the new thread
+//         ThisThread - btBool indicating if proc should run in this thread
+// Outputs: none.
+// Comments: A placement that can't be resolved is not an error. The thread
+//           runs wherever the OS schedules it.
+//=============================================================================
+OSLThread::OSLThread(ThreadProc                     pProc,
+                     OSLThread::ThreadPriority      nPriority,
+                     void                          *pContext,
+                     const ThreadPlacement         &Placement,
+                     btBool                         ThisThread) :
+#if   defined( __AAL_WINDOWS__ )
+   m_hThread(NULL),
+#elif defined( __AAL_LINUX__ )
+   m_Thread(),
+#endif // OS
+   m_tid(),
+   m_pProc(pProc),
+   m_nPriority(THREADPRIORITY_INVALID),
+   m_pContext(pContext),
+   m_State(0),
+   m_bPlaced(false),
+   m_Node(-1),
+   m_Cpus()
 {
-   ASSERT(NULL != pProc);
+   if ( !ThisThread ) {
+      m_bPlaced = Placement.Resolve(m_Cpus, m_Node);
+   }
+   Create(nPriority, ThisThread);
+}
+
+//=============================================================================
+// Name: Create
+// Description: Common construction
+// Interface: private
+// Inputs: nPriority - OSAL thread priority
+//         ThisThread - btBool indicating if proc should run in this thread
+// Outputs: none.
+// Comments:
+//=============================================================================
+void OSLThread::Create(OSLThread::ThreadPriority nPriority, btBool ThisThread)
+{
+   ASSERT(NULL != m_pProc);
 
    if ( ( nPriority >= 0 ) &&
         ( (unsigned)nPriority < (sizeof(OSLThread::sm_PriorityTranslationTable) / sizeof(OSLThread::sm_PriorityTranslationTable[0])) ) ) {
@@ -129,7 +230,7 @@ OSLThread::OSLThread(ThreadProc                     pProc,
       return;
    }
 
-   if ( NULL == pProc ) { // (Without setting THR_ST_OK.)
+   if ( NULL == m_pProc ) { // (Without setting THR_ST_OK.)
       return;
    }
 
@@ -217,6 +318,10 @@ void * OSLThread::StartThread(void *p)
 
    }
 
+   if ( pThread->m_bPlaced ) {
+      ApplyPlacement(pThread->m_Cpus, pThread->m_Node);
+   }
+
    pThread->m_tid = CurrentThreadID();
 
    ThreadProc fn = pThread->m_pProc;
@@ -50,6 +50,8 @@
 #include "aalsdk/osal/ThreadGroup.h"
 #include "aalsdk/osal/Sleep.h"
 
+#include <cstddef>
+
 #ifdef DBG_THREADGROUP
 # include "dbg_threadgroup.cpp"
 #else
@@ -61,8 +63,240 @@
 # define AutoLock5(__x) AutoLock(__x)
 #endif // DBG_THREADGROUP
 
+#if defined( _MSC_VER )
+# include <intrin.h>
+#endif // _MSC_VER
+
 BEGIN_NAMESPACE(AAL)
 
+// Atomics for Scheduling WorkStealing.
+static inline btUnsignedInt TGAtomicInc(volatile btUnsignedInt *p)
+{
+#if defined( _MSC_VER )
+   return (btUnsignedInt)_InterlockedIncrement(reinterpret_cast<volatile long *>(p)) - 1;
+#else
+   return __sync_fetch_and_add(p, 1);
+#endif // _MSC_VER
+}
+
+static inline void TGAtomicDec(volatile btUnsignedInt *p)
+{
+#if defined( _MSC_VER )
+   _InterlockedDecrement(reinterpret_cast<volatile long *>(p));
+#else
+   __sync_fetch_and_sub(p, 1);
+#endif // _MSC_VER
+}
+
+static inline btBool TGAtomicCAS(volatile btUIntPtr *p, btUIntPtr oldval, btUIntPtr newval)
+{
+#if defined( _MSC_VER )
+   return oldval == (btUIntPtr)_InterlockedCompareExchangePointer(reinterpret_cast<void * volatile *>(p),
+                                                                   (void *)newval,
+                                                                   (void *)oldval);
+#else
+   return __sync_bool_compare_and_swap(p, oldval, newval);
+#endif // _MSC_VER
+}
+
+static inline void TGFullBarrier()
+{
+#if defined( _MSC_VER )
+   MemoryBarrier();
+#else
+   __sync_synchronize();
+#endif // _MSC_VER
+}
+
+// Orders the stores of a deque slot before the store that publishes it. x86 does not
+//  reorder stores with other stores, so only the compiler needs restraining there.
+static inline void TGStoreBarrier()
+{
+#if defined( _MSC_VER )
+   _ReadWriteBarrier();
+#elif defined( __i386__ ) || defined( __x86_64__ )
+   __asm__ __volatile__ ("" : : : "memory");
+#else
+   __sync_synchronize();
+#endif // _MSC_VER
+}
+
+// The thread group whose worker this thread is, if any, and the worker's slot in it.
+static __AAL_THREAD_LOCAL void         *gTGWorkerOf   = NULL;
+static __AAL_THREAD_LOCAL btUnsignedInt gTGWorkerSlot = 0;
+
+class OSLThreadGroup::ThrGrpState::WSQueues
+{
+public:
+   // Chase-Lev work-stealing deque of fixed capacity. The owning worker Push()'es and Pop()'s
+   //  at the bottom; any thread may Steal() from the top. Indices increase monotonically and
+   //  are compared by difference, so wrapping is harmless.
+   class Deque
+   {
+   public:
+      enum { Capacity = 1024 };
+
+      Deque() :
+         m_Top(0),
+         m_Bottom(0)
+      {}
+
+      std::ptrdiff_t Size() const
+      {
+         const std::ptrdiff_t sz = (std::ptrdiff_t)(m_Bottom - m_Top);
+         return ( sz > 0 ) ? sz : 0;
+      }
+
+      // Owner only. returns false if the deque is full.
+      btBool Push(IDispatchable *pWork)
+      {
+         const btUIntPtr b = m_Bottom;
+         if ( (std::ptrdiff_t)(b - m_Top) >= (std::ptrdiff_t)Capacity ) {
+            return false;
+         }
+         m_Items[b % Capacity] = pWork;
+         TGStoreBarrier();
+         m_Bottom = b + 1;
+         return true;
+      }
+
+      // Owner only. The most recently pushed item, or NULL.
+      IDispatchable * Pop()
+      {
+         const btUIntPtr b = m_Bottom - 1;
+         m_Bottom = b;
+         TGFullBarrier();
+         const btUIntPtr t = m_Top;
+
+         const std::ptrdiff_t sz = (std::ptrdiff_t)(b - t);
+         if ( sz < 0 ) {
+            m_Bottom = t;
+            return NULL;
+         }
+
+         IDispatchable *pWork = m_Items[b % Capacity];
+         if ( sz > 0 ) {
+            return pWork;
+         }
+
+         // Last item - race the thieves for it.
+         if ( !TGAtomicCAS(&m_Top, t, t + 1) ) {
+            pWork = NULL;
+         }
+         m_Bottom = t + 1;
+         return pWork;
+      }
+
+      // Any thread. The oldest item, or NULL if the deque was empty or another thread won it.
+      IDispatchable * Steal()
+      {
+         const btUIntPtr t = m_Top;
+         TGFullBarrier();
+         const btUIntPtr b = m_Bottom;
+
+         if ( (std::ptrdiff_t)(b - t) <= 0 ) {
+            return NULL;
+         }
+
+         IDispatchable *pWork = m_Items[t % Capacity];
+         if ( !TGAtomicCAS(&m_Top, t, t + 1) ) {
+            return NULL;
+         }
+         return pWork;
+      }
+
+   protected:
+      volatile btUIntPtr       m_Top;
+      btByte                   m_Pad0[64 - sizeof(btUIntPtr)];
+      volatile btUIntPtr       m_Bottom;
+      btByte                   m_Pad1[64 - sizeof(btUIntPtr)];
+      IDispatchable * volatile m_Items[Capacity];
+   };
+
+   struct Worker
+   {
+      Worker() :
+         m_InboxSize(0),
+         m_Seed(0)
+      {}
+
+      // Takes the oldest item in the inbox, or NULL.
+      IDispatchable * TakeInbox()
+      {
+         if ( 0 == m_InboxSize ) {
+            return NULL;
+         }
+
+         AutoLock(&m_InboxLock);
+
+         if ( m_Inbox.empty() ) {
+            return NULL;
+         }
+
+         IDispatchable *pWork = m_Inbox.front();
+         m_Inbox.pop_front();
+         --m_InboxSize;
+         return pWork;
+      }
+
+      void PutInbox(IDispatchable *pWork)
+      {
+         AutoLock(&m_InboxLock);
+         m_Inbox.push_back(pWork);
+         ++m_InboxSize;
+      }
+
+      Deque                       m_Deque;
+      // Work items added from outside the group (and local overflow) land here, so that
+      //  the deque keeps a single producer.
+      CriticalSection             m_InboxLock;
+      std::deque<IDispatchable *> m_Inbox;
+      volatile btUnsignedInt      m_InboxSize;
+      btUnsigned32bitInt          m_Seed;      // victim selection (owner only).
+   };
+
+   WSQueues(btUnsignedInt NumWorkers) :
+      m_NumWorkers(NumWorkers),
+      m_Workers(NULL),
+      m_NextSlot(0),
+      m_NextInbox(0),
+      m_Adders(0),
+      m_Idle(0)
+   {
+      m_Workers = new(std::nothrow) Worker[NumWorkers];
+
+      btUnsignedInt i;
+      for ( i = 0 ; ( NULL != m_Workers ) && ( i < NumWorkers ) ; ++i ) {
+         m_Workers[i].m_Seed = 0x9e3779b9 * (i + 1);
+      }
+   }
+
+   ~WSQueues()
+   {
+      if ( NULL != m_Workers ) {
+         delete[] m_Workers;
+      }
+   }
+
+   btBool IsOK() const { return NULL != m_Workers; }
+
+   // xorshift32
+   static btUnsigned32bitInt Random(btUnsigned32bitInt &seed)
+   {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      return seed;
+   }
+
+   btUnsignedInt          m_NumWorkers;
+   Worker                *m_Workers;
+   volatile btUnsignedInt m_NextSlot;  // next worker slot to hand out.
+   volatile btUnsignedInt m_NextInbox; // round robin target for Add()'s from outside the group.
+   volatile btUnsignedInt m_Adders;    // Add()'s between their state check and their push.
+   volatile btUnsignedInt m_Idle;      // workers about to wait, or waiting, on m_WorkSem.
+};
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -97,11 +331,15 @@ BEGIN_NAMESPACE(AAL)
 /// @param[in]    uiMaxThreads - Maximum threads (default = 0 = auto).
 /// @param[in]    nPriority    - Thread priority (default = OSLThread::THREADPRIORITY_NORMAL).
 /// @param[in]    JoinTimeout  - Timeout waiting for thread to exit (default = AAL_INFINITE_WAIT).
+/// @param[in]    eScheduling  - How work items are handed to the threads (default = SharedQueue).
+/// @param[in]    Placement    - CPUs and NUMA node of the threads (default = anywhere).
 /// @return void
 OSLThreadGroup::OSLThreadGroup(btUnsignedInt             uiMinThreads,
                                btUnsignedInt             uiMaxThreads,
                                OSLThread::ThreadPriority nPriority,
-                               btTime                    JoinTimeout) :
+                               btTime                    JoinTimeout,
+                               Scheduling                eScheduling,
+                               const ThreadPlacement    &Placement) :
    m_bDestroyed(false),
    m_JoinTimeout(JoinTimeout),
    m_pState(NULL)
@@ -128,7 +366,7 @@ OSLThreadGroup::OSLThreadGroup(btUnsignedInt             uiMinThreads,
       //  have been deleted. By making the state and synchronization members outside
       //  the ThreadGroup, the Threads can safely access them even if the Group object
       //  is gone.
-      m_pState = new(std::nothrow) OSLThreadGroup::ThrGrpState(uiMinThreads);
+      m_pState = new(std::nothrow) OSLThreadGroup::ThrGrpState(uiMinThreads, eScheduling, Placement);
       if ( NULL == m_pState ) {
          m_bDestroyed = true;
          ASSERT(false);
@@ -265,7 +503,9 @@ void OSLThreadGroup::ExecProc(OSLThread *pThread, void *lpParms)
 ////////////////////////////////////////////////////////////////////////////////
 // OSLThreadGroup::ThrGroupState
 
-OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
+OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt          NumThreads,
+                                         Scheduling             eScheduling,
+                                         const ThreadPlacement &Placement) :
    m_eState(Running),
    m_Flags(THRGRPSTATE_FLAG_OK),
    m_WorkSemTimeout(AAL_INFINITE_WAIT),
@@ -275,6 +515,8 @@ OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
    m_ThrJoinBarrier(),
    m_ThrExitBarrier(),
    m_WorkSem(),
+   m_pWS(NULL),
+   m_Placement(Placement),
    m_workqueue(),
    m_RunningThreads(),
    m_ExitedThreads(),
@@ -295,6 +537,13 @@ OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
    if ( !m_WorkSem.Create(0, INT_MAX) ) {
       flag_clrf(m_Flags, THRGRPSTATE_FLAG_OK);
    }
+
+   if ( OSLThreadGroup::WorkStealing == eScheduling ) {
+      m_pWS = new(std::nothrow) WSQueues(NumThreads);
+      if ( ( NULL == m_pWS ) || !m_pWS->IsOK() ) {
+         flag_clrf(m_Flags, THRGRPSTATE_FLAG_OK);
+      }
+   }
 }
 
 OSLThreadGroup::ThrGrpState::~ThrGrpState()
@@ -304,6 +553,11 @@ OSLThreadGroup::ThrGrpState::~ThrGrpState()
    ASSERT(m_RunningThreads.empty());
    ASSERT(m_ExitedThreads.empty());
    DestructMembers();
+
+   if ( NULL != m_pWS ) {
+      ASSERT(0 == WSCollect());
+      delete m_pWS;
+   }
 }
 
 //=============================================================================
@@ -327,7 +581,18 @@ btUnsignedInt OSLThreadGroup::ThrGrpState::GetNumThreads() const
 btUnsignedInt OSLThreadGroup::ThrGrpState::GetNumWorkItems() const
 {
    AutoLock(this);
-   return (btUnsignedInt) m_workqueue.size();
+
+   btUnsignedInt items = (btUnsignedInt) m_workqueue.size();
+
+   if ( NULL != m_pWS ) {
+      btUnsignedInt i;
+      for ( i = 0 ; i < m_pWS->m_NumWorkers ; ++i ) {
+         items += (btUnsignedInt) m_pWS->m_Workers[i].m_Deque.Size();
+         items += m_pWS->m_Workers[i].m_InboxSize;
+      }
+   }
+
+   return items;
 }
 
 void OSLThreadGroup::ThrGrpState::UserDefined(btObjectType User)
@@ -358,6 +623,10 @@ btBool OSLThreadGroup::ThrGrpState::Add(IDispatchable *pDisp)
       return false;
    }
 
+   if ( NULL != m_pWS ) {
+      return WSAdd(pDisp);
+   }
+
    {
       AutoLock0(this);
 
@@ -401,6 +670,12 @@ void OSLThreadGroup::ThrGrpState::Stop()
    // which is what we want anyway - no need to check the return value from Reset().
    m_WorkSem.Reset(0);
 
+   if ( NULL != m_pWS ) {
+      // Gather the work items of every worker onto m_workqueue, to be flushed with it.
+      WSQuiesceAdders();
+      WSCollect();
+   }
+
    // If there is something on the queue then remove it and destroy it.
    while ( m_workqueue.size() > 0 ) {
       IDispatchable *wi = m_workqueue.front();
@@ -420,6 +695,11 @@ btBool OSLThreadGroup::ThrGrpState::Start()
    AutoLock1(this);
 
    if ( Running == State(Running) ) {
+      if ( NULL != m_pWS ) {
+         // Workers don't count on m_WorkSem for work items, and Stop() left none.
+         return true;
+      }
+
       btInt s = (btInt) m_workqueue.size();
 
       btInt c = 0;
@@ -481,7 +761,7 @@ btBool OSLThreadGroup::ThrGrpState::CreateWorkerThread(ThreadProc
                                                        OSLThread::ThreadPriority pri,
                                                        void                     *context)
 {
-   OSLThread *pThread = new(std::nothrow) OSLThread(fn, pri, context);
+   OSLThread *pThread = new(std::nothrow) OSLThread(fn, pri, context, m_Placement);
 
    ASSERT(NULL != pThread);
    if ( NULL == pThread ) {
@@ -510,6 +790,10 @@ btBool OSLThreadGroup::ThrGrpState::CreateWorkerThread(ThreadProc
 //=============================================================================
 OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::GetWorkItem(IDispatchable * &pWork)
 {
+   if ( NULL != m_pWS ) {
+      return WSGetWorkItem(pWork);
+   }
+
    // Wait for work item
    m_WorkSem.Wait(m_WorkSemTimeout);
 
@@ -560,6 +844,16 @@ OSLThread * OSLThreadGroup::ThrGrpState::ThreadRunningInThisGroup(btTID tid) con
 
 void OSLThreadGroup::ThrGrpState::WorkerHasStarted(OSLThread *pThread)
 {
+   if ( NULL != m_pWS ) {
+      // Claim a deque.
+      const btUnsignedInt slot = TGAtomicInc(&m_pWS->m_NextSlot);
+      ASSERT(slot < m_pWS->m_NumWorkers);
+      if ( slot < m_pWS->m_NumWorkers ) {
+         gTGWorkerOf   = this;
+         gTGWorkerSlot = slot;
+      }
+   }
+
    m_ThrStartBarrier.Post(1);
 }
 
@@ -671,6 +965,187 @@ btBool OSLThreadGroup::ThrGrpState::Quiesce(btTime Timeout)
    return true;
 }
 
+//=============================================================================
+// Name: WSAdd
+// Description: Add() for Scheduling WorkStealing
+// Interface: private
+// Comments: A worker of this group pushes onto its own deque, without locking.
+//           Anyone else posts to the inbox of the next worker, round robin.
+//=============================================================================
+btBool OSLThreadGroup::ThrGrpState::WSAdd(IDispatchable *pDisp)
+{
+   // Announce the Add() before checking the state. Stop() and Drain() change the state
+   // first, then wait for the announced Add()'s to finish, so no item can slip onto a
+   // deque behind their backs.
+   TGAtomicInc(&m_pWS->m_Adders);
+
+   const eState state = State();
+
+   // We allow new work items when Running or Joining.
+   if ( ( Stopped  == state ) ||
+        ( Draining == state ) ) {
+      TGAtomicDec(&m_pWS->m_Adders);
+      return false;
+   }
+
+   if ( ( this != gTGWorkerOf ) ||
+        !m_pWS->m_Workers[gTGWorkerSlot].m_Deque.Push(pDisp) ) {
+      const btUnsignedInt slot = ( this == gTGWorkerOf ) ?
+                                    gTGWorkerSlot :
+                                    TGAtomicInc(&m_pWS->m_NextInbox) % m_pWS->m_NumWorkers;
+      m_pWS->m_Workers[slot].PutInbox(pDisp);
+   }
+
+   TGAtomicDec(&m_pWS->m_Adders);
+
+   // Pairs with the barrier in WSGetWorkItem(): either we see the idle worker, or it
+   // sees our item.
+   TGFullBarrier();
+   if ( m_pWS->m_Idle > 0 ) {
+      m_WorkSem.Post(1);
+   }
+
+   return true;
+}
+
+//=============================================================================
+// Name: WSGetWorkItem
+// Description: GetWorkItem() for Scheduling WorkStealing
+// Interface: private
+// Comments: Blocks on m_WorkSem only when no work item can be found anywhere.
+//=============================================================================
+OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::WSGetWorkItem(IDispatchable * &pWork)
+{
+   eState state = State();
+
+   if ( Stopped != state ) {
+      pWork = WSFind(state);
+      if ( ( NULL != pWork ) || ( Joining == state ) ) {
+         // Joining with nothing left to do - the worker exits.
+         return state;
+      }
+   }
+
+   // Go idle, then look once more, in case an Add() missed seeing us idle.
+   TGAtomicInc(&m_pWS->m_Idle);
+   TGFullBarrier();
+
+   state = State();
+   if ( Stopped != state ) {
+      pWork = WSFind(state);
+   }
+
+   if ( NULL == pWork ) {
+      m_WorkSem.Wait(m_WorkSemTimeout);
+
+      state = State();
+      if ( Stopped != state ) {
+         pWork = WSFind(state);
+      }
+   }
+
+   TGAtomicDec(&m_pWS->m_Idle);
+
+   return state;
+}
+
+IDispatchable * OSLThreadGroup::ThrGrpState::WSFind(eState state)
+{
+   WSQueues          *pWS   = m_pWS;
+   const btUnsignedInt N     = pWS->m_NumWorkers;
+   const btUnsignedInt Me    = ( this == gTGWorkerOf ) ? gTGWorkerSlot : N;
+   IDispatchable      *pWork = NULL;
+   btUnsignedInt       i;
+   btUnsignedInt       start = 0;
+
+   if ( Me < N ) {
+      // Our own deque, newest first, then our inbox.
+      pWork = pWS->m_Workers[Me].m_Deque.Pop();
+      if ( NULL != pWork ) {
+         return pWork;
+      }
+      pWork = pWS->m_Workers[Me].TakeInbox();
+      if ( NULL != pWork ) {
+         return pWork;
+      }
+      start = WSQueues::Random(pWS->m_Workers[Me].m_Seed) % N;
+   }
+
+   if ( Running != state ) {
+      // Drain(), Join() and Destroy() gather work items onto m_workqueue.
+      AutoLock(this);
+      if ( m_workqueue.size() > 0 ) {
+         pWork = m_workqueue.front();
+         m_workqueue.pop();
+         return pWork;
+      }
+   }
+
+   // Steal the oldest item of a victim, starting at a random one.
+   for ( i = 0 ; i < N ; ++i ) {
+      const btUnsignedInt v = (start + i) % N;
+      if ( v == Me ) {
+         continue;
+      }
+      while ( pWS->m_Workers[v].m_Deque.Size() > 0 ) {
+         pWork = pWS->m_Workers[v].m_Deque.Steal();
+         if ( NULL != pWork ) {
+            return pWork;
+         }
+      }
+   }
+
+   for ( i = 0 ; i < N ; ++i ) {
+      const btUnsignedInt v = (start + i) % N;
+      if ( v == Me ) {
+         continue;
+      }
+      pWork = pWS->m_Workers[v].TakeInbox();
+      if ( NULL != pWork ) {
+         return pWork;
+      }
+   }
+
+   return NULL;
+}
+
+void OSLThreadGroup::ThrGrpState::WSQuiesceAdders()
+{
+   TGFullBarrier();
+   while ( m_pWS->m_Adders > 0 ) {
+      SleepZero();
+   }
+}
+
+btUnsignedInt OSLThreadGroup::ThrGrpState::WSCollect()
+{
+   btUnsignedInt  items = 0;
+   IDispatchable *pWork;
+   btUnsignedInt  i;
+
+   for ( i = 0 ; i < m_pWS->m_NumWorkers ; ++i ) {
+      WSQueues::Worker &w = m_pWS->m_Workers[i];
+
+      while ( w.m_Deque.Size() > 0 ) {
+         pWork = w.m_Deque.Steal();
+         if ( NULL != pWork ) {
+            m_workqueue.push(pWork);
+            ++items;
+         }
+      }
+
+      AutoLock(&w.m_InboxLock);
+      while ( !w.m_Inbox.empty() ) {
+         m_workqueue.push(w.m_Inbox.front());
+         w.m_Inbox.pop_front();
+         ++items;
+      }
+      w.m_InboxSize = 0;
+   }
+
+   return items;
+}
+
 void OSLThreadGroup::ThrGrpState::DestructMembers()
 {
    m_ThrStartBarrier.Destroy();
@@ -878,6 +1353,25 @@ btBool OSLThreadGroup::ThrGrpState::Drain()
    {
       AutoLock3(this);
 
+      if ( NULL != m_pWS ) {
+         // The items to drain are spread across the workers. Fence off Add()'s while they
+         // are gathered onto m_workqueue, then drain m_workqueue as usual.
+         const eState st = State();
+
+         if ( Stopped == st ) {
+            return true;
+         }
+
+         if ( Joining != st ) {
+            State(Draining);
+            WSQuiesceAdders();
+         }
+
+         if ( ( 0 == WSCollect() ) && m_workqueue.empty() && ( Running == st ) ) {
+            State(Running);
+         }
+      }
+
       const btUnsignedInt items = (btUnsignedInt) m_workqueue.size();
 
       // No need to drain if already empty.
@@ -893,6 +1387,11 @@ btBool OSLThreadGroup::ThrGrpState::Drain()
 
       pDrainBarrier = m_DrainManager.Begin(MyThrID, items);
 
+      if ( NULL != m_pWS ) {
+         // Wake any idle workers to help.
+         m_WorkSem.Post( (btInt) items );
+      }
+
       if ( NULL == pDrainBarrier ) {
          // Self-referential Drain().
 
@@ -980,11 +1479,13 @@ btBool OSLThreadGroup::ThrGrpState::Join(btTime Timeout)
 
          // We need to continue to execute work.
          IDispatchable *pWork;
-         while ( m_workqueue.size() > 0 ) {
-            pWork = m_workqueue.front();
-            m_workqueue.pop();
-            _UnlockedDispatch uld(this, pWork);
-         }
+         do {
+            while ( m_workqueue.size() > 0 ) {
+               pWork = m_workqueue.front();
+               m_workqueue.pop();
+               _UnlockedDispatch uld(this, pWork);
+            }
+         } while ( ( NULL != m_pWS ) && ( WSCollect() > 0 ) );
 
          WorkerIsSelfTerminating(pThread);
       }
@@ -1046,11 +1547,13 @@ btBool OSLThreadGroup::ThrGrpState::Destroy(btTime Timeout)
          flag_setf(m_Flags, THRGRPSTATE_FLAG_SELF_JOIN);
 
          IDispatchable *pWork;
-         while ( m_workqueue.size() > 0 ) {
-            pWork = m_workqueue.front();
-            m_workqueue.pop();
-            _UnlockedDispatch uld(this, pWork);
-         }
+         do {
+            while ( m_workqueue.size() > 0 ) {
+               pWork = m_workqueue.front();
+               m_workqueue.pop();
+               _UnlockedDispatch uld(this, pWork);
+            }
+         } while ( ( NULL != m_pWS ) && ( WSCollect() > 0 ) );
 
          WorkerIsSelfTerminating(pThread);
       }
@@ -0,0 +1,498 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ThreadPlacement.cpp
+/// @brief CPU affinity and NUMA placement for OSLThread's.
+/// @ingroup OSAL
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/osal/ThreadPlacement.h"
+#include "aalsdk/osal/CriticalSection.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#if   defined( __AAL_LINUX__ )
+# include <dirent.h>
+#elif defined( __AAL_WINDOWS__ )
+# include <initguid.h>
+# include <devpkey.h>
+# include <setupapi.h>
+#endif // OS
+
+
+BEGIN_NAMESPACE(AAL)
+
+//=============================================================================
+// CpuSet
+//=============================================================================
+CpuSet::CpuSet()
+{
+   Clear();
+}
+
+void CpuSet::Add(btUnsignedInt Cpu)
+{
+   if ( Cpu < MaxCpus ) {
+      m_Bits[Cpu / 64] |= (btUnsigned64bitInt)1 << (Cpu % 64);
+   }
+}
+
+void CpuSet::Remove(btUnsignedInt Cpu)
+{
+   if ( Cpu < MaxCpus ) {
+      m_Bits[Cpu / 64] &= ~( (btUnsigned64bitInt)1 << (Cpu % 64) );
+   }
+}
+
+void CpuSet::Clear()
+{
+   memset(m_Bits, 0, sizeof(m_Bits));
+}
+
+btBool CpuSet::Has(btUnsignedInt Cpu) const
+{
+   if ( Cpu >= MaxCpus ) {
+      return false;
+   }
+   return 0 != ( m_Bits[Cpu / 64] & ( (btUnsigned64bitInt)1 << (Cpu % 64) ) );
+}
+
+btBool CpuSet::IsEmpty() const
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < sizeof(m_Bits) / sizeof(m_Bits[0]) ; ++i ) {
+      if ( 0 != m_Bits[i] ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+btUnsignedInt CpuSet::Count() const
+{
+   btUnsignedInt c = 0;
+   btUnsignedInt i;
+   for ( i = 0 ; i < MaxCpus ; ++i ) {
+      if ( Has(i) ) {
+         ++c;
+      }
+   }
+   return c;
+}
+
+btBool CpuSet::FromList(btcString List)
+{
+   Clear();
+
+   if ( NULL == List ) {
+      return false;
+   }
+
+   const char *p = List;
+
+   while ( ( ' ' == *p ) || ( '\t' == *p ) ) {
+      ++p;
+   }
+
+   while ( ( '\0' != *p ) && ( '\n' != *p ) ) {
+      char *end = NULL;
+
+      if ( ( *p < '0' ) || ( *p > '9' ) ) {
+         Clear();
+         return false;
+      }
+      unsigned long first = strtoul(p, &end, 10);
+      unsigned long last  = first;
+      p = end;
+
+      if ( '-' == *p ) {
+         ++p;
+         if ( ( *p < '0' ) || ( *p > '9' ) ) {
+            Clear();
+            return false;
+         }
+         last = strtoul(p, &end, 10);
+         p = end;
+      }
+
+      if ( ( last < first ) || ( last >= MaxCpus ) ) {
+         Clear();
+         return false;
+      }
+
+      for ( ; first <= last ; ++first ) {
+         Add((btUnsignedInt)first);
+      }
+
+      if ( ',' == *p ) {
+         ++p;
+      } else if ( ( '\0' != *p ) && ( '\n' != *p ) ) {
+         Clear();
+         return false;
+      }
+   }
+
+   return true;
+}
+
+std::string CpuSet::ToList() const
+{
+   std::ostringstream oss;
+   btUnsignedInt      i = 0;
+
+   while ( i < MaxCpus ) {
+      if ( !Has(i) ) {
+         ++i;
+         continue;
+      }
+
+      btUnsignedInt last = i;
+      while ( ( last + 1 < MaxCpus ) && Has(last + 1) ) {
+         ++last;
+      }
+
+      if ( !oss.str().empty() ) {
+         oss << ',';
+      }
+      oss << i;
+      if ( last > i ) {
+         oss << '-' << last;
+      }
+
+      i = last + 1;
+   }
+
+   return oss.str();
+}
+
+btBool CpuSet::operator == (const CpuSet &rOther) const
+{
+   return 0 == memcmp(m_Bits, rOther.m_Bits, sizeof(m_Bits));
+}
+
+//=============================================================================
+// ThreadPlacement
+//=============================================================================
+ThreadPlacement::ThreadPlacement() :
+   m_ePolicy(Anywhere),
+   m_Node(-1),
+   m_Cpus()
+{}
+
+ThreadPlacement::ThreadPlacement(const CpuSet &Cpus) :
+   m_ePolicy(OnCpus),
+   m_Node(-1),
+   m_Cpus(Cpus)
+{}
+
+ThreadPlacement::ThreadPlacement(Policy ePolicy, btInt Node) :
+   m_ePolicy(ePolicy),
+   m_Node(Node),
+   m_Cpus()
+{
+   if ( Node >= 0 ) {
+      m_ePolicy = OnNode;
+   } else if ( ( OnNode == ePolicy ) || ( OnCpus == ePolicy ) ) {
+      // No node and no CPUs: nothing to bind to.
+      m_ePolicy = Anywhere;
+   }
+}
+
+btBool ThreadPlacement::Resolve(CpuSet &Cpus, btInt &Node) const
+{
+   Cpus.Clear();
+   Node = -1;
+
+   switch ( m_ePolicy ) {
+      case OnCpus : {
+         Cpus = m_Cpus;
+      } break;
+
+      case OnNode : {
+         if ( NodeCpus(m_Node, Cpus) ) {
+            Node = m_Node;
+         }
+      } break;
+
+      case NearDevice : {
+         const btInt n = DeviceNode();
+         if ( ( n >= 0 ) && NodeCpus(n, Cpus) ) {
+            Node = n;
+         }
+      } break;
+
+      default : break;
+   }
+
+   return !Cpus.IsEmpty();
+}
+
+btBool ThreadPlacement::FromString(btcString Str)
+{
+   if ( NULL == Str ) {
+      return false;
+   }
+
+   if ( 0 == strcmp(Str, "anywhere") ) {
+      *this = ThreadPlacement();
+      return true;
+   }
+
+   if ( 0 == strcmp(Str, "near-device") ) {
+      *this = ThreadPlacement(NearDevice);
+      return true;
+   }
+
+   if ( 0 == strncmp(Str, "node:", 5) ) {
+      const char *p   = Str + 5;
+      char       *end = NULL;
+      if ( ( *p < '0' ) || ( *p > '9' ) ) {
+         return false;
+      }
+      long n = strtol(p, &end, 10);
+      if ( ( '\0' != *end ) || ( n > 1023 ) ) {
+         return false;
+      }
+      *this = ThreadPlacement(OnNode, (btInt)n);
+      return true;
+   }
+
+   if ( 0 == strncmp(Str, "cpus:", 5) ) {
+      CpuSet cpus;
+      if ( !cpus.FromList(Str + 5) || cpus.IsEmpty() ) {
+         return false;
+      }
+      *this = ThreadPlacement(cpus);
+      return true;
+   }
+
+   return false;
+}
+
+std::string ThreadPlacement::ToString() const
+{
+   std::ostringstream oss;
+
+   switch ( m_ePolicy ) {
+      case OnCpus     : oss << "cpus:" << m_Cpus.ToList(); break;
+      case OnNode     : oss << "node:" << m_Node;          break;
+      case NearDevice : oss << "near-device";              break;
+      default         : oss << "anywhere";                 break;
+   }
+
+   return oss.str();
+}
+
+// The PCI device id's claimed by the CCI-P driver (aalkernel/cci_PCIe_driver).
+static btBool IsCCIPDeviceId(unsigned long id)
+{
+   static const unsigned long Ids[] = {
+      0xBCBD, 0xBCBE, 0xBCBC, // RCiEP0, RCiEP1, RCiEP2
+      0xBCC0, 0xBCC1,         // SKX-P PF, VF
+      0x09C4, 0x09C5          // DCP PF, VF
+   };
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < sizeof(Ids) / sizeof(Ids[0]) ; ++i ) {
+      if ( Ids[i] == id ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+#if defined( __AAL_LINUX__ )
+
+// Reads the first line of a sysfs attribute.
+static btBool ReadSysfsLine(const std::string &Path, char *pBuf, size_t Len)
+{
+   FILE *fp = fopen(Path.c_str(), "r");
+   if ( NULL == fp ) {
+      return false;
+   }
+   const btBool res = ( NULL != fgets(pBuf, (int)Len, fp) );
+   fclose(fp);
+   return res;
+}
+
+// The NUMA node of the PCI device at sysfs directory Dir, or -1.
+static btInt PciDeviceNode(const std::string &Dir)
+{
+   char buf[32];
+   if ( !ReadSysfsLine(Dir + "/numa_node", buf, sizeof(buf)) ) {
+      return -1;
+   }
+   return (btInt)strtol(buf, NULL, 10);
+}
+
+// Whether the PCI device at sysfs directory Dir is one the CCI-P driver claims.
+static btBool IsCCIPDevice(const std::string &Dir)
+{
+   char buf[32];
+   if ( !ReadSysfsLine(Dir + "/vendor", buf, sizeof(buf)) || ( 0x8086 != strtoul(buf, NULL, 16) ) ) {
+      return false;
+   }
+   if ( !ReadSysfsLine(Dir + "/device", buf, sizeof(buf)) ) {
+      return false;
+   }
+
+   return IsCCIPDeviceId(strtoul(buf, NULL, 16));
+}
+
+btInt ThreadPlacement::DeviceNode()
+{
+   static const char *Devices = "/sys/bus/pci/devices";
+
+   DIR *d = opendir(Devices);
+   if ( NULL == d ) {
+      return -1;
+   }
+
+   btInt          Node = -1;
+   struct dirent *e;
+   while ( ( -1 == Node ) && ( NULL != ( e = readdir(d) ) ) ) {
+      if ( '.' == e->d_name[0] ) {
+         continue;
+      }
+      const std::string Dir = std::string(Devices) + "/" + e->d_name;
+      if ( IsCCIPDevice(Dir) ) {
+         Node = PciDeviceNode(Dir);
+      }
+   }
+
+   closedir(d);
+   return Node;
+}
+
+btBool ThreadPlacement::NodeCpus(btInt Node, CpuSet &Cpus)
+{
+   Cpus.Clear();
+
+   if ( Node < 0 ) {
+      return false;
+   }
+
+   std::ostringstream path;
+   path << "/sys/devices/system/node/node" << Node << "/cpulist";
+
+   char buf[4096];
+   if ( !ReadSysfsLine(path.str(), buf, sizeof(buf)) ) {
+      return false;
+   }
+
+   return Cpus.FromList(buf) && !Cpus.IsEmpty();
+}
+
+#elif defined( __AAL_WINDOWS__ )
+
+btInt ThreadPlacement::DeviceNode()
+{
+   HDEVINFO DevInfo = SetupDiGetClassDevsA(NULL, "PCI", NULL, DIGCF_ALLCLASSES | DIGCF_PRESENT);
+   if ( INVALID_HANDLE_VALUE == DevInfo ) {
+      return -1;
+   }
+
+   btInt           Node = -1;
+   SP_DEVINFO_DATA Dev;
+   DWORD           i;
+
+   Dev.cbSize = sizeof(Dev);
+   for ( i = 0 ; ( -1 == Node ) && SetupDiEnumDeviceInfo(DevInfo, i, &Dev) ; ++i ) {
+      // The first hardware id is the most specific one, PCI\VEN_8086&DEV_xxxx&SUBSYS_...
+      char HwIds[512];
+      if ( !SetupDiGetDeviceRegistryPropertyA(DevInfo, &Dev, SPDRP_HARDWAREID, NULL,
+                                              (PBYTE)HwIds, sizeof(HwIds), NULL) ) {
+         continue;
+      }
+      HwIds[sizeof(HwIds) - 1] = '\0';
+      if ( ( 0 != _strnicmp(HwIds, "PCI\\VEN_8086&DEV_", 17) ) ||
+           !IsCCIPDeviceId(strtoul(HwIds + 17, NULL, 16)) ) {
+         continue;
+      }
+
+      DEVPROPTYPE Type   = DEVPROP_TYPE_EMPTY;
+      ULONG       Domain = 0;
+      UCHAR       n      = 0;
+      if ( SetupDiGetDevicePropertyW(DevInfo, &Dev, &DEVPKEY_Numa_Proximity_Domain, &Type,
+                                     (PBYTE)&Domain, sizeof(Domain), NULL, 0) &&
+           ( DEVPROP_TYPE_UINT32 == Type ) &&
+           GetNumaProximityNode(Domain, &n) ) {
+         Node = (btInt)n;
+      }
+   }
+
+   SetupDiDestroyDeviceInfoList(DevInfo);
+   return Node;
+}
+
+btBool ThreadPlacement::NodeCpus(btInt Node, CpuSet &Cpus)
+{
+   Cpus.Clear();
+
+   ULONGLONG Mask = 0;
+   if ( ( Node < 0 ) || ( Node > 0xff ) || !GetNumaNodeProcessorMask((UCHAR)Node, &Mask) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 64 ; ++i ) {
+      if ( Mask & ( (ULONGLONG)1 << i ) ) {
+         Cpus.Add(i);
+      }
+   }
+
+   return !Cpus.IsEmpty();
+}
+
+#endif // OS
+
+static CriticalSection gSDKPlacementLock;
+static ThreadPlacement gSDKPlacement;
+
+ThreadPlacement ThreadPlacement::SDKDefault()
+{
+   AutoLock(&gSDKPlacementLock);
+   return gSDKPlacement;
+}
+
+void ThreadPlacement::SDKDefault(const ThreadPlacement &Placement)
+{
+   AutoLock(&gSDKPlacementLock);
+   gSDKPlacement = Placement;
+}
+
+END_NAMESPACE(AAL)
+
@@ -182,7 +182,8 @@ btBool CResourceManager::init( IBase *pclientBase,
       // Kick off the polling loop on the Proxy
       m_pProxyPoll = new OSLThread( CResourceManager::ProxyPollThread,
                                     OSLThread::THREADPRIORITY_NORMAL,
-                                    this);
+                                    this,
+                                    ThreadPlacement::SDKDefault());
       if(NULL == m_pProxyPoll){
          m_RMProxy.Close();
          initFailed(new CExceptionTransactionEvent( NULL,
@@ -530,7 +531,8 @@ void CResourceManager::serviceAllocated(IBase               *pServiceBase,
          // Kick off the polling loop on the Proxy
          m_pProxyPoll = new OSLThread( CResourceManager::ProxyPollThread,
                                        OSLThread::THREADPRIORITY_NORMAL,
-                                       this);
+                                       this,
+                                       ThreadPlacement::SDKDefault());
          if(NULL == m_pProxyPoll){
             m_RMProxy.Close();
             initFailed(new CExceptionTransactionEvent( NULL,
@@ -45,6 +45,7 @@
 #include "aalsdk/AALIDDefs.h"
 #include "aalsdk/kernel/aalrm_client.h"
 #include "aalsdk/AALLoggerExtern.h"          // Logger
+#include "aalsdk/AALNVSBinary.h"
 
 
 
@@ -295,18 +296,28 @@ btBool CResourceManagerProxy::SendRequest(NamedValueSet const   &nvsManifest,
 
    memset(&req, 0, sizeof(req));
 
-   // Marshal the NVS into an ostringstream
-   std::string        temp(nvsManifest);
-   btUnsigned32bitInt len  = temp.length();
+   // Marshal the NVS as text, or in the binary form of AALNVSBinary.h if NVSBinaryOnWire().
+   //    The Resource Manager replies in the same form.
+   std::string temp;
+   btWSSize    len    = NVSBinaryOnWire() ? NVSBinarySize(nvsManifest) : 0;
+   btBool      binary = ( 0 != len );
+   if ( !binary ) {
+      temp = std::string(nvsManifest);
+      len  = temp.length();
+   }
 
-   btVirtAddr buf = (btVirtAddr)new(std::nothrow) btByte[len];
+   btVirtAddr buf = ( 0 == len ) ? NULL : (btVirtAddr)new(std::nothrow) btByte[(size_t)len];
 
    if(NULL == buf){
       m_bIsOK = false;
       return IsOK();
    }
 
-   BufFromString(buf, temp);
+   if ( binary ) {
+      NVSToBinary(nvsManifest, buf, len, &len);
+   } else {
+      BufFromString(buf, temp);
+   }
 
    req.id      = reqid_URMS_RequestDevice;
    req.size    = len;
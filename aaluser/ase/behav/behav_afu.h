@@ -0,0 +1,111 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Behavioral AFU model interface
+ * Language   : C++
+ *
+ * The behavioral backend stands in for the RTL simulator: it speaks the
+ * simulator side of the ASE IPC protocol and hands MMIO, UMsg and reset
+ * traffic to an AFU model written in C++. The model reaches system
+ * memory through the backend, one cache line at a time.
+ */
+
+#ifndef _BEHAV_AFU_H_
+#define _BEHAV_AFU_H_
+
+#include <stdint.h>
+
+// Backend time is in picoseconds since the backend started
+#define BEHAV_PS_PER_NS      1000ULL
+#define BEHAV_PS_PER_US      1000000ULL
+
+// Cache line size in bytes
+#define BEHAV_CL_BYTES       64
+
+
+/*
+ * Services the backend offers an AFU model
+ * - Memory is addressed by cache line address (physical address >> 6), as
+ *   on CCI-P
+ * - ReadLine/WriteLine move the data immediately and return the time at
+ *   which the request completes, under the configured latency and
+ *   bandwidth. A request issued before its channel is free waits for it.
+ */
+class IBehavHost
+{
+ public:
+  virtual ~IBehavHost() {}
+
+  // Current time
+  virtual uint64_t Now() = 0;
+
+  // Earliest time at which the read/write channel accepts a request
+  virtual uint64_t ReadIssue() = 0;
+  virtual uint64_t WriteIssue() = 0;
+
+  // Issue a cache line read/write at time 'when', returns completion time
+  virtual uint64_t ReadLine(uint64_t cl_addr, void *data, uint64_t when) = 0;
+  virtual uint64_t WriteLine(uint64_t cl_addr, const void *data, uint64_t when) = 0;
+
+  // AFU clock in MHz, for models that count cycles
+  virtual double UsrClkMHz() = 0;
+};
+
+
+/*
+ * Behavioral AFU model
+ * - MMIO offsets are byte offsets from the AFU base, as in mmio_t
+ * - Clock() is called continuously between IPC polls. It should do a
+ *   bounded amount of work and return true while it has work in flight,
+ *   so that the backend knows when it may sleep.
+ */
+class IBehavAFU
+{
+ public:
+  virtual ~IBehavAFU() {}
+
+  // AFU reset (also called between sessions)
+  virtual void Reset() = 0;
+
+  // MMIO access, width is 32 or 64 (MMIO_WIDTH_32, MMIO_WIDTH_64)
+  virtual uint64_t MMIORead(uint32_t offset, int width) = 0;
+  virtual void MMIOWrite(uint32_t offset, int width, uint64_t data) = 0;
+
+  // UMsg with its hint bit and the 8 qwords of the UMsg line
+  virtual void UMsg(int id, int hint, const uint64_t *qword) = 0;
+
+  virtual bool Clock(IBehavHost *host) = 0;
+};
+
+
+/*
+ * AFU models
+ * - Add new models to the table in behav_backend.cpp
+ */
+IBehavAFU *behav_nlb_create();
+
+#endif // _BEHAV_AFU_H_
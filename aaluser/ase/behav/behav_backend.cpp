@@ -0,0 +1,632 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Behavioral backend (ASE without an RTL simulator)
+ * Language   : C++
+ *
+ * Serves the simulator side of the ASE IPC protocol, so that an unchanged
+ * application linked with libASE runs against a C++ AFU model:
+ * - Port control: ASE_INIT, AFU_RESET, UMSG_MODE, ASE_SIMKILL
+ * - Buffer allocate/deallocate, through the ASE memory model
+ * - MMIO requests, answered by the AFU model
+ * - UMsgs, handed to the AFU model
+ *
+ * Latency and bandwidth can be injected on the read and write channels
+ * and on MMIO. Without them, requests complete as fast as the host runs.
+ *
+ * USAGE: Run ase_behav in the directory that ASE_WORKDIR will point to,
+ *        then start the application. See 'ase_behav --help'.
+ */
+
+#include <getopt.h>
+
+#include <deque>
+
+extern "C" {
+#include "ase_common.h"
+}
+
+#include "behav_afu.h"
+#include "behav_channel.h"
+
+// Idle backend sleeps this long between polls, once ase_spin_polls() are used up
+#define BEHAV_IDLE_USEC      20
+
+
+/*
+ * AFU model table
+ */
+struct behav_afu_entry
+{
+  const char *name;
+  IBehavAFU  *(*create)();
+  const char *description;
+};
+
+static const struct behav_afu_entry behav_afu_table[] =
+{
+  { "nlb", behav_nlb_create, "Native loopback: LPBK1, READ, WRITE, TRPUT (fpgadiag, NLB samples)" },
+};
+
+#define BEHAV_NUM_AFUS (sizeof(behav_afu_table) / sizeof(behav_afu_table[0]))
+
+
+/*
+ * MMIO response waiting for its injected latency
+ */
+struct behav_mmio_rsp
+{
+  uint64_t due;
+  mmio_t   pkt;
+};
+
+
+class BehavBackend : public IBehavHost
+{
+ public:
+  BehavBackend() :
+    m_afu(NULL),
+    m_usr_clk_mhz(400.0),
+    m_mmio_latency(0),
+    m_one_shot(false),
+    m_trace(false),
+    m_umsg_mode(0)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &m_t0);
+  }
+
+  // Configuration
+  IBehavAFU    *m_afu;
+  BehavChannel  m_rd;
+  BehavChannel  m_wr;
+  double        m_usr_clk_mhz;
+  uint64_t      m_mmio_latency;
+  bool          m_one_shot;
+  bool          m_trace;
+
+  // IBehavHost
+  virtual uint64_t Now()
+  {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)(ts.tv_sec - m_t0.tv_sec) * 1000000000ULL * BEHAV_PS_PER_NS +
+      (uint64_t)(ts.tv_nsec - m_t0.tv_nsec) * BEHAV_PS_PER_NS;
+  }
+
+  virtual uint64_t ReadIssue()  { return m_rd.FreeAt(); }
+  virtual uint64_t WriteIssue() { return m_wr.FreeAt(); }
+
+  virtual uint64_t ReadLine(uint64_t cl_addr, void *data, uint64_t when)
+  {
+    memcpy(data, ase_fakeaddr_to_vaddr(cl_addr << 6), BEHAV_CL_BYTES);
+    uint64_t done = m_rd.Issue(when);
+    if (m_trace)
+      {
+        TraceLine(CCIP_TRACE_CH_RD, CCIP_TRACE_RDLINE_I, cl_addr, when, done);
+      }
+    return done;
+  }
+
+  virtual uint64_t WriteLine(uint64_t cl_addr, const void *data, uint64_t when)
+  {
+    memcpy(ase_fakeaddr_to_vaddr(cl_addr << 6), data, BEHAV_CL_BYTES);
+    __sync_synchronize();
+    uint64_t done = m_wr.Issue(when);
+    if (m_trace)
+      {
+        TraceLine(CCIP_TRACE_CH_WR, CCIP_TRACE_WRLINE_I, cl_addr, when, done);
+      }
+    return done;
+  }
+
+  virtual double UsrClkMHz() { return m_usr_clk_mhz; }
+
+  // Backend time in AFU clock cycles, for the CCI-P trace
+  uint64_t Cycles(uint64_t ps) { return (uint64_t)((double)ps * m_usr_clk_mhz / (double)BEHAV_PS_PER_US); }
+
+  int  Listen();
+  bool MMIORespond();
+
+ private:
+  void PortControl(char *msg);
+  void Alloc(struct buffer_t *buf);
+  void Dealloc(struct buffer_t *buf);
+  void MMIORequest(mmio_t *pkt);
+  void SessionEnd();
+  void TraceLine(int channel, int reqtype, uint64_t cl_addr, uint64_t when, uint64_t done);
+
+  struct timespec             m_t0;
+  int                         m_umsg_mode;
+  std::deque<behav_mmio_rsp>  m_mmio_rsp;
+};
+
+static BehavBackend *behav;
+
+// Port CSRs in the MMIO region, as initialize_fme_dfh() in protocol_backend.c
+static uint64_t *behav_port_vbase;
+
+
+// -----------------------------------------------------------------------
+// Port control message: "<cmd> <value>", always answered with COMPLETED
+// -----------------------------------------------------------------------
+void BehavBackend::PortControl(char *msg)
+{
+  char cmd[ASE_MQ_MSGSIZE];
+  int value = 0;
+
+  memset(cmd, 0, ASE_MQ_MSGSIZE);
+  sscanf(msg, "%s %d", cmd, &value);
+
+  if (memcmp(cmd, "AFU_RESET", 9) == 0)
+    {
+      if (value != 0)
+        {
+          m_afu->Reset();
+          m_mmio_rsp.clear();
+        }
+    }
+  else if (memcmp(cmd, "UMSG_MODE", 9) == 0)
+    {
+      m_umsg_mode = value;
+      printf("BEHAV : UMSG Mode mask set to 0x%x\n", m_umsg_mode);
+    }
+  else if (memcmp(cmd, "ASE_INIT", 8) == 0)
+    {
+      printf("BEHAV : Session requested by PID = %d\n", value);
+      put_timestamp();
+      snprintf(tstamp_filepath, ASE_FILEPATH_LEN, "%s/%s", ase_workdir_path, TSTAMP_FILENAME);
+    }
+  else if (memcmp(cmd, "ASE_SIMKILL", 11) == 0)
+    {
+      mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg, ASE_MQ_MSGSIZE);
+      SessionEnd();
+      return;
+    }
+  else
+    {
+      BEGIN_RED_FONTCOLOR;
+      printf("BEHAV : Undefined Port Control function ... IGNORING\n");
+      END_RED_FONTCOLOR;
+    }
+
+  mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg, ASE_MQ_MSGSIZE);
+}
+
+
+// -----------------------------------------------------------------------
+// Application closed its session: free its buffers and reset the AFU, or
+// exit in one-shot mode
+// -----------------------------------------------------------------------
+void BehavBackend::SessionEnd()
+{
+  mqueue_ring_detach();
+
+  if (m_one_shot)
+    {
+      printf("BEHAV : Session ended, exiting (one-shot mode)\n");
+      start_simkill_countdown();
+    }
+
+  ase_destroy();
+  m_afu->Reset();
+  m_mmio_rsp.clear();
+  behav_port_vbase = NULL;
+
+  BEGIN_GREEN_FONTCOLOR;
+  printf("BEHAV : Ready to run next test\n");
+  END_GREEN_FONTCOLOR;
+}
+
+
+// -----------------------------------------------------------------------
+// Buffer allocation: map the buffer, give it a physical address, reply
+// -----------------------------------------------------------------------
+void BehavBackend::Alloc(struct buffer_t *buf)
+{
+  ase_alloc_action(buf);
+  buf->is_privmem = 0;
+  buf->is_mmiomap = (buf->index == 0) ? 1 : 0;
+
+  if (buf->is_mmiomap)
+    {
+      // MMIO map: fill in the port CSRs
+      behav_port_vbase = (uint64_t*)buf->pbase;
+      behav_port_vbase[0x0030/8] = (0x100 << 23);
+      behav_port_vbase[0x2000/8] = (0x3ULL << 60) | (0x1000ULL << 39) | 0x11;
+      behav_port_vbase[0x2008/8] = 0x8;
+      behav_port_vbase[0x2018/8] = 0x0;
+    }
+  else if (buf->is_umas && (behav_port_vbase != NULL))
+    {
+      // UMSG_BASE_ADDRESS
+      behav_port_vbase[0x2010/8] = buf->pbase;
+    }
+
+  ase_buffer_oneline(buf);
+}
+
+
+void BehavBackend::Dealloc(struct buffer_t *buf)
+{
+  if (buf->index == 0)
+    {
+      behav_port_vbase = NULL;
+    }
+  ase_dealloc_action(buf, 1);
+  buf->valid = ASE_BUFFER_INVALID;
+  ase_buffer_oneline(buf);
+}
+
+
+// -----------------------------------------------------------------------
+// CCI-P trace record for a memory request issued at 'when'
+// -----------------------------------------------------------------------
+void BehavBackend::TraceLine(int channel, int reqtype, uint64_t cl_addr, uint64_t when, uint64_t done)
+{
+  struct ccip_trace_rec_t rec;
+
+  memset(&rec, 0, sizeof(rec));
+  rec.tstamp  = Cycles(done);
+  rec.cl_addr = cl_addr;
+  rec.latency = (uint32_t)(Cycles(done) - Cycles(when));
+  rec.channel = (uint8_t)channel;
+  rec.vc      = CCIP_TRACE_VC_VA;
+  rec.reqtype = (uint8_t)reqtype;
+  ccip_trace_write(&rec);
+}
+
+
+// -----------------------------------------------------------------------
+// MMIO request: reads are answered with data, writes for credit only,
+// both after the injected MMIO latency
+// -----------------------------------------------------------------------
+void BehavBackend::MMIORequest(mmio_t *pkt)
+{
+  behav_mmio_rsp rsp;
+
+  if (m_trace)
+    {
+      ccip_trace_mmio_request(Cycles(Now()), pkt);
+    }
+
+  if (pkt->write_en == MMIO_WRITE_REQ)
+    {
+      m_afu->MMIOWrite((uint32_t)pkt->addr, pkt->width, (uint64_t)pkt->qword[0]);
+    }
+  else
+    {
+      pkt->qword[0] = (long long)m_afu->MMIORead((uint32_t)pkt->addr, pkt->width);
+      memset(&pkt->qword[1], 0, 7 * sizeof(pkt->qword[0]));
+    }
+  pkt->resp_en = 1;
+
+  if (m_mmio_latency == 0)
+    {
+      if (m_trace)
+        {
+          ccip_trace_mmio_response(Cycles(Now()), pkt);
+        }
+      mqueue_send(sim2app_mmiorsp_tx, (char*)pkt, sizeof(mmio_t));
+    }
+  else
+    {
+      rsp.due = Now() + m_mmio_latency;
+      rsp.pkt = *pkt;
+      m_mmio_rsp.push_back(rsp);
+    }
+}
+
+
+// Send MMIO responses whose latency has passed. Returns true if any are waiting.
+bool BehavBackend::MMIORespond()
+{
+  if (m_mmio_rsp.empty())
+    {
+      return false;
+    }
+
+  uint64_t now = Now();
+  while (!m_mmio_rsp.empty() && (m_mmio_rsp.front().due <= now))
+    {
+      if (m_trace)
+        {
+          ccip_trace_mmio_response(Cycles(now), &m_mmio_rsp.front().pkt);
+        }
+      mqueue_send(sim2app_mmiorsp_tx, (char*)&m_mmio_rsp.front().pkt, sizeof(mmio_t));
+      m_mmio_rsp.pop_front();
+    }
+  return true;
+}
+
+
+// -----------------------------------------------------------------------
+// Poll every app2sim channel once, as ase_listener() does each clock.
+// Returns the number of messages served.
+// -----------------------------------------------------------------------
+int BehavBackend::Listen()
+{
+  char msg[ASE_MQ_MSGSIZE];
+  struct buffer_t buf;
+  mmio_t mmio_pkt;
+  umsgcmd_t umsg_pkt;
+  int served = 0;
+
+  if (mqueue_recv(app2sim_portctrl_req_rx, msg, ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT)
+    {
+      PortControl(msg);
+      served++;
+    }
+
+  ase_empty_buffer(&buf);
+  if (mqueue_recv(app2sim_alloc_rx, msg, ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT)
+    {
+      memcpy(&buf, msg, sizeof(struct buffer_t));
+      Alloc(&buf);
+      served++;
+    }
+
+  ase_empty_buffer(&buf);
+  if (mqueue_recv(app2sim_dealloc_rx, msg, ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT)
+    {
+      memcpy(&buf, msg, sizeof(struct buffer_t));
+      Dealloc(&buf);
+      served++;
+    }
+
+  if (mqueue_recv(app2sim_mmioreq_rx, (char*)&mmio_pkt, sizeof(mmio_t)) == ASE_MSG_PRESENT)
+    {
+      MMIORequest(&mmio_pkt);
+      served++;
+    }
+
+  if (mqueue_recv(app2sim_umsg_rx, (char*)&umsg_pkt, sizeof(umsgcmd_t)) == ASE_MSG_PRESENT)
+    {
+      umsg_pkt.hint = (m_umsg_mode >> (4*umsg_pkt.id)) & 0xF;
+      m_afu->UMsg(umsg_pkt.id, umsg_pkt.hint, (const uint64_t*)umsg_pkt.qword);
+      served++;
+    }
+
+  return served;
+}
+
+
+// -----------------------------------------------------------------------
+// Teardown, called on CTRL-C, on fatal errors in the shared ASE code, and
+// at the end of a one-shot session
+// -----------------------------------------------------------------------
+void start_simkill_countdown()
+{
+  int ipc_iter;
+
+  self_destruct_in_progress = 1;
+  printf("BEHAV : Closing message queue and unlinking...\n");
+
+  mqueue_close(app2sim_alloc_rx);
+  mqueue_close(sim2app_alloc_tx);
+  mqueue_close(app2sim_mmioreq_rx);
+  mqueue_close(sim2app_mmiorsp_tx);
+  mqueue_close(app2sim_umsg_rx);
+  mqueue_close(app2sim_portctrl_req_rx);
+  mqueue_close(app2sim_dealloc_rx);
+  mqueue_close(sim2app_dealloc_tx);
+  mqueue_close(sim2app_portctrl_rsp_tx);
+  mqueue_close(sim2app_intr_request_tx);
+
+  for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+    mqueue_destroy(mq_array[ipc_iter].name);
+  mqueue_ring_destroy();
+
+  unlink(tstamp_filepath);
+  final_ipc_cleanup();
+  ccip_trace_close();
+  if (ase_ready_filepath != NULL)
+    {
+      unlink(ase_ready_filepath);
+    }
+
+  printf("BEHAV : Exiting\n");
+  exit(0);
+}
+
+
+// -----------------------------------------------------------------------
+// Command line
+// -----------------------------------------------------------------------
+static void behav_usage(const char *prog)
+{
+  unsigned int i;
+
+  printf("Usage: %s [OPTIONS]\n", prog);
+  printf("  Run in the directory that ASE_WORKDIR will point to.\n");
+  printf("  --afu=NAME               AFU model (default: %s)\n", behav_afu_table[0].name);
+  printf("  --rd-latency=NS          Read request latency\n");
+  printf("  --wr-latency=NS          Write request latency\n");
+  printf("  --rd-bandwidth=MB/s      Read channel bandwidth (0: unlimited)\n");
+  printf("  --wr-bandwidth=MB/s      Write channel bandwidth (0: unlimited)\n");
+  printf("  --mmio-latency=NS        MMIO response latency\n");
+  printf("  --usr-clk=MHz            AFU clock, for cycle counts (default: 400)\n");
+  printf("  --one-shot               Exit when the first application ends\n");
+  printf("  --trace                  Write the CCI-P binary trace to %s\n", CCIP_TRACE_FILENAME);
+  printf("  AFU models:\n");
+  for (i = 0; i < BEHAV_NUM_AFUS; i++)
+    {
+      printf("    %-8s %s\n", behav_afu_table[i].name, behav_afu_table[i].description);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+  static const struct option longopts[] =
+  {
+    { "afu",           required_argument, NULL, 'a' },
+    { "rd-latency",    required_argument, NULL, 'r' },
+    { "wr-latency",    required_argument, NULL, 'w' },
+    { "rd-bandwidth",  required_argument, NULL, 'R' },
+    { "wr-bandwidth",  required_argument, NULL, 'W' },
+    { "mmio-latency",  required_argument, NULL, 'm' },
+    { "usr-clk",       required_argument, NULL, 'c' },
+    { "one-shot",      no_argument,       NULL, '1' },
+    { "trace",         no_argument,       NULL, 't' },
+    { "help",          no_argument,       NULL, 'h' },
+    { NULL,            0,                 NULL, 0   }
+  };
+
+  const char *afu_name = behav_afu_table[0].name;
+  uint64_t rd_latency = 0, wr_latency = 0, rd_bw = 0, wr_bw = 0;
+  unsigned int i;
+  int opt;
+  int idle = 0;
+
+  behav = new BehavBackend();
+
+  while ((opt = getopt_long(argc, argv, "h", longopts, NULL)) != -1)
+    {
+      switch (opt)
+        {
+        case 'a': afu_name = optarg;                                              break;
+        case 'r': rd_latency = strtoull(optarg, NULL, 0);                         break;
+        case 'w': wr_latency = strtoull(optarg, NULL, 0);                         break;
+        case 'R': rd_bw = strtoull(optarg, NULL, 0);                              break;
+        case 'W': wr_bw = strtoull(optarg, NULL, 0);                              break;
+        case 'm': behav->m_mmio_latency = strtoull(optarg, NULL, 0) * BEHAV_PS_PER_NS; break;
+        case 'c': behav->m_usr_clk_mhz = strtod(optarg, NULL);                    break;
+        case '1': behav->m_one_shot = true;                                       break;
+        case 't': behav->m_trace = true;                                          break;
+        default:
+          behav_usage(argv[0]);
+          return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+  for (i = 0; i < BEHAV_NUM_AFUS; i++)
+    {
+      if (strcmp(afu_name, behav_afu_table[i].name) == 0)
+        {
+          behav->m_afu = behav_afu_table[i].create();
+        }
+    }
+  if (behav->m_afu == NULL)
+    {
+      BEGIN_RED_FONTCOLOR;
+      printf("BEHAV : Unknown AFU model '%s'\n", afu_name);
+      END_RED_FONTCOLOR;
+      behav_usage(argv[0]);
+      return 1;
+    }
+  behav->m_rd.Configure(rd_latency, rd_bw);
+  behav->m_wr.Configure(wr_latency, wr_bw);
+
+  setbuf(stdout, NULL);
+  self_destruct_in_progress = 0;
+
+  register_signal(SIGTERM, (void*)start_simkill_countdown);
+  register_signal(SIGINT , (void*)start_simkill_countdown);
+  register_signal(SIGQUIT, (void*)start_simkill_countdown);
+  register_signal(SIGHUP,  (void*)start_simkill_countdown);
+  register_signal(SIGSEGV, (void*)backtrace_handler);
+  register_signal(SIGBUS,  (void*)backtrace_handler);
+  register_signal(SIGABRT, (void*)backtrace_handler);
+  signal(SIGPIPE, SIG_IGN);
+
+  ase_pid = getpid();
+  printf("BEHAV : PID of behavioral backend is %d, AFU model is '%s'\n", ase_pid, afu_name);
+
+  // Defaults that ase.cfg would give the simulator
+  cfg = (struct ase_cfg_t *)ase_malloc(sizeof(struct ase_cfg_t));
+  cfg->ase_mode = behav->m_one_shot ? ASE_MODE_DAEMON_SW_SIMKILL : ASE_MODE_DAEMON_NO_SIMKILL;
+  cfg->ase_seed = 1234;
+  cfg->phys_memory_available_gb = 128;
+
+  completed_str_msg = (char*)ase_malloc(ASE_MQ_MSGSIZE);
+  snprintf(completed_str_msg, 10, "COMPLETED");
+
+  // IPCs, exactly as ase_init() sets them up
+  ipc_init();
+  printf("BEHAV : Current Directory located at =>\n");
+  printf("        %s\n", ase_workdir_path);
+  create_ipc_listfile();
+
+  for(i = 0; i < ASE_MQ_INSTANCES; i++)
+    mqueue_create(mq_array[i].name);
+
+  app2sim_alloc_rx        = mqueue_open(mq_array[0].name,  mq_array[0].perm_flag);
+  app2sim_mmioreq_rx      = mqueue_open(mq_array[1].name,  mq_array[1].perm_flag);
+  app2sim_umsg_rx         = mqueue_open(mq_array[2].name,  mq_array[2].perm_flag);
+  sim2app_alloc_tx        = mqueue_open(mq_array[3].name,  mq_array[3].perm_flag);
+  sim2app_mmiorsp_tx      = mqueue_open(mq_array[4].name,  mq_array[4].perm_flag);
+  app2sim_portctrl_req_rx = mqueue_open(mq_array[5].name,  mq_array[5].perm_flag);
+  app2sim_dealloc_rx      = mqueue_open(mq_array[6].name,  mq_array[6].perm_flag);
+  sim2app_dealloc_tx      = mqueue_open(mq_array[7].name,  mq_array[7].perm_flag);
+  sim2app_portctrl_rsp_tx = mqueue_open(mq_array[8].name,  mq_array[8].perm_flag);
+  sim2app_intr_request_tx = mqueue_open(mq_array[9].name,  mq_array[9].perm_flag);
+  mqueue_ring_create();
+
+  // Physical memory map, as calc_phys_memory_ranges()
+  sysmem_size = (uint64_t)cfg->phys_memory_available_gb << 30;
+  sysmem_phys_lo = 0;
+  sysmem_phys_hi = sysmem_size - 1;
+  PHYS_ADDR_PREFIX_MASK = ((sysmem_phys_hi >> MEMBUF_2MB_ALIGN) << MEMBUF_2MB_ALIGN);
+
+  ase_write_seed(cfg->ase_seed);
+  srand(cfg->ase_seed);
+
+  if (behav->m_trace)
+    {
+      cfg->enable_ccip_trace = 1;
+      ccip_trace_open(CCIP_TRACE_FILENAME, behav->m_usr_clk_mhz);
+    }
+
+  ase_write_lock_file();
+
+  BEGIN_GREEN_FONTCOLOR;
+  printf("BEHAV : Set env(ASE_WORKDIR) in terminal where application will run =>\n");
+  printf("        bash/zsh | export ASE_WORKDIR=%s\n", ase_workdir_path);
+  printf("        tcsh/csh | setenv ASE_WORKDIR %s\n", ase_workdir_path);
+  printf("BEHAV : Ready for simulation...\n");
+  printf("BEHAV : Press CTRL-C to close backend...\n");
+  END_GREEN_FONTCOLOR;
+
+  // Main loop: serve the application, let the AFU run, sleep when idle
+  for (;;)
+    {
+      int busy = behav->Listen();
+      busy |= behav->MMIORespond();
+      busy |= behav->m_afu->Clock(behav);
+
+      if (busy)
+        {
+          idle = 0;
+        }
+      else if (++idle > ase_spin_polls())
+        {
+          usleep(BEHAV_IDLE_USEC);
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Behavioral request channel model
+ * Language   : C++
+ *
+ * Shared by the behavioral backend and the trace replay in ccip_trace.
+ */
+
+#ifndef _BEHAV_CHANNEL_H_
+#define _BEHAV_CHANNEL_H_
+
+#include "behav_afu.h"
+
+/*
+ * Request channel with a fixed latency and a bandwidth limit
+ * - A request occupies the channel for one line time, and completes one
+ *   latency after it leaves the channel
+ */
+class BehavChannel
+{
+ public:
+  BehavChannel() :
+    m_latency(0),
+    m_line_time(0),
+    m_free_at(0)
+  {}
+
+  void Configure(uint64_t latency_ns, uint64_t mbytes_per_sec)
+  {
+    m_latency   = latency_ns * BEHAV_PS_PER_NS;
+    m_line_time = (mbytes_per_sec == 0) ? 0 : (BEHAV_CL_BYTES * BEHAV_PS_PER_US) / mbytes_per_sec;
+    m_free_at   = 0;
+  }
+
+  uint64_t FreeAt() const { return m_free_at; }
+
+  uint64_t Issue(uint64_t when)
+  {
+    uint64_t start = (when > m_free_at) ? when : m_free_at;
+    m_free_at = start + m_line_time;
+    return m_free_at + m_latency;
+  }
+
+ private:
+  uint64_t m_latency;
+  uint64_t m_line_time;
+  uint64_t m_free_at;
+};
+
+#endif // _BEHAV_CHANNEL_H_
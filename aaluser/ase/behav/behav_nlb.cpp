@@ -0,0 +1,403 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Behavioral NLB (native loopback) AFU
+ * Language   : C++
+ *
+ * Models the NLB test modes driven by fpgadiag and the NLB samples:
+ * LPBK1 (copy), READ, WRITE and TRPUT, each in one-shot or continuous
+ * mode. CSRs and the DSM layout follow aalsdk/utils/NLBVAFU.h.
+ *
+ * Not modeled: cache and VC hints, multi-line requests, strided access,
+ * write fences, and the SW/ATOMIC/LPBK3 modes. Every line is one read
+ * and/or one write; hints only change what the RTL puts on the wire.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "behav_afu.h"
+
+// AFU header (CCI-P DFH, type AFU, end of list) and NLB mode 0 AFU ID
+#define NLB_AFU_DFH             ( (0x1ULL << 60) | (0x1ULL << 40) )
+#define NLB_AFU_ID_H            0xD8424DC4A4A3C413ULL
+#define NLB_AFU_ID_L            0xF89E433683F9040BULL
+
+// CSRs (byte offsets)
+#define NLB_CSR_AFU_DFH         0x0000
+#define NLB_CSR_AFU_ID_L        0x0008
+#define NLB_CSR_AFU_ID_H        0x0010
+#define NLB_CSR_DSM_BASEL       0x0110
+#define NLB_CSR_SRC_ADDR        0x0120
+#define NLB_CSR_DST_ADDR        0x0128
+#define NLB_CSR_NUM_LINES       0x0130
+#define NLB_CSR_CTL             0x0138
+#define NLB_CSR_CFG             0x0140
+#define NLB_CSR_SPACE           0x0400
+
+// CSR_CTL bits
+#define NLB_CTL_RESET_N         0x1
+#define NLB_CTL_START           0x2
+#define NLB_CTL_STOP            0x4
+
+// CSR_CFG fields
+#define NLB_CFG_CONT            0x002
+#define NLB_CFG_MODE_MASK       0x01c
+#define NLB_CFG_MODE_LPBK1      0x000
+#define NLB_CFG_MODE_READ       0x004
+#define NLB_CFG_MODE_WRITE      0x008
+#define NLB_CFG_MODE_TRPUT      0x00c
+
+// DSM status line, at DSM base + 0x40
+#define NLB_DSM_STATUS_CL       1
+struct nlb_dsm_status
+{
+  uint32_t test_complete;
+  uint32_t test_error;
+  uint64_t num_clocks;
+  uint32_t num_reads;
+  uint32_t num_writes;
+  uint32_t start_overhead;
+  uint32_t end_overhead;
+  uint32_t mode_error[8];
+};
+
+// Lines issued per Clock() call, so that MMIO is served during long tests
+#define NLB_LINES_PER_CLOCK     64
+
+
+class BehavNLB : public IBehavAFU
+{
+ public:
+  BehavNLB()
+  {
+    Reset();
+  }
+
+  virtual void Reset()
+  {
+    memset(m_csr, 0, sizeof(m_csr));
+    m_ctl           = 0;
+    m_in_reset      = true;
+    m_write_afuid   = false;
+    m_running       = false;
+    m_stopping      = false;
+    m_start_pending = false;
+    m_cont          = false;
+    m_mode_error    = false;
+    m_mode          = NLB_CFG_MODE_LPBK1;
+    m_num_lines     = 0;
+    m_line          = 0;
+    m_num_reads     = 0;
+    m_num_writes    = 0;
+    m_start         = 0;
+    m_end           = 0;
+  }
+
+  virtual uint64_t MMIORead(uint32_t offset, int width)
+  {
+    uint64_t qword;
+
+    switch (offset & ~0x7)
+      {
+      case NLB_CSR_AFU_DFH:  qword = NLB_AFU_DFH;   break;
+      case NLB_CSR_AFU_ID_L: qword = NLB_AFU_ID_L;  break;
+      case NLB_CSR_AFU_ID_H: qword = NLB_AFU_ID_H;  break;
+      default:               qword = (offset < NLB_CSR_SPACE) ? m_csr[offset >> 3] : 0;
+      }
+
+    if (width == 32)
+      {
+        return (qword >> ((offset & 0x4) * 8)) & 0xFFFFFFFFULL;
+      }
+    return qword;
+  }
+
+  virtual void MMIOWrite(uint32_t offset, int width, uint64_t data)
+  {
+    if (offset >= NLB_CSR_SPACE)
+      {
+        return;
+      }
+
+    // 32-bit writes land in their half of the qword
+    uint64_t *csr = &m_csr[offset >> 3];
+    if (width == 32)
+      {
+        int shift = (offset & 0x4) * 8;
+        *csr = (*csr & ~(0xFFFFFFFFULL << shift)) | ((data & 0xFFFFFFFFULL) << shift);
+      }
+    else
+      {
+        *csr = data;
+      }
+
+    if ((offset & ~0x7) == NLB_CSR_CTL)
+      {
+        Control((uint32_t)m_csr[NLB_CSR_CTL >> 3]);
+      }
+  }
+
+  virtual void UMsg(int id, int hint, const uint64_t *qword)
+  {
+    // UMsgs only drive the SW mode, which is not modeled
+  }
+
+  virtual bool Clock(IBehavHost *host)
+  {
+    // Reset deasserted: the RTL writes its AFU ID to the first DSM line
+    if (m_write_afuid)
+      {
+        m_write_afuid = false;
+        if (Dsm() != 0)
+          {
+            uint64_t line[BEHAV_CL_BYTES / 8];
+            memset(line, 0, sizeof(line));
+            line[0] = NLB_AFU_ID_L;
+            line[1] = NLB_AFU_ID_H;
+            host->WriteLine(Dsm(), line, host->Now());
+          }
+        return true;
+      }
+
+    if (!m_running)
+      {
+        return false;
+      }
+
+    if (m_start_pending)
+      {
+        m_start_pending = false;
+        m_start = host->Now();
+        m_end   = m_start;
+      }
+
+    uint64_t now = host->Now();
+    int issued = 0;
+
+    // Issue lines while the channels keep up with real time
+    while ( !m_stopping && (issued < NLB_LINES_PER_CLOCK) &&
+            (m_cont || (m_line < m_num_lines)) )
+      {
+        // LPBK1 writes queue behind their reads, so only reads pace it
+        uint64_t when = m_start;
+        if (m_mode != NLB_CFG_MODE_WRITE)
+          {
+            when = Later(when, host->ReadIssue());
+          }
+        if ((m_mode == NLB_CFG_MODE_WRITE) || (m_mode == NLB_CFG_MODE_TRPUT))
+          {
+            when = Later(when, host->WriteIssue());
+          }
+        if (when > now)
+          {
+            break;
+          }
+
+        IssueLine(host, m_line % m_num_lines, when);
+        m_line++;
+        issued++;
+      }
+
+    // One-shot test issued all lines, or a continuous test was stopped
+    if (!m_cont && (m_line >= m_num_lines))
+      {
+        m_stopping = true;
+      }
+
+    if (m_stopping && (now >= m_end))
+      {
+        Complete(host, 0);
+      }
+
+    // Busy while a test runs, so that completions are not late by a sleep
+    return true;
+  }
+
+ private:
+  uint64_t Dsm()     { return m_csr[NLB_CSR_DSM_BASEL >> 3] >> 6; }
+  uint64_t Src()     { return m_csr[NLB_CSR_SRC_ADDR >> 3];       }
+  uint64_t Dst()     { return m_csr[NLB_CSR_DST_ADDR >> 3];       }
+
+  static uint64_t Later(uint64_t a, uint64_t b) { return (a > b) ? a : b; }
+
+  // CSR_CTL write. Start and stop act on the rising edge of their bits,
+  // software writes 3 to start and 7 to stop.
+  void Control(uint32_t ctl)
+  {
+    uint32_t rise = ctl & ~m_ctl;
+    m_ctl = ctl;
+
+    if ((ctl & NLB_CTL_RESET_N) == 0)
+      {
+        m_running  = false;
+        m_stopping = false;
+        m_in_reset = true;
+        return;
+      }
+
+    if (m_in_reset)
+      {
+        m_in_reset    = false;
+        m_write_afuid = true;
+      }
+
+    if ((rise & NLB_CTL_START) && !m_running)
+      {
+        uint32_t cfg = (uint32_t)m_csr[NLB_CSR_CFG >> 3];
+
+        m_mode          = cfg & NLB_CFG_MODE_MASK;
+        m_cont          = (cfg & NLB_CFG_CONT) != 0;
+        m_num_lines     = (uint32_t)m_csr[NLB_CSR_NUM_LINES >> 3];
+        m_line          = 0;
+        m_num_reads     = 0;
+        m_num_writes    = 0;
+        m_running       = true;
+        m_stopping      = false;
+        m_start_pending = true;
+
+        if ( (m_mode != NLB_CFG_MODE_LPBK1) && (m_mode != NLB_CFG_MODE_READ) &&
+             (m_mode != NLB_CFG_MODE_WRITE) && (m_mode != NLB_CFG_MODE_TRPUT) )
+          {
+            printf("BEHAV : NLB mode 0x%x is not modeled, test will report an error\n", cfg);
+            m_num_lines = 0;
+            m_mode_error = true;
+          }
+        else
+          {
+            m_mode_error = false;
+          }
+
+        if (m_num_lines == 0)
+          {
+            m_cont = false;
+          }
+      }
+
+    if ((rise & NLB_CTL_STOP) && m_running)
+      {
+        m_stopping = true;
+      }
+  }
+
+  // Read and/or write one line, as the test mode does
+  void IssueLine(IBehavHost *host, uint64_t idx, uint64_t when)
+  {
+    uint64_t line[BEHAV_CL_BYTES / 8];
+    uint64_t done = when;
+    int i;
+
+    switch (m_mode)
+      {
+      case NLB_CFG_MODE_LPBK1:
+        // The write carries the data read, so it is issued on completion
+        done = host->ReadLine(Src() + idx, line, when);
+        done = host->WriteLine(Dst() + idx, line, done);
+        m_num_reads++;
+        m_num_writes++;
+        break;
+
+      case NLB_CFG_MODE_READ:
+        done = host->ReadLine(Src() + idx, line, when);
+        m_num_reads++;
+        break;
+
+      case NLB_CFG_MODE_WRITE:
+      case NLB_CFG_MODE_TRPUT:
+        if (m_mode == NLB_CFG_MODE_TRPUT)
+          {
+            done = host->ReadLine(Src() + idx, line, when);
+            m_num_reads++;
+          }
+        for (i = 0; i < BEHAV_CL_BYTES / 8; i++)
+          {
+            line[i] = m_line;
+          }
+        done = Later(done, host->WriteLine(Dst() + idx, line, when));
+        m_num_writes++;
+        break;
+      }
+
+    m_end = Later(m_end, done);
+  }
+
+  // Post the test status to the DSM. The cycle count runs to the later of
+  // the modeled completion and now, as the host may be the slower one.
+  // The status is written with test_complete clear, then again with it
+  // set, so that software that sees test_complete sees the rest of the
+  // status too.
+  void Complete(IBehavHost *host, uint32_t test_error)
+  {
+    struct nlb_dsm_status status;
+    uint64_t line[BEHAV_CL_BYTES / 8];
+    uint64_t end = Later(m_end, host->Now());
+
+    memset(&status, 0, sizeof(status));
+    status.test_error = test_error | (m_mode_error ? 0x1 : 0x0);
+    status.num_clocks = (uint64_t)((double)(end - m_start) * host->UsrClkMHz() / (double)BEHAV_PS_PER_US);
+    status.num_reads  = m_num_reads;
+    status.num_writes = m_num_writes;
+
+    if (Dsm() != 0)
+      {
+        memset(line, 0, sizeof(line));
+        memcpy(line, &status, sizeof(status));
+        host->WriteLine(Dsm() + NLB_DSM_STATUS_CL, line, end);
+
+        status.test_complete = 1;
+        memcpy(line, &status, sizeof(status));
+        host->WriteLine(Dsm() + NLB_DSM_STATUS_CL, line, end);
+      }
+
+    m_running  = false;
+    m_stopping = false;
+  }
+
+  uint64_t m_csr[NLB_CSR_SPACE / 8];
+  uint32_t m_ctl;
+
+  bool     m_in_reset;
+  bool     m_write_afuid;
+  bool     m_running;
+  bool     m_stopping;
+  bool     m_start_pending;
+  bool     m_cont;
+  bool     m_mode_error;
+  uint32_t m_mode;
+  uint32_t m_num_lines;
+  uint64_t m_line;
+  uint32_t m_num_reads;
+  uint32_t m_num_writes;
+  uint64_t m_start;
+  uint64_t m_end;
+};
+
+
+IBehavAFU *behav_nlb_create()
+{
+  return new BehavNLB();
+}
@@ -0,0 +1,525 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: CCI-P binary trace analysis and replay
+ * Language   : C++
+ *
+ * Reads a trace written by ASE (ENABLE_CCIP_TRACE in ase.cfg) or by
+ * 'ase_behav --trace' and reports, per channel:
+ * - Bandwidth, from the first request to the last completion
+ * - Latency statistics and a log2 histogram
+ * - Outstanding request depth
+ * - Address locality (sequential lines, reuse, 4KB and 2MB pages)
+ *
+ * With --replay, the memory requests are re-issued at their captured
+ * times through the behavioral backend's channel model, and the replayed
+ * statistics are compared with the captured ones. Requests do not wait on
+ * each other in replay (open loop).
+ *
+ * USAGE: ccip_trace [--replay [model options]] TRACE, see --help
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ccip_trace.h"
+#include "behav_channel.h"
+
+// Latency histogram: bucket 0 is latency 0, bucket b is [2^(b-1), 2^b)
+#define TRACE_HIST_BUCKETS   33
+#define TRACE_HIST_BAR       40
+
+static const char *trace_ch_name[CCIP_TRACE_NUM_CH] = { "RD", "WR", "MMIO" };
+static const char *trace_vc_name[4] = { "VA", "VL0", "VH0", "VH1" };
+
+
+/*
+ * Statistics of one channel
+ */
+struct trace_stats
+{
+  uint64_t count;
+  uint64_t unmatched;          // Latency unknown
+  uint64_t lines;              // Cache lines moved (fences excluded)
+  uint64_t vc[4];
+  uint64_t mmio_reads;
+  uint64_t first_issue;
+  uint64_t last_done;
+  double   lat_mean;
+  uint32_t lat_min, lat_p50, lat_p90, lat_p99, lat_max;
+  uint64_t hist[TRACE_HIST_BUCKETS];
+  uint64_t depth_max;
+  double   depth_mean;
+  uint64_t sequential;
+  uint64_t distinct_lines;
+  uint64_t distinct_4k;
+  uint64_t distinct_2m;
+};
+
+
+static bool trace_read(const char *filename, struct ccip_trace_hdr_t *hdr, std::vector<ccip_trace_rec_t> &recs)
+{
+  FILE *fp = fopen(filename, "rb");
+  struct ccip_trace_rec_t rec;
+
+  if (fp == NULL)
+    {
+      perror(filename);
+      return false;
+    }
+
+  if ( (fread(hdr, sizeof(*hdr), 1, fp) != 1) || (hdr->magic != CCIP_TRACE_MAGIC) )
+    {
+      fprintf(stderr, "%s: not a CCI-P trace\n", filename);
+      fclose(fp);
+      return false;
+    }
+  if ( (hdr->version != CCIP_TRACE_VERSION) || (hdr->rec_size != sizeof(rec)) || (hdr->clk_mhz <= 0.0) )
+    {
+      fprintf(stderr, "%s: unsupported trace version %u (record size %u)\n", filename, hdr->version, hdr->rec_size);
+      fclose(fp);
+      return false;
+    }
+
+  while (fread(&rec, sizeof(rec), 1, fp) == 1)
+    {
+      recs.push_back(rec);
+    }
+  fclose(fp);
+  return true;
+}
+
+
+static bool trace_write(const char *filename, const struct ccip_trace_hdr_t *hdr, const std::vector<ccip_trace_rec_t> &recs)
+{
+  FILE *fp = fopen(filename, "wb");
+
+  if (fp == NULL)
+    {
+      perror(filename);
+      return false;
+    }
+  fwrite(hdr, sizeof(*hdr), 1, fp);
+  if (!recs.empty())
+    {
+      fwrite(&recs[0], sizeof(recs[0]), recs.size(), fp);
+    }
+  fclose(fp);
+  return true;
+}
+
+
+static bool trace_known(const struct ccip_trace_rec_t &rec)
+{
+  return (rec.latency != CCIP_TRACE_LATENCY_UNKNOWN);
+}
+
+static uint64_t trace_issue(const struct ccip_trace_rec_t &rec)
+{
+  return trace_known(rec) ? (rec.tstamp - rec.latency) : rec.tstamp;
+}
+
+static bool trace_issue_before(const struct ccip_trace_rec_t &a, const struct ccip_trace_rec_t &b)
+{
+  return trace_issue(a) < trace_issue(b);
+}
+
+static uint32_t trace_percentile(const std::vector<uint32_t> &sorted, int pct)
+{
+  return sorted[(sorted.size() - 1) * pct / 100];
+}
+
+static uint64_t trace_distinct(std::vector<uint64_t> &keys)
+{
+  std::sort(keys.begin(), keys.end());
+  return (uint64_t)(std::unique(keys.begin(), keys.end()) - keys.begin());
+}
+
+
+/*
+ * Statistics of one channel. recs must be sorted by issue time.
+ */
+static void trace_analyze(const std::vector<ccip_trace_rec_t> &recs, int channel, struct trace_stats *st)
+{
+  std::vector<uint32_t> lat;
+  std::vector< std::pair<uint64_t, int> > events;
+  std::vector<uint64_t> lines, pages_4k, pages_2m;
+  uint64_t prev_line = 0;
+  double lat_sum = 0.0;
+  size_t ii;
+
+  memset(st, 0, sizeof(*st));
+  st->first_issue = ~0ULL;
+
+  for (ii = 0; ii < recs.size(); ii++)
+    {
+      const struct ccip_trace_rec_t &rec = recs[ii];
+      if (rec.channel != channel)
+        {
+          continue;
+        }
+
+      st->count++;
+      st->vc[rec.vc & 0x3]++;
+      if ( (channel == CCIP_TRACE_CH_MMIO) && (rec.reqtype == CCIP_TRACE_MMIO_RD) )
+        {
+          st->mmio_reads++;
+        }
+      st->first_issue = std::min(st->first_issue, trace_issue(rec));
+      st->last_done   = std::max(st->last_done, (uint64_t)rec.tstamp);
+
+      if (trace_known(rec))
+        {
+          int bucket = 0;
+          while ( (bucket < TRACE_HIST_BUCKETS - 1) && ((1ULL << bucket) <= rec.latency) )
+            {
+              bucket++;
+            }
+          st->hist[bucket]++;
+          lat.push_back(rec.latency);
+          lat_sum += rec.latency;
+          events.push_back(std::make_pair(trace_issue(rec), 1));
+          events.push_back(std::make_pair((uint64_t)rec.tstamp, -1));
+        }
+      else
+        {
+          st->unmatched++;
+        }
+
+      if ( (channel != CCIP_TRACE_CH_MMIO) && (rec.reqtype != CCIP_TRACE_WRFENCE) )
+        {
+          if ( (st->lines != 0) && (rec.cl_addr == prev_line + 1) )
+            {
+              st->sequential++;
+            }
+          prev_line = rec.cl_addr;
+          st->lines++;
+          lines.push_back(rec.cl_addr);
+          pages_4k.push_back(rec.cl_addr >> 6);
+          pages_2m.push_back(rec.cl_addr >> 15);
+        }
+    }
+
+  if (!lat.empty())
+    {
+      std::sort(lat.begin(), lat.end());
+      st->lat_mean = lat_sum / lat.size();
+      st->lat_min  = lat.front();
+      st->lat_p50  = trace_percentile(lat, 50);
+      st->lat_p90  = trace_percentile(lat, 90);
+      st->lat_p99  = trace_percentile(lat, 99);
+      st->lat_max  = lat.back();
+    }
+
+  // Outstanding depth: completions sort before issues in the same cycle
+  if (!events.empty())
+    {
+      int64_t depth = 0;
+      double area = 0.0;
+      std::sort(events.begin(), events.end());
+      for (ii = 0; ii < events.size(); ii++)
+        {
+          if (ii > 0)
+            {
+              area += (double)depth * (double)(events[ii].first - events[ii-1].first);
+            }
+          depth += events[ii].second;
+          st->depth_max = std::max(st->depth_max, (uint64_t)std::max(depth, (int64_t)0));
+        }
+      if (events.back().first > events.front().first)
+        {
+          st->depth_mean = area / (double)(events.back().first - events.front().first);
+        }
+    }
+
+  st->distinct_lines = trace_distinct(lines);
+  st->distinct_4k    = trace_distinct(pages_4k);
+  st->distinct_2m    = trace_distinct(pages_2m);
+}
+
+
+static double trace_span_us(const struct trace_stats *st, double clk_mhz)
+{
+  return (st->last_done > st->first_issue) ? (double)(st->last_done - st->first_issue) / clk_mhz : 0.0;
+}
+
+static double trace_bandwidth(const struct trace_stats *st, double clk_mhz)
+{
+  double span = trace_span_us(st, clk_mhz);
+  return (span > 0.0) ? (double)(st->lines * BEHAV_CL_BYTES) / span : 0.0;
+}
+
+
+static void trace_print(const char *title, const struct ccip_trace_hdr_t *hdr, size_t nrecs, const struct trace_stats *st)
+{
+  int ch, bb;
+
+  printf("%s: %lu records, %.3f MHz clock\n", title, (unsigned long)nrecs, hdr->clk_mhz);
+
+  for (ch = 0; ch < CCIP_TRACE_NUM_CH; ch++)
+    {
+      const struct trace_stats *s = &st[ch];
+      if (s->count == 0)
+        {
+          continue;
+        }
+
+      printf("\n  Channel %s: %lu requests", trace_ch_name[ch], (unsigned long)s->count);
+      if (ch == CCIP_TRACE_CH_MMIO)
+        {
+          printf(" (%lu reads, %lu writes)", (unsigned long)s->mmio_reads, (unsigned long)(s->count - s->mmio_reads));
+        }
+      else
+        {
+          printf(" (%s %lu, %s %lu, %s %lu, %s %lu)",
+                 trace_vc_name[0], (unsigned long)s->vc[0], trace_vc_name[1], (unsigned long)s->vc[1],
+                 trace_vc_name[2], (unsigned long)s->vc[2], trace_vc_name[3], (unsigned long)s->vc[3]);
+        }
+      if (s->unmatched != 0)
+        {
+          printf(", %lu with unknown latency", (unsigned long)s->unmatched);
+        }
+      printf("\n");
+
+      if (ch != CCIP_TRACE_CH_MMIO)
+        {
+          printf("    Bandwidth   : %.1f MB/s, %lu lines in %.3f us\n",
+                 trace_bandwidth(s, hdr->clk_mhz), (unsigned long)s->lines, trace_span_us(s, hdr->clk_mhz));
+        }
+
+      if (s->count == s->unmatched)
+        {
+          continue;
+        }
+      printf("    Latency     : min %u, mean %.1f, p50 %u, p90 %u, p99 %u, max %u cycles\n",
+             s->lat_min, s->lat_mean, s->lat_p50, s->lat_p90, s->lat_p99, s->lat_max);
+
+      // Histogram over the non-empty range
+      int lo = 0, hi = TRACE_HIST_BUCKETS - 1;
+      uint64_t peak = 0;
+      while (s->hist[lo] == 0) lo++;
+      while (s->hist[hi] == 0) hi--;
+      for (bb = lo; bb <= hi; bb++)
+        {
+          peak = std::max(peak, s->hist[bb]);
+        }
+      for (bb = lo; bb <= hi; bb++)
+        {
+          uint64_t from = (bb == 0) ? 0 : (1ULL << (bb - 1));
+          uint64_t to   = (bb == 0) ? 0 : ((1ULL << bb) - 1);
+          int bar = (int)((s->hist[bb] * TRACE_HIST_BAR + peak - 1) / peak);
+          printf("      %10lu - %-10lu %10lu %5.1f%% %.*s\n", (unsigned long)from, (unsigned long)to,
+                 (unsigned long)s->hist[bb], 100.0 * s->hist[bb] / (s->count - s->unmatched),
+                 bar, "########################################");
+        }
+
+      printf("    Outstanding : max %lu, mean %.1f\n", (unsigned long)s->depth_max, s->depth_mean);
+
+      if ( (ch != CCIP_TRACE_CH_MMIO) && (s->lines != 0) )
+        {
+          printf("    Locality    : %.1f%% sequential, %lu distinct lines (%.1f%% reuse), %lu 4KB pages, %lu 2MB pages\n",
+                 100.0 * s->sequential / s->lines, (unsigned long)s->distinct_lines,
+                 100.0 * (s->lines - s->distinct_lines) / s->lines,
+                 (unsigned long)s->distinct_4k, (unsigned long)s->distinct_2m);
+        }
+    }
+  printf("\n");
+}
+
+
+/*
+ * Replay the memory requests through the channel model. MMIO records and
+ * fences are kept as captured.
+ */
+static void trace_replay(const struct ccip_trace_hdr_t *hdr, const std::vector<ccip_trace_rec_t> &in,
+                         BehavChannel *rd, BehavChannel *wr, std::vector<ccip_trace_rec_t> &out)
+{
+  double ps_per_cycle = (double)BEHAV_PS_PER_US / hdr->clk_mhz;
+  size_t ii;
+
+  out.clear();
+  for (ii = 0; ii < in.size(); ii++)
+    {
+      struct ccip_trace_rec_t rec = in[ii];
+      BehavChannel *chan = (rec.channel == CCIP_TRACE_CH_RD) ? rd : ((rec.channel == CCIP_TRACE_CH_WR) ? wr : NULL);
+
+      if ( (chan != NULL) && (rec.reqtype != CCIP_TRACE_WRFENCE) )
+        {
+          uint64_t issue = trace_issue(rec);
+          uint64_t done  = chan->Issue((uint64_t)(issue * ps_per_cycle));
+          rec.tstamp  = (uint64_t)ceil((double)done / ps_per_cycle);
+          rec.latency = (uint32_t)(rec.tstamp - issue);
+        }
+      out.push_back(rec);
+    }
+}
+
+
+// Relative difference in percent, 0 when both are 0
+static double trace_diff(double captured, double replayed)
+{
+  if (captured == 0.0)
+    {
+      return (replayed == 0.0) ? 0.0 : 100.0;
+    }
+  return 100.0 * (replayed - captured) / captured;
+}
+
+
+static void trace_usage(const char *prog)
+{
+  printf("Usage: %s [OPTIONS] TRACE\n", prog);
+  printf("  Analyze a CCI-P binary trace (%s).\n", CCIP_TRACE_FILENAME);
+  printf("  --replay                 Replay memory requests through the behavioral\n");
+  printf("                           channel model and compare with the capture\n");
+  printf("  --rd-latency=NS          Replay read latency\n");
+  printf("  --wr-latency=NS          Replay write latency\n");
+  printf("  --rd-bandwidth=MB/s      Replay read bandwidth (0: unlimited)\n");
+  printf("  --wr-bandwidth=MB/s      Replay write bandwidth (0: unlimited)\n");
+  printf("  --out=FILE               Write the replayed trace to FILE\n");
+  printf("  --tolerance=PCT          Exit with 1 if replayed bandwidth or mean latency\n");
+  printf("                           of a channel is off by more than PCT percent\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+  static const struct option longopts[] =
+  {
+    { "replay",        no_argument,       NULL, 'p' },
+    { "rd-latency",    required_argument, NULL, 'r' },
+    { "wr-latency",    required_argument, NULL, 'w' },
+    { "rd-bandwidth",  required_argument, NULL, 'R' },
+    { "wr-bandwidth",  required_argument, NULL, 'W' },
+    { "out",           required_argument, NULL, 'o' },
+    { "tolerance",     required_argument, NULL, 'T' },
+    { "help",          no_argument,       NULL, 'h' },
+    { NULL,            0,                 NULL, 0   }
+  };
+
+  struct ccip_trace_hdr_t hdr;
+  std::vector<ccip_trace_rec_t> recs, replayed;
+  struct trace_stats captured_st[CCIP_TRACE_NUM_CH], replayed_st[CCIP_TRACE_NUM_CH];
+  uint64_t rd_latency = 0, wr_latency = 0, rd_bw = 0, wr_bw = 0;
+  const char *out_file = NULL;
+  double tolerance = -1.0;
+  bool replay = false;
+  int opt, ch;
+  int ret = 0;
+
+  while ((opt = getopt_long(argc, argv, "h", longopts, NULL)) != -1)
+    {
+      switch (opt)
+        {
+        case 'p': replay = true;                           break;
+        case 'r': rd_latency = strtoull(optarg, NULL, 0);  break;
+        case 'w': wr_latency = strtoull(optarg, NULL, 0);  break;
+        case 'R': rd_bw = strtoull(optarg, NULL, 0);       break;
+        case 'W': wr_bw = strtoull(optarg, NULL, 0);       break;
+        case 'o': out_file = optarg;                       break;
+        case 'T': tolerance = strtod(optarg, NULL);        break;
+        default:
+          trace_usage(argv[0]);
+          return (opt == 'h') ? 0 : 2;
+        }
+    }
+  if (optind != argc - 1)
+    {
+      trace_usage(argv[0]);
+      return 2;
+    }
+
+  if (!trace_read(argv[optind], &hdr, recs))
+    {
+      return 2;
+    }
+
+  // Records are written in completion order, analysis wants issue order
+  std::stable_sort(recs.begin(), recs.end(), trace_issue_before);
+
+  for (ch = 0; ch < CCIP_TRACE_NUM_CH; ch++)
+    {
+      trace_analyze(recs, ch, &captured_st[ch]);
+    }
+  trace_print(argv[optind], &hdr, recs.size(), captured_st);
+
+  if (!replay)
+    {
+      return 0;
+    }
+
+  BehavChannel rd, wr;
+  rd.Configure(rd_latency, rd_bw);
+  wr.Configure(wr_latency, wr_bw);
+  trace_replay(&hdr, recs, &rd, &wr, replayed);
+
+  for (ch = 0; ch < CCIP_TRACE_NUM_CH; ch++)
+    {
+      trace_analyze(replayed, ch, &replayed_st[ch]);
+    }
+  printf("Replay: read %lu ns / %lu MB/s, write %lu ns / %lu MB/s (0 MB/s: unlimited)\n",
+         (unsigned long)rd_latency, (unsigned long)rd_bw, (unsigned long)wr_latency, (unsigned long)wr_bw);
+  trace_print("Replayed", &hdr, replayed.size(), replayed_st);
+
+  printf("Captured vs replayed:\n");
+  printf("  %-4s %12s %12s %8s %12s %12s %8s\n", "", "MB/s", "MB/s", "diff", "mean lat", "mean lat", "diff");
+  for (ch = CCIP_TRACE_CH_RD; ch <= CCIP_TRACE_CH_WR; ch++)
+    {
+      const struct trace_stats *c = &captured_st[ch];
+      const struct trace_stats *r = &replayed_st[ch];
+      if (c->lines == 0)
+        {
+          continue;
+        }
+      double bw_diff  = trace_diff(trace_bandwidth(c, hdr.clk_mhz), trace_bandwidth(r, hdr.clk_mhz));
+      double lat_diff = trace_diff(c->lat_mean, r->lat_mean);
+      printf("  %-4s %12.1f %12.1f %7.1f%% %12.1f %12.1f %7.1f%%\n", trace_ch_name[ch],
+             trace_bandwidth(c, hdr.clk_mhz), trace_bandwidth(r, hdr.clk_mhz), bw_diff,
+             c->lat_mean, r->lat_mean, lat_diff);
+      if ( (tolerance >= 0.0) && ((fabs(bw_diff) > tolerance) || (fabs(lat_diff) > tolerance)) )
+        {
+          ret = 1;
+        }
+    }
+  if (tolerance >= 0.0)
+    {
+      printf("%s (tolerance %.1f%%)\n", (ret == 0) ? "PASS" : "FAIL", tolerance);
+    }
+
+  if ( (out_file != NULL) && !trace_write(out_file, &hdr, replayed) )
+    {
+      ret = 2;
+    }
+
+  return ret;
+}
@@ -0,0 +1,145 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Buffer lookup microbenchmark
+ * Language   : C
+ *
+ * Measures ll_search_physaddr(), the fake physical address index of
+ * linked_list_ops.c, against a walk of the buffer list, which is how
+ * addresses were resolved before the index. Each run registers 1, 64 and
+ * 1024 buffers of 2MB, then looks up 16 consecutive lines per visit to a
+ * randomly chosen buffer, and reports lookups (lines) per second.
+ *
+ * Links linked_list_ops.c alone; the rest of ASE is stubbed out below.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ase_common.h"
+
+// Buffer list, as mem_model.c defines it
+struct buffer_t *head;
+struct buffer_t *end;
+
+// Used by linked_list_ops.c on errors, which this driver does not cause
+void ase_error_report(char *err_func, int err_num, int err_code) {}
+void ase_perror_teardown() {}
+void start_simkill_countdown() {}
+
+#define BENCH_BUF_SIZE        ( 2 << 20 )
+#define BENCH_LINES_PER_VISIT 16
+#define BENCH_LOOKUPS         4000000L
+
+// Lookup by list walk, as before the index
+static struct buffer_t* list_search_physaddr(uint64_t paddr)
+{
+  struct buffer_t *t = head;
+  while (t != NULL)
+    {
+      if ((paddr >= t->fake_paddr) && (paddr < t->fake_paddr_hi))
+        return t;
+      t = t->next;
+    }
+  return NULL;
+}
+
+static double now_sec()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Mlines/s of lookup() over nbuf buffers, for n lookups
+static double run(struct buffer_t *bufs, int nbuf, long n,
+                  struct buffer_t* (*lookup)(uint64_t))
+{
+  volatile uintptr_t sink = 0;
+  unsigned seed = 1;
+  struct buffer_t *buf = bufs;
+  double t0;
+  long i;
+
+  t0 = now_sec();
+  for (i = 0; i < n; i++)
+    {
+      if ((i % BENCH_LINES_PER_VISIT) == 0)
+        {
+          seed = seed * 1103515245 + 12345;
+          buf = &bufs[(seed >> 8) % nbuf];
+        }
+      sink += (uintptr_t) lookup(buf->fake_paddr + (i % BENCH_LINES_PER_VISIT) * CL_BYTE_WIDTH);
+    }
+  return n / (now_sec() - t0) / 1e6;
+}
+
+int main()
+{
+  static const int nbufs[] = { 1, 64, 1024 };
+  unsigned k;
+
+  for (k = 0; k < sizeof(nbufs) / sizeof(nbufs[0]); k++)
+    {
+      int nbuf = nbufs[k];
+      int i;
+      struct buffer_t *bufs = calloc(nbuf, sizeof(struct buffer_t));
+      if (bufs == NULL)
+        {
+          perror("calloc");
+          return 1;
+        }
+
+      // Scattered, non-overlapping 2MB ranges, registered out of address order
+      head = end = NULL;
+      for (i = 0; i < nbuf; i++)
+        {
+          bufs[i].index         = i;
+          bufs[i].fake_paddr    = ((uint64_t)((i * 7919) % 4096) + 1) * BENCH_BUF_SIZE;
+          bufs[i].fake_paddr_hi = bufs[i].fake_paddr + BENCH_BUF_SIZE;
+          ll_append_buffer(&bufs[i]);
+          ll_index_insert(&bufs[i]);
+        }
+
+      // The list walk gets too slow to run the full count with many buffers
+      printf("%4d buffers: indexed %7.1f Mlines/s, list walk %7.2f Mlines/s\n",
+             nbuf,
+             run(bufs, nbuf, BENCH_LOOKUPS, ll_search_physaddr),
+             run(bufs, nbuf, (nbuf >= 1024) ? BENCH_LOOKUPS / 50 : BENCH_LOOKUPS,
+                 list_search_physaddr));
+
+      for (i = 0; i < nbuf; i++)
+        {
+          ll_index_remove(&bufs[i]);
+          ll_remove_buffer(&bufs[i]);
+        }
+      free(bufs);
+    }
+
+  return 0;
+}
@@ -307,6 +307,7 @@ package ase_pkg;
       int 	  enable_cl_view;
       int 	  usr_tps;
       int 	  phys_memory_available_gb;
+      int 	  enable_ccip_trace;
    } ase_cfg_t;
    ase_cfg_t cfg;
 
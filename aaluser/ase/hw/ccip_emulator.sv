@@ -353,15 +353,16 @@ module ccip_emulator
    import "DPI-C" function void sv2c_script_dex(string str);
 
    // Data exchange for READ, WRITE system
-   import "DPI-C" function void rd_memline_dex(inout cci_pkt foo );
-   import "DPI-C" function void wr_memline_dex(inout cci_pkt foo );
+   // (context: they read ase_trace_cycle() when tracing)
+   import "DPI-C" context function void rd_memline_dex(inout cci_pkt foo );
+   import "DPI-C" context function void wr_memline_dex(inout cci_pkt foo );
 
    // Get ASE seed
    import "DPI-C" function int get_ase_seed();
    // int ase_seed;
 
    // MMIO response
-   import "DPI-C" function void mmio_response(inout mmio_t mmio_pkt);
+   import "DPI-C" context function void mmio_response(inout mmio_t mmio_pkt);
    mmio_t mmio_rdrsp_pkt;
    mmio_t mmio_wrrsp_pkt;
 
@@ -380,6 +381,10 @@ module ccip_emulator
    // cci_logger buffer message
    export "DPI-C" task buffer_msg_inject;
 
+   // CCI-P binary trace: cycle count and request issue
+   export "DPI-C" function ase_trace_cycle;
+   import "DPI-C" function void ccip_trace_issue(longint cycle, int channel, int reqtype, int vc, int len, longint cl_addr, int mdata);
+
    // Page table called status
    logic rd_memline_dex_called;
    logic wr_memline_dex_called;
@@ -1366,6 +1371,7 @@ module ccip_emulator
 	 cfg.enable_cl_view           = cfg_in.enable_cl_view           ;
 	 cfg.usr_tps                  = cfg_in.usr_tps                  ;
 	 cfg.phys_memory_available_gb = cfg_in.phys_memory_available_gb ;
+	 cfg.enable_ccip_trace        = cfg_in.enable_ccip_trace        ;
 	 // Set UsrClk
 	 update_usrclk_delay( cfg.usr_tps );
       end
@@ -1689,6 +1695,34 @@ module ccip_emulator
    endfunction
 
 
+   /*
+    * CCI-P binary trace (ENABLE_CCIP_TRACE in ase.cfg)
+    * - Requests are posted to ccip_trace.c as the AFU issues them, and
+    *   recorded when rd_memline_dex/wr_memline_dex/mmio_response complete
+    *   them. Multi-line writes are posted once, on SOP.
+    */
+   longint ase_cycle_cnt = 0;
+
+   always @(posedge clk) begin : ase_cycle_proc
+      ase_cycle_cnt <= ase_cycle_cnt + 1;
+   end
+
+   function longint ase_trace_cycle();
+      return ase_cycle_cnt;
+   endfunction
+
+   always @(posedge clk) begin : ccip_trace_proc
+      if (cfg.enable_ccip_trace) begin
+	 if (C0TxValid) begin
+	    ccip_trace_issue(ase_cycle_cnt, 0, int'(C0TxHdr.reqtype), int'(C0TxHdr.vc), int'(C0TxHdr.len), longint'(C0TxHdr.addr), int'(C0TxHdr.mdata));
+	 end
+	 if (C1TxValid && (C1TxHdr.sop || (C1TxHdr.reqtype == ASE_WRFENCE))) begin
+	    ccip_trace_issue(ase_cycle_cnt, 1, int'(C1TxHdr.reqtype), int'(C1TxHdr.vc), int'(C1TxHdr.len), longint'(C1TxHdr.addr), int'(C1TxHdr.mdata));
+	 end
+      end
+   end
+
+
    /*
     * CAFU->ASE CH0 (TX0)
     * Formed as {TxHdr_t}
@@ -35,6 +35,8 @@
 #define _GNU_SOURCE
 
 #include "ase_common.h"
+#include <poll.h>
+#include <sys/eventfd.h>
 
 // Lock
 pthread_mutex_t mmio_port_lock;
@@ -71,6 +73,8 @@ struct mmio_scoreboard_line_t
   uint64_t data;
   bool tx_flag;
   bool rx_flag;
+  uint32_t rx_doorbell;       // Rung when a reader sleeps on rx_flag
+  uint32_t rx_waiting;
 };
 volatile struct mmio_scoreboard_line_t mmio_table[MMIO_MAX_OUTSTANDING];
 
@@ -99,6 +103,10 @@ mmio_t *mmio_rsp_pkt;
 // UMsg Watch TID
 pthread_t umsg_watch_tid;
 
+// umsg_send() signals the UMsg watcher through this, when it sleeps
+int umsg_event_fd = -1;
+volatile uint32_t umsg_watcher_waiting;
+
 // UMsg byte offset
 const int umsg_byteindex_arr[] =
   {
@@ -148,9 +156,8 @@ uint32_t generate_mmio_tid()
  */
 void *mmio_response_watcher()
 {
-  // Mark as thread that can be cancelled anytime
-  pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
-
+  // Leaves when the session ends. Cancellation is deferred: it only
+  // breaks a blocking read on the named pipe, never a ring lock.
   mmio_rsp_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
   int ret;
   int slot_idx;
@@ -209,7 +216,14 @@ void *mmio_response_watcher()
                   mmio_table[slot_idx].tid = mmio_rsp_pkt->tid;
                   mmio_table[slot_idx].data = mmio_rsp_pkt->qword[0];
                   mmio_table[slot_idx].tx_flag = true;
+                  __sync_synchronize();
                   mmio_table[slot_idx].rx_flag = true;
+
+                  // Wake the reader, if it went to sleep
+                  __sync_synchronize();
+                  if ( mmio_table[slot_idx].rx_waiting &&
+                       __sync_bool_compare_and_swap(&mmio_table[slot_idx].rx_waiting, 1, 0) )
+                    ase_doorbell_ring(&mmio_table[slot_idx].rx_doorbell);
                 }
               // MMIO Write response (for credit count only)
               else if (mmio_rsp_pkt->write_en == MMIO_WRITE_REQ)
@@ -227,12 +241,43 @@ void *mmio_response_watcher()
               /* #endif */
             }
         }
+      else
+        {
+          // Simulator has closed its end, don't spin on end-of-file
+          usleep(ASE_DOORBELL_WAIT_MSEC * 1000);
+        }
     }
 
   return 0;
 }
 
 
+/*
+ * Wait for the response to an MMIO read to land in its scoreboard slot
+ * Polls the slot ase_spin_polls() times, then sleeps on the slot's doorbell
+ */
+static void mmio_wait_response(int slot_idx)
+{
+  uint32_t doorbell;
+  int spin = 0;
+
+  while (mmio_table[slot_idx].rx_flag != true)
+    {
+      if (++spin <= ase_spin_polls())
+        continue;
+
+      // Ask for the doorbell, and look once more before sleeping
+      doorbell = mmio_table[slot_idx].rx_doorbell;
+      mmio_table[slot_idx].rx_waiting = 1;
+      __sync_synchronize();
+      if (mmio_table[slot_idx].rx_flag != true)
+        ase_doorbell_wait(&mmio_table[slot_idx].rx_doorbell, doorbell, ASE_DOORBELL_WAIT_MSEC);
+      mmio_table[slot_idx].rx_waiting = 0;
+    }
+  __sync_synchronize();
+}
+
+
 /*
  * Interrupt request (FPGA->CPU) watcher
  */
@@ -364,6 +409,9 @@ void session_init()
       sim2app_portctrl_rsp_rx = mqueue_open( mq_array[8].name, mq_array[8].perm_flag );
       sim2app_intr_request_rx = mqueue_open( mq_array[9].name, mq_array[9].perm_flag );
 
+      // Pass messages through shared memory rings, if the simulator has them
+      mqueue_ring_attach();
+
       // Message queues have been established
       mq_exist_status = ESTABLISHED;
 
@@ -482,6 +530,16 @@ void session_init()
       END_YELLOW_FONTCOLOR;
 
       // Initiate UMsg watcher
+      umsg_watcher_waiting = 0;
+      umsg_event_fd = eventfd(0, EFD_NONBLOCK);
+      if (umsg_event_fd == -1)
+        {
+          BEGIN_RED_FONTCOLOR;
+          printf("FAILED\n");
+          perror("eventfd");
+          exit(1);
+          END_RED_FONTCOLOR;
+        }
       thr_err = pthread_create (&umsg_watch_tid, NULL, &umsg_watcher, NULL);
       if (thr_err != 0)
         {
@@ -548,8 +606,16 @@ void session_deinit()
           BEGIN_YELLOW_FONTCOLOR;
           printf("  [APP]  Closing Watcher threads\n");
           END_YELLOW_FONTCOLOR;
-          // Close UMsg thread
-          pthread_cancel (umsg_watch_tid);
+          // Stop the UMsg thread, wake it, and wait for it; then close
+          // its event
+          uint64_t event = 1;
+          umas_exist_status = NOT_ESTABLISHED;
+          __sync_synchronize();
+          if (write(umsg_event_fd, &event, sizeof(uint64_t)) < 0)
+            perror("write");
+          pthread_join (umsg_watch_tid, NULL);
+          close(umsg_event_fd);
+          umsg_event_fd = -1;
 
           // Deallocate the region
           BEGIN_YELLOW_FONTCOLOR;
@@ -588,8 +654,11 @@ void session_deinit()
       fclose(fp_mmioaccess_log);
 #endif
 
-      // Close MMIO Response tracker thread
+      // Close MMIO Response tracker thread: wake it off the rings, or
+      // out of a blocking read on the named pipe, and wait for it
+      mqueue_ring_stop();
       pthread_cancel (mmio_watch_tid);
+      pthread_join (mmio_watch_tid, NULL);
 
       // close message queue
       mqueue_close(app2sim_mmioreq_tx);
@@ -602,6 +671,9 @@ void session_deinit()
       mqueue_close(sim2app_dealloc_rx);
       mqueue_close(sim2app_portctrl_rsp_rx);
 
+      // Unmap the rings, now that the MMIO Response tracker is gone
+      mqueue_ring_detach();
+
       // Lock deinit
       pthread_mutex_unlock(&mmio_port_lock);
       pthread_mutex_destroy(&mmio_port_lock);
@@ -756,8 +828,10 @@ void mmio_write32 (int offset, uint32_t data)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      // Packet is copied into the message queue, no need for the heap
+      mmio_t mmio_req;
+      mmio_t *mmio_pkt = &mmio_req;
+      memset(mmio_pkt, 0, sizeof(mmio_t));
 
       mmio_pkt->write_en = MMIO_WRITE_REQ;
       mmio_pkt->width    = MMIO_WIDTH_32;
@@ -788,7 +862,6 @@ void mmio_write32 (int offset, uint32_t data)
       BEGIN_YELLOW_FONTCOLOR;
       printf("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n", mmio_pkt->tid, mmio_pkt->addr, data);
       END_YELLOW_FONTCOLOR;
-      free(mmio_pkt);
     }
 
   FUNC_CALL_EXIT;
@@ -816,8 +889,10 @@ void mmio_write64 (int offset, uint64_t data)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      // Packet is copied into the message queue, no need for the heap
+      mmio_t mmio_req;
+      mmio_t *mmio_pkt = &mmio_req;
+      memset(mmio_pkt, 0, sizeof(mmio_t));
 
       mmio_pkt->write_en = MMIO_WRITE_REQ;
       mmio_pkt->width = MMIO_WIDTH_64;
@@ -847,8 +922,6 @@ void mmio_write64 (int offset, uint64_t data)
       BEGIN_YELLOW_FONTCOLOR;
       printf("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n", mmio_pkt->tid, mmio_pkt->addr, (unsigned long long)data);
       END_YELLOW_FONTCOLOR;
-
-      free(mmio_pkt);
     }
 
   FUNC_CALL_EXIT;
@@ -889,8 +962,10 @@ void mmio_read32(int offset, uint32_t *data32)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      // Packet is copied into the message queue, no need for the heap
+      mmio_t mmio_req;
+      mmio_t *mmio_pkt = &mmio_req;
+      memset(mmio_pkt, 0, sizeof(mmio_t));
 
       mmio_pkt->write_en = MMIO_READ_REQ;
       mmio_pkt->width    = MMIO_WIDTH_32;
@@ -918,10 +993,7 @@ void mmio_read32(int offset, uint32_t *data32)
 #endif
 
       // Wait until correct response found
-      while (mmio_table[slot_idx].rx_flag != true)
-        {
-          usleep(1);
-        }
+      mmio_wait_response(slot_idx);
 
       // Write data
       *data32 = (uint32_t)mmio_table[slot_idx].data;
@@ -934,8 +1006,6 @@ void mmio_read32(int offset, uint32_t *data32)
       // Reset scoreboard flags
       mmio_table[slot_idx].tx_flag = false;
       mmio_table[slot_idx].rx_flag = false;
-
-      free(mmio_pkt);
     }
 
   FUNC_CALL_EXIT;
@@ -964,8 +1034,10 @@ void mmio_read64(int offset, uint64_t *data64)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      // Packet is copied into the message queue, no need for the heap
+      mmio_t mmio_req;
+      mmio_t *mmio_pkt = &mmio_req;
+      memset(mmio_pkt, 0, sizeof(mmio_t));
 
       mmio_pkt->write_en = MMIO_READ_REQ;
       mmio_pkt->width    = MMIO_WIDTH_64;
@@ -993,10 +1065,7 @@ void mmio_read64(int offset, uint64_t *data64)
 #endif
 
       // Wait for correct response to be back
-      while(mmio_table[slot_idx].rx_flag != true)
-        {
-          usleep(1);
-        };
+      mmio_wait_response(slot_idx);
 
       // Write data
       *data64 = mmio_table[slot_idx].data;
@@ -1010,8 +1079,159 @@ void mmio_read64(int offset, uint64_t *data64)
       // Reset scoreboard flags
       mmio_table[slot_idx].tx_flag = false;
       mmio_table[slot_idx].rx_flag = false;
+    }
+
+  FUNC_CALL_EXIT;
+}
+
+
+/* *********************************************************************
+ * MMIO Batch
+ * *********************************************************************
+ *
+ * Vectored form of mmio_write32/64 and mmio_read32/64. Requests are
+ * put on the request queue back to back, in order, under one hold of
+ * mmio_port_lock. Reads are then reaped together, so a batch of reads
+ * waits for one simulator round trip instead of one per read.
+ *
+ * No more than MMIO_BATCH_MAX_READS reads are in flight at once,
+ * leaving scoreboard slots for writes and for other threads.
+ */
+#define MMIO_BATCH_MAX_READS  (MMIO_MAX_OUTSTANDING/2)
+
+/*
+ * Check batch, abort on bad entry (as single accesses do)
+ */
+static void mmio_batch_check(struct mmio_batch_t *ops, int count, char *what)
+{
+  int ii;
+
+  for (ii = 0 ; ii < count ; ii = ii + 1)
+    {
+      if ( (ops[ii].addr < 0) ||
+           ((ops[ii].width != MMIO_WIDTH_32) && (ops[ii].width != MMIO_WIDTH_64)) )
+        {
+          BEGIN_RED_FONTCOLOR;
+          printf("  [APP]  Batch entry %d is not a valid AFU MMIO access\n", ii);
+          printf("         MMIO %s Error\n", what);
+          END_RED_FONTCOLOR;
+          raise(SIGABRT);
+        }
+    }
+}
+
+
+/*
+ * MMIO Write batch
+ */
+void mmio_write_batch(struct mmio_batch_t *ops, int count)
+{
+  FUNC_CALL_ENTRY;
+
+  int ii;
+  mmio_t mmio_pkt;
+
+  mmio_batch_check(ops, count, "Write");
+
+  // Critical section
+  pthread_mutex_lock (&mmio_port_lock);
+
+  for (ii = 0 ; ii < count ; ii = ii + 1)
+    {
+      memset(&mmio_pkt, 0, sizeof(mmio_t));
+      mmio_pkt.write_en = MMIO_WRITE_REQ;
+      mmio_pkt.width    = ops[ii].width;
+      mmio_pkt.addr     = ops[ii].addr;
+      mmio_pkt.resp_en  = 0;
+      if (ops[ii].width == MMIO_WIDTH_32)
+        {
+          uint32_t data32 = (uint32_t)ops[ii].data;
+          memcpy(mmio_pkt.qword, &data32, sizeof(uint32_t));
+        }
+      else
+        {
+          memcpy(mmio_pkt.qword, &ops[ii].data, sizeof(uint64_t));
+        }
+
+      mmio_pkt.tid = generate_mmio_tid();
+      mmio_request_put(&mmio_pkt);
+
+      // Write to MMIO map
+      memcpy((char*)((uint64_t)mmio_afu_vbase + ops[ii].addr),
+             (char*)mmio_pkt.qword,
+             (ops[ii].width == MMIO_WIDTH_32) ? sizeof(uint32_t) : sizeof(uint64_t));
+
+      BEGIN_YELLOW_FONTCOLOR;
+      printf("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n", mmio_pkt.tid, mmio_pkt.addr, (unsigned long long)ops[ii].data);
+      END_YELLOW_FONTCOLOR;
+    }
+
+  pthread_mutex_unlock (&mmio_port_lock);
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * MMIO Read batch
+ */
+void mmio_read_batch(struct mmio_batch_t *ops, int count)
+{
+  FUNC_CALL_ENTRY;
+
+  int slot_idx[MMIO_BATCH_MAX_READS];
+  int first;
+  int num;
+  int ii;
+  mmio_t mmio_pkt;
+
+  mmio_batch_check(ops, count, "Read");
+
+  for (first = 0 ; first < count ; first = first + num)
+    {
+      num = count - first;
+      if (num > MMIO_BATCH_MAX_READS)
+        num = MMIO_BATCH_MAX_READS;
+
+      // Critical section
+      pthread_mutex_lock (&mmio_port_lock);
+
+      for (ii = 0 ; ii < num ; ii = ii + 1)
+        {
+          memset(&mmio_pkt, 0, sizeof(mmio_t));
+          mmio_pkt.write_en = MMIO_READ_REQ;
+          mmio_pkt.width    = ops[first + ii].width;
+          mmio_pkt.addr     = ops[first + ii].addr;
+          mmio_pkt.resp_en  = 0;
+
+          mmio_pkt.tid = generate_mmio_tid();
+          slot_idx[ii] = mmio_request_put(&mmio_pkt);
+
+          BEGIN_YELLOW_FONTCOLOR;
+          printf("  [APP]  MMIO Read      : tid = 0x%03x, offset = 0x%x\n", mmio_pkt.tid, mmio_pkt.addr);
+          END_YELLOW_FONTCOLOR;
+        }
+
+      pthread_mutex_unlock (&mmio_port_lock);
+
+      // Responses may arrive in any order, collect them in request order
+      for (ii = 0 ; ii < num ; ii = ii + 1)
+        {
+          mmio_wait_response(slot_idx[ii]);
+
+          if (ops[first + ii].width == MMIO_WIDTH_32)
+            ops[first + ii].data = (uint32_t)mmio_table[slot_idx[ii]].data;
+          else
+            ops[first + ii].data = mmio_table[slot_idx[ii]].data;
 
-      free(mmio_pkt);
+          BEGIN_YELLOW_FONTCOLOR;
+          printf("  [APP]  MMIO Read Resp : tid = 0x%03x, data = %llx\n", mmio_table[slot_idx[ii]].tid, (unsigned long long)ops[first + ii].data);
+          END_YELLOW_FONTCOLOR;
+
+          // Reset scoreboard flags
+          mmio_table[slot_idx[ii]].tx_flag = false;
+          mmio_table[slot_idx[ii]].rx_flag = false;
+        }
     }
 
   FUNC_CALL_EXIT;
@@ -1333,12 +1553,54 @@ uint64_t* umsg_get_address(int umsg_id)
 }
 
 
+/*
+ * umsg_patrol: Send every UMsg line that changed since the last patrol
+ * Returns number of UMsgs sent
+ */
+static int umsg_patrol(char umsg_old_data[][CL_BYTE_WIDTH], umsgcmd_t *umsg_pkt)
+{
+  int cl_index;
+  int sent = 0;
+
+  // Walk through each line
+  for(cl_index = 0; cl_index < NUM_UMSG_PER_AFU ; cl_index++)
+    {
+      if ( memcmp(umsg_addr_array[cl_index], umsg_old_data[cl_index], CL_BYTE_WIDTH) != 0)
+        {
+          // Construct UMsg packet
+          umsg_pkt->id = cl_index;
+          memcpy((char*)umsg_pkt->qword, (char*)umsg_addr_array[cl_index], CL_BYTE_WIDTH);
+
+          // Send UMsg
+          mqueue_send(app2sim_umsg_tx, (char*)umsg_pkt, sizeof(struct umsgcmd_t));
+
+          // Update local mirror
+          memcpy( (char*)umsg_old_data[cl_index], (char*)umsg_pkt->qword, CL_BYTE_WIDTH );
+          sent++;
+        }
+    }
+
+  return sent;
+}
+
+
 /*
  * umsg_send: Write data to umsg region
  */
 void umsg_send (int umsg_id, uint64_t *umsg_data)
 {
+  uint64_t event = 1;
+
   memcpy((char*)umsg_addr_array[umsg_id], (char*)umsg_data, sizeof(uint64_t));
+
+  // Wake the UMsg watcher, if it went to sleep
+  __sync_synchronize();
+  if ( umsg_watcher_waiting &&
+       __sync_bool_compare_and_swap(&umsg_watcher_waiting, 1, 0) )
+    {
+      if (write(umsg_event_fd, &event, sizeof(uint64_t)) < 0)
+        perror("write");
+    }
 }
 
 
@@ -1367,9 +1629,7 @@ void umsg_set_attribute(uint32_t hint_mask)
  */
 void *umsg_watcher()
 {
-  // Mark as thread that can be cancelled anytime
-  pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
-
+  // Leaves when umas_exist_status is cleared, see session_deinit()
   // Generic index
   int cl_index;
 
@@ -1380,6 +1640,13 @@ void *umsg_watcher()
   umsgcmd_t *umsg_pkt;
   umsg_pkt = (struct umsgcmd_t *)ase_malloc( sizeof(struct umsgcmd_t) );
 
+  // Sleeping on umsg_send() signals
+  struct pollfd umsg_event;
+  uint64_t event_count;
+  int idle_polls = 0;
+  umsg_event.fd = umsg_event_fd;
+  umsg_event.events = POLLIN;
+
   // Patrol each UMSG line
   for(cl_index = 0; cl_index < NUM_UMSG_PER_AFU; cl_index++)
     {
@@ -1404,23 +1671,30 @@ void *umsg_watcher()
   // While application is running
   while(umas_exist_status == ESTABLISHED)
     {
-      // Walk through each line
-      for(cl_index = 0; cl_index < NUM_UMSG_PER_AFU ; cl_index++)
+      if (umsg_patrol(umsg_old_data, umsg_pkt) != 0)
         {
-          if ( memcmp(umsg_addr_array[cl_index], umsg_old_data[cl_index], CL_BYTE_WIDTH) != 0)
-            {
-              // Construct UMsg packet
-              umsg_pkt->id = cl_index;
-              memcpy((char*)umsg_pkt->qword, (char*)umsg_addr_array[cl_index], CL_BYTE_WIDTH);
-
-              // Send UMsg
-              mqueue_send(app2sim_umsg_tx, (char*)umsg_pkt, sizeof(struct umsgcmd_t));
+          idle_polls = 0;
+          continue;
+        }
 
-              // Update local mirror
-              memcpy( (char*)umsg_old_data[cl_index], (char*)umsg_pkt->qword, CL_BYTE_WIDTH );
-            }
+      // Optional spin, for latency
+      if (idle_polls < ase_spin_polls())
+        {
+          idle_polls++;
+          continue;
         }
-      usleep(1);
+
+      // Idle: sleep until umsg_send() signals, looking at the lines again
+      // every UMSG_PATROL_MSEC for writes that bypass it
+      umsg_watcher_waiting = 1;
+      __sync_synchronize();
+      if (umsg_patrol(umsg_old_data, umsg_pkt) == 0)
+        poll(&umsg_event, 1, UMSG_PATROL_MSEC);
+      umsg_watcher_waiting = 0;
+
+      // Consume the signal, if any; a UMsg is likely to follow another
+      if (read(umsg_event_fd, &event_count, sizeof(uint64_t)) == sizeof(uint64_t))
+        idle_polls = 0;
     }
 
   // Free memory
@@ -68,7 +68,7 @@
 #include <pthread.h>
 #endif
 
-#ifdef SIM_SIDE
+#if defined(SIM_SIDE) && !defined(ASE_BEHAV)
 #include "svdpi.h"
 #endif
 
@@ -122,10 +122,17 @@
 #define UMAS_LENGTH                NUM_UMSG_PER_AFU * ASE_PAGESIZE
 #define UMAS_REGION_MEMSIZE        2*1024*1024
 
+// An idle UMsg watcher still looks at the UMsg lines this often, for
+// writes that do not go through umsg_send()
+#define UMSG_PATROL_MSEC           10
+
 // User clock default
 #define DEFAULT_USR_CLK_MHZ        312.500
 #define DEFAULT_USR_CLK_TPS        (int)( 1E+12/(DEFAULT_USR_CLK_MHZ*pow(1000,2)) );
 
+// CCI-P clock (pClk, CLK_16UI_TIME in platform.vh)
+#define ASE_PCLK_MHZ               400.000
+
 
 /* *******************************************************************************
  *
@@ -272,6 +279,16 @@ typedef struct mmio_t {
 } mmio_t;
 
 
+/*
+ * MMIO batch entry (APP side only, see mmio_write_batch/mmio_read_batch)
+ */
+typedef struct mmio_batch_t {
+  int      addr;
+  int      width;          // MMIO_WIDTH_32 or MMIO_WIDTH_64
+  uint64_t data;           // Write data, or read data returned
+} mmio_batch_t;
+
+
 /*
  * Umsg transaction packet
  */
@@ -343,7 +360,11 @@ void ll_traverse_print();
 void ll_append_buffer(struct buffer_t *);
 void ll_remove_buffer(struct buffer_t *);
 uint32_t check_if_physaddr_used(uint64_t);
+uint32_t check_if_physrange_used(uint64_t, uint64_t);
 struct buffer_t* ll_search_buffer(int);
+void ll_index_insert(struct buffer_t *);
+void ll_index_remove(struct buffer_t *);
+struct buffer_t* ll_search_physaddr(uint64_t);
 
 // Mem-ops functions
 int ase_recv_msg(struct buffer_t *);
@@ -378,6 +399,9 @@ void remove_tabs (char*);
 void remove_newline (char*);
 uint32_t ret_random_in_range(int, int);
 void ase_string_copy(char *, const char *, size_t);
+int ase_spin_polls();
+void ase_doorbell_wait(volatile uint32_t *, uint32_t, int);
+void ase_doorbell_ring(volatile uint32_t *);
 
 // Message queue operations
 void ipc_init();
@@ -387,6 +411,11 @@ void mqueue_close(int);
 void mqueue_destroy(char*);
 void mqueue_send(int, const char*, int);
 int mqueue_recv(int, char*, int);
+void mqueue_ring_create();
+int mqueue_ring_attach();
+void mqueue_ring_stop();
+void mqueue_ring_detach();
+void mqueue_ring_destroy();
 
 // Timestamp functions
 void put_timestamp();
@@ -437,6 +466,8 @@ extern "C" {
   void mmio_write64 (int , uint64_t  );
   void mmio_read32  (int , uint32_t* );
   void mmio_read64  (int , uint64_t* );
+  void mmio_write_batch(struct mmio_batch_t *, int);
+  void mmio_read_batch (struct mmio_batch_t *, int);
   // UMSG functions
   uint64_t* umsg_get_address(int);
   void umsg_send (int , uint64_t *);
@@ -476,6 +507,45 @@ extern "C" {
 #define ASE_MSG_PRESENT 0xD33D
 #define ASE_MSG_ABSENT  0xDEAD
 
+// Idle waits (see ase_ops.c)
+#define ASE_SPIN_POLLS          2000     // Polls before sleeping, if there is more than one CPU
+#define ASE_DOORBELL_WAIT_MSEC  100      // Sleep at most this long before looking again
+
+// Shared memory rings (see mqueue_ops.c)
+#define ASE_RING_SLOTS       64          // Messages per ring, power of 2
+#define ASE_RING_MAGIC       0x41534552  // "ASER"
+#define ASE_RING_VERSION     1
+
+// One direction of one message queue: single producer, single consumer
+struct ase_ring_t
+{
+  // Written by producer
+  volatile uint64_t head;
+  volatile uint32_t doorbell;            // futex word, bumped to wake the consumer
+  char pad0[64 - sizeof(uint64_t) - sizeof(uint32_t)];
+  // Written by consumer
+  volatile uint64_t tail;
+  volatile uint32_t waiting;             // Consumer is asleep on doorbell
+  char pad1[64 - sizeof(uint64_t) - sizeof(uint32_t)];
+  struct
+  {
+    uint32_t len;
+    char     data[ASE_MQ_MSGSIZE];
+  } slot[ASE_RING_SLOTS];
+};
+
+// Shared memory segment, one ring per message queue
+struct ase_ring_seg_t
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t msgsize;
+  volatile int32_t sim_pid;
+  volatile int32_t app_pid;              // Attached application, 0 if none
+  char pad[64 - 5*sizeof(uint32_t)];
+  struct ase_ring_t ring[ASE_MQ_INSTANCES];
+};
+
 // Message queue controls
 struct ipc_t
 {
@@ -555,6 +625,7 @@ struct ase_cfg_t
   int enable_cl_view;
   int usr_tps;
   int phys_memory_available_gb;
+  int enable_ccip_trace;
 };
 struct ase_cfg_t *cfg;
 
@@ -634,6 +705,17 @@ extern int count_error_flag_ping();
 void count_error_flag_pong(int);
 void update_glbl_dealloc(int);
 
+// CCI-P binary trace (ccip_trace.c)
+#include "ccip_trace.h"
+extern long long ase_trace_cycle();
+void ccip_trace_open(const char *, double);
+void ccip_trace_close();
+void ccip_trace_write(struct ccip_trace_rec_t *);
+void ccip_trace_issue(long long, int, int, int, int, long long, int);
+void ccip_trace_complete(uint64_t, int, long long, int);
+void ccip_trace_mmio_request(uint64_t, struct mmio_t *);
+void ccip_trace_mmio_response(uint64_t, struct mmio_t *);
+
 // Redeclaring ase_malloc, following maintainer-check issues !!! Do Not Edit !!!
 char* ase_malloc (size_t);
 
@@ -34,6 +34,9 @@
  */
 
 #include "ase_common.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
 
 struct buffer_t *head;
 struct buffer_t *end;
@@ -228,6 +231,52 @@ void ase_memory_barrier()
 }
 
 
+/*
+ * Number of times an idle waiter looks for its event before going to sleep
+ * env(ASE_SPIN_POLLS) sets it. By default there is no spinning on a single
+ * CPU, where it only delays whoever is being waited for.
+ */
+int ase_spin_polls()
+{
+  static int spin_polls = -1;
+  char *env;
+
+  if (spin_polls < 0)
+    {
+      env = getenv("ASE_SPIN_POLLS");
+      if (env != NULL)
+        spin_polls = (atoi(env) > 0) ? atoi(env) : 0;
+      else
+        spin_polls = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? ASE_SPIN_POLLS : 0;
+    }
+
+  return spin_polls;
+}
+
+
+/*
+ * Doorbells: a 32-bit word that waiters sleep on (futex), in private or
+ * shared memory
+ * - ase_doorbell_wait() sleeps until the doorbell rings, unless it no
+ *   longer holds val, or msec have passed. Callers look again either way.
+ * - ase_doorbell_ring() changes the word and wakes every waiter
+ */
+void ase_doorbell_wait(volatile uint32_t *doorbell, uint32_t val, int msec)
+{
+  struct timespec ts;
+
+  ts.tv_sec  = msec / 1000;
+  ts.tv_nsec = (msec % 1000) * 1000000;
+  syscall(SYS_futex, (uint32_t*)doorbell, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+void ase_doorbell_ring(volatile uint32_t *doorbell)
+{
+  __sync_fetch_and_add(doorbell, 1);
+  syscall(SYS_futex, (uint32_t*)doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
 /*
  * Evaluate Session directory
  * If SIM_SIDE is set, Return "$ASE_WORKDIR/work/"
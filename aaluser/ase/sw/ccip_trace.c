@@ -0,0 +1,317 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: CCI-P binary trace writer
+ * Language   : C/C++
+ *
+ * Requests are posted by ccip_trace_issue() when the AFU issues them, and
+ * matched to their completion by channel, cache line address and mdata,
+ * oldest first. MMIO requests are matched by tid. Each completion writes
+ * one struct ccip_trace_rec_t (see ccip_trace.h).
+ *
+ */
+
+#include "ase_common.h"
+
+// Pending request table
+#define CCIP_TRACE_HASH_SIZE    4096
+#define CCIP_TRACE_POOL_CHUNK   1024
+#define CCIP_TRACE_FILE_BUFSIZE (1024*1024)
+#define CCIP_TRACE_MMIO_SLOTS   (1 << MMIO_TID_BITWIDTH)
+
+struct ccip_trace_pending_t
+{
+  struct ccip_trace_pending_t *next;
+  uint64_t cl_addr;
+  uint64_t tstamp;
+  uint16_t mdata;
+  uint8_t  channel;
+  uint8_t  vc;
+  uint8_t  reqtype;
+};
+
+static FILE *fp_ccip_trace = (FILE*)NULL;
+static char *ccip_trace_filebuf;
+
+static struct ccip_trace_pending_t *ccip_trace_hash[CCIP_TRACE_HASH_SIZE];
+static struct ccip_trace_pending_t *ccip_trace_free;
+
+// Outstanding MMIO requests, by tid
+struct ccip_trace_mmio_t
+{
+  uint64_t tstamp;
+  uint32_t addr;
+  uint8_t  valid;
+  uint8_t  write;
+  uint8_t  width;
+};
+static struct ccip_trace_mmio_t ccip_trace_mmio[CCIP_TRACE_MMIO_SLOTS];
+
+
+static uint32_t ccip_trace_hash_key(int channel, uint64_t cl_addr, int mdata)
+{
+  return (uint32_t)((cl_addr * 0x9E3779B1ULL) ^ ((uint64_t)mdata << 2) ^ (uint64_t)channel) % CCIP_TRACE_HASH_SIZE;
+}
+
+
+/*
+ * ccip_trace_open : Start a trace, clk_mhz is the clock of the cycle counts
+ */
+void ccip_trace_open(const char *filepath, double clk_mhz)
+{
+  FUNC_CALL_ENTRY;
+
+  struct ccip_trace_hdr_t hdr;
+
+  fp_ccip_trace = fopen(filepath, "wb");
+  if (fp_ccip_trace == (FILE*)NULL)
+    {
+      BEGIN_RED_FONTCOLOR;
+      printf("SIM-C : CCI-P trace %s could not be opened, trace DISABLED\n", filepath);
+      END_RED_FONTCOLOR;
+      ase_error_report("fopen", errno, ASE_OS_FOPEN_ERR);
+      FUNC_CALL_EXIT;
+      return;
+    }
+
+  ccip_trace_filebuf = ase_malloc(CCIP_TRACE_FILE_BUFSIZE);
+  setvbuf(fp_ccip_trace, ccip_trace_filebuf, _IOFBF, CCIP_TRACE_FILE_BUFSIZE);
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic    = CCIP_TRACE_MAGIC;
+  hdr.version  = CCIP_TRACE_VERSION;
+  hdr.rec_size = sizeof(struct ccip_trace_rec_t);
+  hdr.clk_mhz  = clk_mhz;
+  fwrite(&hdr, sizeof(hdr), 1, fp_ccip_trace);
+
+  memset(ccip_trace_hash, 0, sizeof(ccip_trace_hash));
+  memset(ccip_trace_mmio, 0, sizeof(ccip_trace_mmio));
+
+  printf("SIM-C : CCI-P binary trace => %s\n", filepath);
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ccip_trace_close : Flush and close the trace, drop pending requests
+ */
+void ccip_trace_close()
+{
+  FUNC_CALL_ENTRY;
+
+  struct ccip_trace_pending_t *ptr;
+  int ii;
+
+  if (fp_ccip_trace != NULL)
+    {
+      fclose(fp_ccip_trace);
+      fp_ccip_trace = (FILE*)NULL;
+      ase_free_buffer(ccip_trace_filebuf);
+    }
+
+  // Return every pending entry to the free list
+  for(ii = 0; ii < CCIP_TRACE_HASH_SIZE; ii++)
+    {
+      while (ccip_trace_hash[ii] != NULL)
+        {
+          ptr = ccip_trace_hash[ii];
+          ccip_trace_hash[ii] = ptr->next;
+          ptr->next = ccip_trace_free;
+          ccip_trace_free = ptr;
+        }
+    }
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ccip_trace_write : Append one record
+ */
+void ccip_trace_write(struct ccip_trace_rec_t *rec)
+{
+  if (fp_ccip_trace != NULL)
+    {
+      fwrite(rec, sizeof(struct ccip_trace_rec_t), 1, fp_ccip_trace);
+    }
+}
+
+
+/*
+ * DPI: ccip_trace_issue : AFU issued a request of 'len' cache lines
+ * - len is the CCI-P length field (0 = 1 CL)
+ */
+void ccip_trace_issue(long long cycle, int channel, int reqtype, int vc, int len, long long cl_addr, int mdata)
+{
+  struct ccip_trace_pending_t *entry;
+  struct ccip_trace_pending_t **tail;
+  int ii;
+
+  if (fp_ccip_trace == NULL)
+    {
+      return;
+    }
+
+  for(ii = 0; ii <= len; ii++)
+    {
+      // Grow the pool when it runs dry
+      if (ccip_trace_free == NULL)
+        {
+          int jj;
+          entry = (struct ccip_trace_pending_t *)ase_malloc(CCIP_TRACE_POOL_CHUNK * sizeof(struct ccip_trace_pending_t));
+          for(jj = 0; jj < CCIP_TRACE_POOL_CHUNK; jj++)
+            {
+              entry[jj].next = ccip_trace_free;
+              ccip_trace_free = &entry[jj];
+            }
+        }
+      entry = ccip_trace_free;
+      ccip_trace_free = entry->next;
+
+      entry->next    = NULL;
+      entry->cl_addr = (uint64_t)cl_addr + ii;
+      entry->tstamp  = (uint64_t)cycle;
+      entry->mdata   = (uint16_t)mdata;
+      entry->channel = (uint8_t)channel;
+      entry->vc      = (uint8_t)vc;
+      entry->reqtype = (uint8_t)reqtype;
+
+      // Append, so that the oldest request with this key is found first
+      tail = &ccip_trace_hash[ccip_trace_hash_key(channel, entry->cl_addr, mdata & 0xFFFF)];
+      while (*tail != NULL)
+        {
+          tail = &(*tail)->next;
+        }
+      *tail = entry;
+    }
+}
+
+
+/*
+ * ccip_trace_complete : A memory request completed (rd/wr_memline_dex)
+ */
+void ccip_trace_complete(uint64_t cycle, int channel, long long cl_addr, int mdata)
+{
+  struct ccip_trace_pending_t **pptr;
+  struct ccip_trace_pending_t *entry;
+  struct ccip_trace_rec_t rec;
+
+  if (fp_ccip_trace == NULL)
+    {
+      return;
+    }
+
+  memset(&rec, 0, sizeof(rec));
+  rec.tstamp  = cycle;
+  rec.cl_addr = (uint64_t)cl_addr;
+  rec.mdata   = (uint16_t)mdata;
+  rec.channel = (uint8_t)channel;
+  rec.latency = CCIP_TRACE_LATENCY_UNKNOWN;
+  rec.reqtype = (channel == CCIP_TRACE_CH_RD) ? CCIP_TRACE_RDLINE_I : CCIP_TRACE_WRLINE_I;
+
+  pptr = &ccip_trace_hash[ccip_trace_hash_key(channel, (uint64_t)cl_addr, mdata & 0xFFFF)];
+  while (*pptr != NULL)
+    {
+      entry = *pptr;
+      if ( (entry->channel == channel) && (entry->cl_addr == (uint64_t)cl_addr) && (entry->mdata == rec.mdata) )
+        {
+          rec.latency = (uint32_t)(cycle - entry->tstamp);
+          rec.vc      = entry->vc;
+          rec.reqtype = entry->reqtype;
+
+          *pptr = entry->next;
+          entry->next = ccip_trace_free;
+          ccip_trace_free = entry;
+          break;
+        }
+      pptr = &entry->next;
+    }
+
+  fwrite(&rec, sizeof(rec), 1, fp_ccip_trace);
+}
+
+
+/*
+ * ccip_trace_mmio_request : Software MMIO request reached the simulator
+ */
+void ccip_trace_mmio_request(uint64_t cycle, struct mmio_t *pkt)
+{
+  struct ccip_trace_mmio_t *slot;
+
+  if (fp_ccip_trace == NULL)
+    {
+      return;
+    }
+
+  slot = &ccip_trace_mmio[pkt->tid & (CCIP_TRACE_MMIO_SLOTS - 1)];
+  slot->tstamp = cycle;
+  slot->addr   = (uint32_t)pkt->addr;
+  slot->valid  = 1;
+  slot->write  = (pkt->write_en == MMIO_WRITE_REQ) ? 1 : 0;
+  slot->width  = (uint8_t)pkt->width;
+}
+
+
+/*
+ * ccip_trace_mmio_response : MMIO response sent back to software
+ */
+void ccip_trace_mmio_response(uint64_t cycle, struct mmio_t *pkt)
+{
+  struct ccip_trace_mmio_t *slot;
+  struct ccip_trace_rec_t rec;
+
+  if (fp_ccip_trace == NULL)
+    {
+      return;
+    }
+
+  slot = &ccip_trace_mmio[pkt->tid & (CCIP_TRACE_MMIO_SLOTS - 1)];
+
+  memset(&rec, 0, sizeof(rec));
+  rec.tstamp  = cycle;
+  rec.mdata   = (uint16_t)pkt->tid;
+  rec.channel = CCIP_TRACE_CH_MMIO;
+  rec.vc      = CCIP_TRACE_VC_VA;
+  if (slot->valid)
+    {
+      rec.cl_addr = slot->addr;
+      rec.latency = (uint32_t)(cycle - slot->tstamp);
+      rec.reqtype = slot->write ? CCIP_TRACE_MMIO_WR : CCIP_TRACE_MMIO_RD;
+      rec.width   = slot->width;
+      slot->valid = 0;
+    }
+  else
+    {
+      rec.cl_addr = (uint32_t)pkt->addr;
+      rec.latency = CCIP_TRACE_LATENCY_UNKNOWN;
+      rec.reqtype = (pkt->write_en == MMIO_WRITE_REQ) ? CCIP_TRACE_MMIO_WR : CCIP_TRACE_MMIO_RD;
+      rec.width   = (uint8_t)pkt->width;
+    }
+
+  fwrite(&rec, sizeof(rec), 1, fp_ccip_trace);
+}
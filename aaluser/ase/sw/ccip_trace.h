@@ -0,0 +1,103 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: CCI-P binary trace format
+ * Language   : C/C++
+ *
+ * The trace is a header followed by fixed size records, one per completed
+ * request, roughly in completion order. Times are CCI-P clock cycles
+ * (pClk). Written by ccip_trace.c, read by behav/ccip_trace_tool.cpp.
+ *
+ * Kept apart from ase_common.h so that offline tools can read traces
+ * without pulling in the ASE globals.
+ */
+
+#ifndef _CCIP_TRACE_H_
+#define _CCIP_TRACE_H_
+
+#include <stdint.h>
+
+// Trace file, written to the ASE work directory
+#define CCIP_TRACE_FILENAME        "ccip_trace.bin"
+
+// "ASETRC01", little endian
+#define CCIP_TRACE_MAGIC           0x3130435254455341ULL
+#define CCIP_TRACE_VERSION         1
+
+// Channels
+#define CCIP_TRACE_CH_RD           0    // C0 Tx: memory reads
+#define CCIP_TRACE_CH_WR           1    // C1 Tx: memory writes and fences
+#define CCIP_TRACE_CH_MMIO         2    // MMIO requests from software
+#define CCIP_TRACE_NUM_CH          3
+
+// Request types: CCI-P reqtype for memory channels (as ase_pkg.sv)
+#define CCIP_TRACE_RDLINE_S        0x1
+#define CCIP_TRACE_RDLINE_I        0x2
+#define CCIP_TRACE_WRLINE_I        0x3
+#define CCIP_TRACE_WRLINE_M        0x4
+#define CCIP_TRACE_WRPUSH          0x5
+#define CCIP_TRACE_WRFENCE         0x6
+#define CCIP_TRACE_INTR_REQ        0x7
+#define CCIP_TRACE_ATOMIC_REQ      0x8
+// ... and for MMIO
+#define CCIP_TRACE_MMIO_RD         0x0
+#define CCIP_TRACE_MMIO_WR         0x1
+
+// Virtual channels (as ccip_vc_t)
+#define CCIP_TRACE_VC_VA           0x0
+#define CCIP_TRACE_VC_VL0          0x1
+#define CCIP_TRACE_VC_VH0          0x2
+#define CCIP_TRACE_VC_VH1          0x3
+
+// Completion whose request was not seen
+#define CCIP_TRACE_LATENCY_UNKNOWN 0xFFFFFFFF
+
+// File header (32 bytes)
+struct ccip_trace_hdr_t
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t rec_size;      // sizeof(struct ccip_trace_rec_t)
+  double   clk_mhz;       // Clock of the cycle counts
+  uint64_t rsvd;
+};
+
+// Record (32 bytes)
+struct ccip_trace_rec_t
+{
+  uint64_t tstamp;        // Completion cycle
+  uint64_t cl_addr;       // Cache line address, or MMIO byte offset
+  uint32_t latency;       // Cycles from request to completion
+  uint16_t mdata;         // Metadata, or MMIO tid
+  uint8_t  channel;       // CCIP_TRACE_CH_*
+  uint8_t  vc;            // Requested virtual channel, VA for MMIO
+  uint8_t  reqtype;       // CCIP_TRACE_* request type
+  uint8_t  width;         // MMIO width in bits, 0 for memory
+  uint8_t  rsvd[6];
+};
+
+#endif // _CCIP_TRACE_H_
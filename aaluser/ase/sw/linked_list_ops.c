@@ -185,26 +185,163 @@ struct buffer_t* ll_search_buffer(int search_index)
 
 
 /*
- * Check if physical address is used
- * RETURN 0 if not found, 1 if found
+ * Physical address index
+ * Pointers to the buffers in the linked list, sorted by fake_paddr, so that
+ * an AFU physical address is found by binary search instead of a walk of the
+ * whole list. The buffer found last is tried first, as consecutive
+ * accesses mostly fall in the same buffer.
+ * Maintained by ase_alloc_action() and ase_dealloc_action().
  */
-uint32_t check_if_physaddr_used(uint64_t paddr)
+static struct buffer_t **physaddr_index = NULL;
+static uint32_t physaddr_index_count = 0;
+static uint32_t physaddr_index_size = 0;
+static struct buffer_t *physaddr_last_hit = NULL;
+
+
+// --------------------------------------------------------------------
+// ll_index_upper_bound : Position of the first buffer in the index
+// whose fake_paddr is greater than paddr
+// --------------------------------------------------------------------
+static uint32_t ll_index_upper_bound(uint64_t paddr)
 {
-  struct buffer_t *search_ptr;
-  int flag = 0;
+  uint32_t lo = 0;
+  uint32_t hi = physaddr_index_count;
+  uint32_t mid;
 
-  search_ptr = head;
-  while(search_ptr != NULL)
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo) / 2;
+      if (physaddr_index[mid]->fake_paddr <= paddr)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+
+// --------------------------------------------------------------------
+// ll_index_insert : Add a buffer to the physical address index
+// fake_paddr and fake_paddr_hi must be set before this is called
+// --------------------------------------------------------------------
+void ll_index_insert(struct buffer_t *buf)
+{
+  FUNC_CALL_ENTRY;
+
+  struct buffer_t **grown;
+  uint32_t pos;
+
+  // Double the index when it is full
+  if (physaddr_index_count == physaddr_index_size)
     {
-      if ( (paddr >= search_ptr->fake_paddr) && (paddr < search_ptr->fake_paddr_hi) )
+      grown = (struct buffer_t **)realloc(physaddr_index,
+                                          2 * (physaddr_index_size + 16) * sizeof(struct buffer_t *));
+      if (grown == NULL)
         {
-          flag = 1;
-          break;
+          ase_error_report("realloc", errno, ASE_OS_MALLOC_ERR);
+          ase_perror_teardown();
+          start_simkill_countdown();
+          return;
         }
-      else
+      physaddr_index = grown;
+      physaddr_index_size = 2 * (physaddr_index_size + 16);
+    }
+
+  pos = ll_index_upper_bound(buf->fake_paddr);
+  memmove(&physaddr_index[pos + 1],
+          &physaddr_index[pos],
+          (physaddr_index_count - pos) * sizeof(struct buffer_t *));
+  physaddr_index[pos] = buf;
+  physaddr_index_count++;
+
+  FUNC_CALL_EXIT;
+}
+
+
+// --------------------------------------------------------------------
+// ll_index_remove : Remove a buffer from the physical address index
+// --------------------------------------------------------------------
+void ll_index_remove(struct buffer_t *buf)
+{
+  FUNC_CALL_ENTRY;
+
+  uint32_t pos;
+
+  if (physaddr_last_hit == buf)
+    physaddr_last_hit = NULL;
+
+  // Buffers never share a fake_paddr, so buf is just before the upper bound
+  pos = ll_index_upper_bound(buf->fake_paddr);
+  if ((pos > 0) && (physaddr_index[pos - 1] == buf))
+    {
+      pos--;
+      memmove(&physaddr_index[pos],
+              &physaddr_index[pos + 1],
+              (physaddr_index_count - pos - 1) * sizeof(struct buffer_t *));
+      physaddr_index_count--;
+    }
+
+  FUNC_CALL_EXIT;
+}
+
+
+// --------------------------------------------------------------------
+// ll_search_physaddr : Search buffer containing a fake physical address
+// Returns NULL if no buffer contains paddr
+// --------------------------------------------------------------------
+struct buffer_t* ll_search_physaddr(uint64_t paddr)
+{
+  struct buffer_t *search_ptr;
+  uint32_t pos;
+
+  // Same buffer as last time ?
+  search_ptr = physaddr_last_hit;
+  if ( (search_ptr != NULL) && (paddr >= search_ptr->fake_paddr) && (paddr < search_ptr->fake_paddr_hi) )
+    return search_ptr;
+
+  // Else, the buffer starting last at or below paddr
+  pos = ll_index_upper_bound(paddr);
+  if (pos > 0)
+    {
+      search_ptr = physaddr_index[pos - 1];
+      if (paddr < search_ptr->fake_paddr_hi)
         {
-          search_ptr = search_ptr->next;
+          physaddr_last_hit = search_ptr;
+          return search_ptr;
         }
     }
-  return flag;
+
+  return (struct buffer_t *)NULL;
+}
+
+
+/*
+ * Check if physical address range [paddr, paddr + size) overlaps a buffer
+ * RETURN 0 if not, 1 if it does
+ */
+uint32_t check_if_physrange_used(uint64_t paddr, uint64_t size)
+{
+  uint32_t pos;
+
+  // The buffer starting last at or below paddr must end at or below paddr
+  pos = ll_index_upper_bound(paddr);
+  if ((pos > 0) && (paddr < physaddr_index[pos - 1]->fake_paddr_hi))
+    return 1;
+
+  // The next buffer must start at or above the end of the range
+  if ((pos < physaddr_index_count) && (physaddr_index[pos]->fake_paddr < paddr + size))
+    return 1;
+
+  return 0;
+}
+
+
+/*
+ * Check if physical address is used
+ * RETURN 0 if not found, 1 if found
+ */
+uint32_t check_if_physaddr_used(uint64_t paddr)
+{
+  return (ll_search_physaddr(paddr) == NULL) ? 0 : 1;
 }
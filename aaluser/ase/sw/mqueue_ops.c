@@ -52,6 +52,40 @@ const char * mq_name_arr[] =
   };
 
 
+/*
+ * Shared memory transport
+ *
+ * Every message queue also has a single-producer, single-consumer ring in
+ * one /dev/shm segment, created by the simulator in ase_init(). An
+ * application attaches to it in session_init(), and from then on both
+ * sides pass that session's messages through the rings instead of the
+ * named pipes, without a system call per message. A consumer that finds
+ * its ring empty spins for a while, then sleeps on the ring's futex
+ * doorbell; a producer rings the doorbell only if the consumer said it is
+ * asleep.
+ *
+ * The rings are opt-in: an application attaches only when
+ * env(ASE_IPC_TRANSPORT) is set to "shm". The named pipes are still
+ * opened, and are used whenever no application is attached.
+ */
+static struct ase_ring_seg_t *ring_seg = NULL;
+
+// Descriptor of each open message queue + 1, 0 if not open
+static int ring_mq[ASE_MQ_INSTANCES];
+
+#ifndef SIM_SIDE
+// This application is attached and passes messages through the rings
+static volatile int ring_active = 0;
+
+// Serializes the threads sending or receiving on each queue. Threads are
+// not cancelled while they hold one.
+static pthread_mutex_t ring_lock[ASE_MQ_INSTANCES];
+#endif
+
+// Blocked receivers are to give up, the session is ending
+static volatile int ring_stopping = 0;
+
+
 /*
  * get_smq_perm_flag : Calculate perm_flag based on string name
  *      Automates the assignment of MQ flags
@@ -266,6 +300,14 @@ int mqueue_open(char *mq_name, int perm_flag)
     }
 #endif
 
+  // Remember which queue the descriptor belongs to
+  int ipc_iter;
+  for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+    {
+      if (strncmp(mq_array[ipc_iter].name, mq_name, ASE_MQ_NAME_LEN) == 0)
+        ring_mq[ipc_iter] = mq + 1;
+    }
+
   FUNC_CALL_EXIT;
 
   // Free temp variables
@@ -283,6 +325,14 @@ void mqueue_close(int mq)
   FUNC_CALL_ENTRY;
 
   int ret;
+  int ipc_iter;
+
+  for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+    {
+      if (ring_mq[ipc_iter] == mq + 1)
+        ring_mq[ipc_iter] = 0;
+    }
+
   ret = close (mq);
   if (ret == -1)
     {
@@ -329,6 +379,116 @@ void mqueue_destroy(char* mq_name_suffix)
 }
 
 
+// ------------------------------------------------------------
+// Shared memory ring helpers
+// ------------------------------------------------------------
+// Ring of an open message queue, if messages go through the rings, else -1
+static int mqueue_ring_index(int mq)
+{
+  int ipc_iter;
+
+#ifdef SIM_SIDE
+  if ((ring_seg == NULL) || (ring_seg->app_pid == 0))
+    return -1;
+#else
+  if (!ring_active)
+    return -1;
+#endif
+
+  for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+    {
+      if (ring_mq[ipc_iter] == mq + 1)
+        return ipc_iter;
+    }
+  return -1;
+}
+
+// Is the process at the other end of the rings still there ?
+static int ring_peer_alive()
+{
+  pid_t peer_pid;
+
+#ifdef SIM_SIDE
+  peer_pid = ring_seg->app_pid;
+#else
+  peer_pid = ring_seg->sim_pid;
+#endif
+
+  if (peer_pid == 0)
+    return 0;
+  return ((kill(peer_pid, 0) == 0) || (errno != ESRCH)) ? 1 : 0;
+}
+
+// Copy a message into the ring; waits while the ring is full
+static void ring_send(struct ase_ring_t *ring, const char *str, int size)
+{
+  uint64_t head = ring->head;
+  int spin = 0;
+
+  // Consumers free slots without a doorbell, so poll
+  while ((head - ring->tail) >= ASE_RING_SLOTS)
+    {
+      if (++spin > ase_spin_polls())
+        {
+          if (!ring_peer_alive())
+            return;
+          usleep(1);
+        }
+    }
+
+  if (size > ASE_MQ_MSGSIZE)
+    size = ASE_MQ_MSGSIZE;
+  ring->slot[head & (ASE_RING_SLOTS - 1)].len = size;
+  memcpy(ring->slot[head & (ASE_RING_SLOTS - 1)].data, str, size);
+
+  // Publish, then wake the consumer if it went to sleep
+  __sync_synchronize();
+  ring->head = head + 1;
+  __sync_synchronize();
+  if (ring->waiting && __sync_bool_compare_and_swap(&ring->waiting, 1, 0))
+    ase_doorbell_ring(&ring->doorbell);
+}
+
+// Copy the oldest message out of the ring. If blocking, waits for one
+// unless the other side has gone away.
+static int ring_recv(struct ase_ring_t *ring, char *str, int size, int blocking)
+{
+  uint64_t tail = ring->tail;
+  uint32_t doorbell;
+  int spin = 0;
+  int len;
+
+  while (ring->head == tail)
+    {
+      if (!blocking)
+        return ASE_MSG_ABSENT;
+      if (++spin <= ase_spin_polls())
+        continue;
+
+      // Idle: ask for the doorbell, and look once more before sleeping
+      doorbell = ring->doorbell;
+      ring->waiting = 1;
+      __sync_synchronize();
+      if ((ring->head == tail) && !ring_stopping)
+        ase_doorbell_wait(&ring->doorbell, doorbell, ASE_DOORBELL_WAIT_MSEC);
+      ring->waiting = 0;
+
+      if ((ring->head == tail) && (ring_stopping || !ring_peer_alive()))
+        return ASE_MSG_ABSENT;
+    }
+
+  __sync_synchronize();
+  len = ring->slot[tail & (ASE_RING_SLOTS - 1)].len;
+  if (len > size)
+    len = size;
+  memcpy(str, ring->slot[tail & (ASE_RING_SLOTS - 1)].data, len);
+  __sync_synchronize();
+  ring->tail = tail + 1;
+
+  return ASE_MSG_PRESENT;
+}
+
+
 // ------------------------------------------------------------
 // mqueue_send(): Easy send function
 // - Typecast any message as a character array and ram it in.
@@ -338,6 +498,28 @@ void mqueue_send(int mq, const char* str, int size)
   FUNC_CALL_ENTRY;
 
   int ret_tx;
+  int ring_idx;
+#ifndef SIM_SIDE
+  int cancel_state;
+#endif
+
+  // Shared memory ring, if attached
+  ring_idx = mqueue_ring_index(mq);
+  if (ring_idx >= 0)
+    {
+#ifndef SIM_SIDE
+      pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+      pthread_mutex_lock(&ring_lock[ring_idx]);
+#endif
+      ring_send(&ring_seg->ring[ring_idx], str, size);
+#ifndef SIM_SIDE
+      pthread_mutex_unlock(&ring_lock[ring_idx]);
+      pthread_setcancelstate(cancel_state, NULL);
+#endif
+      FUNC_CALL_EXIT;
+      return;
+    }
+
   ret_tx = write(mq, (void*)str, size);
 
   if ((ret_tx == 0) || (ret_tx != size))
@@ -361,6 +543,28 @@ int mqueue_recv(int mq, char* str, int size)
   FUNC_CALL_ENTRY;
 
   int ret;
+  int ring_idx;
+#ifndef SIM_SIDE
+  int cancel_state;
+#endif
+
+  // Shared memory ring, if attached
+  ring_idx = mqueue_ring_index(mq);
+  if (ring_idx >= 0)
+    {
+#ifndef SIM_SIDE
+      pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+      pthread_mutex_lock(&ring_lock[ring_idx]);
+#endif
+      ret = ring_recv(&ring_seg->ring[ring_idx], str, size,
+                      (mq_array[ring_idx].perm_flag & O_NONBLOCK) ? 0 : 1);
+#ifndef SIM_SIDE
+      pthread_mutex_unlock(&ring_lock[ring_idx]);
+      pthread_setcancelstate(cancel_state, NULL);
+#endif
+      FUNC_CALL_EXIT;
+      return ret;
+    }
 
   ret = read(mq, str, size);
   FUNC_CALL_EXIT;
@@ -373,3 +577,243 @@ int mqueue_recv(int mq, char* str, int size)
       return ASE_MSG_ABSENT;
     }
 }
+
+
+// ------------------------------------------------------------------
+// mqueue_ring_name(): Name of the ring segment of this work directory
+// ------------------------------------------------------------------
+static int mqueue_ring_name(char *name)
+{
+  struct stat workdir_stat;
+
+  if (stat(ase_workdir_path, &workdir_stat) != 0)
+    return -1;
+
+  snprintf(name, ASE_FILEPATH_LEN, "/ase_ring.%d.%lx.%lx",
+           (int)getuid(),
+           (unsigned long)workdir_stat.st_dev,
+           (unsigned long)workdir_stat.st_ino);
+  return 0;
+}
+
+
+#ifdef SIM_SIDE
+// ------------------------------------------------------------------
+// mqueue_ring_create(): Create the ring segment (simulator)
+// If this fails, the simulator only talks over named pipes
+// ------------------------------------------------------------------
+void mqueue_ring_create()
+{
+  FUNC_CALL_ENTRY;
+
+  char ring_name[ASE_FILEPATH_LEN];
+  int fd;
+  void *seg;
+
+  if (mqueue_ring_name(ring_name) != 0)
+    {
+      printf("SIM-C : Shared memory rings not available, using named pipes\n");
+      FUNC_CALL_EXIT;
+      return;
+    }
+
+  shm_unlink(ring_name);
+  fd = shm_open(ring_name, O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR);
+  if (fd < 0)
+    {
+      ase_error_report("shm_open", errno, ASE_OS_SHM_ERR);
+      FUNC_CALL_EXIT;
+      return;
+    }
+  add_to_ipc_list ("SHM", ring_name);
+
+  if (ftruncate(fd, (off_t)sizeof(struct ase_ring_seg_t)) != 0)
+    {
+      ase_error_report("ftruncate", errno, ASE_OS_SHM_ERR);
+      close(fd);
+      shm_unlink(ring_name);
+      FUNC_CALL_EXIT;
+      return;
+    }
+
+  seg = mmap(NULL, sizeof(struct ase_ring_seg_t), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (seg == MAP_FAILED)
+    {
+      ase_error_report("mmap", errno, ASE_OS_MEMMAP_ERR);
+      shm_unlink(ring_name);
+      FUNC_CALL_EXIT;
+      return;
+    }
+
+  ring_seg = (struct ase_ring_seg_t *)seg;
+  memset(ring_seg, 0, sizeof(struct ase_ring_seg_t));
+  ring_seg->version = ASE_RING_VERSION;
+  ring_seg->msgsize = ASE_MQ_MSGSIZE;
+  ring_seg->sim_pid = getpid();
+  __sync_synchronize();
+  ring_seg->magic   = ASE_RING_MAGIC;
+
+  printf("SIM-C : Shared memory rings created => /dev/shm%s\n", ring_name);
+
+  FUNC_CALL_EXIT;
+}
+
+
+// ------------------------------------------------------------------
+// mqueue_ring_destroy(): Unmap and remove the ring segment (simulator)
+// ------------------------------------------------------------------
+void mqueue_ring_destroy()
+{
+  FUNC_CALL_ENTRY;
+
+  char ring_name[ASE_FILEPATH_LEN];
+
+  if (ring_seg != NULL)
+    {
+      munmap((void*)ring_seg, sizeof(struct ase_ring_seg_t));
+      ring_seg = NULL;
+      if (mqueue_ring_name(ring_name) == 0)
+        shm_unlink(ring_name);
+    }
+
+  FUNC_CALL_EXIT;
+}
+#else
+// ------------------------------------------------------------------
+// mqueue_ring_attach(): Attach to the simulator's ring segment
+// Call after the message queues are opened, before any is used.
+// RETURN 1 if attached, 0 if the named pipes are to be used
+// ------------------------------------------------------------------
+int mqueue_ring_attach()
+{
+  FUNC_CALL_ENTRY;
+
+  char ring_name[ASE_FILEPATH_LEN];
+  char *transport;
+  int fd;
+  int ipc_iter;
+  void *seg;
+
+  if (mqueue_ring_name(ring_name) != 0)
+    {
+      FUNC_CALL_EXIT;
+      return 0;
+    }
+
+  fd = shm_open(ring_name, O_RDWR, S_IRUSR|S_IWUSR);
+  if (fd < 0)
+    {
+      // Simulator without rings
+      FUNC_CALL_EXIT;
+      return 0;
+    }
+
+  seg = mmap(NULL, sizeof(struct ase_ring_seg_t), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (seg == MAP_FAILED)
+    {
+      FUNC_CALL_EXIT;
+      return 0;
+    }
+
+  ring_seg = (struct ase_ring_seg_t *)seg;
+  if ( (ring_seg->magic != ASE_RING_MAGIC) ||
+       (ring_seg->version != ASE_RING_VERSION) ||
+       (ring_seg->msgsize != ASE_MQ_MSGSIZE) )
+    {
+      BEGIN_YELLOW_FONTCOLOR;
+      printf("  [APP]  Shared memory rings do not match this library, using named pipes\n");
+      END_YELLOW_FONTCOLOR;
+      munmap(seg, sizeof(struct ase_ring_seg_t));
+      ring_seg = NULL;
+      FUNC_CALL_EXIT;
+      return 0;
+    }
+
+  // Rings not requested: make sure the simulator does not expect them
+  transport = getenv("ASE_IPC_TRANSPORT");
+  if ((transport == NULL) || (strcmp(transport, "shm") != 0))
+    {
+      ring_seg->app_pid = 0;
+      __sync_synchronize();
+      munmap(seg, sizeof(struct ase_ring_seg_t));
+      ring_seg = NULL;
+      FUNC_CALL_EXIT;
+      return 0;
+    }
+
+  // Drop anything left for an earlier application
+  for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+    {
+      pthread_mutex_init(&ring_lock[ipc_iter], NULL);
+      if (strncmp(mq_array[ipc_iter].name, "sim2app", 7) == 0)
+        ring_seg->ring[ipc_iter].tail = ring_seg->ring[ipc_iter].head;
+    }
+
+  ring_stopping = 0;
+  __sync_synchronize();
+  ring_seg->app_pid = getpid();
+  ring_active = 1;
+
+  BEGIN_YELLOW_FONTCOLOR;
+  printf("  [APP]  Using shared memory rings => /dev/shm%s\n", ring_name);
+  END_YELLOW_FONTCOLOR;
+
+  FUNC_CALL_EXIT;
+  return 1;
+}
+#endif
+
+
+#ifndef SIM_SIDE
+// ------------------------------------------------------------------
+// mqueue_ring_stop(): Wake the threads blocked receiving on the rings,
+// and have them return ASE_MSG_ABSENT from now on. Call at session
+// end, before joining them; the rings stay mapped until
+// mqueue_ring_detach().
+// ------------------------------------------------------------------
+void mqueue_ring_stop()
+{
+  FUNC_CALL_ENTRY;
+
+  int ipc_iter;
+
+  if (ring_active)
+    {
+      ring_stopping = 1;
+      __sync_synchronize();
+      for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
+        ase_doorbell_ring(&ring_seg->ring[ipc_iter].doorbell);
+    }
+
+  FUNC_CALL_EXIT;
+}
+#endif
+
+
+// ------------------------------------------------------------------
+// mqueue_ring_detach(): Go back to the named pipes
+// Simulator: after answering a session's ASE_SIMKILL, so that the next
+//   application may use either transport.
+// Application: at session end, once the threads that used the rings
+//   have been joined.
+// ------------------------------------------------------------------
+void mqueue_ring_detach()
+{
+  FUNC_CALL_ENTRY;
+
+#ifdef SIM_SIDE
+  if (ring_seg != NULL)
+    ring_seg->app_pid = 0;
+#else
+  if (ring_active)
+    {
+      ring_active = 0;
+      munmap((void*)ring_seg, sizeof(struct ase_ring_seg_t));
+      ring_seg = NULL;
+    }
+#endif
+
+  FUNC_CALL_EXIT;
+}
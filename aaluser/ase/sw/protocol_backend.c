@@ -259,6 +259,12 @@ void wr_memline_dex(cci_pkt *pkt)
 /*     } */
 /* #endif */
 
+  // CCI-P trace (write or fence completion)
+  if (cfg->enable_ccip_trace)
+    {
+      ccip_trace_complete((uint64_t)ase_trace_cycle(), CCIP_TRACE_CH_WR, pkt->cl_addr, (int)pkt->mdata);
+    }
+
   FUNC_CALL_EXIT;
 }
 
@@ -280,6 +286,12 @@ void rd_memline_dex(cci_pkt *pkt )
   // Read from memory
   memcpy((char*)pkt->qword, rd_target_vaddr, CL_BYTE_WIDTH);
 
+  // CCI-P trace
+  if (cfg->enable_ccip_trace)
+    {
+      ccip_trace_complete((uint64_t)ase_trace_cycle(), CCIP_TRACE_CH_RD, pkt->cl_addr, (int)pkt->mdata);
+    }
+
   FUNC_CALL_EXIT;
 }
 
@@ -298,6 +310,12 @@ void mmio_response (struct mmio_t *mmio_pkt)
   print_mmiopkt(fp_memaccess_log, "MMIO Got ", mmio_pkt);
 #endif
 
+  // CCI-P trace
+  if (cfg->enable_ccip_trace)
+    {
+      ccip_trace_mmio_response((uint64_t)ase_trace_cycle(), mmio_pkt);
+    }
+
   // Send MMIO Response
   mqueue_send(sim2app_mmiorsp_tx, (char*)mmio_pkt, sizeof(mmio_t));
 
@@ -574,6 +592,9 @@ int ase_listener()
               // Send portctrl_rsp message
               mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg, ASE_MQ_MSGSIZE);
 
+              // Session is over, next application may use either transport
+              mqueue_ring_detach();
+
               // Clean up session OD
               ase_free_buffer(glbl_session_id);
             }
@@ -714,6 +735,10 @@ int ase_listener()
 #ifdef ASE_DEBUG
           print_mmiopkt(fp_memaccess_log, "MMIO Sent", incoming_mmio_pkt);
 #endif
+          if (cfg->enable_ccip_trace)
+            {
+              ccip_trace_mmio_request((uint64_t)ase_trace_cycle(), incoming_mmio_pkt);
+            }
           mmio_dispatch (0, incoming_mmio_pkt);
         }
 
@@ -903,6 +928,9 @@ int ase_init()
   sim2app_portctrl_rsp_tx = mqueue_open(mq_array[8].name,  mq_array[8].perm_flag);
   sim2app_intr_request_tx = mqueue_open(mq_array[9].name,  mq_array[9].perm_flag);
 
+  // Shared memory rings for the same messages
+  mqueue_ring_create();
+
   // Calculate memory map regions
   printf("SIM-C : Calculating memory map...\n");
   calc_phys_memory_ranges();
@@ -931,6 +959,12 @@ int ase_init()
       printf("SIM-C : Information about opened workspaces => workspace_info.log \n");
     }
 
+  // CCI-P binary trace
+  if (cfg->enable_ccip_trace)
+    {
+      ccip_trace_open(CCIP_TRACE_FILENAME, ASE_PCLK_MHZ);
+    }
+
   fflush(stdout);
 
   FUNC_CALL_EXIT;
@@ -1034,6 +1068,7 @@ void start_simkill_countdown()
   int ipc_iter;
   for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
     mqueue_destroy(mq_array[ipc_iter].name);
+  mqueue_ring_destroy();
 
   // Destroy all open shared memory regions
   printf("SIM-C : Unlinking Shared memory regions.... \n");
@@ -1058,6 +1093,9 @@ void start_simkill_countdown()
       fclose(fp_workspace_log);
     }
 
+  // Close CCI-P trace
+  ccip_trace_close();
+
 #ifdef ASE_DEBUG
   if (fp_memaccess_log != NULL)
     {
@@ -1083,6 +1121,10 @@ void start_simkill_countdown()
   printf("SIM-C : Simulation generated log files\n");
   printf("        Transactions file       | $ASE_WORKDIR/ccip_transactions.tsv\n");
   printf("        Workspaces info         | $ASE_WORKDIR/workspace_info.log\n");
+  if (cfg->enable_ccip_trace)
+    {
+      printf("        CCI-P binary trace      | $ASE_WORKDIR/%s\n", CCIP_TRACE_FILENAME);
+    }
   END_GREEN_FONTCOLOR;
   if ( access(ccip_sniffer_file_statpath, F_OK) != -1 )
     {
@@ -1173,6 +1215,7 @@ void ase_config_parse(char *filename)
       cfg->enable_cl_view           = 1;
       cfg->usr_tps                  = DEFAULT_USR_CLK_TPS;
       cfg->phys_memory_available_gb = 256;
+      cfg->enable_ccip_trace        = 0;
 
       // Fclk Mhz
       f_usrclk = DEFAULT_USR_CLK_MHZ;
@@ -1254,6 +1297,14 @@ void ase_config_parse(char *filename)
                                   cfg->enable_cl_view =  atoi(pch);
                                 }
                             }
+                          else if (strncmp (parameter,"ENABLE_CCIP_TRACE", 20) == 0)
+                            {
+                              pch = strtok(NULL, "");
+                              if (pch != NULL)
+                                {
+                                  cfg->enable_ccip_trace =  atoi(pch);
+                                }
+                            }
                           else if (strncmp (parameter, "USR_CLK_MHZ", 20) == 0)
                             {
                               pch = strtok(NULL, "");
@@ -1406,6 +1457,12 @@ void ase_config_parse(char *filename)
       else
         printf("        ASE Transaction view       ... DISABLED\n");
 
+      // Binary trace
+      if (cfg->enable_ccip_trace != 0)
+        printf("        CCI-P binary trace         ... ENABLED ($ASE_WORKDIR/%s)\n", CCIP_TRACE_FILENAME);
+      else
+        printf("        CCI-P binary trace         ... DISABLED\n");
+
       // User clock frequency
       printf("        User Clock Frequency       ... %.6f MHz, T_uclk = %d ps \n", f_usrclk, cfg->usr_tps);
       if (f_usrclk != DEFAULT_USR_CLK_MHZ)
@@ -436,6 +436,18 @@ BEGIN_NAMESPACE(AAL)
       virtual void        SetFlush (btBool flush) = 0;
       virtual btBool      GetFlush () const = 0;
 
+      /// @brief Tells the Logger whether to write from a background thread.
+      ///
+      /// When true, Log() copies the line into a bounded in-memory ring and returns
+      ///    without taking the Logger lock or touching the destination. A writer thread
+      ///    drains the ring and writes the lines in batches. When the ring is full, the
+      ///    line is dropped and counted; the writer reports the count in the log.
+      /// Setting false writes out every line already handed over before it returns.
+      virtual void        SetAsync (btBool fAsync) = 0;
+      virtual btBool      GetAsync () const = 0;
+      /// @brief Number of lines dropped because the asynchronous ring was full.
+      virtual btUnsigned64bitInt GetDropped () const = 0;
+
    }; // class ILogger
 
    // AAL scope, get a heap-allocated instance of an object that implements ILogger
@@ -0,0 +1,214 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file AALNVSBinary.h
+/// @brief Binary wire format for NamedValueSets, and an in-place read-only view.
+/// @ingroup BasicTypes
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_AALNVSBINARY_H__
+#define __AALSDK_AALNVSBINARY_H__
+#include <aalsdk/AALNamedValueSet.h>
+
+BEGIN_NAMESPACE(AAL)
+
+/* Binary NamedValueSet wire format, version 1.
+ * All fields are in host byte order; a buffer from a host of the other byte order does
+ *    not carry NVS_BINARY_MAGIC and is rejected. Every entry and every value begins on
+ *    an 8-byte boundary relative to the start of the buffer, and padding is zero.
+ *
+ *    Header  { u32 Magic, u16 Version, u16 HeaderSize (16), u32 Length, u32 Reserved }
+ *            followed by the root Set. Length counts all bytes, including the Header.
+ *    Set     { u32 Count, u32 Size } followed by Count Entries. Size includes the 8
+ *            bytes of the Set header.
+ *    Entry   { u32 Size, u16 NameType, u16 Type, u32 KeyLen, u32 Elements }, then the
+ *            key, then the value, padded to Size (a multiple of 8).
+ *            NameType is an eNameTypes: a btNumberKey is 8 bytes, KeyLen 8; a
+ *            btStringKey is KeyLen characters and a terminating NUL.
+ *            Type is an eBasicTypes. Elements is 1 for scalars and nested Sets, the
+ *            string length (excluding the NUL) for btString, and the element count for
+ *            arrays.
+ *    Values  Scalars occupy an 8-byte slot (btObjectType as 64 bits). A btString is its
+ *            characters and a NUL. A btNamedValueSet is a Set. Numeric arrays are their
+ *            elements, contiguous (btObjectArray as 64-bit elements). A btStringArray is
+ *            Elements u32 offsets, from the start of the value, to NUL-terminated strings
+ *            that follow the offsets back to back.
+ *
+ * Nothing in the format refers outside of itself, so an encoded NVS can be copied,
+ *    mapped, or sent between processes as is, and read in place with NVSView.
+ */
+#define NVS_BINARY_MAGIC     0x4253564EU   // "NVSB" when stored little-endian
+#define NVS_BINARY_VERSION   1
+#define NVS_BINARY_MAX_DEPTH 64            // Deepest nesting of Sets encoded or accepted.
+
+/// Returns true if senders are to use the binary form on the wire. Receivers accept both
+///   forms, but peers that predate the binary form read only text, so this is false
+///   unless the environment variable AAL_NVS_WIRE is "binary" in the sending process.
+AASLIB_API btBool       NVSBinaryOnWire();
+
+/// Returns true if pBuf/Len begins with a binary NVS header of a supported version.
+///   The body is not validated.
+AASLIB_API btBool       IsNVSBinary(const void *pBuf, btWSSize Len);
+
+/// Returns the number of bytes NVSToBinary() needs to encode rNVS, or 0 if rNVS can not
+///   be encoded (nesting deeper than NVS_BINARY_MAX_DEPTH, or a Set over 4 GB).
+AASLIB_API btWSSize     NVSBinarySize(const INamedValueSet &rNVS);
+
+/// Encodes rNVS into the Len bytes at pBuf, and returns the number of bytes written in
+///   *pUsed. If Len is less than NVSBinarySize(rNVS), returns ENamedValuesIndexOutOfRange
+///   with the size needed in *pUsed, and the contents of pBuf are undefined.
+AASLIB_API ENamedValues NVSToBinary(const INamedValueSet &rNVS,
+                                    void                 *pBuf,
+                                    btWSSize              Len,
+                                    btWSSize             *pUsed);
+
+/// Validates the binary NVS at pBuf and adds its contents to rNVS. pBuf need not be
+///   aligned. Returns ENamedValuesBadType if pBuf/Len is not a well-formed binary NVS,
+///   in which case rNVS may hold part of the contents.
+AASLIB_API ENamedValues NVSFromBinary(INamedValueSet &rNVS, const void *pBuf, btWSSize Len);
+
+
+/// @brief Read-only view of a binary NVS, queried in place.
+///
+/// The constructor validates the whole buffer once, so every later query is a bounds-safe
+///   walk of the entries. Nothing is copied: strings and arrays are returned as pointers
+///   into the buffer, which must outlive the view and any pointer obtained from it.
+///   Lookups are linear in the number of names in the Set.
+/// The buffer must be 8-byte aligned, as any new[] or malloc() buffer is; a misaligned
+///   buffer leaves the view !IsOK(). Use NVSFromBinary() for buffers of unknown alignment.
+class AASLIB_API NVSView
+{
+public:
+   NVSView();
+   NVSView(const void *pBuf, btWSSize Len);
+
+   btBool IsOK() const { return NULL != m_pSet; }
+
+   ENamedValues GetNumNames(btUnsignedInt *pNum)                       const;
+   ENamedValues GetNameType(btUnsignedInt index, eNameTypes *pType)    const;
+   ENamedValues     GetName(btUnsignedInt index, btNumberKey *pName)   const;
+   ENamedValues     GetName(btUnsignedInt index, btStringKey *pName)   const;
+
+   btBool                Has(btNumberKey Name)                         const { return NULL != Find(Name); }
+   btBool                Has(btStringKey Name)                         const { return NULL != Find(Name); }
+   ENamedValues         Type(btNumberKey Name, eBasicTypes *pType)     const { return TypeOf(Find(Name), pType);  }
+   ENamedValues         Type(btStringKey Name, eBasicTypes *pType)     const { return TypeOf(Find(Name), pType);  }
+   ENamedValues      GetSize(btNumberKey Name, btWSSize *pSize)        const { return SizeOf(Find(Name), pSize);  }
+   ENamedValues      GetSize(btStringKey Name, btWSSize *pSize)        const { return SizeOf(Find(Name), pSize);  }
+
+   // Scalars, btStrings, and nested Sets. A btString points into the buffer.
+   // GetArray() points at the elements of a numeric array, in the buffer.
+   // GetElement() returns element i of a btStringArray or btObjectArray.
+   ENamedValues        Get(btNumberKey Name, btBool *pValue)                        const { return Scalar(Find(Name), btBool_t,             pValue); }
+   ENamedValues        Get(btNumberKey Name, btByte *pValue)                        const { return Scalar(Find(Name), btByte_t,             pValue); }
+   ENamedValues        Get(btNumberKey Name, bt32bitInt *pValue)                    const { return Scalar(Find(Name), bt32bitInt_t,         pValue); }
+   ENamedValues        Get(btNumberKey Name, btUnsigned32bitInt *pValue)            const { return Scalar(Find(Name), btUnsigned32bitInt_t, pValue); }
+   ENamedValues        Get(btNumberKey Name, bt64bitInt *pValue)                    const { return Scalar(Find(Name), bt64bitInt_t,         pValue); }
+   ENamedValues        Get(btNumberKey Name, btUnsigned64bitInt *pValue)            const { return Scalar(Find(Name), btUnsigned64bitInt_t, pValue); }
+   ENamedValues        Get(btNumberKey Name, btFloat *pValue)                       const { return Scalar(Find(Name), btFloat_t,            pValue); }
+   ENamedValues        Get(btNumberKey Name, btObjectType *pValue)                  const { return Object(Find(Name), pValue); }
+   ENamedValues        Get(btNumberKey Name, btcString *pValue)                     const { return String(Find(Name), pValue); }
+   ENamedValues        Get(btNumberKey Name, NVSView *pValue)                       const { return Nested(Find(Name), pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const btByte **pValue)                 const { return Array(Find(Name), btByteArray_t,             pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const bt32bitInt **pValue)             const { return Array(Find(Name), bt32bitIntArray_t,         pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const btUnsigned32bitInt **pValue)     const { return Array(Find(Name), btUnsigned32bitIntArray_t, pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const bt64bitInt **pValue)             const { return Array(Find(Name), bt64bitIntArray_t,         pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const btUnsigned64bitInt **pValue)     const { return Array(Find(Name), btUnsigned64bitIntArray_t, pValue); }
+   ENamedValues   GetArray(btNumberKey Name, const btFloat **pValue)                const { return Array(Find(Name), btFloatArray_t,            pValue); }
+   ENamedValues GetElement(btNumberKey Name, btUnsignedInt i, btcString *pValue)    const { return StringAt(Find(Name), i, pValue); }
+   ENamedValues GetElement(btNumberKey Name, btUnsignedInt i, btObjectType *pValue) const { return ObjectAt(Find(Name), i, pValue); }
+
+   ENamedValues        Get(btStringKey Name, btBool *pValue)                        const { return Scalar(Find(Name), btBool_t,             pValue); }
+   ENamedValues        Get(btStringKey Name, btByte *pValue)                        const { return Scalar(Find(Name), btByte_t,             pValue); }
+   ENamedValues        Get(btStringKey Name, bt32bitInt *pValue)                    const { return Scalar(Find(Name), bt32bitInt_t,         pValue); }
+   ENamedValues        Get(btStringKey Name, btUnsigned32bitInt *pValue)            const { return Scalar(Find(Name), btUnsigned32bitInt_t, pValue); }
+   ENamedValues        Get(btStringKey Name, bt64bitInt *pValue)                    const { return Scalar(Find(Name), bt64bitInt_t,         pValue); }
+   ENamedValues        Get(btStringKey Name, btUnsigned64bitInt *pValue)            const { return Scalar(Find(Name), btUnsigned64bitInt_t, pValue); }
+   ENamedValues        Get(btStringKey Name, btFloat *pValue)                       const { return Scalar(Find(Name), btFloat_t,            pValue); }
+   ENamedValues        Get(btStringKey Name, btObjectType *pValue)                  const { return Object(Find(Name), pValue); }
+   ENamedValues        Get(btStringKey Name, btcString *pValue)                     const { return String(Find(Name), pValue); }
+   ENamedValues        Get(btStringKey Name, NVSView *pValue)                       const { return Nested(Find(Name), pValue); }
+   ENamedValues   GetArray(btStringKey Name, const btByte **pValue)                 const { return Array(Find(Name), btByteArray_t,             pValue); }
+   ENamedValues   GetArray(btStringKey Name, const bt32bitInt **pValue)             const { return Array(Find(Name), bt32bitIntArray_t,         pValue); }
+   ENamedValues   GetArray(btStringKey Name, const btUnsigned32bitInt **pValue)     const { return Array(Find(Name), btUnsigned32bitIntArray_t, pValue); }
+   ENamedValues   GetArray(btStringKey Name, const bt64bitInt **pValue)             const { return Array(Find(Name), bt64bitIntArray_t,         pValue); }
+   ENamedValues   GetArray(btStringKey Name, const btUnsigned64bitInt **pValue)     const { return Array(Find(Name), btUnsigned64bitIntArray_t, pValue); }
+   ENamedValues   GetArray(btStringKey Name, const btFloat **pValue)                const { return Array(Find(Name), btFloatArray_t,            pValue); }
+   ENamedValues GetElement(btStringKey Name, btUnsignedInt i, btcString *pValue)    const { return StringAt(Find(Name), i, pValue); }
+   ENamedValues GetElement(btStringKey Name, btUnsignedInt i, btObjectType *pValue) const { return ObjectAt(Find(Name), i, pValue); }
+
+   /// Adds every name of the view to rNVS, copying the values.
+   ENamedValues CopyTo(INamedValueSet &rNVS) const;
+
+private:
+   NVSView(const btByte *pSet);
+
+   const btByte * Find(btNumberKey Name) const;
+   const btByte * Find(btStringKey Name) const;
+   const btByte * Entry(btUnsignedInt index) const;
+
+   ENamedValues   TypeOf(const btByte *pEntry, eBasicTypes *pType) const;
+   ENamedValues   SizeOf(const btByte *pEntry, btWSSize *pSize) const;
+   ENamedValues    Value(const btByte *pEntry, eBasicTypes Type, const btByte **ppValue) const;
+   ENamedValues   Object(const btByte *pEntry, btObjectType *pValue) const;
+   ENamedValues   String(const btByte *pEntry, btcString *pValue) const;
+   ENamedValues   Nested(const btByte *pEntry, NVSView *pValue) const;
+   ENamedValues StringAt(const btByte *pEntry, btUnsignedInt i, btcString *pValue) const;
+   ENamedValues ObjectAt(const btByte *pEntry, btUnsignedInt i, btObjectType *pValue) const;
+
+   ENamedValues     Copy(const btByte *pEntry, eBasicTypes Type, void *pValue, btWSSize Size) const;
+
+   template <typename T>
+   ENamedValues Scalar(const btByte *pEntry, eBasicTypes Type, T *pValue) const
+   {
+      return Copy(pEntry, Type, pValue, sizeof(T));
+   }
+
+   template <typename T>
+   ENamedValues Array(const btByte *pEntry, eBasicTypes Type, const T **pValue) const
+   {
+      const btByte *p = NULL;
+      ENamedValues  e = Value(pEntry, Type, &p);
+      if ( ( ENamedValuesOK == e ) && ( NULL == pValue ) ) {
+         e = ENamedValuesInvalidReadToNull;
+      }
+      if ( ENamedValuesOK == e ) {
+         *pValue = reinterpret_cast<const T *>(p);
+      }
+      return e;
+   }
+
+   const btByte *m_pSet;
+};
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_AALNVSBINARY_H__
+
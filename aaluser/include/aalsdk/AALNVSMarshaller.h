@@ -45,6 +45,7 @@
 #include <aalsdk/AALIDDefs.h>
 #include <aalsdk/aas/AALServiceModule.h>
 #include <aalsdk/AALLoggerExtern.h>
+#include <aalsdk/AALNVSBinary.h>
 
 BEGIN_NAMESPACE(AAL)
 
@@ -109,15 +110,29 @@ public:
    ENamedValues Add(btStringKey Name, btStringArray value,           btUnsigned32bitInt NumElements) { return m_NamedValueSet.Add(Name, value, NumElements); }
    ENamedValues Add(btStringKey Name, btObjectArray value,           btUnsigned32bitInt NumElements) { return m_NamedValueSet.Add(Name, value, NumElements); }
 
-    // Extract a byte stream from marshaller
+   // Extract a byte stream from marshaller. The stream is text, or the binary NVS format of
+   //  AALNVSBinary.h if NVSBinaryOnWire().
    btcString pmsgp(btWSSize *len)
    {
-      std::ostringstream oss;
-      oss << m_NamedValueSet << '\0';  // add a final, ensuring, terminating null
-      std::string s = oss.str();
       if ( NULL != m_tempbuf ) {
          delete[] m_tempbuf;
+         m_tempbuf = NULL;
+      }
+
+      *len = NVSBinaryOnWire() ? NVSBinarySize(m_NamedValueSet) : 0;
+      if ( 0 != *len ) {
+         m_tempbuf = new char[(size_t)*len];
+         if ( ENamedValuesOK == NVSToBinary(m_NamedValueSet, m_tempbuf, *len, len) ) {
+            return m_tempbuf;
+         }
+         delete[] m_tempbuf;
+         m_tempbuf = NULL;
       }
+
+      // Text, or not encodable as binary (nested too deeply).
+      std::ostringstream oss;
+      oss << m_NamedValueSet << '\0';  // add a final, ensuring, terminating null
+      std::string s = oss.str();
       *len = (btWSSize)s.length();
       m_tempbuf = new char[(size_t)*len];
       BufFromString(m_tempbuf, s);
@@ -188,7 +203,8 @@ public:
    ENamedValues Get(btStringKey Name, btStringArray *pValue)           const { return m_NamedValueSet.Get(Name, pValue); }
    ENamedValues Get(btStringKey Name, btObjectArray *pValue)           const { return m_NamedValueSet.Get(Name, pValue); }
 
-   // Import a byte stream to the marshaller
+   // Import a byte stream to the marshaller. FromStr() takes both the binary form
+   //  written by NVSMarshaller and the text form of older peers.
    void importmsg(char const * pmsg, btWSSize len)
    {
       m_NamedValueSet.Empty();
@@ -112,7 +112,9 @@ public:
    /// @brief Copy Constructor.
    /// @param[in] rOther TransactionID to copy.
    /// @return void
-   TransactionID(const TransactionID &rOther);
+   TransactionID(const TransactionID &rOther) :
+      m_tid(rOther.m_tid)
+   {}
 
    /// @brief Construct using system assigned unique ID, default event handler
    ///        and application specified context.
@@ -285,7 +287,11 @@ public:
    /// @brief Assignment operator - assigns the transaction ID.
    /// <B>Parameters:</B> [in]  A reference to a TransactionID to copy the
    ///                          transaction ID from.
-   TransactionID & operator = (const TransactionID     & );
+   TransactionID & operator = (const TransactionID &rOther)
+   {
+      m_tid = rOther.m_tid;
+      return *this;
+   }
    /// @brief Assignment operator - assigns the transaction ID.
    /// <B>Parameters:</B> [in]  A reference to a transaction ID to set.
    TransactionID & operator = (const stTransactionID_t & );
@@ -304,14 +310,16 @@ public:
    btBool operator == (const TransactionID & ) const;
 
    /// @brief Get a unique ID for a TransactionID.
-   /// @return A randomly generated 32-bit integer ID.
+   ///
+   /// IDs are taken from a process-wide counter with an atomic increment, so that
+   /// threads creating TransactionID's do not serialize on a lock.
+   /// @return The next unused system assigned ID.
    static btID NextUniqueID();
 
 private:
    stTransactionID_t m_tid;
 
-   static btID            sm_NextUniqueID;
-   static CriticalSection sm_CS;
+   static volatile btID sm_NextUniqueID;
 };
 
 /// TransactionID streamer.
@@ -120,6 +120,13 @@ private:
    CAASBase(const CAASBase & );
    CAASBase & operator = (const CAASBase & );
 
+   // Immutable sorted snapshot of m_InterfaceMap, searched by Interface() and Has()
+   //  without taking the lock.
+   struct InterfaceTable;
+
+   InterfaceTable *   Freeze()  const;
+   void             Publish();
+
 #ifdef _MSC_VER
 # pragma warning(push)
 # pragma warning(disable:4251)
@@ -128,6 +135,11 @@ private:
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif // _MSC_VER
+
+   // NULL until the first lookup freezes the table. Afterward, SetInterface() and
+   //  ReplaceInterface() publish a new table, retiring the old one until destruction.
+   mutable InterfaceTable * volatile m_pTable;
+   mutable InterfaceTable *          m_pRetired;
 };
 
 /// Concrete base class for objects that generate events.
@@ -104,6 +104,14 @@ BEGIN_NAMESPACE(AAL)
 * their btIID where no new methods are required.
 ******************************************************************************/
 
+/// Interface table of an event. Events are pooled (see IDispatchable), and so are the
+/// nodes of their interface tables.
+typedef std::map< btID,
+                  btGenericInterface,
+                  std::less<btID>,
+                  PoolAllocator< std::pair<const btID, btGenericInterface> > > EventInterfaceMap_t;
+typedef EventInterfaceMap_t::const_iterator                                  EVENTINTERFACE_CITR;
+
 /// Concrete implementation of IEvent.
 class AASLIB_API CAALEvent : protected CriticalSection,
                              public    CCountedObject,
@@ -153,6 +161,9 @@ public:
    /// @return void
    virtual void operator()();
 
+   /// The client the Event is delivered to, if any.
+   virtual btObjectType DeliveryTarget() const;
+
    /// Deletes this.
    virtual void Delete();
 
@@ -196,7 +207,7 @@ protected:
 # pragma warning( push )
 # pragma warning( disable:4251 )  // Cannot export template definitions
 #endif
-   iidInterfaceMap_t     m_InterfaceMap;
+   EventInterfaceMap_t   m_InterfaceMap;
 #if defined( __AAL_WINDOWS__ )
 # pragma warning( pop )
 #endif
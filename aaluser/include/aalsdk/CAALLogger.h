@@ -64,6 +64,8 @@ BEGIN_NAMESPACE(AAL)
 enum LoggerConstants {
    TempStringLength = 128       // length for a buffer for strerror_r
 };
+
+class CLoggerAsync;             // State of the asynchronous mode, see SetAsync()
 /*
  * ostringstream record for the PIDossMap, below.
  * pointer should be smart reference counter, but expect that each is created and
@@ -195,6 +197,16 @@ private:
    volatile btBool      m_needFlush;
    unsigned	int			m_autoFlushTime;
 
+   CLoggerAsync        *m_pAsync;      // Created by the first SetAsync(true)
+   volatile btBool      m_bAsync;      // Whether Log() hands lines to the writer thread
+
+   // Return the calling thread's line for the asynchronous mode.
+   std::ostringstream * AsyncOss();
+   // Hand a line to the writer thread. Never blocks; a line that does not fit is dropped.
+   void                 AsyncLog       (int errLevel, const char *pText, size_t Len);
+   // Write a line (or a batch of lines) to the destination. Callers need to be locked.
+   void                 Write          (int errLevel, const std::string &sText);
+
    void StartFlushThread() {
       AutoLock(this);
       if ( NULL == m_pFlushThread ) {
@@ -337,7 +349,13 @@ public:
    void		   	SetAutoFlushTime( unsigned int seconds );
    unsigned int GetAutoFlushTime( void ) const;
 
+   // Tell the Logger whether to write from a background thread
+   void        SetAsync (btBool fAsync);
+   btBool      GetAsync () const;
+   btUnsigned64bitInt GetDropped () const;
+
    static void FileFlushThread(OSLThread *pThread, void *pContext);
+   static void AsyncWriterThread(OSLThread *pThread, void *pContext);
 
    // No copying allowed
    CLogger(const CLogger & );
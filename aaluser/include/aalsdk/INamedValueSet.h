@@ -817,6 +817,9 @@ public:
    //=============================================================================
    /// @brief Converts a char* + length into an NVS.
    ///
+   /// The buffer may also hold the binary form written by NVSToBinary(), which is
+   /// recognized by its header.
+   ///
    /// <B>Parameters:</B> [in]  Pointer to the character string to convert.\n
    /// <B>Parameters:</B> [in]  Length of the character string to convert.
    /// @retval ENamedValuesOK   On success.
@@ -922,6 +925,12 @@ public:
    //=======================================================================
    CValue & operator = (const CValue &rOther);
 
+   //=======================================================================
+   //Exchange contents with rOther, without copying any arrays, strings
+   // or NVS.
+   //=======================================================================
+   void Swap(CValue &rOther);
+
    //=======================================================================
    //Type Accessors
    //=======================================================================
@@ -74,6 +74,14 @@ BEGIN_NAMESPACE(AAL)
 
 #define AALRUNTIME_CONFIG_RECORD          "AALRUNTIME_CONFIG_RECORD"
 #define AALRUNTIME_CONFIG_BROKER_SERVICE  "AALRUNTIME_CONFIG_BROKER_SERVICE"
+/// Number of threads that deliver client callbacks (btUnsigned32bitInt, in the
+///  AALRUNTIME_CONFIG_RECORD; default 1). Each client's callbacks are delivered in order.
+#define AALRUNTIME_CONFIG_MDS_THREADS     "AALRUNTIME_CONFIG_MDS_THREADS"
+/// Where the SDK's own threads run (btcString, in the AALRUNTIME_CONFIG_RECORD; default
+///  "anywhere"): message delivery, Service message threads and device polling. One of
+///  "anywhere", "near-device" (the NUMA node of the CCI-P device), "node:<n>" or
+///  "cpus:<cpulist>", eg "cpus:0-3,8". See ThreadPlacement.
+#define AALRUNTIME_CONFIG_THREAD_PLACEMENT "AALRUNTIME_CONFIG_THREAD_PLACEMENT"
 
 
 class IRuntime;
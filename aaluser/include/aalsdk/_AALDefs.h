@@ -318,6 +318,9 @@
 # ifndef __AAL_SHORT_FILE__
 #    define __AAL_SHORT_FILE__ __BASE_FILE__
 # endif // __AAL_SHORT_FILE__
+# ifndef __AAL_THREAD_LOCAL
+#    define __AAL_THREAD_LOCAL __thread
+# endif // __AAL_THREAD_LOCAL
 #elif defined ( _MSC_VER )
 // MS C/C++
 # ifndef __AAL_FUNC__
@@ -339,6 +342,9 @@ const char * AALWinShortFile(const char *f) {
 }
 #    define __AAL_SHORT_FILE__ AALWinShortFile( __FILE__ )
 # endif // __AAL_SHORT_FILE__
+# ifndef __AAL_THREAD_LOCAL
+#    define __AAL_THREAD_LOCAL __declspec(thread)
+# endif // __AAL_THREAD_LOCAL
 #elif defined( __GNUC__ ) && !defined( __cplusplus )
 // gcc
 // __func__ is part of the C99 standard.
@@ -361,6 +367,9 @@ const char * AALWinShortFile(const char *f) {
    p;                              \
 })
 # endif // __AAL_SHORT_FILE__
+# ifndef __AAL_THREAD_LOCAL
+#    define __AAL_THREAD_LOCAL __thread
+# endif // __AAL_THREAD_LOCAL
 #elif defined ( __GNUG__ )
 // g++
 # ifndef __AAL_FUNC__
@@ -382,6 +391,9 @@ const char * AALWinShortFile(const char *f) {
    p;                              \
 })
 # endif // __AAL_SHORT_FILE__
+# ifndef __AAL_THREAD_LOCAL
+#    define __AAL_THREAD_LOCAL __thread
+# endif // __AAL_THREAD_LOCAL
 #endif // toolchain
 
 
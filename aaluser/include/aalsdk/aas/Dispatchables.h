@@ -69,6 +69,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 
 protected:
    IServiceClient      *m_pSvcClient;
@@ -95,6 +96,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IServiceClient *m_pSvcClient;
    IRuntimeClient *m_pRTClient;
@@ -133,6 +135,7 @@ public:
                    IBase               *pServiceBase,
                    TransactionID const &rTranID);
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IServiceClient      *m_pSvcClient;
    IBase               *m_pServiceBase;
@@ -155,6 +158,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IServiceClient *m_pSvcClient;
    const IEvent   *m_pEvent;
@@ -176,6 +180,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IServiceClient *m_pSvcClient;
    const IEvent   *m_pEvent;
@@ -201,6 +206,7 @@ public:
    ///
    /// @returns void
    virtual void       operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -224,6 +230,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient      *m_pRTClient;
    IRuntime            *m_pRT;
@@ -246,6 +253,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -266,6 +274,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient *m_pRTClient;
    IRuntime       *m_pRT;
@@ -287,6 +296,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -310,6 +320,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient      *m_pRTClient;
    IBase               *m_pServiceBase;
@@ -332,6 +343,7 @@ public:
    ///
    /// @returns void
    virtual void      operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -361,6 +373,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 
    /// @brief assignment operator
    ///
@@ -381,6 +394,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IServiceRevoke *m_pRevoke;
 };
@@ -394,6 +408,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType DeliveryTarget() const;
 protected:
    IBase          *m_pSvcBase;
    const IEvent   *m_pEvent;
@@ -49,6 +49,7 @@
 #ifndef __IDISPATCHABLE_H__
 #define __IDISPATCHABLE_H__
 #include <aalsdk/AALTypes.h>
+#include <aalsdk/osal/ObjectPool.h>
 
 /// @addtogroup Dispatchable
 /// @{
@@ -56,7 +57,10 @@
 BEGIN_NAMESPACE(AAL)
 
 /// @brief Object used to schedule work
-class OSAL_API IDispatchable
+///
+/// Dispatchables are created and destroyed for every message, so they are allocated
+/// from ObjectPool.
+class OSAL_API IDispatchable : public PooledObject
 {
 public:
    /// @brief  Where the work happens. The function performed here can be virtually anything.
@@ -65,6 +69,13 @@ public:
    /// @returns void
    virtual void operator() () = 0;
 
+   /// @brief  The object that operator() delivers to, if any. A message delivery service that
+   /// dispatches on several threads keeps the dispatchables for any one target in the order
+   /// they were scheduled.
+   ///
+   /// @returns The target object, or NULL if the dispatchable has no particular target.
+   virtual btObjectType DeliveryTarget() const { return NULL; }
+
    virtual ~IDispatchable() {}
 };
 
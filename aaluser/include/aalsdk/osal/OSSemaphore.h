@@ -194,20 +194,35 @@ public:
    /// @retval NULL if the User-Defined data item pointer was not set.
    btObjectType UserDefined() const;
 
+   /// Have Wait() poll the count up to Spins times before putting the caller to sleep.
+   ///
+   /// Useful when Post() is expected within a few microseconds and the waiter has a CPU
+   /// of its own. The default is 0 (no spinning). Linux only.
+   ///
+   /// @param[in]  Spins  The number of polls.
+   /// @return void
+   void SpinBeforeSleep(btUnsignedInt Spins);
+
 private:
    // flags for m_State
 #define SEM_ST_OK        0x00000001
 #define SEM_ST_UNBLOCKED 0x00000002
-   btUnsignedInt   m_State;
-   btInt           m_MaxCount;
-   btInt           m_CurCount;
-   btUnsignedInt   m_WaitCount;
-   btObjectType    m_UserDefined;
+   btUnsignedInt          m_State;
+   btInt                  m_MaxCount;
+   volatile btInt         m_CurCount;
+   volatile btUnsignedInt m_WaitCount;
+   btObjectType           m_UserDefined;
+   btUnsignedInt          m_Spins;
 
 #if   defined( __AAL_WINDOWS__ )
-   HANDLE          m_hEvent;
+   HANDLE                 m_hEvent;
 #elif defined( __AAL_LINUX__ )
-   pthread_cond_t  m_condition;
+   // Post() and Wait() adjust m_CurCount with atomic operations, without the lock.
+   //  Waiters that find the count at 0 sleep on this futex word, which is advanced
+   //  whenever they must wake.
+   volatile btInt         m_Futex;
+
+   btBool WaitForPost(btTime Timeout);
 #endif // OS
 };
 
@@ -0,0 +1,150 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ObjectPool.h
+/// @brief Thread-caching pools for small, frequently allocated objects.
+/// @ingroup OSAL
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_OSAL_OBJECTPOOL_H__
+#define __AALSDK_OSAL_OBJECTPOOL_H__
+#include <aalsdk/AALTypes.h>
+#include <cstddef>
+#include <new>
+
+/// @addtogroup OSAL
+/// @{
+
+BEGIN_NAMESPACE(AAL)
+
+/// @brief Recycles the memory of small objects, such as events and dispatchables,
+/// that are allocated and freed at a high rate, often on different threads.
+///
+/// Blocks are kept on free lists, one per size class of Granule bytes. Each thread
+/// caches up to ThreadCacheDepth blocks of each class, and exchanges them in batches
+/// with a locked list shared by all threads, so that the common case takes no lock
+/// and does not reach the heap. Blocks larger than MaxObjectSize come from the heap.
+///
+/// The blocks cached by a thread are returned to the shared lists when the thread
+/// exits, by a thread-specific data destructor set up on the thread's first use.
+class OSAL_API ObjectPool
+{
+public:
+   enum
+   {
+      Granule          = 16,
+      MaxObjectSize    = 1024,
+      NumClasses       = MaxObjectSize / Granule,
+      ThreadCacheDepth = 32,
+      SharedDepth      = 4096  ///< Per class. Blocks freed beyond this go back to the heap.
+   };
+
+   /// Allocate at least Size bytes. Throws std::bad_alloc on failure, as operator new.
+   static void * Allocate(size_t Size);
+   /// Allocate at least Size bytes, or return NULL.
+   static void * Allocate(size_t Size, std::nothrow_t const & ) throw();
+   /// Free a block returned by Allocate(Size).
+   static void       Free(void *p, size_t Size) throw();
+
+   /// Return the calling thread's cached blocks to the shared lists.
+   static void FlushThreadCache();
+
+   /// The number of blocks of at most MaxObjectSize bytes obtained from the heap.
+   static btUnsigned64bitInt HeapAllocations();
+};
+
+/// @brief Gives a class, and every class derived from it, operator new and delete
+/// that allocate from ObjectPool.
+///
+/// The size passed to operator delete is that of the most-derived class, provided the
+/// object is deleted through a pointer to a class with a virtual destructor.
+class PooledObject
+{
+public:
+   static void * operator new(size_t Size)                              { return ObjectPool::Allocate(Size);    }
+   static void * operator new(size_t Size, std::nothrow_t const &nt) throw() { return ObjectPool::Allocate(Size, nt); }
+   static void * operator new(size_t , void *p) throw()                 { return p;                             }
+
+   static void   operator delete(void *p, size_t Size) throw()          { ObjectPool::Free(p, Size);            }
+   // Called only when a constructor throws. Every pooled block came from the global
+   //  operator new, so it may be handed back to the heap without its size.
+   static void   operator delete(void *p, std::nothrow_t const & ) throw() { ::operator delete(p);              }
+   static void   operator delete(void * , void * ) throw()              {                                       }
+};
+
+/// @brief Standard allocator over ObjectPool, for node-based containers owned by
+/// pooled objects.
+template <typename T>
+class PoolAllocator
+{
+public:
+   typedef T              value_type;
+   typedef T *            pointer;
+   typedef T const *      const_pointer;
+   typedef T &            reference;
+   typedef T const &      const_reference;
+   typedef size_t         size_type;
+   typedef std::ptrdiff_t difference_type;
+
+   template <typename U>
+   struct rebind { typedef PoolAllocator<U> other; };
+
+   PoolAllocator() throw() {}
+   PoolAllocator(PoolAllocator const & ) throw() {}
+   template <typename U>
+   PoolAllocator(PoolAllocator<U> const & ) throw() {}
+
+   pointer       address(reference r)       const { return &r; }
+   const_pointer address(const_reference r) const { return &r; }
+
+   pointer allocate(size_type n, void const * = 0)
+   {
+      return reinterpret_cast<pointer>(ObjectPool::Allocate(n * sizeof(T)));
+   }
+   void deallocate(pointer p, size_type n)
+   {
+      ObjectPool::Free(p, n * sizeof(T));
+   }
+
+   size_type max_size() const throw() { return ((size_type)-1) / sizeof(T); }
+
+   void construct(pointer p, const_reference v) { new(static_cast<void *>(p)) T(v); }
+   void destroy(pointer p)                      { p->~T();                           }
+
+   template <typename U>
+   btBool operator == (PoolAllocator<U> const & ) const throw() { return true;  }
+   template <typename U>
+   btBool operator != (PoolAllocator<U> const & ) const throw() { return false; }
+};
+
+END_NAMESPACE(AAL)
+
+/// @}
+
+#endif // __AALSDK_OSAL_OBJECTPOOL_H__
@@ -47,6 +47,7 @@
 #ifndef __AALSDK_OSAL_THREAD_H__
 #define __AALSDK_OSAL_THREAD_H__
 #include <aalsdk/osal/OSSemaphore.h>
+#include <aalsdk/osal/ThreadPlacement.h>
 
 #ifdef __AAL_UNKNOWN_OS__
 # error TODO: Threads for unknown OS.
@@ -145,6 +146,20 @@ public:
 	          OSLThread::ThreadPriority     nPriority,
 	          void                         *pContext,
 	          btBool                        ThisThread = false);
+   /// OSLThread Constructor, for a thread with a CPU affinity and NUMA placement.
+   ///
+   /// @param[in]  pProc       The function to be executed by the thread.
+   /// @param[in]  nPriority   The thread priority. Must be one of ThreadPriority values. If not, default is normal.
+   /// @param[in]  pContext    Parameter to be passed to pProc.
+   /// @param[in]  Placement   Where the new thread runs. Resolved before the thread is created.
+   ///                          Ignored when ThisThread is true.
+   /// @param[in]  ThisThread  true if pProc is to be run in the context of this thread. false if in a new thread.
+   /// @return void
+   OSLThread(ThreadProc                    pProc,
+             OSLThread::ThreadPriority     nPriority,
+             void                         *pContext,
+             const ThreadPlacement        &Placement,
+             btBool                        ThisThread = false);
    // OSLThread Destructor.
 	virtual ~OSLThread();
    /// Check the internal state of the thread.
@@ -201,6 +216,11 @@ private:
    void              *m_pContext;
    btUnsignedInt      m_State;
    CSemaphore         m_Semaphore;
+   btBool             m_bPlaced;
+   btInt              m_Node;
+   CpuSet             m_Cpus;
+
+   void Create(OSLThread::ThreadPriority nPriority, btBool ThisThread);
 
 #if   defined( __AAL_WINDOWS__ )
    // CreateThread() takes this signature.
@@ -123,14 +123,31 @@ class OSAL_API OSLThreadGroup : public IThreadGroup,
                                 public CriticalSection
 {
 public:
+   /// @brief How work items are handed to the worker threads.
+   enum Scheduling
+   {
+      /// All work items pass through a single FIFO queue, guarded by the Thread Group lock.
+      SharedQueue = 0,
+      /// Each worker owns a lock-free deque. Work items added by a worker of the group are
+      ///  pushed onto that worker's deque and executed LIFO by it; idle workers steal the
+      ///  oldest items from randomly chosen victims. Items added from outside the group are
+      ///  distributed round robin across the workers. No ordering between work items is
+      ///  guaranteed.
+      WorkStealing
+   };
+
    ///  If uiMinThreads is the default 0, the Thread Group will determine the minimum
    ///  number of threads in the group.
    ///
    ///  If uiMaxThreads < uiMinThreads then uiMaxThreads is set to uiMinThreads.
+   ///
+   ///  Every worker thread is created with Placement.
    OSLThreadGroup(btUnsignedInt             uiMinThreads=0,
                   btUnsignedInt             uiMaxThreads=0,
                   OSLThread::ThreadPriority nPriority=OSLThread::THREADPRIORITY_NORMAL,
-                  btTime                    JoinTimeout=AAL_INFINITE_WAIT);
+                  btTime                    JoinTimeout=AAL_INFINITE_WAIT,
+                  Scheduling                eScheduling=SharedQueue,
+                  const ThreadPlacement    &Placement=ThreadPlacement());
 
    virtual ~OSLThreadGroup();
 
@@ -218,7 +235,7 @@ private:
 #define THRGRPSTATE_FLAG_SELF_JOIN 0x00000002
 #define THRGRPSTATE_FLAG_JOINING   0x00000004
    public:
-      ThrGrpState(btUnsignedInt NumThreads);
+      ThrGrpState(btUnsignedInt NumThreads, Scheduling eScheduling, const ThreadPlacement &Placement);
       virtual ~ThrGrpState();
 
       // <IThreadGroup>
@@ -248,7 +265,10 @@ private:
       typedef thr_list_t::iterator        thr_list_iter;
       typedef thr_list_t::const_iterator  const_thr_list_iter;
 
-      eState        m_eState;
+      // Per-worker deques and inboxes of Scheduling WorkStealing (defined in ThreadGroup.cpp).
+      class WSQueues;
+
+      volatile eState m_eState;
       btUnsignedInt m_Flags;
       btTime        m_WorkSemTimeout;
       btTID         m_Joiner;
@@ -257,6 +277,8 @@ private:
       Barrier       m_ThrJoinBarrier;
       Barrier       m_ThrExitBarrier;
       CSemaphore    m_WorkSem;
+      WSQueues     *m_pWS;           // NULL for Scheduling SharedQueue.
+      ThreadPlacement m_Placement;   // Of each worker.
 
 #ifdef _MSC_VER
 # pragma warning(push)
@@ -378,6 +400,16 @@ private:
       eState       State() const { return m_eState; }
       eState       State(eState );
 
+      // Scheduling WorkStealing.
+      btBool                WSAdd(IDispatchable * );
+      eState        WSGetWorkItem(IDispatchable * &pWork);
+      IDispatchable *      WSFind(eState );
+      /// Wait for the Add()'s that raced a transition to Stopped or Draining to finish.
+      void        WSQuiesceAdders();
+      /// Move the contents of every deque and inbox to m_workqueue, oldest first.
+      /// returns the number of work items moved.
+      btUnsignedInt     WSCollect();
+
       friend class OSLThreadGroup;
    };
 
@@ -0,0 +1,135 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ThreadPlacement.h
+/// @brief CPU affinity and NUMA placement for OSLThread's.
+/// @ingroup OSAL
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_OSAL_THREADPLACEMENT_H__
+#define __AALSDK_OSAL_THREADPLACEMENT_H__
+#include <aalsdk/AALTypes.h>
+#include <string>
+
+/// @addtogroup OSAL
+/// @{
+
+BEGIN_NAMESPACE(AAL)
+
+/// @brief A set of logical CPU numbers, 0 .. MaxCpus - 1.
+class OSAL_API CpuSet
+{
+public:
+   enum { MaxCpus = 1024 };
+
+   /// Constructs the empty set.
+   CpuSet();
+
+   void              Add(btUnsignedInt Cpu);
+   void           Remove(btUnsignedInt Cpu);
+   void            Clear();
+   btBool            Has(btUnsignedInt Cpu) const;
+   btBool        IsEmpty() const;
+   btUnsignedInt   Count() const;
+
+   /// Replace the contents with a list in the Linux cpulist format, eg "0-3,8,10-11".
+   /// @retval true  if List was well-formed and named only CPUs below MaxCpus.
+   /// @retval false otherwise. The set is left empty.
+   btBool      FromList(btcString List);
+   /// The set in the cpulist format.
+   std::string   ToList() const;
+
+   btBool operator == (const CpuSet &rOther) const;
+
+private:
+   btUnsigned64bitInt m_Bits[MaxCpus / 64];
+};
+
+/// @brief Where the threads of an OSLThread or OSLThreadGroup should run.
+///
+/// A placement is resolved to a CpuSet (and, for OnNode and NearDevice, a NUMA node)
+/// when the thread is created. The new thread is bound to those CPUs before its thread
+/// function runs and, on Linux, prefers memory from the node, so that the structures it
+/// first touches are local. A placement that can't be resolved, such as NearDevice
+/// where no CCI-P device is present, leaves the thread where the OS puts it.
+class OSAL_API ThreadPlacement
+{
+public:
+   enum Policy
+   {
+      Anywhere = 0, ///< No affinity. The default.
+      OnCpus,       ///< The CPUs of an explicit CpuSet.
+      OnNode,       ///< The CPUs of one NUMA node.
+      NearDevice    ///< The CPUs of the NUMA node to which the CCI-P device is attached.
+   };
+
+   /// Anywhere.
+   ThreadPlacement();
+   /// OnCpus.
+   explicit ThreadPlacement(const CpuSet &Cpus);
+   /// OnNode, when Node >= 0, otherwise NearDevice or Anywhere.
+   explicit ThreadPlacement(Policy ePolicy, btInt Node=-1);
+
+   Policy GetPolicy() const { return m_ePolicy; }
+
+   /// Compute the CPUs and NUMA node for this placement.
+   /// @param[out]  Cpus  The CPUs on which to run.
+   /// @param[out]  Node  The NUMA node whose memory to prefer, or -1 for none.
+   /// @retval true  if the thread should be bound to Cpus.
+   /// @retval false for Anywhere, or if the placement could not be resolved.
+   btBool Resolve(CpuSet &Cpus, btInt &Node) const;
+
+   /// Parse "anywhere", "near-device", "node:<n>" or "cpus:<cpulist>".
+   /// @retval false if Str is not one of those. The placement is not modified.
+   btBool FromString(btcString Str);
+   std::string ToString() const;
+
+   /// The NUMA node of the first CCI-P device (from sysfs, or from its proximity domain on
+   /// Windows), or -1 if not known.
+   static btInt DeviceNode();
+   /// Fill Cpus with the CPUs of NUMA node Node.
+   static btBool NodeCpus(btInt Node, CpuSet &Cpus);
+
+   /// The placement for the threads the SDK itself creates: message delivery, service
+   ///  message threads and device polling. Set from AALRUNTIME_CONFIG_THREAD_PLACEMENT.
+   static ThreadPlacement SDKDefault();
+   static void            SDKDefault(const ThreadPlacement &Placement);
+
+private:
+   Policy m_ePolicy;
+   btInt  m_Node;
+   CpuSet m_Cpus;
+};
+
+END_NAMESPACE(AAL)
+
+/// @}
+
+#endif // __AALSDK_OSAL_THREADPLACEMENT_H__
+
@@ -105,6 +105,11 @@ public:
       delete this;
    }
 
+virtual btObjectType DeliveryTarget() const
+{
+   return dynamic_cast<void *>(m_pobject);
+}
+
 virtual ~ResourceManagerClientMessage(){}
 
 protected:
@@ -120,6 +120,16 @@ BEGIN_NAMESPACE(AAL)
 #define ALI_GETFEATURE_TYPE_DATATYPE     btUnsigned64bitInt
 #define ALI_GETFEATURE_GUID_KEY          "ALIGetFeatureGUID"
 #define ALI_GETFEATURE_GUID_DATATYPE     btcString
+#define ALI_BUFFPOOL_ARENA_SIZE_KEY      "ALIBufferPoolArenaSize"
+#define ALI_BUFFPOOL_ARENA_SIZE_DATATYPE btUnsigned64bitInt
+#define ALI_BUFFER_HUGEPAGE_KEY          "ALIBufferHugePage"
+#define ALI_BUFFER_HUGEPAGE_DATATYPE     btUnsigned64bitInt
+#define ALI_BUFFER_PAGESIZE_KEY          "ALIBufferPageSize"
+#define ALI_BUFFER_PAGESIZE_DATATYPE     btUnsigned64bitInt
+
+// ALI_BUFFER_HUGEPAGE_KEY values
+#define ALI_BUFFER_HUGEPAGE_2MB ( ((btUnsigned64bitInt)1) << 21 )
+#define ALI_BUFFER_HUGEPAGE_1GB ( ((btUnsigned64bitInt)1) << 30 )
 
 // CCIP DFH header types
 #define ALI_DFH_TYPE_RSVD    0
@@ -185,7 +195,8 @@ typedef enum
    ali_errnumBadSocket,                          // 44
    ali_errnumRdMsrCmdFail,                       // 45
    ali_errnumFPGAPowerRequestTooLarge,           // 46
-   ali_errnumAP6Detected                         // 47
+   ali_errnumAP6Detected,                        // 47
+   ali_errnumNotImpl                             // 48
 
 } ali_errnum_e;
 
@@ -214,6 +225,8 @@ typedef enum
 #define iidALI_POWER_Service        __INTC_IID(INTC_sysAFULinkInterface,0x0012)
 #define iidALI_TEMP_Service         __INTC_IID(INTC_sysAFULinkInterface,0x0013)
 
+#define iidALI_BUFF_POOL_Service    __INTC_IID(INTC_sysAFULinkInterface,0x0014)
+
 
 // FME GUID
 #define CCIP_FME_AFUID              "BFAF2AE9-4A52-46E3-82FE-38F0F9E17764"
@@ -243,6 +256,25 @@ typedef enum
 } ali_afu_target_e;
 
 
+//-----------------------------------------------------------------------------
+// MMIO batch access.
+//-----------------------------------------------------------------------------
+typedef enum
+{
+   ali_mmio_width32 = 4,      // 32-bit access
+   ali_mmio_width64 = 8       // 64-bit access
+
+} ali_mmio_width_e;
+
+/// @brief One access in a batch passed to IALIMMIO::mmioWriteBatch or IALIMMIO::mmioReadBatch.
+typedef struct
+{
+   btCSROffset        Offset;   ///< Byte offset into the MMIO region.
+   ali_mmio_width_e   Width;    ///< Access width.
+   btUnsigned64bitInt Value;    ///< Value to write, or the value read (zero-extended for 32-bit reads).
+} ali_mmio_op;
+
+
 //-----------------------------------------------------------------------------
 // IALIMMIO interface.
 //-----------------------------------------------------------------------------
@@ -266,6 +298,17 @@ public:
    /// @returns The length of the region.
    virtual btCSROffset  mmioGetLength( void ) = 0;
 
+   /// @brief Whether loads and stores through mmioGetAddress() reach the AFU.
+   ///
+   /// True when the MMIO region is mapped into the process, so that it may be accessed
+   /// directly (see MMIORegion in aalsdk/utils/ALIMMIORegion.h). False under ASE, where
+   /// mmioGetAddress() returns a shadow of the region, and the AFU is reached only
+   /// through the access methods below.
+   /// @retval True if the region may be accessed through its address.
+   /// @retval False if it must be accessed through this interface. This is the default, so
+   ///         that a service which does not say takes the access methods.
+   virtual btBool       mmioIsDirect( void ) { return false; }
+
    /// @brief      Read an MMIO address (or register) as a 32-bit value.
    ///
    /// Convenience function for those who organize an MMIO space as a set of Registers.
@@ -306,6 +349,95 @@ public:
    /// @retval     False if the write was not successful.
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value) = 0;
 
+   /// @brief      Perform a sequence of MMIO writes.
+   ///
+   /// Equivalent to calling mmioWrite32 or mmioWrite64 for each of the Count entries of
+   /// pOps, in order, but at the cost of a single call. A hardware AFU sees the writes
+   /// issued back to back, and they are complete when the call returns. ASE submits
+   /// them all under one acquisition of its MMIO request path.
+   /// @note       Synchronous function; no TransactionID. Generally very fast.
+   /// @param[in]  pOps  Array of Count accesses. Value of each is the value to write.
+   /// @param[in]  Count Number of entries in pOps.
+   /// @retval     True if the writes were successful.
+   /// @retval     False if any entry is out of range or of invalid width, in which case
+   ///             nothing was written.
+   /// @note       The default implementation checks the entries against mmioGetLength(),
+   ///             then calls mmioWrite32 or mmioWrite64 for each one.
+   virtual btBool  mmioWriteBatch( const ali_mmio_op * const pOps, const btUnsignedInt Count)
+   {
+      if ( !mmioBatchInRange(pOps, Count) ) {
+         return false;
+      }
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         btBool res = ( ali_mmio_width32 == pOps[i].Width ) ?
+                         mmioWrite32(pOps[i].Offset, (btUnsigned32bitInt)pOps[i].Value) :
+                         mmioWrite64(pOps[i].Offset, pOps[i].Value);
+         if ( !res ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /// @brief      Perform a sequence of MMIO reads.
+   ///
+   /// Equivalent to calling mmioRead32 or mmioRead64 for each of the Count entries of
+   /// pOps, in order, but at the cost of a single call. Under ASE, the reads are all
+   /// outstanding at once, so the batch waits for one simulator round trip rather than
+   /// one per read.
+   /// @note       Synchronous function; no TransactionID. Generally very fast.
+   /// @param[in,out] pOps  Array of Count accesses. Value of each receives the value read.
+   /// @param[in]  Count Number of entries in pOps.
+   /// @retval     True if the reads were successful.
+   /// @retval     False if any entry is out of range or of invalid width, in which case
+   ///             nothing was read.
+   /// @note       The default implementation checks the entries against mmioGetLength(),
+   ///             then calls mmioRead32 or mmioRead64 for each one.
+   virtual btBool  mmioReadBatch( ali_mmio_op * const pOps, const btUnsignedInt Count)
+   {
+      if ( !mmioBatchInRange(pOps, Count) ) {
+         return false;
+      }
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         btBool res;
+         if ( ali_mmio_width32 == pOps[i].Width ) {
+            btUnsigned32bitInt v = 0;
+            res = mmioRead32(pOps[i].Offset, &v);
+            pOps[i].Value = v;
+         } else {
+            res = mmioRead64(pOps[i].Offset, &pOps[i].Value);
+         }
+         if ( !res ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+protected:
+   // True if every access in a batch has a valid width and lies within mmioGetLength().
+   btBool mmioBatchInRange( const ali_mmio_op * const pOps, const btUnsignedInt Count )
+   {
+      if ( ( NULL == pOps ) && ( 0 != Count ) ) {
+         return false;
+      }
+      const btCSROffset Length = mmioGetLength();
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         if ( ( ali_mmio_width32 != pOps[i].Width ) && ( ali_mmio_width64 != pOps[i].Width ) ) {
+            return false;
+         }
+         if ( ( pOps[i].Offset > Length ) || ( (btCSROffset)pOps[i].Width > Length - pOps[i].Offset ) ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+public:
+
    /// @brief      Request a pointer to a device feature header (DFH).
    ///
    /// Will deposit in *pFeatureAddr the base address of the device feature
@@ -428,6 +560,15 @@ public:
    virtual void    umsgTrigger64( const btVirtAddr pUMsg,
                                   const btUnsigned64bitInt Value ) = 0;
 
+   /// @brief     Whether stores to the addresses returned by umsgGetAddress() send UMsgs.
+   ///
+   /// True when the UMsg region is mapped into the process. False under ASE, where a
+   /// UMsg is sent only by umsgTrigger64() (see UMsgRing in aalsdk/utils/UMsgRing.h).
+   /// @retval True if a UMsg may be sent by writing its cache line directly.
+   /// @retval False if it must be sent through umsgTrigger64(). This is the default, so
+   ///         that a service which does not say takes the trigger method.
+   virtual btBool  umsgIsDirect( void ) { return false; }
+
    /// @brief  Set attributes associated with the UMsg region and/or
    ///            individual UMsgs, depending on the arguments.
    /// @param[in] nvsArgs defines the bitmask that will be set. Each bit
@@ -493,6 +634,15 @@ public:
    /// @param[out] rOutputArgs  Reference to optional return arguments if needed.
    /// @return On success, ali_errnumOK.
    /// @return On failure, ali_errnumSystem.
+   ///
+   /// ALI_BUFFER_HUGEPAGE_KEY in rInputArgs (ALI_BUFFER_HUGEPAGE_2MB or ALI_BUFFER_HUGEPAGE_1GB)
+   ///    requests a workspace that is physically contiguous and aligned to the huge page size,
+   ///    so that the device side can map it with large pages. Length is rounded up to a multiple
+   ///    of that size. If no such memory is available, a smaller size is used instead; the
+   ///    allocation does not fail for that reason. The page size of the mapping in this process
+   ///    is returned in rOutputArgs as ALI_BUFFER_PAGESIZE_KEY. It is the huge page size only
+   ///    where the kernel can map the buffer with huge pages and ALI_MMAP_TARGET_VADDR_KEY, if
+   ///    given, is aligned to it.
    virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
                                              btVirtAddr          *pBufferptr,
                                              NamedValueSet const &rInputArgs,
@@ -508,6 +658,39 @@ public:
    /// @return On failure, ali_errnumBadParameter or ali_errnumSystem.
    virtual AAL::ali_errnum_e bufferFree( btVirtAddr           Address) = 0;
 
+   /// @brief Make existing memory accessible to the AFU, without copying it.
+   ///
+   /// The pages of [Address, Address + Length) are pinned and mapped for the AFU, and
+   ///    the range is then translated by bufferGetIOVA() just like an allocated buffer.
+   ///    The memory still belongs to the caller, who must bufferRelease() it (not
+   ///    bufferFree() it) before unmapping or freeing it.
+   ///
+   /// @param[in]  Address  User virtual address of the memory. Need not be page aligned.
+   /// @param[in]  Length   Length of the memory, in bytes.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter if the range is empty or overlaps a buffer,
+   ///    ali_errnumNoMap if the memory can not be pinned or can not be mapped as one range
+   ///    for the AFU, ali_errnumNotImpl if the service does not support it, or ali_errnumSystem.
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                            btWSSize             Length ) { return ali_errnumNotImpl; }
+   /// @brief Make existing memory accessible to the AFU, using additional input arguments.
+   ///
+   /// @param[in]  Address     User virtual address of the memory.
+   /// @param[in]  Length      Length of the memory, in bytes.
+   /// @param[in]  rInputArgs  Reference to optional input arguments if needed.
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                            btWSSize             Length,
+                                            NamedValueSet const &rInputArgs ) { return ali_errnumNotImpl; }
+
+   /// @brief Release memory previously prepared with IALIBuffer::bufferPrepare.
+   ///
+   /// @param[in]  Address  The Address that was passed to bufferPrepare().
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter, ali_errnumNotImpl or ali_errnumSystem.
+   virtual AAL::ali_errnum_e bufferRelease( btVirtAddr           Address) { return ali_errnumNotImpl; }
+
    /// @brief Retrieve the location at which the AFU can access the passed in virtual address.
    ///
    /// The user virtual address that the application uses to access a buffer may or
@@ -527,6 +710,67 @@ public:
 }; // class IALIBuffer
 
 
+//-----------------------------------------------------------------------------
+// IALIBufferPool interface.
+//-----------------------------------------------------------------------------
+/// @brief  Sub-allocating Buffer Pool Service Interface of IALI.
+///
+/// Each IALIBuffer::bufferAllocate() and IALIBuffer::bufferFree() is a round trip to
+///    the driver plus an mmap() or munmap(). IALIBufferPool carves small buffers out of
+///    a few large workspaces (arenas) obtained from IALIBuffer instead, so that in the
+///    steady state allocating and freeing a buffer costs no system call at all.
+///
+/// Requests are rounded up to a power-of-two size class of at least 64 bytes. Every
+///    buffer is aligned to its size class, up to a page: i.e. buffers are always
+///    cache-line aligned, and buffers of 4KB and larger are page aligned. Requests
+///    larger than the largest size class are passed through to IALIBuffer.
+///
+/// The arena size can be selected by passing the Named Value pair
+///    (ALI_BUFFPOOL_ARENA_SIZE_KEY, btUnsigned64bitInt) in the arguments to
+///    IRuntime::allocService when requesting the ALI Service.
+///
+/// @note   This service interface is obtained from an IBase via iidALI_BUFF_POOL_Service.
+/// @code
+///         m_pALIBufferPoolService = dynamic_ptr<IALIBufferPool>(iidALI_BUFF_POOL_Service, pServiceBase);
+/// @endcode
+class IALIBufferPool
+{
+public:
+   virtual ~IALIBufferPool() {}
+
+   /// @brief Allocate a buffer from the pool.
+   ///
+   /// @param[in]  Length       Requested length, in bytes.
+   /// @param[out] pBufferptr   Buffer Pointer.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter or ali_errnumNoMem.
+   virtual AAL::ali_errnum_e poolAllocate( btWSSize    Length,
+                                           btVirtAddr *pBufferptr ) = 0;
+
+   /// @brief Return a buffer to the pool.
+   ///
+   /// The provided Address must have been acquired previously by IALIBufferPool::poolAllocate.
+   ///
+   /// @param[in]  Address  User virtual address of the buffer.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter or ali_errnumSystem.
+   virtual AAL::ali_errnum_e poolFree( btVirtAddr Address ) = 0;
+
+   /// @brief Retrieve the location at which the AFU can access the passed in virtual address.
+   ///
+   /// As IALIBuffer::bufferGetIOVA, except that only buffers allocated from the pool
+   ///    are considered.
+   ///
+   /// @param[in]  Address User virtual address within a buffer acquired by poolAllocate.
+   /// @return     The AFU-addressable location of Address, or 0 if Address is not
+   ///             within a buffer allocated from the pool.
+   virtual btPhysAddr poolGetIOVA( btVirtAddr Address ) = 0;
+
+}; // class IALIBufferPool
+
+
 //-----------------------------------------------------------------------------
 // IALIPerf interface.
 //-----------------------------------------------------------------------------
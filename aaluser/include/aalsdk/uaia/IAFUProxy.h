@@ -64,6 +64,22 @@ public:
 
 };
 
+//=============================================================================
+// Name: IAIATransactionCallback
+// Description: Completion notification for a transaction submitted through
+//              IAFUProxy::SendTransactionAsync().
+// Comments: AIATransactionComplete() is called on a proxy worker thread once
+//           the transaction has been sent to the device and its errno and
+//           response payload are available. It must not block for long, as
+//           it holds up the next queued transaction.
+//=============================================================================
+class UAIA_API IAIATransactionCallback
+{
+public:
+   virtual ~IAIATransactionCallback(){};
+   virtual void AIATransactionComplete(IAIATransaction *pAFUmessage)         = 0;
+};
+
 //==========================================================================
 // Name: IUIDriverEvent
 // Description: AAL Event object containing a message from the UI Device
@@ -113,6 +129,14 @@ public:
    // Send a message to the device
    virtual AAL::btBool SendTransaction( IAIATransaction *pAFUmessage )       = 0;
 
+   // Queue a message to the device and return without waiting for it. pCallback
+   //  is notified when the message has been sent; pAFUmessage must remain valid
+   //  until then. Several transactions may be in flight at once, and they may
+   //  complete in any order. Returns false (and pCallback is not called) if the
+   //  message could not be queued.
+   virtual AAL::btBool SendTransactionAsync( IAIATransaction         *pAFUmessage,
+                                             IAIATransactionCallback *pCallback ) = 0;
+
    // Map/Unmap Workspace IDs to virtual memory addresses
    virtual AAL::btBool MapWSID(AAL::btWSSize             Size,
                                AAL::btWSID               wsid,
@@ -0,0 +1,187 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file AALBufferPool.h
+/// @brief Sub-allocating buffer pool layered on IALIBuffer.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_UTILS_AALBUFFERPOOL_H__
+#define __AALSDK_UTILS_AALBUFFERPOOL_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/osal/CriticalSection.h>
+#include <aalsdk/service/IALIAFU.h>
+#include <aalsdk/utils/AALWorkSpaceUtilities.h>
+
+
+BEGIN_NAMESPACE(AAL)
+
+   struct BufferPoolThreadCache;
+
+   /* BufferPool - IALIBufferPool implemented on top of any IALIBuffer.
+    * The pool obtains arenas of ArenaSize bytes from IALIBuffer::bufferAllocate() and
+    *    divides each arena into slabs of SlabSize bytes. A slab is dedicated to a single
+    *    power-of-two size class between MinBlockSize and SlabSize when it is first
+    *    needed, and is carved into blocks of that size. Blocks are never returned to
+    *    their slab, and arenas are never returned to IALIBuffer before Release().
+    * Free blocks are kept on singly-linked lists threaded through the blocks themselves,
+    *    one list per size class in the pool (guarded by the pool's CriticalSection)
+    *    and one per size class in each thread that uses the pool. A thread allocates
+    *    from and frees to its own lists without taking any lock, and moves blocks to
+    *    and from the pool in batches. A thread keeps separate lists for each of the
+    *    last few pools it used, and gives them back to their pools when it exits.
+    * The arena of a pointer (and from it the slab, size class and IOVA) is found in
+    *    constant time, without a lock. The address space is divided into granules of
+    *    ArenaSize bytes. An arena covers at most two granules, and a small open-addressed
+    *    table maps each granule to the arenas that cover it.
+    * Requests larger than SlabSize are passed through to IALIBuffer, and kept in a
+    *    WorkSpaceIndex together with the arenas.
+    */
+#if defined ( __AAL_WINDOWS__ )
+# pragma warning(push)           // ignoring this because IALIBufferPool is purely abstract.
+# pragma warning(disable : 4275) // non dll-interface class 'AAL::IALIBufferPool' used as base for dll-interface class 'AAL::BufferPool'
+#endif // __AAL_WINDOWS__
+   class AASLIB_API BufferPool : public IALIBufferPool,
+                                 public CriticalSection
+   {
+#if defined ( __AAL_WINDOWS__ )
+# pragma warning(pop)
+#endif // __AAL_WINDOWS__
+   public:
+      enum {
+         MinBlockShift    = 6,                         // Blocks are at least cache-line sized,
+         SlabShift        = 16,                        //    and at most one slab.
+         MinBlockSize     = 1 << MinBlockShift,
+         SlabSize         = 1 << SlabShift,
+         NumClasses       = SlabShift - MinBlockShift + 1,
+         MaxArenas        = 64,
+         DefaultArenaSize = 32 * SlabSize,
+         ArenaSlotShift   = 8,                         // Arena table size, at least 4 * MaxArenas,
+         ArenaSlots       = 1 << ArenaSlotShift        //    so that it stays at most half full.
+      };
+
+      BufferPool(IALIBuffer *pBuffer);
+      virtual ~BufferPool();
+
+      // Selects the size of the arenas obtained from IALIBuffer. ArenaSize must be a
+      //    non-zero multiple of SlabSize. Returns false if ArenaSize is invalid or if
+      //    the pool already has arenas.
+      btBool Configure(btWSSize ArenaSize);
+      // As above, taking ArenaSize from ALI_BUFFPOOL_ARENA_SIZE_KEY in rArgs, if present.
+      btBool Configure(NamedValueSet const &rArgs);
+      btWSSize ArenaSize() const { return m_ArenaSize; }
+
+      // Returns every arena and large block to IALIBuffer. All buffers previously
+      //    allocated from the pool become invalid. The pool may be used again afterward.
+      //    The caller must ensure that no other thread is using the pool meanwhile.
+      void Release();
+
+      // <IALIBufferPool>
+      virtual AAL::ali_errnum_e poolAllocate( btWSSize    Length,
+                                              btVirtAddr *pBufferptr );
+      virtual AAL::ali_errnum_e poolFree( btVirtAddr Address );
+      virtual btPhysAddr poolGetIOVA( btVirtAddr Address );
+      // </IALIBufferPool>
+
+      // Number of arenas and of large blocks currently held from IALIBuffer.
+      btUnsigned32bitInt Arenas() const;
+      btUnsigned32bitInt LargeBlocks() const;
+
+      // Gives the calling thread's cached blocks back to their pools. Done automatically
+      //    when the thread exits.
+      static void FlushThreadCache();
+
+   private:
+      // Not copyable.
+      BufferPool(const BufferPool & );
+      BufferPool & operator = (const BufferPool & );
+
+      struct Arena {
+         btVirtAddr         m_ptr;         // Base of the workspace
+         btPhysAddr         m_iova;        // IOVA of m_ptr
+         btUnsigned32bitInt m_Slabs;       // Number of slabs in the arena
+         btUnsigned32bitInt m_SlabsUsed;   // Slabs dedicated to a size class so far
+         btByte            *m_SlabClass;   // Size class of each slab in use
+      };
+
+      // Index entries for large blocks carry this in place of an arena number.
+      enum { LargeBlock = MaxArenas };
+
+      // One granule covered by one arena. m_Granule is the granule number plus one, and
+      //    zero in an unused slot.
+      struct ArenaSlot {
+         btUnsigned64bitInt m_Granule;
+         btUnsigned32bitInt m_Arena;
+      };
+
+      // The calling thread's free lists for this pool.
+      inline BufferPoolThreadCache & ThreadCache();
+      // Gives the calling thread free lists for pPool, taking a slot that is unused or
+      //    whose pool is gone, or else giving another pool's lists back to it.
+      static BufferPoolThreadCache & AdoptThreadCache(BufferPool *pPool);
+      // Gives the blocks on tc back to its pool, if that still exists, and clears tc.
+      //    Called with the pool registry locked.
+      static void ReturnThreadCache(BufferPoolThreadCache &tc);
+
+      btBool Refill(btUnsigned32bitInt Class, btUnsigned32bitInt Count, btVirtAddr *pHead, btUnsigned32bitInt *pGot);
+      void   ReturnBlocks(btUnsigned32bitInt Class, btVirtAddr Head, btVirtAddr Tail, btUnsigned32bitInt Count);
+      btBool CarveSlab(btUnsigned32bitInt Class);
+      btBool AddArena();
+      // Publishes the granules of m_Arenas[Index], or withdraws those of every arena.
+      //    Called with the pool locked.
+      void   MapArena(btUnsigned32bitInt Index);
+      void   UnmapArenas();
+      // The arena holding Address, or NULL if Address is not in one of this pool's arenas.
+      const Arena * FindArena(btVirtAddr Address) const;
+      AAL::ali_errnum_e AllocateLarge(btWSSize Length, btVirtAddr *pBufferptr);
+      AAL::ali_errnum_e FreeLarge(btVirtAddr Address);
+
+      IALIBuffer           *m_pBuffer;
+      btWSSize              m_ArenaSize;
+      btUnsigned64bitInt    m_Id;
+      Arena                 m_Arenas[MaxArenas];
+      btUnsigned32bitInt    m_NumArenas;
+      ArenaSlot             m_ArenaSlots[ArenaSlots];
+      btVirtAddr            m_FreeHead[NumClasses];
+      btUnsigned32bitInt    m_FreeCount[NumClasses];
+      WorkSpaceIndex        m_Index;
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif // _MSC_VER
+      std::map<btVirtAddr, btWSSize> m_Large;
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif // _MSC_VER
+   }; // end of BufferPool
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_UTILS_AALBUFFERPOOL_H__
+
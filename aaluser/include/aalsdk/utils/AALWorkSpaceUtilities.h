@@ -51,6 +51,7 @@
 #define __AALSDK_UTILS_AALWORKSPACEUTILITIES_H__
 #include <aalsdk/AALTypes.h>            // btUnsigned, etc.
 #include <aalsdk/kernel/AALWorkspace.h> // TTASK_MODE
+#include <aalsdk/osal/CriticalSection.h>
 
 
 /// @todo Document WorkSpaceMapper
@@ -184,6 +185,73 @@ BEGIN_NAMESPACE(AAL)
    AASLIB_API std::ostream & operator << (std::ostream &s, const WorkSpaceMapper::WkSp &wksp);
    AASLIB_API std::ostream & operator << (std::ostream &s, const WorkSpaceMapper::eWSM_Ret &e);
 
+
+   /* WorkSpaceIndex - interval index over the workspaces of a single address space,
+    *    answering "which workspace contains this address, and where does the AFU
+    *    see it" for interior pointers as well as workspace bases.
+    * Same restriction as WorkSpaceMapper: workspaces never overlap, so the workspace
+    *    containing a pointer, if any, is the one with the greatest base <= pointer.
+    *    That one is found with upper_bound() on the sorted map, O(log n).
+    * Each thread additionally caches the last workspace it hit. Any Add() or Remove()
+    *    moves the index to a new generation, which invalidates every cached hit, so
+    *    a repeated lookup within the same workspace costs no lock and no search.
+    */
+   class AASLIB_API WorkSpaceIndex : public CriticalSection
+   {
+   public:
+      // The thing that is indexed.
+      struct WkSp {
+         btVirtAddr m_ptr;    // User virtual pointer
+         btWSSize   m_len;    // Length of buffer
+         btPhysAddr m_iova;   // Address at which the AFU sees m_ptr
+         btWSID     m_wsid;   // WorkSpace ID containing the buffer
+      };
+
+      WorkSpaceIndex();
+      virtual ~WorkSpaceIndex();
+
+      // Returns false if ptr is NULL, len is 0, or [ptr, ptr + len) overlaps an indexed workspace.
+      btBool Add(btVirtAddr ptr,
+                 btWSSize   len,
+                 btPhysAddr iova,
+                 btWSID     wsid);
+
+      // Returns false if ptr is not the base of an indexed workspace.
+      //    If pwksp is non-NULL, it receives the removed entry.
+      btBool Remove(btVirtAddr ptr, WkSp *pwksp=NULL);
+
+      // Exact match on a workspace base.
+      btBool Find(btVirtAddr ptr, WkSp *pwksp) const;
+
+      // The workspace that contains ptr (base or interior).
+      btBool Lookup(btVirtAddr ptr, WkSp *pwksp) const;
+
+      // The AFU-visible address corresponding to ptr, or 0 if ptr is in no workspace.
+      btPhysAddr GetIOVA(btVirtAddr ptr) const;
+
+      btUnsigned32bitInt Size() const;
+      btBool             Empty() const { return 0 == Size(); }
+
+   private:
+      typedef std::map<btVirtAddr, WkSp> wkspMap_t;
+      typedef wkspMap_t::iterator        wkspMap_itr_t;
+      typedef wkspMap_t::const_iterator  wkspMap_citr_t;
+
+      // Index generations are unique across all instances, so that a cached hit can
+      //    never validate against a different (e.g. re-constructed) index.
+      static btUnsigned64bitInt NextGeneration();
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif // _MSC_VER
+      wkspMap_t                   m_map;
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif // _MSC_VER
+      volatile btUnsigned64bitInt m_Generation;
+   }; // end of WorkSpaceIndex
+
 END_NAMESPACE(AAL)
 
 #endif // __AALSDK_UTILS_AALWORKSPACEUTILITIES_H__
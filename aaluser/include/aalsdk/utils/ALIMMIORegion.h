@@ -0,0 +1,237 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file ALIMMIORegion.h
+/// @brief Inline accessor handle for the MMIO region of an IALIMMIO.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_UTILS_ALIMMIOREGION_H__
+#define __AALSDK_UTILS_ALIMMIOREGION_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/service/IALIAFU.h>
+
+#if defined( __i386__ ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+# define __AAL_MMIO_REGION_X86__ 1
+# if defined( __AVX__ )
+#    include <immintrin.h>
+# else
+#    include <xmmintrin.h>
+# endif // __AVX__
+#endif // x86
+
+
+BEGIN_NAMESPACE(AAL)
+
+   // Register widths accepted by MMIORegion. Any other T fails to compile.
+   template <typename T> struct MMIORegionAccess;
+
+   template <> struct MMIORegionAccess<btUnsigned32bitInt>
+   {
+      static btUnsigned32bitInt Read(IALIMMIO *pMMIO, btCSROffset Off)
+      {
+         btUnsigned32bitInt v = 0;
+         pMMIO->mmioRead32(Off, &v);
+         return v;
+      }
+      static void Write(IALIMMIO *pMMIO, btCSROffset Off, btUnsigned32bitInt v) { pMMIO->mmioWrite32(Off, v); }
+   };
+
+   template <> struct MMIORegionAccess<btUnsigned64bitInt>
+   {
+      static btUnsigned64bitInt Read(IALIMMIO *pMMIO, btCSROffset Off)
+      {
+         btUnsigned64bitInt v = 0;
+         pMMIO->mmioRead64(Off, &v);
+         return v;
+      }
+      static void Write(IALIMMIO *pMMIO, btCSROffset Off, btUnsigned64bitInt v) { pMMIO->mmioWrite64(Off, v); }
+   };
+
+   // Only MMIORegionAligned<true> is complete, so a misaligned constant offset fails to compile.
+   template <bool > struct MMIORegionAligned;
+   template <>      struct MMIORegionAligned<true> { enum { value = 1 }; };
+
+   /* MMIORegion - handle on the MMIO region of an IALIMMIO, for code that touches
+    *    registers at fixed offsets in a loop.
+    * If the service reports that its region is mapped into the process
+    *    (IALIMMIO::mmioIsDirect()), each access is one volatile load or store through the
+    *    address from mmioGetAddress(), inlined at the call site. Otherwise, e.g. under ASE,
+    *    where an MMIO access is a message to the simulator, each access goes through the
+    *    virtual IALIMMIO methods, as it would without the handle.
+    * Accessors do no range checking. Give the constructor the number of bytes of the
+    *    region the caller will use, and check IsOK() once, instead.
+    * The handle is two pointers and a length, and may be copied freely, but it must not
+    *    outlive the service it was obtained from.
+    */
+   class MMIORegion
+   {
+   public:
+      MMIORegion() :
+         m_pMMIO(NULL),
+         m_pBase(NULL),
+         m_Length(0)
+      {}
+
+      // IsOK() is false if pMMIO is NULL or its region is shorter than Span bytes.
+      explicit MMIORegion(IALIMMIO *pMMIO, btCSROffset Span=0) :
+         m_pMMIO(NULL),
+         m_pBase(NULL),
+         m_Length(0)
+      {
+         if ( NULL == pMMIO ) {
+            return;
+         }
+         m_Length = pMMIO->mmioGetLength();
+         if ( m_Length < Span ) {
+            m_Length = 0;
+            return;
+         }
+         m_pMMIO = pMMIO;
+         if ( pMMIO->mmioIsDirect() ) {
+            m_pBase = pMMIO->mmioGetAddress();
+         }
+      }
+
+      btBool      IsOK()     const { return NULL != m_pMMIO; }
+      btBool      IsDirect() const { return NULL != m_pBase; }
+      btCSROffset Length()   const { return m_Length;        }
+      IALIMMIO *  Service()  const { return m_pMMIO;         }
+
+      // Register of type T (btUnsigned32bitInt or btUnsigned64bitInt) at constant offset Off,
+      //    which must be a multiple of sizeof(T).
+      template <typename T, btCSROffset Off>
+      T read() const
+      {
+         (void)sizeof(MMIORegionAligned<0 == Off % sizeof(T)>);
+         return read<T>(Off);
+      }
+
+      template <typename T, btCSROffset Off>
+      void write(T Value) const
+      {
+         (void)sizeof(MMIORegionAligned<0 == Off % sizeof(T)>);
+         write<T>(Off, Value);
+      }
+
+      // As above, for an offset known only at run time.
+      template <typename T>
+      T read(btCSROffset Off) const
+      {
+         if ( NULL != m_pBase ) {
+            return *reinterpret_cast<volatile T *>(m_pBase + Off);
+         }
+         return MMIORegionAccess<T>::Read(m_pMMIO, Off);
+      }
+
+      template <typename T>
+      void write(btCSROffset Off, T Value) const
+      {
+         if ( NULL != m_pBase ) {
+            *reinterpret_cast<volatile T *>(m_pBase + Off) = Value;
+            return;
+         }
+         MMIORegionAccess<T>::Write(m_pMMIO, Off, Value);
+      }
+
+      // Store the 32 (64) bytes at pSrc to the region at Off. Both must be 32 (64)-byte
+      //    aligned. Where the code is compiled for AVX (AVX-512F), the data is written with
+      //    a single store, which a write-combining mapping delivers to the AFU as one
+      //    transaction. Otherwise it is written as 64-bit stores in ascending order, and
+      //    the AFU may see several transactions.
+      //    Stores to a write-combining mapping are not ordered with later stores until
+      //    writeFence() is called.
+      void write256(btCSROffset Off, const void *pSrc) const
+      {
+#if defined( __AVX__ )
+         if ( NULL != m_pBase ) {
+            _mm256_store_si256(reinterpret_cast<__m256i *>(m_pBase + Off),
+                               _mm256_load_si256(reinterpret_cast<const __m256i *>(pSrc)));
+            return;
+         }
+#endif // __AVX__
+         writeWide(Off, reinterpret_cast<const btUnsigned64bitInt *>(pSrc), 4);
+      }
+
+      void write512(btCSROffset Off, const void *pSrc) const
+      {
+#if defined( __AVX512F__ )
+         if ( NULL != m_pBase ) {
+            _mm512_store_si512(reinterpret_cast<void *>(m_pBase + Off),
+                               _mm512_load_si512(pSrc));
+            return;
+         }
+#endif // __AVX512F__
+         writeWide(Off, reinterpret_cast<const btUnsigned64bitInt *>(pSrc), 8);
+      }
+
+      // Drain write-combining buffers, so that all prior stores to the region are
+      //    visible to the AFU before any later one.
+      void writeFence() const
+      {
+         if ( NULL == m_pBase ) {
+            return; // The virtual path completes each access before returning.
+         }
+#if defined( __AAL_MMIO_REGION_X86__ )
+         _mm_sfence();
+#else
+         __sync_synchronize();
+#endif // __AAL_MMIO_REGION_X86__
+      }
+
+   private:
+      void writeWide(btCSROffset Off, const btUnsigned64bitInt *pSrc, btUnsignedInt n) const
+      {
+         btUnsignedInt i;
+         if ( NULL != m_pBase ) {
+            volatile btUnsigned64bitInt *pDst = reinterpret_cast<volatile btUnsigned64bitInt *>(m_pBase + Off);
+            for ( i = 0 ; i < n ; ++i ) {
+               pDst[i] = pSrc[i];
+            }
+            return;
+         }
+         ali_mmio_op ops[8];
+         for ( i = 0 ; i < n ; ++i ) {
+            ops[i].Offset = Off + i * sizeof(btUnsigned64bitInt);
+            ops[i].Width  = ali_mmio_width64;
+            ops[i].Value  = pSrc[i];
+         }
+         m_pMMIO->mmioWriteBatch(ops, n);
+      }
+
+      IALIMMIO   *m_pMMIO;
+      btVirtAddr  m_pBase;
+      btCSROffset m_Length;
+   }; // end of MMIORegion
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_UTILS_ALIMMIOREGION_H__
+
@@ -0,0 +1,153 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file CompletionWaiter.h
+/// @brief Spin, back off, then block until a completion flag is set.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_UTILS_COMPLETIONWAITER_H__
+#define __AALSDK_UTILS_COMPLETIONWAITER_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/osal/OSSemaphore.h>
+
+
+BEGIN_NAMESPACE(AAL)
+
+   /* CompletionWaiter - waits for a completion flag written by an AFU (or another
+    *    thread) to become non-zero, in three stages:
+    *    1) Spin. The flag is polled with a pause between reads for up to SpinNanos,
+    *       which catches completions that arrive within a few microseconds at the cost
+    *       of one busy core.
+    *    2) Back off. The thread sleeps between polls, starting at 1 usec and doubling
+    *       up to MaxBackoffMicros.
+    *    3) Block. If the waiter was given an IBlocker, once the back off reaches its
+    *       maximum the thread waits on the blocker (e.g. a UMsg or interrupt event)
+    *       instead of sleeping. The blocker is only a hint: the flag is re-read after
+    *       every wake up, so a missed or spurious event costs at most BlockSliceMillis.
+    *       Without a blocker, the thread keeps sleeping MaxBackoffMicros between polls.
+    * Every Wait() is recorded in a histogram of wait times (power-of-two buckets of
+    *    nanoseconds), along with the stage in which the flag was seen set, so that the
+    *    spin budget can be tuned to the observed completion latencies.
+    * A CompletionWaiter is not thread safe; use one per waiting thread.
+    */
+   class AASLIB_API CompletionWaiter
+   {
+   public:
+      // Something to block on in stage 3. Block() returns when it is signaled or when
+      //    TimeoutMillis expires, whichever comes first.
+      class AASLIB_API IBlocker
+      {
+      public:
+         virtual ~IBlocker() {}
+         virtual void Block(btTime TimeoutMillis) = 0;
+      };
+
+      // IBlocker signaled by calling Signal(), e.g. from a UMsg or interrupt event
+      //    handler. Signals that arrive while no thread is blocked are coalesced into one.
+      class AASLIB_API EventBlocker : public IBlocker
+      {
+      public:
+         EventBlocker();
+         virtual ~EventBlocker();
+
+         void         Signal();
+         virtual void Block(btTime TimeoutMillis);
+
+      private:
+         CSemaphore m_Sem;
+      };
+
+      enum Stage {
+         StageImmediate = 0, // The flag was already set when Wait() was called.
+         StageSpin,
+         StageBackoff,
+         StageBlock,
+         StageTimeout,       // The flag was not set within the timeout.
+         NumStages
+      };
+
+      // Bucket i counts waits of [2^i, 2^(i+1)) nanoseconds; bucket 0 also counts waits
+      //    shorter than 1 nsec, and the last bucket everything longer.
+      enum { NumBuckets = 40 };
+
+      enum {
+         DefaultSpinNanos        = 20000,
+         DefaultMaxBackoffMicros = 1000,
+         BlockSliceMillis        = 10
+      };
+
+      CompletionWaiter(btUnsigned64bitInt SpinNanos        = DefaultSpinNanos,
+                       btUnsigned32bitInt MaxBackoffMicros = DefaultMaxBackoffMicros,
+                       IBlocker          *pBlocker         = NULL);
+
+      // Wait until *pFlag is non-zero, or TimeoutMillis have elapsed.
+      //    Returns true if the flag was seen set, false on timeout.
+      //    TimeoutMillis may be AAL_INFINITE_WAIT.
+      btBool Wait(volatile btUnsigned32bitInt const *pFlag, btTime TimeoutMillis);
+
+      void SetSpinNanos(btUnsigned64bitInt SpinNanos)     { m_SpinNanos        = SpinNanos; }
+      void SetMaxBackoffMicros(btUnsigned32bitInt Micros) { m_MaxBackoffMicros = Micros;    }
+      void SetBlocker(IBlocker *pBlocker)                 { m_pBlocker         = pBlocker;  }
+
+      // Wait histogram.
+      btUnsigned64bitInt Waits()                      const { return m_Waits;          }
+      btUnsigned64bitInt StageCount(Stage s)          const { return m_Stages[s];      }
+      btUnsigned64bitInt BucketCount(btUnsignedInt i) const { return m_Buckets[i];     }
+      btUnsigned64bitInt MaxWaitNanos()               const { return m_MaxWaitNanos;   }
+      btUnsigned64bitInt TotalWaitNanos()             const { return m_TotalWaitNanos; }
+      void               ResetHistogram();
+
+      // The bucket that a wait of Nanos falls into.
+      static btUnsignedInt Bucket(btUnsigned64bitInt Nanos);
+
+      // Stage counts, then one line per non-empty bucket.
+      void Print(std::ostream &s) const;
+
+   private:
+      void Record(Stage s, btUnsigned64bitInt Nanos);
+
+      btUnsigned64bitInt m_SpinNanos;
+      btUnsigned32bitInt m_MaxBackoffMicros;
+      IBlocker          *m_pBlocker;
+
+      btUnsigned64bitInt m_Waits;
+      btUnsigned64bitInt m_TotalWaitNanos;
+      btUnsigned64bitInt m_MaxWaitNanos;
+      btUnsigned64bitInt m_Stages[NumStages];
+      btUnsigned64bitInt m_Buckets[NumBuckets];
+   }; // end of CompletionWaiter
+
+   AASLIB_API std::ostream & operator << (std::ostream &s, const CompletionWaiter &w);
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_UTILS_COMPLETIONWAITER_H__
+
@@ -0,0 +1,135 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file UMsgRing.h
+/// @brief Lock-free UMsg doorbell producer layered on IALIUMsg.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// AUTHOR: Intel Corporation@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_UTILS_UMSGRING_H__
+#define __AALSDK_UTILS_UMSGRING_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/service/IALIAFU.h>
+
+
+BEGIN_NAMESPACE(AAL)
+
+   /* UMsgRing - rings the UMsgs of an AFU as doorbells.
+    * Init() asks IALIUMsg for the number of UMsgs and the address of each, once, and
+    *    keeps them; nothing after Init() makes a driver transaction.
+    * Each doorbell collects notification bits from any number of threads:
+    *    Post() atomically ORs bits into the doorbell's pending word, and Flush()
+    *    atomically takes all of the pending bits and sends them in a single write of
+    *    the doorbell's cache line. Bits posted by several threads before a Flush() are
+    *    thus coalesced into one UMsg.
+    * The line written is { Sequence << 32 | Bits, 0, 0, 0, 0, 0, 0, 0 }, where Sequence
+    *    counts the writes to that doorbell, so that no two consecutive writes carry the
+    *    same data. When IALIUMsg::umsgIsDirect(), the line is written with non-temporal
+    *    stores followed by a store fence, so that it leaves the core as one 64-byte write
+    *    and is visible to the AFU when Flush() returns. Otherwise (ASE), the first
+    *    quadword is sent through IALIUMsg::umsgTrigger64().
+    * ThreadDoorbell() assigns doorbells to threads round robin, without a lock, and
+    *    remembers the assignment in the thread, so that threads that each ring their
+    *    own doorbell never share a cache line.
+    * Nothing here is locked; all methods may be called concurrently, except Init().
+    */
+   class AASLIB_API UMsgRing
+   {
+   public:
+      enum {
+         MaxDoorbells = 64,
+         LineQWords   = 8
+      };
+
+      UMsgRing();
+      ~UMsgRing();
+
+      // Cache the UMsg map of pUMsg. Doorbells limits the number of UMsgs used (0 for
+      //    all of them, up to MaxDoorbells). Returns false if pUMsg is NULL, or has no
+      //    UMsgs, or any of their addresses can not be obtained.
+      btBool Init(IALIUMsg *pUMsg, btUnsignedInt Doorbells=0);
+
+      btBool        IsOK()      const { return 0 != m_Doorbells; }
+      btBool        IsDirect()  const { return m_Direct;          }
+      btUnsignedInt Doorbells() const { return m_Doorbells;       }
+
+      // The doorbell of the calling thread.
+      btUnsignedInt ThreadDoorbell();
+
+      // Add Bits to the doorbell's pending notification.
+      void   Post(btUnsignedInt Doorbell, btUnsigned32bitInt Bits);
+      // Send the doorbell's pending notification, if any. Returns true if a UMsg was sent.
+      btBool Flush(btUnsignedInt Doorbell);
+      // Post() then Flush().
+      btBool Notify(btUnsignedInt Doorbell, btUnsigned32bitInt Bits) { Post(Doorbell, Bits); return Flush(Doorbell); }
+      btBool Notify(btUnsigned32bitInt Bits)                         { return Notify(ThreadDoorbell(), Bits);      }
+
+      // Per-doorbell counters: Post()'s, and UMsgs sent. Posts - Rings were coalesced.
+      btUnsigned64bitInt Posts(btUnsignedInt Doorbell) const;
+      btUnsigned64bitInt Rings(btUnsignedInt Doorbell) const;
+      void               ResetCounters();
+
+      // The first quadword of the line written for Sequence and Bits.
+      static btUnsigned64bitInt LineValue(btUnsigned32bitInt Sequence, btUnsigned32bitInt Bits)
+      {
+         return ( (btUnsigned64bitInt)Sequence << 32 ) | Bits;
+      }
+
+   private:
+      // One per doorbell, alone in its cache line.
+      struct Doorbell
+      {
+         btVirtAddr                  m_pLine;
+         volatile btUnsigned32bitInt m_Pending;
+         volatile btUnsigned32bitInt m_Sequence;
+         volatile btUnsigned64bitInt m_Posts;
+         volatile btUnsigned64bitInt m_Rings;
+         btByte                      m_Pad[64 - sizeof(btVirtAddr) - 2 * sizeof(btUnsigned32bitInt) - 2 * sizeof(btUnsigned64bitInt)];
+      };
+
+      void Write(Doorbell &d, btUnsigned64bitInt Value);
+
+      // Not copyable.
+      UMsgRing(const UMsgRing & );
+      UMsgRing & operator = (const UMsgRing & );
+
+      IALIUMsg                   *m_pUMsg;
+      btBool                      m_Direct;
+      btUnsignedInt               m_Doorbells;
+      btUnsigned64bitInt          m_Id;
+      volatile btUnsigned32bitInt m_NextDoorbell;
+      Doorbell                   *m_pDoorbells;
+      btByte                     *m_pStorage;
+   }; // end of UMsgRing
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_UTILS_UMSGRING_H__
+
@@ -408,6 +408,10 @@ btBool ALI::setAFUInterfaces()
       goto FAIL;
    }
 
+   if( EObjOK != SetInterface(iidALI_BUFF_POOL_Service, dynamic_cast<IALIBufferPool *>(m_pALIBase)) ){
+      goto FAIL;
+   }
+
    if( EObjOK != SetInterface(iidALI_RSET_Service, dynamic_cast<IALIReset *>(m_pALIBase)) ){
       goto FAIL;
    }
@@ -549,6 +553,10 @@ btBool ALI::ASEInit()
          goto FAIL;
       }
 
+      if( EObjOK != SetInterface(iidALI_BUFF_POOL_Service, dynamic_cast<IALIBufferPool *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
       if( EObjOK != SetInterface(iidALI_RSET_Service, dynamic_cast<IALIReset *>(m_pALIBase)) ){
          goto FAIL;
       }
@@ -77,7 +77,7 @@ USING_NAMESPACE(AAL)
 //        tranID   - Transaction ID
 // Comments:
 //=============================================================================
-BufferAllocateTransaction::BufferAllocateTransaction( btWSSize len ) :
+BufferAllocateTransaction::BufferAllocateTransaction( btWSSize len, btWSSize pgsize ) :
    m_msgID(reqid_UID_SendAFU),
    m_bIsOK(false),
    m_payload(NULL),
@@ -114,7 +114,7 @@ BufferAllocateTransaction::BufferAllocateTransaction( btWSSize len ) :
    // fill out ahm_req
    req->u.wksp.m_wsid   = 0;        // not used?
    req->u.wksp.m_size   = len;
-   req->u.wksp.m_pgsize = 0;        // not used?
+   req->u.wksp.m_pgsize = pgsize;
 
    // package in AIA transaction
    m_payload = (btVirtAddr) afumsg;
@@ -137,6 +137,69 @@ BufferAllocateTransaction::~BufferAllocateTransaction() {
    delete afumsg;
 }
 
+//=============================================================================
+// Name:          BufferPrepareTransaction
+// Description:   Send a Workspace Pin operation to the Driver stack
+// Input:         ptr      - Start of the user memory
+//                len      - Length of the user memory
+// Comments:
+//=============================================================================
+BufferPrepareTransaction::BufferPrepareTransaction( btVirtAddr ptr, btWSSize len ) :
+   m_msgID(reqid_UID_SendAFU),
+   m_bIsOK(false),
+   m_payload(NULL),
+   m_size(0),
+   m_errno(uid_errnumOK)
+{
+   union msgpayload{
+      struct ahm_req                req;    // [IN]
+      struct AAL::aalui_WSMEvent    resp;   // [OUT]
+   };
+
+   // We need to send an ahm_req within an aalui_CCIdrvMessage packaged in an
+   // BufferPrepare-AIATransaction.
+   m_size = sizeof(struct aalui_CCIdrvMessage) +  sizeof(union msgpayload );
+
+   // Allocate structs
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
+
+   //check afumsg is non-NULL before using it
+   ASSERT(NULL != afumsg);
+   if (afumsg == NULL){
+      setErrno(uid_errnumNoMem);
+      return;
+   }
+
+   // Point at payload
+   struct ahm_req *req                 = reinterpret_cast<struct ahm_req *>(afumsg->payload);
+
+   // fill out aalui_CCIdrvMessage
+   afumsg->cmd     = ccipdrv_afucmdWKSP_PIN;
+   afumsg->size    =  sizeof(union msgpayload );
+
+   // fill out ahm_req
+   req->u.wksp_pin.m_ptr  = ptr;
+   req->u.wksp_pin.m_size = len;
+
+   // package in AIA transaction
+   m_payload = (btVirtAddr) afumsg;
+
+   m_bIsOK = true;
+}
+
+AAL::btBool                    BufferPrepareTransaction::IsOK() const {return m_bIsOK;}
+AAL::btVirtAddr                BufferPrepareTransaction::getPayloadPtr()const {return m_payload;}
+AAL::btWSSize                  BufferPrepareTransaction::getPayloadSize()const {return m_size;}
+AAL::stTransactionID_t const   BufferPrepareTransaction::getTranID()const {return m_tid_t;}
+AAL::uid_msgIDs_e              BufferPrepareTransaction::getMsgID()const {return m_msgID;}
+struct AAL::aalui_WSMEvent     BufferPrepareTransaction::getWSIDEvent() const {return *(reinterpret_cast<struct AAL::aalui_WSMEvent*>(m_payload));}
+AAL::uid_errnum_e              BufferPrepareTransaction::getErrno()const {return m_errno;};
+void                           BufferPrepareTransaction::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
+
+BufferPrepareTransaction::~BufferPrepareTransaction() {
+   delete [] reinterpret_cast<btByte *>(m_payload);
+}
+
 //=============================================================================
 // Name:          BufferFreeTransaction
 // Description:   Send a Workspace Free operation to the driver stack
@@ -60,12 +60,13 @@
 // Description:   Send a Workspace Allocate operation to the Driver stack
 // Input: devHandl - Device Handle received from Resource Manager
 //        tranID   - Transaction ID
+//        pgsize   - Preferred page size (CCIP_WKSP_PGSIZE_*), 0 for default
 // Comments:
 //=============================================================================
 class UAIA_API BufferAllocateTransaction : public IAIATransaction
 {
 public:
-   BufferAllocateTransaction( AAL::btWSSize len );
+   BufferAllocateTransaction( AAL::btWSSize len, AAL::btWSSize pgsize = 0 );
    AAL::btBool                IsOK() const;
 
    AAL::btVirtAddr                getPayloadPtr() const;
@@ -91,6 +92,42 @@ private:
 }; // class BufferAllocateTransaction
 
 
+//=============================================================================
+// Name:          BufferPrepareTransaction
+// Description:   Send a Workspace Pin operation to the Driver stack, making
+//                existing user memory accessible to the AFU
+// Input: ptr      - Start of the user memory
+//        len      - Length of the user memory
+// Comments: The resulting workspace is released with BufferFreeTransaction.
+//=============================================================================
+class UAIA_API BufferPrepareTransaction : public IAIATransaction
+{
+public:
+   BufferPrepareTransaction( AAL::btVirtAddr ptr, AAL::btWSSize len );
+   AAL::btBool                IsOK() const;
+
+   AAL::btVirtAddr                getPayloadPtr() const;
+   AAL::btWSSize                  getPayloadSize() const;
+   AAL::stTransactionID_t const   getTranID() const;
+   AAL::uid_msgIDs_e              getMsgID() const;
+   struct AAL::aalui_WSMEvent     getWSIDEvent() const;
+   AAL::uid_errnum_e              getErrno()const;
+   void                           setErrno(AAL::uid_errnum_e);
+
+
+   ~BufferPrepareTransaction();
+
+private:
+   AAL::uid_msgIDs_e             m_msgID;
+   AAL::stTransactionID_t        m_tid_t;
+   AAL::btBool                   m_bIsOK;
+   AAL::btVirtAddr               m_payload;
+   AAL::btWSSize                 m_size;
+   AAL::uid_errnum_e             m_errno;
+
+}; // class BufferPrepareTransaction
+
+
 //=============================================================================
 // Name:          BufferFreeTransaction
 // Description:   Send a Workspace Free operation to the driver stack
@@ -77,6 +77,26 @@ public :
 protected:
    IRuntime * getRuntime() { return m_pServiceBase->getRuntime(); }
 
+   // True if every access in an IALIMMIO batch lies within an MMIO region of Length bytes.
+   static btBool mmioBatchIsValid( const ali_mmio_op * const pOps,
+                                   const btUnsignedInt       Count,
+                                   const btCSROffset         Length )
+   {
+      if ( ( NULL == pOps ) && ( 0 != Count ) ) {
+         return false;
+      }
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         if ( ( ali_mmio_width32 != pOps[i].Width ) && ( ali_mmio_width64 != pOps[i].Width ) ) {
+            return false;
+         }
+         if ( ( pOps[i].Offset > Length ) || ( (btCSROffset)pOps[i].Width > Length - pOps[i].Offset ) ) {
+            return false;
+         }
+      }
+      return true;
+   }
+
    IBase                  *m_pSvcClient;
    IServiceBase           *m_pServiceBase;
    TransactionID           m_tidSaved;
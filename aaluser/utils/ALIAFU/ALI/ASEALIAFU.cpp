@@ -70,13 +70,17 @@ CASEALIAFU::CASEALIAFU( IBase *pSvcClient,
                         IServiceBase *pServiceBase,
                         TransactionID transID):
                         CALIBase(pSvcClient,pServiceBase,transID),
-                        m_mapWkSpc(),
+                        m_WkSpcIndex(),
                         m_MMIORmap(NULL),
                         m_MMIORsize(0),
                         m_Last3c4(0xffffffff),
-                        m_Last3cc(0xffffffff)
+                        m_Last3cc(0xffffffff),
+                        m_BufferPool(this)
 {
-
+   if ( !m_BufferPool.Configure(m_pServiceBase->OptArgs()) ) {
+      AAL_WARNING(LM_ALI, "Invalid " << ALI_BUFFPOOL_ARENA_SIZE_KEY << ", using " <<
+                          m_BufferPool.ArenaSize() << std::endl);
+   }
 }
 
 //
@@ -84,6 +88,8 @@ CASEALIAFU::CASEALIAFU( IBase *pSvcClient,
 //
 btBool CASEALIAFU::ASERelease()
 {
+   // The pool's arenas are ASE buffers, so they must go before the session does.
+   m_BufferPool.Release();
    session_deinit();
    return true;
 }
@@ -287,6 +293,15 @@ btCSROffset CASEALIAFU::mmioGetLength( void )
   return m_MMIORsize;
 }
 
+//
+// mmioIsDirect. mmio_afu_vbase only shadows the simulated region; every access
+// must be sent to the simulator.
+//
+btBool CASEALIAFU::mmioIsDirect( void )
+{
+  return false;
+}
+
 //
 // mmioRead32. Read 32bit CSR. Offset given in bytes.
 //
@@ -339,6 +354,58 @@ btBool CASEALIAFU::mmioWrite64(const btCSROffset Offset, const btUnsigned64bitIn
   return true;
 }
 
+//
+// mmioWriteBatch. Write a sequence of 32/64bit CSRs in one pass over the MMIO request path.
+//
+btBool CASEALIAFU::mmioWriteBatch(const ali_mmio_op * const pOps, const btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pOps, Count, m_MMIORsize) ) {
+      return false;
+   }
+   if ( 0 == Count ) {
+      return true;
+   }
+
+   std::vector<mmio_batch_t> batch(Count);
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      batch[i].addr  = (int)pOps[i].Offset;
+      batch[i].width = ( ali_mmio_width32 == pOps[i].Width ) ? MMIO_WIDTH_32 : MMIO_WIDTH_64;
+      batch[i].data  = pOps[i].Value;
+   }
+
+   mmio_write_batch(&batch[0], (int)Count);
+   return true;
+}
+
+//
+// mmioReadBatch. Read a sequence of 32/64bit CSRs, waiting for their responses together.
+//
+btBool CASEALIAFU::mmioReadBatch(ali_mmio_op * const pOps, const btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pOps, Count, m_MMIORsize) ) {
+      return false;
+   }
+   if ( 0 == Count ) {
+      return true;
+   }
+
+   std::vector<mmio_batch_t> batch(Count);
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      batch[i].addr  = (int)pOps[i].Offset;
+      batch[i].width = ( ali_mmio_width32 == pOps[i].Width ) ? MMIO_WIDTH_32 : MMIO_WIDTH_64;
+      batch[i].data  = 0;
+   }
+
+   mmio_read_batch(&batch[0], (int)Count);
+
+   for ( i = 0 ; i < Count ; ++i ) {
+      pOps[i].Value = batch[i].data;
+   }
+   return true;
+}
+
 //
 // mmioGetFeature. Get pointer to feature's DFH, if found.
 //
@@ -514,33 +581,55 @@ AAL::ali_errnum_e CASEALIAFU::bufferAllocate( btWSSize             Length,
 
   *pBufferptr = (btVirtAddr)buf->vbase;
 
-  // Add info to Workspace map
-  struct aalui_WSMParms wsParms;
-  wsParms.wsid = buf->index;
-  wsParms.ptr = (btVirtAddr)buf->vbase;
-  wsParms.physptr = buf->fake_paddr;
-  wsParms.size = buf->memsize;
+  // Add info to Workspace index
+  m_WkSpcIndex.Add((btVirtAddr)buf->vbase,
+                   buf->memsize,
+                   buf->fake_paddr,
+                   buf->index);
 
-  m_mapWkSpc[(btVirtAddr)buf->vbase] = wsParms;
+  // ASE buffers are shared memory mappings, always backed by base pages.
+  //  A request for huge pages (ALI_BUFFER_HUGEPAGE_KEY) falls back to them.
+  if ( rOutputArgs.Has(ALI_BUFFER_PAGESIZE_KEY) ) {
+    rOutputArgs.Delete(ALI_BUFFER_PAGESIZE_KEY);
+  }
+  rOutputArgs.Add(ALI_BUFFER_PAGESIZE_KEY, (ALI_BUFFER_PAGESIZE_DATATYPE)getpagesize());
 
   return ali_errnumOK;
 }
 
 
-AAL::ali_errnum_e CASEALIAFU::bufferFree( btVirtAddr Address)
+//
+// bufferPrepare. ASE has no way to let the simulated AFU reach memory outside
+// its own shared buffers, so existing memory can not be prepared.
+//
+AAL::ali_errnum_e CASEALIAFU::bufferPrepare( btVirtAddr           Address,
+                                             btWSSize             Length,
+                                             NamedValueSet const &rInputArgs )
 {
-  // Find in map and remove
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i == m_mapWkSpc.end()) {  // not found
-      AAL_ERR(LM_ALI, "Tried to free non-existent Buffer");
-      return ali_errnumBadParameter;
-   }
+  if ( ( NULL == Address ) || ( 0 == Length ) ) {
+    return ali_errnumBadParameter;
+  }
+  AAL_ERR(LM_ALI, "bufferPrepare is not supported by ASE, use bufferAllocate" << std::endl);
+  return ali_errnumNotImpl;
+}
+
+AAL::ali_errnum_e CASEALIAFU::bufferRelease( btVirtAddr Address)
+{
+  return ali_errnumNotImpl;
+}
 
-  struct aalui_WSMParms wsParms;
-  wsParms = i->second;
+
+AAL::ali_errnum_e CASEALIAFU::bufferFree( btVirtAddr Address)
+{
+  // Find in index and remove
+  WorkSpaceIndex::WkSp wksp;
+  if ( !m_WkSpcIndex.Remove(Address, &wksp) ) {  // not found
+     AAL_ERR(LM_ALI, "Tried to free non-existent Buffer");
+     return ali_errnumBadParameter;
+  }
 
   // Call ase_common:deallocate_buffer_by_index
-  deallocate_buffer_by_index((int)wsParms.wsid);
+  deallocate_buffer_by_index((int)wksp.m_wsid);
 
   return ali_errnumOK;
 }
@@ -549,20 +638,7 @@ AAL::ali_errnum_e CASEALIAFU::bufferFree( btVirtAddr Address)
 // Exactly the same as HWALIAFU::bufferGetIOVA
 btPhysAddr CASEALIAFU::bufferGetIOVA( btVirtAddr Address)
 {
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i != m_mapWkSpc.end()) {
-      return i->second.physptr;
-   }
-
-   for (mapWkSpc_t::iterator i = m_mapWkSpc.begin(); i != m_mapWkSpc.end(); i++)
-     {
-       if (Address < i->second.ptr + i->second.size) {
-         return i->second.physptr + (Address - i->second.ptr);
-       }
-     }
-
-   // not found
-   return 0;
+   return m_WkSpcIndex.GetIOVA(Address);
 }
 
 
@@ -589,7 +665,7 @@ btVirtAddr CASEALIAFU::umsgGetAddress( const btUnsignedInt UMsgNumber )
    //       in the UMAS range
 
    // Input check
-   if ((UMsgNumber < 0) || (UMsgNumber > NUM_UMSG_PER_AFU))
+   if ( UMsgNumber >= NUM_UMSG_PER_AFU )
    {
       return NULL;
    }
@@ -602,12 +678,32 @@ btVirtAddr CASEALIAFU::umsgGetAddress( const btUnsignedInt UMsgNumber )
 }
 
 
+//
+// umsgTrigger64. Hand the value to the ASE UMsg path for the UMsg containing pUMsg.
+//
 void CASEALIAFU::umsgTrigger64( const btVirtAddr pUMsg,
                 const btUnsigned64bitInt Value )
 {
-
+   if ( ( NULL == m_uMSGmap ) || ( pUMsg < m_uMSGmap ) ) {
+      return;
+   }
+   btUnsigned64bitInt UMsgNumber = (btUnsigned64bitInt)(pUMsg - m_uMSGmap) / (4096 + 64);
+   if ( UMsgNumber >= NUM_UMSG_PER_AFU ) {
+      return;
+   }
+   uint64_t data = Value;
+   umsg_send((int)UMsgNumber, &data);
 }  // umsgTrigger64
 
+//
+// umsgIsDirect. The UMsg lines are watched by ASE, but are only guaranteed to
+//    reach the simulation through umsg_send().
+//
+btBool CASEALIAFU::umsgIsDirect( void )
+{
+   return false;
+}
+
 
 //
 // umsgSetAttributes. Set UMSG attributes.
@@ -47,6 +47,8 @@
 
 #include "ALIBase.h"
 #include "aalsdk/kernel/ccip_defs.h"
+#include "aalsdk/utils/AALWorkSpaceUtilities.h"
+#include "aalsdk/utils/AALBufferPool.h"
 //#include <aalsdk/ase/ase_common.h>
 
 // Buffer information structure
@@ -82,6 +84,7 @@ BEGIN_NAMESPACE(AAL)
 class  CASEALIAFU : public CALIBase,
                     public IALIMMIO,
                     public IALIBuffer,
+                    public IALIBufferPool,
                     public IALIUMsg,
                     public IALIReset
 {
@@ -100,11 +103,14 @@ public :
    // <IALIMMIO>
    virtual btVirtAddr   mmioGetAddress( void );
    virtual btCSROffset  mmioGetLength( void );
+   virtual btBool       mmioIsDirect( void );
 
    virtual btBool  mmioRead32( const btCSROffset Offset,       btUnsigned32bitInt * const pValue);
    virtual btBool  mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value);
    virtual btBool  mmioRead64( const btCSROffset Offset,       btUnsigned64bitInt * const pValue);
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value);
+   virtual btBool  mmioWriteBatch( const ali_mmio_op * const pOps, const btUnsignedInt Count);
+   virtual btBool  mmioReadBatch( ali_mmio_op * const pOps, const btUnsignedInt Count);
    virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
                                           NamedValueSet const &rInputArgs,
                                           NamedValueSet       &rOutputArgs );
@@ -134,14 +140,28 @@ public :
                                              NamedValueSet const &rInputArgs,
                                              NamedValueSet       &rOutputArgs );
    virtual AAL::ali_errnum_e bufferFree( btVirtAddr           Address);
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                            btWSSize             Length ) { return bufferPrepare(Address, Length, AAL::NamedValueSet()); }
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                            btWSSize             Length,
+                                            NamedValueSet const &rInputArgs );
+   virtual AAL::ali_errnum_e bufferRelease( btVirtAddr           Address);
    virtual btPhysAddr bufferGetIOVA( btVirtAddr Address);
    // </IALIBuffer>
 
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e poolAllocate( btWSSize    Length,
+                                           btVirtAddr *pBufferptr ) { return m_BufferPool.poolAllocate(Length, pBufferptr); }
+   virtual AAL::ali_errnum_e poolFree( btVirtAddr Address )         { return m_BufferPool.poolFree(Address);              }
+   virtual btPhysAddr poolGetIOVA( btVirtAddr Address )             { return m_BufferPool.poolGetIOVA(Address);           }
+   // </IALIBufferPool>
+
    // <IALIUMsg>
    virtual btUnsignedInt umsgGetNumber( void );
    virtual btVirtAddr   umsgGetAddress( const btUnsignedInt UMsgNumber );
    virtual void          umsgTrigger64( const btVirtAddr pUMsg,
                                         const btUnsigned64bitInt Value );
+   virtual btBool         umsgIsDirect( void );
    virtual bool      umsgSetAttributes( NamedValueSet const &nvsArgs);
    // </IALIUMsg>
 
@@ -168,9 +188,11 @@ protected:
    btCSRValue             m_Last3cc;
    map_t                  m_WkspcMap;
 
-   // Map to store workspace parameters
-   typedef std::map<btVirtAddr, struct aalui_WSMParms> mapWkSpc_t;
-   mapWkSpc_t m_mapWkSpc;
+   // Index of workspace parameters, keyed by virtual address range
+   WorkSpaceIndex         m_WkSpcIndex;
+
+   // Sub-allocator for IALIBufferPool, drawing on this IALIBuffer
+   BufferPool             m_BufferPool;
 
    // List to cache device feature metadata
    typedef struct {
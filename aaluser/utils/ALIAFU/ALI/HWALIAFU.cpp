@@ -66,9 +66,14 @@ CHWALIAFU::CHWALIAFU( IBase *pSvcClient,
                       TransactionID transID,
                       IAFUProxy *pAFUProxy): CHWALIBase(pSvcClient,pServiceBase,transID,pAFUProxy),
                       m_uMSGmap(NULL),
-                      m_uMSGsize(0)
+                      m_uMSGsize(0),
+                     m_uMSGnumber(0),
+                      m_BufferPool(this)
 {
-
+   if ( !m_BufferPool.Configure(m_pServiceBase->OptArgs()) ) {
+      AAL_WARNING(LM_ALI, "Invalid " << ALI_BUFFPOOL_ARENA_SIZE_KEY << ", using " <<
+                          m_BufferPool.ArenaSize() << std::endl);
+   }
 }
 
 
@@ -84,11 +89,18 @@ AAL::ali_errnum_e CHWALIAFU::bufferAllocate( btWSSize             Length,
                                                     NamedValueSet const &rInputArgs,
                                                     NamedValueSet       &rOutputArgs )
 {
-   AutoLock(this);
+   // No lock is held across the transaction: m_WkSpcIndex serializes itself,
+   // so allocations from different threads can be in the driver concurrently.
    *pBufferptr = NULL;
 
+   // Huge pages are a preference; the driver falls back to smaller pages.
+   ALI_BUFFER_HUGEPAGE_DATATYPE pgsize = 0;
+   if ( ENamedValuesOK != rInputArgs.Get(ALI_BUFFER_HUGEPAGE_KEY, &pgsize) ) {
+      pgsize = 0;
+   }
+
    // Create the Transaction
-   BufferAllocateTransaction transaction(Length);
+   BufferAllocateTransaction transaction(Length, pgsize);
 
    // Check the parameters
    if ( transaction.IsOK() ) {
@@ -110,8 +122,30 @@ AAL::ali_errnum_e CHWALIAFU::bufferAllocate( btWSSize             Length,
       AAL_ERR( LM_ALI, "FATAL: MapWSID failed"<< std::endl);
       return ali_errnumSystem;
    }
-   // store entire aalui_WSParms struct in map
-   m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
+   // remember the workspace for bufferFree() and bufferGetIOVA()
+   if ( !m_WkSpcIndex.Add(wsevt.wsParms.ptr,
+                          wsevt.wsParms.size,
+                          wsevt.wsParms.physptr,
+                          wsevt.wsParms.wsid) ) {
+      AAL_ERR( LM_ALI, "FATAL: workspace overlaps an existing one"<< std::endl);
+      m_pAFUProxy->UnMapWSID(wsevt.wsParms.ptr, wsevt.wsParms.size);
+      BufferFreeTransaction freeTransaction(wsevt.wsParms.wsid);
+      if ( freeTransaction.IsOK() ) {
+         m_pAFUProxy->SendTransaction(&freeTransaction);
+      }
+      return ali_errnumSystem;
+   }
+
+   if ( rOutputArgs.Has(ALI_BUFFER_PAGESIZE_KEY) ) {
+      rOutputArgs.Delete(ALI_BUFFER_PAGESIZE_KEY);
+   }
+   // The driver maps huge pages only where the mapping is aligned to them,
+   //  which a caller-chosen ALI_MMAP_TARGET_VADDR_KEY need not be.
+   ALI_BUFFER_PAGESIZE_DATATYPE mappgsize = wsevt.wsParms.pgsize;
+   if ( 0 != ( (btUnsigned64bitInt)wsevt.wsParms.ptr & ( mappgsize - 1 ) ) ) {
+      mappgsize = getpagesize();
+   }
+   rOutputArgs.Add(ALI_BUFFER_PAGESIZE_KEY, mappgsize);
 
    *pBufferptr = wsevt.wsParms.ptr;
    return ali_errnumOK;
@@ -123,34 +157,40 @@ AAL::ali_errnum_e CHWALIAFU::bufferAllocate( btWSSize             Length,
 //
 AAL::ali_errnum_e CHWALIAFU::bufferFree( btVirtAddr           Address)
 {
-   AutoLock(this);
    // TODO: Create a transaction id that wraps the original from the application,
 //    TransactionID tid(new(std::nothrow) TransactionID(TranID));
 
-   // Find workspace id
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i == m_mapWkSpc.end()) {  // not found
-      AAL_ERR(LM_ALI, "Tried to free non-existent Buffer"<< std::endl);
-      return ali_errnumBadParameter;
+   // Find workspace id, and forget the workspace parameters, so that no IOVA
+   // lookup can resolve into the buffer once it starts going away. The lock
+   // is held only for the index updates, not across the transaction; only one
+   // of several concurrent frees of the same buffer gets past here.
+   WorkSpaceIndex::WkSp wksp;
+   {
+      AutoLock(this);
+      if ( m_PreparedIndex.Find(Address, &wksp) ) {
+         AAL_ERR(LM_ALI, "Tried to free a prepared Buffer, use bufferRelease()"<< std::endl);
+         return ali_errnumBadParameter;
+      }
+      if ( !m_WkSpcIndex.Remove(Address, &wksp) ) {  // not found
+         AAL_ERR(LM_ALI, "Tried to free non-existent Buffer"<< std::endl);
+         return ali_errnumBadParameter;
+      }
    }
-   // workspace id is in i->second.wsid
+   // workspace id is in wksp.m_wsid
 
    // Create the Transaction
-   BufferFreeTransaction transaction(i->second.wsid);
+   BufferFreeTransaction transaction(wksp.m_wsid);
 
    // Check the parameters
    if ( transaction.IsOK() ) {
 
       // Unmap buffer
-      m_pAFUProxy->UnMapWSID(i->second.ptr, i->second.size);
+      m_pAFUProxy->UnMapWSID(wksp.m_ptr, wksp.m_len);
 
       // Send transaction
       // Will eventually trigger AFUEvent(), below.
       m_pAFUProxy->SendTransaction(&transaction);
 
-      // Forget workspace parameters
-      m_mapWkSpc.erase(i);
-
    } else {
       return ali_errnumSystem;
    }
@@ -158,29 +198,97 @@ AAL::ali_errnum_e CHWALIAFU::bufferFree( btVirtAddr           Address)
 }
 
 //
-// bufferGetIOVA. Retrieve IO Virtual Address for a virtual address.
+// bufferPrepare. Pin existing memory and make it accessible to the AFU.
 //
-btPhysAddr CHWALIAFU::bufferGetIOVA( btVirtAddr Address)
+AAL::ali_errnum_e CHWALIAFU::bufferPrepare( btVirtAddr           Address,
+                                            btWSSize             Length,
+                                            NamedValueSet const &rInputArgs )
 {
-   // TODO Return actual IOVA instead of physptr
+   if ( ( NULL == Address ) || ( 0 == Length ) ) {
+      return ali_errnumBadParameter;
+   }
+
+   // Create the Transaction
+   BufferPrepareTransaction transaction(Address, Length);
+   if ( !transaction.IsOK() ) {
+      return ali_errnumSystem;
+   }
 
-   // try to find exact match
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i != m_mapWkSpc.end()) {
-      return i->second.physptr;
+   m_pAFUProxy->SendTransaction(&transaction);
+   if ( uid_errnumOK != transaction.getErrno() ) {
+      AAL_ERR( LM_ALI, "buffer prepare error = " << transaction.getErrno()<< std::endl);
+      return ( uid_errnumNoMap == transaction.getErrno() ) ? ali_errnumNoMap : ali_errnumSystem;
+   }
+   struct AAL::aalui_WSMEvent wsevt = transaction.getWSIDEvent();
+
+   // The driver has the pages. Make them visible to bufferGetIOVA(), unless
+   // they overlap a buffer that already is. Both indexes are updated under the
+   // lock, so bufferFree() never sees the range in only one of them.
+   btBool added = false;
+   {
+      AutoLock(this);
+      if ( m_WkSpcIndex.Add(Address,
+                            Length,
+                            wsevt.wsParms.physptr,
+                            wsevt.wsParms.wsid) ) {
+         added = m_PreparedIndex.Add(Address, Length, wsevt.wsParms.physptr, wsevt.wsParms.wsid);
+         if ( !added ) {
+            m_WkSpcIndex.Remove(Address);
+         }
+      }
+   }
+   if ( !added ) {
+      AAL_ERR( LM_ALI, "prepared memory overlaps an existing Buffer"<< std::endl);
+      BufferFreeTransaction freeTransaction(wsevt.wsParms.wsid);
+      if ( freeTransaction.IsOK() ) {
+         m_pAFUProxy->SendTransaction(&freeTransaction);
+      }
+      return ali_errnumBadParameter;
    }
 
-   // look through all workspaces to see if Address is in one of them
-   // TODO: there might be a more efficient way
-   // TODO: this loop works only if map keeps keys in increasing order -- does it?
-   for (mapWkSpc_t::iterator i = m_mapWkSpc.begin(); i != m_mapWkSpc.end(); i++ ) {
-      if (Address < i->second.ptr + i->second.size) {
-         return i->second.physptr + (Address - i->second.ptr);
+   return ali_errnumOK;
+}
+
+//
+// bufferRelease. Unpin memory previously prepared with bufferPrepare().
+//
+AAL::ali_errnum_e CHWALIAFU::bufferRelease( btVirtAddr Address)
+{
+   // Only one of several concurrent releases of the same memory gets past here.
+   // Forget the range before the driver lets go of the pages.
+   WorkSpaceIndex::WkSp wksp;
+   {
+      AutoLock(this);
+      if ( !m_PreparedIndex.Remove(Address, &wksp) ) {
+         AAL_ERR(LM_ALI, "Tried to release memory that was not prepared"<< std::endl);
+         return ali_errnumBadParameter;
       }
+      m_WkSpcIndex.Remove(Address);
+   }
+
+   BufferFreeTransaction transaction(wksp.m_wsid);
+   if ( !transaction.IsOK() ) {
+      return ali_errnumSystem;
+   }
+   m_pAFUProxy->SendTransaction(&transaction);
+   if ( uid_errnumOK != transaction.getErrno() ) {
+      AAL_ERR( LM_ALI, "buffer release error = " << transaction.getErrno()<< std::endl);
+      return ali_errnumSystem;
    }
+   return ali_errnumOK;
+}
+
+//
+// bufferGetIOVA. Retrieve IO Virtual Address for a virtual address.
+//
+btPhysAddr CHWALIAFU::bufferGetIOVA( btVirtAddr Address)
+{
+   // TODO Return actual IOVA instead of physptr
 
-   // not found
-   return 0;
+   // Lock-free when Address is in the same workspace as this thread's
+   // previous lookup, O(log n) in the number of workspaces otherwise.
+   // Returns 0 if Address is not within any workspace.
+   return m_WkSpcIndex.GetIOVA(Address);
 }
 
 // ---------------------------------------------------------------------------
@@ -192,10 +300,17 @@ btPhysAddr CHWALIAFU::bufferGetIOVA( btVirtAddr Address)
 //
 btUnsignedInt CHWALIAFU::umsgGetNumber( void )
 {
-   UmsgGetNumber transaction;
-   m_pAFUProxy->SendTransaction(&transaction);
-   btUnsignedInt temp = transaction.getNumber();
-   return temp;
+   // The number of UMsgs is fixed for the life of the AFU, so ask the driver once.
+   if ( 0 == m_uMSGnumber ) {
+      UmsgGetNumber transaction;
+      m_pAFUProxy->SendTransaction(&transaction);
+      if ( uid_errnumOK == transaction.getErrno() ) {
+         m_uMSGnumber = transaction.getNumber();
+      } else {
+         return 0;
+      }
+   }
+   return m_uMSGnumber;
 }
 
 //
@@ -222,9 +337,11 @@ btVirtAddr CHWALIAFU::umsgGetAddress( const btUnsignedInt UMsgNumber )
       {
         m_uMSGsize = wsevt.wsParms.size;
         m_uMSGmap = wsevt.wsParms.ptr;
-        // store entire aalui_WSParms struct in map
-        // to enable bufferGetIOVA()
-        m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
+        // index the UMAS workspace to enable bufferGetIOVA()
+        m_WkSpcIndex.Add(wsevt.wsParms.ptr,
+                         wsevt.wsParms.size,
+                         wsevt.wsParms.physptr,
+                         wsevt.wsParms.wsid);
       }
    }
    // Umsgs are separated by 1 Page + 1 CL
@@ -247,6 +364,14 @@ void CHWALIAFU::umsgTrigger64( const btVirtAddr pUMsg,
    *reinterpret_cast<btUnsigned64bitInt*>(pUMsg) = Value;
 }  // umsgTrigger64
 
+//
+// umsgIsDirect. The UMsg region is mmapped, so writing a UMsg line sends the UMsg.
+//
+btBool CHWALIAFU::umsgIsDirect( void )
+{
+   return true;
+}
+
 //
 // umsgSetAttributes. Set UMSG attributes.
 //
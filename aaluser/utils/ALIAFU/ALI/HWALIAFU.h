@@ -45,6 +45,7 @@
 #define __HWALIAFU11_H__
 
 #include <aalsdk/service/IALIAFU.h>
+#include <aalsdk/utils/AALBufferPool.h>
 #include "HWALIBase.h"
 
 
@@ -60,6 +61,7 @@ BEGIN_NAMESPACE(AAL)
 
 class  CHWALIAFU : public CHWALIBase,
                    public IALIBuffer,
+                   public IALIBufferPool,
                    public IALIUMsg,
                    public IALIReset
 
@@ -72,7 +74,8 @@ public :
               TransactionID transID,
               IAFUProxy *pAFUProxy);
 
-   ~CHWALIAFU()  { };
+   // Return the pool's arenas while bufferFree() still works.
+   ~CHWALIAFU()  { m_BufferPool.Release(); };
 
    // <IALIBuffer>
    virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
@@ -90,14 +93,28 @@ public :
                                            NamedValueSet       &rOutputArgs );
 
    virtual AAL::ali_errnum_e bufferFree( btVirtAddr           Address);
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                          btWSSize             Length ) { return bufferPrepare(Address, Length, AAL::NamedValueSet()); }
+   virtual AAL::ali_errnum_e bufferPrepare( btVirtAddr           Address,
+                                          btWSSize             Length,
+                                          NamedValueSet const &rInputArgs );
+   virtual AAL::ali_errnum_e bufferRelease( btVirtAddr           Address);
    virtual btPhysAddr bufferGetIOVA( btVirtAddr Address);
    // </IALIBuffer>
 
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e poolAllocate( btWSSize    Length,
+                                           btVirtAddr *pBufferptr ) { return m_BufferPool.poolAllocate(Length, pBufferptr); }
+   virtual AAL::ali_errnum_e poolFree( btVirtAddr Address )         { return m_BufferPool.poolFree(Address);              }
+   virtual btPhysAddr poolGetIOVA( btVirtAddr Address )             { return m_BufferPool.poolGetIOVA(Address);           }
+   // </IALIBufferPool>
+
    // <IALIUMsg>
    virtual btUnsignedInt umsgGetNumber( void );
    virtual btVirtAddr   umsgGetAddress( const btUnsignedInt UMsgNumber );
    virtual void          umsgTrigger64( const btVirtAddr pUMsg,
                                         const btUnsigned64bitInt Value );
+   virtual btBool         umsgIsDirect( void );
    virtual bool      umsgSetAttributes( NamedValueSet const &nvsArgs);
    // </IALIUMsg>
 
@@ -117,6 +134,13 @@ private:
 
    btVirtAddr              m_uMSGmap;
    btUnsigned32bitInt      m_uMSGsize;
+   btUnsignedInt           m_uMSGnumber;        // 0 until the first umsgGetNumber()
+
+   // Sub-allocator for IALIBufferPool, drawing on this IALIBuffer.
+   BufferPool              m_BufferPool;
+
+   // The bufferPrepare()d subset of m_WkSpcIndex, which bufferFree() must not touch.
+   WorkSpaceIndex          m_PreparedIndex;
 
 };
 
@@ -67,9 +67,9 @@ CHWALIBase::CHWALIBase( IBase *pSvcClient,
                         IAFUProxy *pAFUProxy):
                         CALIBase(pSvcClient,pServiceBase,transID),
                         m_pAFUProxy(pAFUProxy),
-                        m_mapWkSpc(),
                         m_MMIORmap(NULL),
-                        m_MMIORsize(0)
+                        m_MMIORsize(0),
+                        m_WkSpcIndex()
 
 {
 
@@ -95,6 +95,14 @@ btCSROffset CHWALIBase::mmioGetLength( void )
    return m_MMIORsize;
 }
 
+//
+// mmioIsDirect. The MMIO region is mmapped, so it may be accessed through its address.
+//
+btBool CHWALIBase::mmioIsDirect( void )
+{
+   return NULL != m_MMIORmap;
+}
+
 //
 // mmioRead32. Read 32bit CSR. Offset given in bytes.
 //
@@ -161,6 +169,62 @@ btBool CHWALIBase::mmioWrite64(const btCSROffset Offset, const btUnsigned64bitIn
    return true;
 }
 
+//
+// mmioWriteFence. Wait for the MMIO writes issued so far to be globally visible.
+//
+static inline void mmioWriteFence()
+{
+#if defined( __AAL_WINDOWS__ )
+   MemoryBarrier();
+#else
+   __asm__ __volatile__ ("sfence" ::: "memory");
+#endif // OS
+}
+
+//
+// mmioWriteBatch. Write a sequence of 32/64bit CSRs back to back, then fence once.
+//
+btBool CHWALIBase::mmioWriteBatch(const ali_mmio_op * const pOps, const btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pOps, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( ali_mmio_width32 == pOps[i].Width ) {
+         *( reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + pOps[i].Offset) ) = (btUnsigned32bitInt)pOps[i].Value;
+      } else {
+         *( reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + pOps[i].Offset) ) = pOps[i].Value;
+      }
+   }
+
+   mmioWriteFence();
+
+   return true;
+}
+
+//
+// mmioReadBatch. Read a sequence of 32/64bit CSRs.
+//
+btBool CHWALIBase::mmioReadBatch(ali_mmio_op * const pOps, const btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pOps, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( ali_mmio_width32 == pOps[i].Width ) {
+         pOps[i].Value = *( reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + pOps[i].Offset) );
+      } else {
+         pOps[i].Value = *( reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + pOps[i].Offset) );
+      }
+   }
+
+   return true;
+}
+
 
 //
 // mmioGetFeature. Get pointer to feature's DFH, if found.
@@ -327,17 +391,17 @@ btBool CHWALIBase:: mapMMIO()
          }
 
          // Remember workspace parameters associated with virtual ptr (if we ever need it)
-         if (m_mapWkSpc.find(wsevt.wsParms.ptr) != m_mapWkSpc.end()) {
-            AAL_ERR( LM_ALI, "FATAL: WSID already exists in m_mapWSID"<< std::endl);
+         if ( !m_WkSpcIndex.Add(wsevt.wsParms.ptr,
+                                wsevt.wsParms.size,
+                                wsevt.wsParms.physptr,
+                                wsevt.wsParms.wsid) ) {
+            AAL_ERR( LM_ALI, "FATAL: WSID already exists in m_WkSpcIndex"<< std::endl);
             m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
                                                                        m_tidSaved,
                                                                        errCreationFailure,
                                                                        reasUnknown,
                                                                        "Error: Duplicate WSID."));
             return false;
-         } else {
-            // store entire aalui_WSParms struct in map
-            m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
          }
 
          m_MMIORmap = wsevt.wsParms.ptr;
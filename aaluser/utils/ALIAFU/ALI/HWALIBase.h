@@ -46,6 +46,7 @@
 
 #include "ALIBase.h"
 #include "aalsdk/kernel/ccip_defs.h"
+#include "aalsdk/utils/AALWorkSpaceUtilities.h"
 
 class IAFUProxy;
 
@@ -74,11 +75,14 @@ public :
    // <IALIMMIO>
    virtual btVirtAddr   mmioGetAddress( void );
    virtual btCSROffset  mmioGetLength( void );
+   virtual btBool       mmioIsDirect( void );
 
    virtual btBool  mmioRead32( const btCSROffset Offset,       btUnsigned32bitInt * const pValue);
    virtual btBool  mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value);
    virtual btBool  mmioRead64( const btCSROffset Offset,       btUnsigned64bitInt * const pValue);
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value);
+   virtual btBool  mmioWriteBatch( const ali_mmio_op * const pOps, const btUnsignedInt Count);
+   virtual btBool  mmioReadBatch( ali_mmio_op * const pOps, const btUnsignedInt Count);
    virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
                                           NamedValueSet const &rInputArgs,
                                           NamedValueSet       &rOutputArgs );
@@ -105,9 +109,8 @@ protected:
    btVirtAddr              m_MMIORmap;
    btUnsigned32bitInt      m_MMIORsize;
 
-   // Map to store workspace parameters
-   typedef std::map<btVirtAddr, struct aalui_WSMParms> mapWkSpc_t;
-   mapWkSpc_t m_mapWkSpc;
+   // Index of workspace parameters, keyed by virtual address range
+   WorkSpaceIndex          m_WkSpcIndex;
 
    // List to cache device feature metadata
    typedef struct {
@@ -102,6 +102,10 @@ public:
       m_pSvcClient->deactivateSucceeded(m_TranID);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -121,6 +125,10 @@ public:
       m_pSvcClient->deactivateFailed(*m_pEvent);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
@@ -140,6 +148,10 @@ public:
       m_pSvcClient->activateSucceeded(m_TranID);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -159,6 +171,10 @@ public:
       m_pSvcClient->activateFailed(*m_pEvent);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
@@ -178,6 +194,10 @@ public:
       m_pSvcClient->configureSucceeded(m_TranID);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -198,6 +218,10 @@ public:
       m_pSvcClient->configureFailed(*m_pEvent);
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
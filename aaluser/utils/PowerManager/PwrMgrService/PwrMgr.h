@@ -165,6 +165,11 @@ public:
 
    }
 
+   virtual btObjectType DeliveryTarget() const
+   {
+      return dynamic_cast<void *>(m_pSvcClient);
+   }
+
 protected:
    IPwrMgr_Client                *m_pSvcClient;
    const IEvent                  *m_pEvent;
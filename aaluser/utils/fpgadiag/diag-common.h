@@ -48,6 +48,7 @@
 #include <aalsdk/AAL.h>
 #include <aalsdk/Runtime.h>
 #include <aalsdk/utils/NLBVAFU.h>
+#include <aalsdk/utils/CompletionWaiter.h>
 #include <string>
 #include "diag-nlb-common.h"
 
@@ -244,7 +245,7 @@ public:
 	  UPI_WRITE
    };
 
-   virtual ~INLB() {}
+   virtual ~INLB() { INFO("test_complete waits: " << m_DSMWaiter); }
    virtual btInt RunTest(const NLBCmdLine &cmd) = 0;
 
    std::string ReadBandwidth()  const { return m_RdBw; }
@@ -276,6 +277,10 @@ protected:
    btInt ResetHandshake();
    btInt CacheCooldown(btVirtAddr CoolVirt, btPhysAddr CoolPhys, btWSSize CoolSize, const NLBCmdLine &cmd);
 
+   // Wait up to MaxPoll millis for the AFU to set test_complete in the DSM.
+   //    On timeout, MaxPoll is set to -1.
+   void WaitForTestComplete(volatile nlb_vafu_dsm *pAFUDSM, btInt &MaxPoll);
+
    void      			ReadPerfMonitors();
    void       			SavePerfMonitors();
    btUnsigned64bitInt   GetPerfMonitor(btUnsignedInt ) const;
@@ -297,6 +302,7 @@ protected:
    btUnsigned64bitInt  m_SavedPerfMonitors[NUM_PERF_MONITORS];
    std::string 		   m_RdBw;
    std::string 		   m_WrBw;
+   CompletionWaiter    m_DSMWaiter;         ///< Waits for test_complete; records the wait times
 };
 
 class CNLBLpbk1 : public INLB
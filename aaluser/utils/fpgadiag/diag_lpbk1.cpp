@@ -94,20 +94,19 @@ btInt CNLBLpbk1::RunTest(const NLBCmdLine &cmd)
 	   m_pVTPService->vtpReset();
    }
 
-   //Set DSM base, high then low
-   m_pALIMMIOService->mmioWrite64(CSR_AFU_DSM_BASEL, m_pMyApp->DSMPhys());
-
-   // Assert Device Reset
-   m_pALIMMIOService->mmioWrite32(CSR_CTL, 0);
-
-   // De-assert Device Reset
-   m_pALIMMIOService->mmioWrite32(CSR_CTL, 1);
-
-   // Set input workspace address
-   m_pALIMMIOService->mmioWrite64(CSR_SRC_ADDR, CACHELINE_ALIGNED_ADDR(m_pMyApp->InputPhys()));
-
-   // Set output workspace address
-   m_pALIMMIOService->mmioWrite64(CSR_DST_ADDR, CACHELINE_ALIGNED_ADDR(m_pMyApp->OutputPhys()));
+   const ali_mmio_op setup[] = {
+      //Set DSM base, high then low
+      { CSR_AFU_DSM_BASEL, ali_mmio_width64, m_pMyApp->DSMPhys()                          },
+      // Assert Device Reset
+      { CSR_CTL,           ali_mmio_width32, 0                                            },
+      // De-assert Device Reset
+      { CSR_CTL,           ali_mmio_width32, 1                                            },
+      // Set input workspace address
+      { CSR_SRC_ADDR,      ali_mmio_width64, CACHELINE_ALIGNED_ADDR(m_pMyApp->InputPhys())  },
+      // Set output workspace address
+      { CSR_DST_ADDR,      ali_mmio_width64, CACHELINE_ALIGNED_ADDR(m_pMyApp->OutputPhys()) }
+   };
+   m_pALIMMIOService->mmioWriteBatch(setup, sizeof(setup) / sizeof(setup[0]));
 
    // Set the test mode
    csr_type cfg = (csr_type)NLB_TEST_MODE_LPBK1;
@@ -221,14 +220,15 @@ btInt CNLBLpbk1::RunTest(const NLBCmdLine &cmd)
 		// Clear the DSM status fields
 		::memset((void *)pAFUDSM, 0, sizeof(nlb_vafu_dsm));
 
-		// De-assert Device Reset
-		m_pALIMMIOService->mmioWrite32(CSR_CTL, 1);
-
-	    // Set the number of cache lines for the test
-		m_pALIMMIOService->mmioWrite32(CSR_NUM_LINES, (csr_type)(sz / CL(1)));
-
-	    // Start the test
-		m_pALIMMIOService->mmioWrite32(CSR_CTL, 3);
+		const ali_mmio_op start[] = {
+		   // De-assert Device Reset
+		   { CSR_CTL,       ali_mmio_width32, 1                        },
+		   // Set the number of cache lines for the test
+		   { CSR_NUM_LINES, ali_mmio_width32, (csr_type)(sz / CL(1))   },
+		   // Start the test
+		   { CSR_CTL,       ali_mmio_width32, 3                        }
+		};
+		m_pALIMMIOService->mmioWriteBatch(start, sizeof(start) / sizeof(start[0]));
 
 	    // In cont mode, send a stop signal after timeout. Wait till DSM complete register goes high
 	    if(flag_is_set(cmd.cmdflags, NLB_CMD_FLAG_CONT))
@@ -242,22 +242,14 @@ btInt CNLBLpbk1::RunTest(const NLBCmdLine &cmd)
 		   m_pALIMMIOService->mmioWrite32(CSR_CTL, 7);
 
 		   //wait for DSM register update or timeout
-		   while ( 0 == pAFUDSM->test_complete &&
-				 ( MaxPoll >= 0 )) {
-			   	 MaxPoll -= 1;
-			   	 SleepMilli(1);
-		   }
+		   WaitForTestComplete(pAFUDSM, MaxPoll);
 
 		   //Update timer.
 		   absolute = Timer() + Timer(&ts);
 	    }
 	    else{	//In non-cont mode, wait till test completes and then stop the device.
 	    		// Wait for test completion or timeout
-		   while ( 0 == pAFUDSM->test_complete &&
-				 ( MaxPoll >= 0 )) {
-			   	 MaxPoll -= 1;
-			   	 SleepMilli(1);
-		   }
+		   WaitForTestComplete(pAFUDSM, MaxPoll);
 
 		   // Stop the device
 		   m_pALIMMIOService->mmioWrite32(CSR_CTL, 7);
@@ -49,6 +49,7 @@
 #include "diag-common.h"
 #include "nlb-specific.h"
 #include "diag-nlb-common.h"
+#include <aalsdk/utils/ALIMMIORegion.h>
 
 btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
 {
@@ -210,6 +211,15 @@ btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
    Timer     timeout = Timer() + Timer(&ts);
 #endif // OS
 
+   // The per-iteration CSR accesses are on the measured path, so make them directly
+   // where the MMIO region is mapped.
+   const MMIORegion csr(m_pALIMMIOService, CSR_SW_NOTICE + sizeof(csr_type));
+   if ( !csr.IsOK() ) {
+      ERR("MMIO region does not cover the NLB CSRs. Exiting test.");
+      ++res;
+      return res;
+   }
+
    ReadPerfMonitors();
    SavePerfMonitors();
 
@@ -229,19 +239,19 @@ btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
       }
 
 	   // Assert Device Reset
-	   m_pALIMMIOService->mmioWrite32(CSR_CTL, 0);
+	   csr.write<csr_type, CSR_CTL>(0);
 
 	   // Clear the DSM status fields
 	   ::memset((void *)pAFUDSM, 0, sizeof(nlb_vafu_dsm));
 
 	   // De-assert Device Reset
-	   m_pALIMMIOService->mmioWrite32(CSR_CTL, 1);
+	   csr.write<csr_type, CSR_CTL>(1);
 
 	   // Set the number of cache lines for the test
-	   m_pALIMMIOService->mmioWrite32(CSR_NUM_LINES, (csr_type)(sz / CL(1)));
+	   csr.write<csr_type, CSR_NUM_LINES>((csr_type)(sz / CL(1)));
 
 	   // Start the test
-	   m_pALIMMIOService->mmioWrite32(CSR_CTL, 3);
+	   csr.write<csr_type, CSR_CTL>(3);
 
 	   timeout = Timer() + Timer(&ts);
 
@@ -264,7 +274,7 @@ btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
 
 	  //3. CPU -> FPGA message. Select notice type
 	  if ( flag_is_set(cmd.cmdflags, NLB_CMD_FLAG_CSR_WRITE)){
-		 m_pALIMMIOService->mmioWrite32(CSR_SW_NOTICE, 0x10101010);
+		 csr.write<csr_type, CSR_SW_NOTICE>(0x10101010);
 	  }
 	  else if( flag_is_set(cmd.cmdflags, NLB_CMD_FLAG_UMSG_DATA) || flag_is_set(cmd.cmdflags, NLB_CMD_FLAG_UMSG_HINT)){
 		 *(btUnsigned32bitInt *)pUMsgUsrVirt = HIGH;
@@ -288,13 +298,9 @@ btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
 	  }
 
 	  // Stop the device
-	  m_pALIMMIOService->mmioWrite32(CSR_CTL, 7);
+	  csr.write<csr_type, CSR_CTL>(7);
 
-	  while ( ( 0 == pAFUDSM->test_complete ) &&
-			  ( MaxPoll >= 0 ) ){
-		  	MaxPoll -= 1;
-		  	SleepMilli(1);
-	  }
+	  WaitForTestComplete(pAFUDSM, MaxPoll);
 
 	  ReadPerfMonitors();
 
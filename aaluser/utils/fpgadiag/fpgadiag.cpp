@@ -982,11 +982,7 @@ btInt INLB::CacheCooldown(btVirtAddr CoolVirt, btPhysAddr CoolPhys, btWSSize Coo
    m_pALIMMIOService->mmioWrite32(CSR_CTL, 3);
 
    // Wait for test completion
-   while ( 0 == pAFUDSM->test_complete &&
-         ( MaxPoll >= 0 )) {
-            MaxPoll -= 1;
-            SleepMilli(1);
-     }
+   WaitForTestComplete(pAFUDSM, MaxPoll);
 
    // Stop the device
    m_pALIMMIOService->mmioWrite32(CSR_CTL, 7);
@@ -1005,6 +1001,14 @@ btInt INLB::CacheCooldown(btVirtAddr CoolVirt, btPhysAddr CoolPhys, btWSSize Coo
    return res;
 }
 
+void INLB::WaitForTestComplete(volatile nlb_vafu_dsm *pAFUDSM, btInt &MaxPoll)
+{
+   if ( ( MaxPoll < 0 ) ||
+        !m_DSMWaiter.Wait(&pAFUDSM->test_complete, (btTime)MaxPoll) ) {
+      MaxPoll = -1;
+   }
+}
+
 void INLB::ReadPerfMonitors()
 {
 	NamedValueSet PerfMon;
@@ -118,7 +118,8 @@ enum wstype
    WSM_TYPE_VIRTUAL,
    WSM_TYPE_PHYSICAL,
    WSM_TYPE_CSR,
-   WSM_TYPE_MMIO
+   WSM_TYPE_MMIO,
+   WSM_TYPE_PINNED      // Pinned user memory; m_id is the struct kosal_pinned_mem *
 };
 struct aal_wsid
 {
@@ -129,6 +130,7 @@ struct aal_wsid
    kosal_map_handle   m_maphandle;  // Used by OS User mode mapping
    enum wstype        m_type;       // Type of allocation
    btWSSize           m_size;       // Size of workspace
+   btWSSize           m_pgsize;     // Page size of the block backing it, 0 if not known
    kosal_list_head    m_list;       // Device owner list it is on
    /* chain of allocated workspace IDs; head is in ui_driver */
    kosal_list_head    m_alloc_list;
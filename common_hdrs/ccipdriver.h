@@ -197,7 +197,8 @@ typedef enum
    ccipdrv_SetPortErrorMask,
    ccipdrv_ClearPortError,
    ccipdrv_ClearAllPortErrors,
-   ccipdrv_PwrMgrResponse
+   ccipdrv_PwrMgrResponse,
+   ccipdrv_afucmdWKSP_PIN      // Pin existing user memory as a workspace. Freed with ccipdrv_afucmdWKSP_FREE.
 
 } ccipdrv_afuCmdID_e;
 
@@ -217,6 +218,7 @@ struct aalui_CCIdrvMessage
 # define AALUID_IOCTL_BINDDEV       _IOWR('x', 0x03, struct ccipui_ioctlreq)
 # define AALUID_IOCTL_ACTIVATEDEV   _IOWR('x', 0x04, struct ccipui_ioctlreq)
 # define AALUID_IOCTL_DEACTIVATEDEV _IOWR('x', 0x05, struct ccipui_ioctlreq)
+# define AALUID_IOCTL_GETMSG_BATCH  _IOWR('x', 0x08, struct ccipui_ioctlreq)
 #elif defined( __AAL_WINDOWS__ )
 # ifdef __AAL_USER__
 #    include <winioctl.h>
@@ -251,6 +253,7 @@ struct aalui_CCIdrvMessage
 # define AALUID_IOCTL_DEACTIVATEDEV   UAIA_IOCTL(0x05)
 # define AALUID_IOCTL_POLL            UAIA_IOCTL(0x06)
 # define AALUID_IOCTL_MMAP            UAIA_IOCTL(0x07)
+# define AALUID_IOCTL_GETMSG_BATCH    UAIA_IOCTL(0x08)
 
 #endif // OS
 
@@ -275,6 +278,17 @@ struct ccipui_ioctlreq
 #define aalui_ioctlPayload(i)    ((void *)(i->payload))
 #define aalui_ioctlPayloadSize(i)   ((i)->size)
 
+// AALUID_IOCTL_GETMSG_BATCH dequeues, in order, as many upstream messages as fit in
+//   the payload of the request. The payload of the response is a sequence of complete
+//   ccipui_ioctlreq records (header and payload), each starting on an 8-byte boundary,
+//   and size is the number of payload bytes used.
+//   If the queue is empty, size is 0 and errcode is uid_errnumOK.
+//   If the message at the head of the queue does not fit, nothing is dequeued, size is
+//   0 and errcode is uid_errnumNoMem. Retrieve that message with
+//   AALUID_IOCTL_GETMSG_DESC and AALUID_IOCTL_GETMSG.
+#define aalui_ioctlBatchRecLen(__payloadsize) \
+   ( ( sizeof(struct ccipui_ioctlreq) + (__payloadsize) + 7 ) & ~((btWSSize)7) )
+
 
 struct ahm_req
 {
@@ -283,7 +297,7 @@ struct ahm_req
       struct {
          btWSID   m_wsid;     // IN
          btWSSize m_size;     // IN
-         btWSSize m_pgsize;
+         btWSSize m_pgsize;   // IN  ccipdrv_afucmdWKSP_ALLOC: preferred page size, 0 for default
       } wksp;
 
       // Special workspace IDs for CSR Aperture mapping
@@ -298,6 +312,12 @@ struct ahm_req
          btUnsigned64bitInt m_cookie; /* OUT */
       } wksp_cookie;
 
+      // ccipdrv_afucmdWKSP_PIN
+      struct {
+         btVirtAddr         m_ptr;    /* IN  */
+         btWSSize           m_size;   /* IN  */
+      } wksp_pin;
+
       struct {
          btVirtAddr         vaddr; /* IN   */
          btWSSize           size;   /* IN   */
@@ -479,8 +499,19 @@ struct aalui_WSMParms
    btWSSize   itemsize;    // Workspace item size
    btWSSize   itemspacing; // Workspace item spacing
    TTASK_MODE type;        // Task mode this workspace is compatible with
+   btWSSize   pgsize;      // Page size of the process mapping of the workspace
 };
 
+// Page sizes that may be requested in ahm_req.u.wksp.m_pgsize for ccipdrv_afucmdWKSP_ALLOC.
+//   The workspace is rounded up to a multiple of the page size, and is physically
+//   contiguous and aligned to it, so that the IOMMU can map it with large pages.
+//   Where the kernel supports huge PFN mappings, the process mapping uses them as
+//   well; aalui_WSMParms.pgsize reports the page size it is mapped with.
+//   If no memory of the requested page size is available, the driver falls back to the
+//   next smaller one, and finally to the default allocation.
+#define CCIP_WKSP_PGSIZE_2M   ( ((btWSSize)1) << 21 )
+#define CCIP_WKSP_PGSIZE_1G   ( ((btWSSize)1) << 30 )
+
 
 //=============================================================================
 // Name: aalui_WSMEvent
@@ -915,6 +915,22 @@ void _kosal_free_dma_coherent(__ASSERT_HERE_PROTO  KOSAL_HANDLE , KOSAL_VIRT , K
 #    undef _kosal_free_dma_coherent
 # endif // _kosal_free_dma_coherent
 # define kosal_free_dma_coherent(__devhandle, __ptr , __size, __dmahandle) _kosal_free_dma_coherent(__ASSERT_HERE_ARGS __devhandle, __ptr, __size, __dmahandle)
+
+// Existing user memory, pinned resident and (for a non-NULL devhandle) mapped for DMA
+//  until it is unpinned. Opaque to callers.
+struct kosal_pinned_mem;
+
+struct kosal_pinned_mem * _kosal_pin_user_mem(__ASSERT_HERE_PROTO KOSAL_HANDLE , KOSAL_VIRT , KOSAL_WSSIZE , KOSAL_PHYS *);
+# ifdef kosal_pin_user_mem
+#    undef kosal_pin_user_mem
+# endif // kosal_pin_user_mem
+# define kosal_pin_user_mem(__devhandle, __uvirt, __size, __piova) _kosal_pin_user_mem(__ASSERT_HERE_ARGS __devhandle, __uvirt, __size, __piova)
+
+void _kosal_unpin_user_mem(__ASSERT_HERE_PROTO struct kosal_pinned_mem * );
+# ifdef kosal_unpin_user_mem
+#    undef kosal_unpin_user_mem
+# endif // kosal_unpin_user_mem
+# define kosal_unpin_user_mem(__ppinned) _kosal_unpin_user_mem(__ASSERT_HERE_ARGS __ppinned)
 //
 // Work queue
 //
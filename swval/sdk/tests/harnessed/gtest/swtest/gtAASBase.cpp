@@ -3,6 +3,7 @@
 # include <config.h>
 #endif // HAVE_CONFIG_H
 #include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
 
 //=============================================================================
 // Name: CAASBase_f_0
@@ -519,3 +520,236 @@ TEST(CAALBaseTest, CAALBaseTest)
    EXPECT_TRUE(d1.IsOK());
 }
 
+
+// Exposes the protected interface mutators of CAASBase.
+class InterfaceTableBase : public CAASBase
+{
+public:
+   InterfaceTableBase() {}
+
+   EOBJECT CallSetInterface(btIID id, btGenericInterface ifc)
+   { return SetInterface(id, ifc); }
+
+   EOBJECT CallReplaceInterface(btIID id, btGenericInterface ifc)
+   { return ReplaceInterface(id, ifc); }
+};
+
+// The lookup that CAASBase::Interface() used to do: take the lock, then search the map.
+class LockedInterfaceMap : public CriticalSection
+{
+public:
+   LockedInterfaceMap() {}
+
+   void Set(btIID id, btGenericInterface ifc) { AutoLock(this); m_Map[id] = ifc; }
+
+   btGenericInterface Interface(btIID id) const
+   {
+      AutoLock(this);
+      IIDINTERFACE_CITR itr = m_Map.find(id);
+      if ( m_Map.end() == itr ) {
+         return NULL;
+      }
+      return (*itr).second;
+   }
+
+protected:
+   iidInterfaceMap_t m_Map;
+};
+
+class CAASBase_f_2 : public ::testing::Test
+{
+public:
+   enum { Interfaces = 8, Readers = 4 };
+
+   CAASBase_f_2() :
+      m_ReadLocked(false),
+      m_Stop(false),
+      m_Running(0),
+      m_Errors(0),
+      m_Lookups(0)
+   {}
+
+   virtual void SetUp()
+   {
+      btUnsignedInt i;
+      for ( i = 0 ; i < Interfaces ; ++i ) {
+         ASSERT_EQ(EObjOK, m_Base.CallSetInterface(IID(i), Ifc(i, 0)));
+         m_Locked.Set(IID(i), Ifc(i, 0));
+      }
+   }
+
+   static btIID              IID(btUnsignedInt i)                 { return 0x1000 + 17 * i; }
+   static btGenericInterface Ifc(btUnsignedInt i, btUnsignedInt v) { return (btGenericInterface)(btUIntPtr)(((i + 1) << 16) + v); }
+
+   // Looks up every interface, in m_Locked if m_ReadLocked and in m_Base otherwise,
+   //  until told to stop, counting the answers that are not one of the values the
+   //  interface has ever been given.
+   static void Reader(OSLThread * , void * );
+
+   void StartReaders(btBool ReadLocked)
+   {
+      m_ReadLocked = ReadLocked;
+      m_Stop       = false;
+      m_Running    = 0;
+
+      btUnsignedInt r;
+      for ( r = 0 ; r < Readers ; ++r ) {
+         m_pThrs[r] = new OSLThread(CAASBase_f_2::Reader, OSLThread::THREADPRIORITY_NORMAL, this);
+         EXPECT_TRUE(m_pThrs[r]->IsOK());
+      }
+
+      YIELD_WHILE(m_Running < Readers);
+   }
+
+   void StopReaders()
+   {
+      m_Stop = true;
+
+      btUnsignedInt r;
+      for ( r = 0 ; r < Readers ; ++r ) {
+         m_pThrs[r]->Join();
+         delete m_pThrs[r];
+      }
+   }
+
+   // Times Lookups calls to Interface() on o, across the interfaces, in ns/lookup.
+   template <typename O>
+   static double Time(O const &o, btUnsignedInt Lookups)
+   {
+      btUIntPtr     sum = 0;
+      btUnsignedInt i;
+
+      Timer start;
+      for ( i = 0 ; i < Lookups ; ++i ) {
+         sum += (btUIntPtr)o.Interface(IID(i % Interfaces));
+      }
+      Timer end;
+
+      EXPECT_NE((btUIntPtr)0, sum);
+
+      double ns = 0.0;
+      (end - start).AsNanoSeconds(ns);
+      return ns / Lookups;
+   }
+
+   InterfaceTableBase      m_Base;
+   LockedInterfaceMap      m_Locked;
+   OSLThread              *m_pThrs[Readers];
+   btBool                  m_ReadLocked;
+   volatile btBool         m_Stop;
+   volatile btUnsignedInt  m_Running;
+   volatile btUnsignedInt  m_Errors;
+   volatile btUnsignedInt  m_Lookups;
+   CriticalSection         m_Lock;
+};
+
+void CAASBase_f_2::Reader(OSLThread * , void *pArg)
+{
+   CAASBase_f_2 *f = reinterpret_cast<CAASBase_f_2 *>(pArg);
+
+   btUnsignedInt errors  = 0;
+   btUnsignedInt lookups = 0;
+
+   {
+      AutoLock(&f->m_Lock);
+      ++f->m_Running;
+   }
+
+   while ( !f->m_Stop ) {
+      btUnsignedInt i;
+      for ( i = 0 ; i < Interfaces ; ++i ) {
+         btUIntPtr v = f->m_ReadLocked ? (btUIntPtr)f->m_Locked.Interface(IID(i)) :
+                                         (btUIntPtr)f->m_Base.Interface(IID(i));
+         if ( (v >> 16) != (i + 1) ) {
+            ++errors;
+         }
+         ++lookups;
+      }
+   }
+
+   AutoLock(&f->m_Lock);
+   f->m_Errors  += errors;
+   f->m_Lookups += lookups;
+}
+
+TEST_F(CAASBase_f_2, aal0857)
+{
+   // The first lookup freezes the interface table. Interfaces set, replaced, and
+   // removed afterward are seen by subsequent lookups, and lookups of unknown
+   // interfaces still fail.
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Interfaces ; ++i ) {
+      EXPECT_EQ(Ifc(i, 0), m_Base.Interface(IID(i)));
+      EXPECT_TRUE(m_Base.Has(IID(i)));
+      EXPECT_FALSE(m_Base.Has(IID(i) + 1));
+      EXPECT_EQ(NULL, m_Base.Interface(IID(i) - 1));
+   }
+   EXPECT_EQ(dynamic_cast<CAASBase *>(&m_Base), m_Base.Interface(iidCBase));
+   EXPECT_EQ(dynamic_cast<IBase *>(&m_Base),    m_Base.Interface(iidBase));
+
+   EXPECT_EQ(EObjOK, m_Base.CallReplaceInterface(IID(3), Ifc(3, 1)));
+   EXPECT_EQ(Ifc(3, 1), m_Base.Interface(IID(3)));
+
+   EXPECT_EQ(EObjOK, m_Base.CallReplaceInterface(IID(5), NULL));
+   EXPECT_FALSE(m_Base.Has(IID(5)));
+   EXPECT_EQ(EObjNameNotFound, m_Base.CallReplaceInterface(IID(5), Ifc(5, 1)));
+
+   EXPECT_EQ(EObjOK, m_Base.CallSetInterface(IID(5), Ifc(5, 2)));
+   EXPECT_EQ(Ifc(5, 2), m_Base.Interface(IID(5)));
+   EXPECT_EQ(EObjDuplicateName, m_Base.CallSetInterface(IID(5), Ifc(5, 3)));
+   EXPECT_EQ(Ifc(5, 2), m_Base.Interface(IID(5)));
+
+   for ( i = 0 ; i < Interfaces ; ++i ) {
+      if ( (3 != i) && (5 != i) ) {
+         EXPECT_EQ(Ifc(i, 0), m_Base.Interface(IID(i)));
+      }
+   }
+}
+
+TEST_F(CAASBase_f_2, aal0858)
+{
+   // Lock-free lookups racing ReplaceInterface() always find the interface, with
+   // either its old or its new value.
+
+   btUnsignedInt i;
+
+   EXPECT_EQ(Ifc(0, 0), m_Base.Interface(IID(0)));
+
+   StartReaders(false);
+
+   for ( i = 1 ; i <= 10000 ; ++i ) {
+      EXPECT_EQ(EObjOK, m_Base.CallReplaceInterface(IID(i % Interfaces), Ifc(i % Interfaces, i)));
+   }
+
+   StopReaders();
+
+   EXPECT_EQ(0, m_Errors);
+   EXPECT_LT(0, m_Lookups);
+}
+
+TEST_F(CAASBase_f_2, aal0859)
+{
+   // Microbenchmark: CAASBase::Interface() on the frozen table, against the locked
+   // map lookup it replaces, single-threaded and with Readers threads looking up
+   // interfaces on the same object.
+
+   const btUnsignedInt Lookups = 10000000;
+
+   double frozen = Time(m_Base,   Lookups);
+   double locked = Time(m_Locked, Lookups);
+
+   MSG("uncontended: frozen table " << frozen << " ns/lookup, locked map " << locked << " ns/lookup");
+
+   StartReaders(false);
+   frozen = Time(m_Base, Lookups / 10);
+   StopReaders();
+
+   StartReaders(true);
+   locked = Time(m_Locked, Lookups / 10);
+   StopReaders();
+
+   EXPECT_EQ(0, m_Errors);
+
+   MSG(Readers << " concurrent readers: frozen table " << frozen << " ns/lookup, locked map " << locked << " ns/lookup");
+}
@@ -5,6 +5,7 @@
 #include "gtCommon.h"
 
 #include "dbg_barrier.h"
+#include "aalsdk/osal/Timer.h"
 
 TEST(OSAL_Barrier, aal0172)
 {
@@ -2468,3 +2469,35 @@ INSTANTIATE_TEST_CASE_P(My, OSAL_Barrier_vp_tuple_1,
 
 #endif // GTEST_HAS_TR1_TUPLE
 
+
+TEST(OSAL_Barrier, aal0867)
+{
+   // Microbenchmark: Post(), Wait() and Reset() on an uncontended Barrier, the pattern
+   // used by the thread start / join / drain paths.
+
+   const btUnsignedInt Cycles = 200000;
+   Barrier       b;
+   btUnsignedInt i;
+
+   ASSERT_TRUE(b.Create(1));
+
+   Timer start;
+   for ( i = 0 ; i < Cycles ; ++i ) {
+      b.Post(1);
+      b.Wait();
+      b.Reset();
+   }
+   Timer end;
+
+   btUnsignedInt cur = 1;
+   btUnsignedInt unlock = 0;
+   EXPECT_TRUE(b.CurrCounts(cur, unlock));
+   EXPECT_EQ(0, cur);
+   EXPECT_EQ(1, unlock);
+   EXPECT_TRUE(b.Destroy());
+
+   double ns = 0.0;
+   (end - start).AsNanoSeconds(ns);
+   MSG(ns / Cycles << " ns per Post()/Wait()/Reset() cycle");
+}
+
@@ -0,0 +1,560 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/utils/AALBufferPool.h"
+#include "aalsdk/osal/Timer.h"
+
+// IALIBuffer over the heap. Workspaces are page aligned, like those of the real thing,
+// and are given IOVAs that do not track their virtual addresses.
+class HeapALIBuffer : public IALIBuffer,
+                      public CriticalSection
+{
+public:
+   HeapALIBuffer() :
+      m_Allocs(0),
+      m_Frees(0),
+      m_NextIOVA(0x80000000ULL)
+   {}
+   virtual ~HeapALIBuffer()
+   {
+      std::map<btVirtAddr, Wksp>::iterator itr;
+      for ( itr = m_Wksps.begin() ; itr != m_Wksps.end() ; ++itr ) {
+         delete[] (*itr).second.m_raw;
+      }
+   }
+
+   virtual ali_errnum_e bufferAllocate(btWSSize Length, btVirtAddr *pBufferptr)
+   {
+      AutoLock(this);
+      *pBufferptr = NULL;
+
+      Wksp w;
+      w.m_raw  = new(std::nothrow) btByte[Length + 4096];
+      if ( NULL == w.m_raw ) {
+         return ali_errnumNoMem;
+      }
+      w.m_len  = Length;
+      w.m_iova = m_NextIOVA;
+      m_NextIOVA += ( Length + 8191 ) & ~4095ULL;
+
+      btVirtAddr p = reinterpret_cast<btVirtAddr>( ( reinterpret_cast<btUnsigned64bitInt>(w.m_raw) + 4095 ) & ~4095ULL );
+      m_Wksps[p] = w;
+      ++m_Allocs;
+
+      *pBufferptr = p;
+      return ali_errnumOK;
+   }
+   virtual ali_errnum_e bufferAllocate(btWSSize Length, btVirtAddr *pBufferptr, NamedValueSet const & )
+   {
+      return bufferAllocate(Length, pBufferptr);
+   }
+   virtual ali_errnum_e bufferAllocate(btWSSize Length, btVirtAddr *pBufferptr, NamedValueSet const & , NamedValueSet & )
+   {
+      return bufferAllocate(Length, pBufferptr);
+   }
+   virtual ali_errnum_e bufferFree(btVirtAddr Address)
+   {
+      AutoLock(this);
+      std::map<btVirtAddr, Wksp>::iterator itr = m_Wksps.find(Address);
+      if ( itr == m_Wksps.end() ) {
+         return ali_errnumBadParameter;
+      }
+      delete[] (*itr).second.m_raw;
+      m_Wksps.erase(itr);
+      ++m_Frees;
+      return ali_errnumOK;
+   }
+   virtual ali_errnum_e bufferPrepare(btVirtAddr , btWSSize )                        { return ali_errnumNoMap;        }
+   virtual ali_errnum_e bufferPrepare(btVirtAddr , btWSSize , NamedValueSet const & ) { return ali_errnumNoMap;        }
+   virtual ali_errnum_e bufferRelease(btVirtAddr )                                    { return ali_errnumBadParameter; }
+   virtual btPhysAddr bufferGetIOVA(btVirtAddr Address)
+   {
+      AutoLock(this);
+      std::map<btVirtAddr, Wksp>::iterator itr = m_Wksps.upper_bound(Address);
+      if ( itr == m_Wksps.begin() ) {
+         return 0;
+      }
+      --itr;
+      if ( Address >= (*itr).first + (*itr).second.m_len ) {
+         return 0;
+      }
+      return (*itr).second.m_iova + ( Address - (*itr).first );
+   }
+
+   btUnsigned32bitInt Allocs() const { AutoLock(this); return m_Allocs; }
+   btUnsigned32bitInt Frees()  const { AutoLock(this); return m_Frees;  }
+   btUnsigned32bitInt Live()   const { AutoLock(this); return (btUnsigned32bitInt)m_Wksps.size(); }
+
+protected:
+   struct Wksp {
+      btByte    *m_raw;
+      btWSSize   m_len;
+      btPhysAddr m_iova;
+   };
+
+   std::map<btVirtAddr, Wksp> m_Wksps;
+   btUnsigned32bitInt         m_Allocs;
+   btUnsigned32bitInt         m_Frees;
+   btPhysAddr                 m_NextIOVA;
+};
+
+class BufferPool_f : public ::testing::Test
+{
+public:
+   BufferPool_f() :
+      m_Pool(&m_Buffer)
+   {}
+
+   virtual void SetUp()
+   {
+      m_Seed = 0xdeadbeef;
+      m_Scratch = 0;
+      m_Blocks.clear();
+   }
+   virtual void TearDown()
+   {
+      m_Pool.Release();
+      EXPECT_EQ(0, m_Buffer.Live());
+   }
+
+   // Sizes that exercise every size class, and both edges of each.
+   btWSSize RandomSize()
+   {
+      btUnsigned32bitInt c = GetRand(&m_Seed) % BufferPool::NumClasses;
+      btWSSize           hi = (btWSSize)BufferPool::MinBlockSize << c;
+      btWSSize           lo = ( 0 == c ) ? 1 : ( hi >> 1 ) + 1;
+      return lo + GetRand(&m_Seed) % ( hi - lo + 1 );
+   }
+
+   static btWSSize ClassSize(btWSSize Length)
+   {
+      btWSSize s = BufferPool::MinBlockSize;
+      while ( s < Length ) {
+         s <<= 1;
+      }
+      return s;
+   }
+
+   static void Churn(OSLThread *pThread, void *pContext);
+   static void AllocFreeExit(OSLThread *pThread, void *pContext);
+
+   HeapALIBuffer               m_Buffer;
+   BufferPool                  m_Pool;
+   btUnsigned32bitInt          m_Seed;
+   CriticalSection             m_Lock;
+   std::vector<btVirtAddr>     m_Blocks;
+   btUnsigned32bitInt          m_Scratch;
+};
+
+TEST_F(BufferPool_f, aal0828)
+{
+   // BufferPool::poolAllocate() returns blocks aligned to their size class, up to a page,
+   // that do not overlap, and whose IOVAs track those of their arenas.
+
+   std::map<btVirtAddr, btWSSize> blocks;
+
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < 200 ; ++i ) {
+      btWSSize   len = RandomSize();
+      btVirtAddr p   = NULL;
+
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(len, &p));
+      ASSERT_NE((btVirtAddr)NULL, p);
+
+      btWSSize align = ClassSize(len) < 4096 ? ClassSize(len) : 4096;
+      EXPECT_EQ(0, reinterpret_cast<btUnsigned64bitInt>(p) & ( align - 1 )) << len;
+
+      EXPECT_NE((btPhysAddr)0,        m_Pool.poolGetIOVA(p));
+      EXPECT_EQ(m_Buffer.bufferGetIOVA(p),           m_Pool.poolGetIOVA(p));
+      EXPECT_EQ(m_Buffer.bufferGetIOVA(p) + len - 1, m_Pool.poolGetIOVA(p + len - 1));
+
+      memset(p, (int)i, len);
+      blocks[p] = len;
+   }
+
+   // No two blocks overlap.
+   std::map<btVirtAddr, btWSSize>::iterator itr = blocks.begin();
+   std::map<btVirtAddr, btWSSize>::iterator prev = itr++;
+   while ( itr != blocks.end() ) {
+      EXPECT_LE(prev->first + prev->second, itr->first);
+      prev = itr++;
+   }
+
+   EXPECT_EQ(m_Buffer.Allocs(), m_Pool.Arenas());
+   EXPECT_LE(m_Pool.Arenas(), 8);
+
+   for ( itr = blocks.begin() ; itr != blocks.end() ; ++itr ) {
+      EXPECT_EQ(ali_errnumOK, m_Pool.poolFree(itr->first));
+   }
+   EXPECT_EQ(0, m_Buffer.Frees());
+}
+
+TEST_F(BufferPool_f, aal0829)
+{
+   // Once warmed up, allocating and freeing pool blocks makes no IALIBuffer calls.
+
+   btVirtAddr p[32];
+   btUnsigned32bitInt i;
+   btUnsigned32bitInt j;
+
+   for ( j = 0 ; j < 32 ; ++j ) {
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(1 + GetRand(&m_Seed) % 256, &p[j]));
+   }
+   for ( j = 0 ; j < 32 ; ++j ) {
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolFree(p[j]));
+   }
+
+   const btUnsigned32bitInt allocs = m_Buffer.Allocs();
+
+   for ( i = 0 ; i < 1000 ; ++i ) {
+      for ( j = 0 ; j < 32 ; ++j ) {
+         ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(1 + GetRand(&m_Seed) % 256, &p[j]));
+      }
+      for ( j = 0 ; j < 32 ; ++j ) {
+         ASSERT_EQ(ali_errnumOK, m_Pool.poolFree(p[j]));
+      }
+   }
+
+   EXPECT_EQ(allocs, m_Buffer.Allocs());
+   EXPECT_EQ(0,      m_Buffer.Frees());
+}
+
+TEST_F(BufferPool_f, aal0830)
+{
+   // BufferPool rejects bad parameters, and passes requests larger than a slab through
+   // to IALIBuffer.
+
+   btVirtAddr p = (btVirtAddr)1;
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolAllocate(0, &p));
+   EXPECT_EQ((btVirtAddr)NULL, p);
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolAllocate(64, NULL));
+
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(100, &p));
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(p + 64));
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(p + 1));
+   EXPECT_EQ(ali_errnumOK,           m_Pool.poolFree(p));
+
+   // Not pool memory.
+   btUnsigned64bitInt stack[8];
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree((btVirtAddr)stack));
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(NULL));
+   EXPECT_EQ(0, m_Pool.poolGetIOVA((btVirtAddr)stack));
+
+   // Not pool memory, even though it belongs to the IALIBuffer.
+   btVirtAddr ws = NULL;
+   ASSERT_EQ(ali_errnumOK, m_Buffer.bufferAllocate(4096, &ws));
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(ws));
+   EXPECT_EQ(0, m_Pool.poolGetIOVA(ws));
+   EXPECT_EQ(ali_errnumOK, m_Buffer.bufferFree(ws));
+
+   // Large blocks.
+   const btUnsigned32bitInt allocs = m_Buffer.Allocs();
+   const btUnsigned32bitInt frees  = m_Buffer.Frees();
+   btVirtAddr big = NULL;
+
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(BufferPool::SlabSize + 1, &big));
+   EXPECT_EQ(allocs + 1, m_Buffer.Allocs());
+   EXPECT_EQ(1, m_Pool.LargeBlocks());
+   EXPECT_EQ(m_Buffer.bufferGetIOVA(big + 100), m_Pool.poolGetIOVA(big + 100));
+
+   EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(big + 100));
+   EXPECT_EQ(ali_errnumOK,           m_Pool.poolFree(big));
+   EXPECT_EQ(frees + 1, m_Buffer.Frees());
+   EXPECT_EQ(0, m_Pool.LargeBlocks());
+   EXPECT_EQ(0, m_Pool.poolGetIOVA(big + 100));
+}
+
+TEST_F(BufferPool_f, aal0831)
+{
+   // BufferPool::Configure() accepts only multiples of SlabSize, and only while the pool
+   // is empty. BufferPool::Release() returns every arena, after which the pool starts over.
+
+   EXPECT_EQ((btWSSize)BufferPool::DefaultArenaSize, m_Pool.ArenaSize());
+   EXPECT_FALSE(m_Pool.Configure((btWSSize)0));
+   EXPECT_FALSE(m_Pool.Configure((btWSSize)BufferPool::SlabSize + 64));
+   EXPECT_TRUE(m_Pool.Configure((btWSSize)BufferPool::SlabSize * 2));
+
+   NamedValueSet nvs;
+   nvs.Add(ALI_BUFFPOOL_ARENA_SIZE_KEY, (ALI_BUFFPOOL_ARENA_SIZE_DATATYPE)BufferPool::SlabSize * 4);
+   EXPECT_TRUE(m_Pool.Configure(nvs));
+   EXPECT_EQ((btWSSize)BufferPool::SlabSize * 4, m_Pool.ArenaSize());
+   EXPECT_TRUE(m_Pool.Configure(NamedValueSet()));
+   EXPECT_EQ((btWSSize)BufferPool::SlabSize * 4, m_Pool.ArenaSize());
+
+   // Each slab-sized block takes its own slab, so this needs three arenas.
+   btVirtAddr p[10];
+   btUnsigned32bitInt j;
+   for ( j = 0 ; j < 10 ; ++j ) {
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(BufferPool::SlabSize, &p[j]));
+   }
+   EXPECT_EQ(3, m_Pool.Arenas());
+   EXPECT_EQ(3, m_Buffer.Live());
+   EXPECT_FALSE(m_Pool.Configure((btWSSize)BufferPool::SlabSize));
+
+   btVirtAddr small = NULL;
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(64, &small));
+   EXPECT_EQ(ali_errnumOK, m_Pool.poolFree(small));
+
+   m_Pool.Release();
+   EXPECT_EQ(0, m_Pool.Arenas());
+   EXPECT_EQ(0, m_Buffer.Live());
+   EXPECT_EQ(0, m_Pool.poolGetIOVA(p[0]));
+
+   // This thread's cached blocks died with the arenas, and are not handed out again.
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(64, &small));
+   EXPECT_EQ(1, m_Pool.Arenas());
+   EXPECT_NE((btPhysAddr)0, m_Pool.poolGetIOVA(small));
+   EXPECT_EQ(ali_errnumOK, m_Pool.poolFree(small));
+}
+
+TEST_F(BufferPool_f, aal0832)
+{
+   // A thread using more than one BufferPool keeps the blocks of each apart, including
+   // when one of the pools is destroyed while the thread has blocks of it cached.
+
+   HeapALIBuffer buf2;
+   btVirtAddr    a = NULL;
+   btVirtAddr    b = NULL;
+
+   {
+      BufferPool pool2(&buf2);
+
+      btUnsigned32bitInt i;
+      for ( i = 0 ; i < 1000 ; ++i ) {
+         ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(128, &a));
+         ASSERT_EQ(ali_errnumOK, pool2.poolAllocate(128, &b));
+         EXPECT_EQ(0, pool2.poolGetIOVA(a));
+         EXPECT_EQ(0, m_Pool.poolGetIOVA(b));
+         EXPECT_EQ(ali_errnumBadParameter, m_Pool.poolFree(b));
+         ASSERT_EQ(ali_errnumOK, m_Pool.poolFree(a));
+         ASSERT_EQ(ali_errnumOK, pool2.poolFree(b));
+      }
+
+      EXPECT_EQ(1, m_Pool.Arenas());
+      EXPECT_EQ(1, pool2.Arenas());
+
+      // Leave this thread's lists with pool2.
+      ASSERT_EQ(ali_errnumOK, pool2.poolAllocate(64, &b));
+      ASSERT_EQ(ali_errnumOK, pool2.poolFree(b));
+   }
+   EXPECT_EQ(0, buf2.Live());
+
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(64, &a));
+   EXPECT_NE((btPhysAddr)0, m_Pool.poolGetIOVA(a));
+   EXPECT_EQ(ali_errnumOK, m_Pool.poolFree(a));
+}
+
+void BufferPool_f::Churn(OSLThread *pThread, void *pContext)
+{
+   BufferPool_f *pTC = static_cast<BufferPool_f *>(pContext);
+   ASSERT(NULL != pTC);
+
+   btUnsigned32bitInt seed = (btUnsigned32bitInt)GetThreadID();
+   btVirtAddr         p[16];
+   btWSSize           len[16];
+   btUnsigned32bitInt i;
+   btUnsigned32bitInt j;
+
+   // Free a share of the blocks that the main thread allocated.
+   for ( ; ; ) {
+      btVirtAddr blk = NULL;
+      {
+         AutoLock(&pTC->m_Lock);
+         if ( pTC->m_Blocks.empty() ) {
+            break;
+         }
+         blk = pTC->m_Blocks.back();
+         pTC->m_Blocks.pop_back();
+      }
+      EXPECT_EQ(ali_errnumOK, pTC->m_Pool.poolFree(blk));
+   }
+
+   for ( i = 0 ; i < 2000 ; ++i ) {
+      for ( j = 0 ; j < 16 ; ++j ) {
+         len[j] = 1 + GetRand(&seed) % 2048;
+         if ( ali_errnumOK != pTC->m_Pool.poolAllocate(len[j], &p[j]) ) {
+            ADD_FAILURE();
+            return;
+         }
+         memset(p[j], (int)j, len[j]);
+      }
+      for ( j = 0 ; j < 16 ; ++j ) {
+         // Had another thread been handed an overlapping block, this would not hold.
+         EXPECT_EQ(j, (btUnsigned32bitInt)p[j][0]);
+         EXPECT_EQ(j, (btUnsigned32bitInt)p[j][len[j] - 1]);
+         EXPECT_EQ(ali_errnumOK, pTC->m_Pool.poolFree(p[j]));
+      }
+   }
+
+   {
+      AutoLock(&pTC->m_Lock);
+      ++pTC->m_Scratch;
+   }
+}
+
+TEST_F(BufferPool_f, aal0833)
+{
+   // Threads allocating and freeing concurrently, including blocks that another thread
+   // allocated, are never handed overlapping blocks.
+
+   const btUnsigned32bitInt T = 4;
+   btUnsigned32bitInt i;
+
+   for ( i = 0 ; i < 1000 ; ++i ) {
+      btVirtAddr p = NULL;
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(RandomSize(), &p));
+      m_Blocks.push_back(p);
+   }
+
+   OSLThread *pThrs[T];
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i] = new OSLThread(BufferPool_f::Churn,
+                               OSLThread::THREADPRIORITY_NORMAL,
+                               this);
+      EXPECT_TRUE(pThrs[i]->IsOK());
+   }
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i]->Join();
+      delete pThrs[i];
+   }
+
+   EXPECT_EQ(T, m_Scratch);
+   EXPECT_TRUE(m_Blocks.empty());
+}
+
+TEST_F(BufferPool_f, aal0834)
+{
+   // Microbenchmark: poolAllocate() / poolFree() pairs, against IALIBuffer allocate / free
+   // pairs of the same size. Against the driver, the latter are a round trip and mmap()
+   // or munmap() each.
+
+   const btUnsigned32bitInt N = 1000000;
+   btVirtAddr         p;
+   btUnsigned32bitInt i;
+
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate(256, &p));
+   ASSERT_EQ(ali_errnumOK, m_Pool.poolFree(p));
+
+   Timer start;
+   for ( i = 0 ; i < N ; ++i ) {
+      m_Pool.poolAllocate(256, &p);
+      m_Pool.poolFree(p);
+   }
+   Timer end;
+
+   double pool = 0.0;
+   (end - start).AsNanoSeconds(pool);
+   pool /= N;
+
+   Timer start2;
+   for ( i = 0 ; i < N / 10 ; ++i ) {
+      m_Buffer.bufferAllocate(256, &p);
+      m_Buffer.bufferFree(p);
+   }
+   Timer end2;
+
+   double heap = 0.0;
+   (end2 - start2).AsNanoSeconds(heap);
+   heap /= N / 10;
+
+   MSG("pool " << pool << " ns/alloc+free, heap-backed IALIBuffer " << heap << " ns/alloc+free");
+}
+
+void BufferPool_f::AllocFreeExit(OSLThread *pThread, void *pContext)
+{
+   BufferPool_f *pTC = static_cast<BufferPool_f *>(pContext);
+   ASSERT(NULL != pTC);
+
+   btVirtAddr         p[4];
+   btUnsigned32bitInt i;
+
+   for ( i = 0 ; i < 4 ; ++i ) {
+      if ( ali_errnumOK != pTC->m_Pool.poolAllocate(BufferPool::SlabSize / 2, &p[i]) ) {
+         ADD_FAILURE();
+         return;
+      }
+   }
+   for ( i = 0 ; i < 4 ; ++i ) {
+      EXPECT_EQ(ali_errnumOK, pTC->m_Pool.poolFree(p[i]));
+   }
+}
+
+TEST_F(BufferPool_f, aal0885)
+{
+   // Blocks cached by a thread go back to the pool when the thread exits, so that
+   // short-lived threads do not use up the pool's arenas.
+
+   ASSERT_TRUE(m_Pool.Configure((btWSSize)BufferPool::SlabSize));
+
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < 2 * BufferPool::MaxArenas ; ++i ) {
+      OSLThread *pThr = new OSLThread(BufferPool_f::AllocFreeExit,
+                                      OSLThread::THREADPRIORITY_NORMAL,
+                                      this);
+      EXPECT_TRUE(pThr->IsOK());
+      pThr->Join();
+      delete pThr;
+   }
+
+   EXPECT_LE(m_Pool.Arenas(), 2U);
+}
+
+TEST_F(BufferPool_f, aal0886)
+{
+   // A thread cycling through more BufferPools than it keeps lists for hands each pool
+   // its blocks back, and every pool keeps reusing its first arena.
+
+   const btUnsigned32bitInt P = 6;
+   HeapALIBuffer            bufs[P];
+   BufferPool              *pools[P];
+   btVirtAddr               p = NULL;
+   btUnsigned32bitInt       i;
+   btUnsigned32bitInt       j;
+
+   for ( j = 0 ; j < P ; ++j ) {
+      pools[j] = new BufferPool(&bufs[j]);
+   }
+
+   for ( i = 0 ; i < 1000 ; ++i ) {
+      for ( j = 0 ; j < P ; ++j ) {
+         ASSERT_EQ(ali_errnumOK, pools[j]->poolAllocate(64 << ( i % 4 ), &p));
+         EXPECT_NE((btPhysAddr)0, pools[j]->poolGetIOVA(p));
+         EXPECT_EQ(ali_errnumBadParameter, pools[( j + 1 ) % P]->poolFree(p));
+         ASSERT_EQ(ali_errnumOK, pools[j]->poolFree(p));
+      }
+   }
+
+   for ( j = 0 ; j < P ; ++j ) {
+      EXPECT_EQ(1, pools[j]->Arenas());
+      delete pools[j];
+      EXPECT_EQ(0, bufs[j].Live());
+   }
+}
+
+TEST_F(BufferPool_f, aal0887)
+{
+   // BufferPool::poolGetIOVA() and poolFree() find the arena of a block in a table of
+   // ArenaSize granules. With one slab per arena, neighbouring heap arenas share
+   // granules, and each block still maps to its own arena's IOVA.
+
+   ASSERT_TRUE(m_Pool.Configure((btWSSize)BufferPool::SlabSize));
+
+   std::vector<btVirtAddr> p(BufferPool::MaxArenas, (btVirtAddr)NULL);
+   btUnsigned32bitInt      i;
+
+   for ( i = 0 ; i < BufferPool::MaxArenas ; ++i ) {
+      ASSERT_EQ(ali_errnumOK, m_Pool.poolAllocate((btWSSize)BufferPool::SlabSize, &p[i]));
+   }
+   EXPECT_EQ((btUnsigned32bitInt)BufferPool::MaxArenas, m_Pool.Arenas());
+
+   for ( i = 0 ; i < BufferPool::MaxArenas ; ++i ) {
+      EXPECT_EQ(m_Buffer.bufferGetIOVA(p[i]),                              m_Pool.poolGetIOVA(p[i]));
+      EXPECT_EQ(m_Buffer.bufferGetIOVA(p[i]) + BufferPool::SlabSize - 1,   m_Pool.poolGetIOVA(p[i] + BufferPool::SlabSize - 1));
+   }
+
+   for ( i = 0 ; i < BufferPool::MaxArenas ; ++i ) {
+      EXPECT_EQ(ali_errnumOK, m_Pool.poolFree(p[i]));
+   }
+}
@@ -0,0 +1,180 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/utils/CompletionWaiter.h"
+
+class CompletionWaiter_f : public ::testing::Test
+{
+public:
+   CompletionWaiter_f() :
+      m_Flag(0),
+      m_DelayMicros(0),
+      m_pBlocker(NULL)
+   {}
+
+   virtual void SetUp() { m_Flag = 0; }
+
+   // Sets m_Flag after m_DelayMicros, then signals m_pBlocker, if any.
+   static void Completer(OSLThread *pThread, void *pContext)
+   {
+      CompletionWaiter_f *pTest = reinterpret_cast<CompletionWaiter_f *>(pContext);
+      if ( pTest->m_DelayMicros > 0 ) {
+         SleepMicro(pTest->m_DelayMicros);
+      }
+      pTest->m_Flag = 1;
+      if ( NULL != pTest->m_pBlocker ) {
+         pTest->m_pBlocker->Signal();
+      }
+   }
+
+   // Wait on m_Flag with w while another thread sets it after DelayMicros.
+   btBool WaitForCompleter(CompletionWaiter &w, unsigned long DelayMicros, btTime TimeoutMillis)
+   {
+      m_Flag        = 0;
+      m_DelayMicros = DelayMicros;
+
+      OSLThread thr(CompletionWaiter_f::Completer, OSLThread::THREADPRIORITY_NORMAL, this);
+      EXPECT_TRUE(thr.IsOK());
+      btBool res = w.Wait(&m_Flag, TimeoutMillis);
+      thr.Join();
+      return res;
+   }
+
+   volatile btUnsigned32bitInt     m_Flag;
+   unsigned long                   m_DelayMicros;
+   CompletionWaiter::EventBlocker *m_pBlocker;
+};
+
+TEST_F(CompletionWaiter_f, aal0839)
+{
+   // CompletionWaiter::Wait() returns true at once for a flag that is already set, and
+   // false for a flag that is not set within the timeout. Each is recorded.
+
+   CompletionWaiter w(1000, 100);
+
+   m_Flag = 1;
+   EXPECT_TRUE(w.Wait(&m_Flag, 0));
+   EXPECT_EQ(1, w.Waits());
+   EXPECT_EQ(1, w.StageCount(CompletionWaiter::StageImmediate));
+   EXPECT_EQ(1, w.BucketCount(0));
+
+   m_Flag = 0;
+   Timer start;
+   EXPECT_FALSE(w.Wait(&m_Flag, 20));
+   Timer end;
+
+   btUnsigned64bitInt ms = 0;
+   (end - start).AsMilliSeconds(ms);
+   EXPECT_GE(ms, 20);
+
+   EXPECT_EQ(2, w.Waits());
+   EXPECT_EQ(1, w.StageCount(CompletionWaiter::StageTimeout));
+   EXPECT_GE(w.MaxWaitNanos(), 20000000ULL);
+   EXPECT_EQ(1, w.BucketCount(CompletionWaiter::Bucket(w.MaxWaitNanos())));
+
+   w.ResetHistogram();
+   EXPECT_EQ(0, w.Waits());
+   EXPECT_EQ(0, w.StageCount(CompletionWaiter::StageTimeout));
+   EXPECT_EQ(0, w.MaxWaitNanos());
+}
+
+TEST_F(CompletionWaiter_f, aal0840)
+{
+   // CompletionWaiter::Bucket() is floor(log2(nsec)), saturating at the last bucket.
+
+   EXPECT_EQ(0, CompletionWaiter::Bucket(0));
+   EXPECT_EQ(0, CompletionWaiter::Bucket(1));
+   EXPECT_EQ(1, CompletionWaiter::Bucket(2));
+   EXPECT_EQ(1, CompletionWaiter::Bucket(3));
+   EXPECT_EQ(10, CompletionWaiter::Bucket(1024));
+   EXPECT_EQ(10, CompletionWaiter::Bucket(2047));
+   EXPECT_EQ(CompletionWaiter::NumBuckets - 1, CompletionWaiter::Bucket(~0ULL));
+}
+
+TEST_F(CompletionWaiter_f, aal0841)
+{
+   // A flag set by another thread is seen while spinning when it is set within the spin
+   // budget, and while backing off when it is set later.
+
+   CompletionWaiter spin(1000000000ULL, 100);
+   EXPECT_TRUE(WaitForCompleter(spin, 100, 1000));
+   EXPECT_EQ(1, spin.Waits());
+   EXPECT_EQ(1, spin.StageCount(CompletionWaiter::StageSpin) +
+                spin.StageCount(CompletionWaiter::StageImmediate));
+
+   CompletionWaiter backoff(0, 100);
+   EXPECT_TRUE(WaitForCompleter(backoff, 10000, 1000));
+   EXPECT_EQ(1, backoff.StageCount(CompletionWaiter::StageBackoff));
+   EXPECT_EQ(0, backoff.StageCount(CompletionWaiter::StageTimeout));
+   EXPECT_GE(backoff.MaxWaitNanos(), 10000000ULL);
+}
+
+TEST_F(CompletionWaiter_f, aal0842)
+{
+   // With an EventBlocker, a waiter past its back off blocks until the event is
+   // signaled, rather than until its next poll. Without a signal, it still sees the
+   // flag, one block slice later.
+
+   CompletionWaiter::EventBlocker blocker;
+   CompletionWaiter               w(0, 1, &blocker);
+
+   m_pBlocker = &blocker;
+   EXPECT_TRUE(WaitForCompleter(w, 20000, AAL_INFINITE_WAIT));
+   EXPECT_EQ(1, w.StageCount(CompletionWaiter::StageBlock));
+   EXPECT_LT(w.MaxWaitNanos(), 20000000ULL + CompletionWaiter::BlockSliceMillis * 1000000ULL);
+
+   m_pBlocker = NULL;
+   EXPECT_TRUE(WaitForCompleter(w, 20000, 1000));
+   EXPECT_EQ(2, w.StageCount(CompletionWaiter::StageBlock));
+
+   // Signaled, but the flag is never set.
+   blocker.Signal();
+   m_Flag = 0;
+   EXPECT_FALSE(w.Wait(&m_Flag, 2 * CompletionWaiter::BlockSliceMillis));
+   EXPECT_EQ(1, w.StageCount(CompletionWaiter::StageTimeout));
+
+   std::ostringstream os;
+   os << w;
+   MSG(os.str());
+}
+
+TEST_F(CompletionWaiter_f, aal0843)
+{
+   // Microbenchmark: time to see a completion 50 usec out, with the default
+   // CompletionWaiter, against sleeping 1 msec between polls as fpgadiag used to.
+   // Both include starting the completing thread.
+
+   const btUnsignedInt Waits = 50;
+   btUnsignedInt       i;
+   CompletionWaiter    w;
+
+   Timer start;
+   for ( i = 0 ; i < Waits ; ++i ) {
+      EXPECT_TRUE(WaitForCompleter(w, 50, 1000));
+   }
+   Timer mid;
+   for ( i = 0 ; i < Waits ; ++i ) {
+      m_Flag        = 0;
+      m_DelayMicros = 50;
+      OSLThread thr(CompletionWaiter_f::Completer, OSLThread::THREADPRIORITY_NORMAL, this);
+      while ( 0 == m_Flag ) {
+         SleepMilli(1);
+      }
+      thr.Join();
+   }
+   Timer end;
+
+   double waiter = 0.0;
+   double polled = 0.0;
+   (mid - start).AsMicroSeconds(waiter);
+   (end - mid).AsMicroSeconds(polled);
+
+   MSG("CompletionWaiter " << waiter / Waits << " usec/completion, SleepMilli(1) poll " <<
+       polled / Waits << " usec/completion");
+   std::ostringstream os;
+   os << w;
+   MSG(os.str());
+}
+
@@ -0,0 +1,275 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+class Logger_f : public ::testing::Test
+{
+public:
+   Logger_f() :
+      m_pLogger(NULL),
+      m_sFile(),
+      m_Lines(0),
+      m_Dropped(0)
+   {}
+
+   virtual void SetUp()
+   {
+      m_sFile = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".log";
+
+      m_pLogger = ILoggerFactory();
+      ASSERT_NONNULL(m_pLogger);
+      m_pLogger->SetLogPID(false);
+      m_pLogger->SetLogTimeStamp(false);
+      m_pLogger->SetLogErrorLevelPrepend(false);
+      m_pLogger->SetFlush(true);          // Everything is in the file when it is read back.
+      m_pLogger->AddToMask(LM_Any, LOG_INFO);
+      m_pLogger->SetDestination(ILogger::FILE, m_sFile);
+   }
+
+   virtual void TearDown()
+   {
+      delete m_pLogger;
+      m_pLogger = NULL;
+      remove(m_sFile.c_str());
+   }
+
+   // Logs Count lines tagged with Thread. Every line is intact only if it was never
+   // interleaved with another.
+   void LogLines(btUnsignedInt Thread, btUnsignedInt Count)
+   {
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         AAL_ANY_LOGP(m_pLogger, LOG_INFO, LM_Any, "thread " << Thread << " line " << i <<
+                      " 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef end" << std::endl);
+      }
+   }
+
+   // Reads the log back, checking that each thread's lines are intact and in order,
+   // and that the dropped lines were reported. Returns false on the first bad line.
+   btBool ReadBack(btUnsignedInt Threads)
+   {
+      std::ifstream      ifs(m_sFile.c_str());
+      std::string        sLine;
+      std::vector<btInt> Next(Threads, 0);
+
+      m_Lines   = 0;
+      m_Dropped = 0;
+
+      while ( std::getline(ifs, sLine) ) {
+         if ( 0 == sLine.compare(0, 28, "AAL Logger-Destination set: ") ) {
+            continue;
+         }
+
+         unsigned long long Dropped = 0;
+         if ( 1 == sscanf(sLine.c_str(), "AAL Logger dropped %llu lines", &Dropped) ) {
+            m_Dropped += Dropped;
+            continue;
+         }
+
+         unsigned Thread = 0;
+         int      Line   = 0;
+         char     End[4] = { 0, };
+         if ( ( 3 != sscanf(sLine.c_str(),
+                            "thread %u line %d 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef %3s",
+                            &Thread, &Line, End) ) ||
+              ( 0 != strcmp(End, "end") ) ||
+              ( Thread >= Threads ) ||
+              ( Line < Next[Thread] ) ) {
+            ADD_FAILURE() << "bad line: " << sLine;
+            return false;
+         }
+
+         Next[Thread] = Line + 1;
+         ++m_Lines;
+      }
+      return true;
+   }
+
+   static void LoggerThread(OSLThread *pThread, void *pContext);
+
+   ILogger           *m_pLogger;
+   std::string        m_sFile;
+   btUnsigned64bitInt m_Lines;
+   btUnsigned64bitInt m_Dropped;
+};
+
+struct LoggerThreadArgs
+{
+   Logger_f     *m_pFixture;
+   btUnsignedInt m_Thread;
+   btUnsignedInt m_Count;
+};
+
+void Logger_f::LoggerThread(OSLThread *pThread, void *pContext)
+{
+   LoggerThreadArgs *pArgs = reinterpret_cast<LoggerThreadArgs *>(pContext);
+   pArgs->m_pFixture->LogLines(pArgs->m_Thread, pArgs->m_Count);
+}
+
+TEST_F(Logger_f, aal0881)
+{
+   // In asynchronous mode, every line logged by one thread is either written, intact and
+   // in order, or counted as dropped and reported in the log.
+
+   const btUnsignedInt Count = 20000;
+
+   EXPECT_FALSE(m_pLogger->GetAsync());
+   m_pLogger->SetAsync(true);
+   EXPECT_TRUE(m_pLogger->GetAsync());
+
+   LogLines(0, Count);
+
+   m_pLogger->SetAsync(false);
+   EXPECT_FALSE(m_pLogger->GetAsync());
+
+   ASSERT_TRUE(ReadBack(1));
+   EXPECT_EQ((btUnsigned64bitInt)Count, m_Lines + m_pLogger->GetDropped());
+   EXPECT_EQ(m_pLogger->GetDropped(), m_Dropped);
+   MSG(m_Lines << " lines written, " << m_pLogger->GetDropped() << " dropped");
+}
+
+TEST_F(Logger_f, aal0882)
+{
+   // Lines logged by several threads at once are never interleaved, and each thread's
+   // lines stay in order.
+
+   const btUnsignedInt Threads = 4;
+   const btUnsignedInt Count   = 5000;
+
+   LoggerThreadArgs Args[Threads];
+   OSLThread       *pThreads[Threads];
+   btUnsignedInt    i;
+
+   m_pLogger->SetAsync(true);
+
+   for ( i = 0 ; i < Threads ; ++i ) {
+      Args[i].m_pFixture = this;
+      Args[i].m_Thread   = i;
+      Args[i].m_Count    = Count;
+      pThreads[i] = new OSLThread(Logger_f::LoggerThread, OSLThread::THREADPRIORITY_NORMAL, &Args[i]);
+   }
+   for ( i = 0 ; i < Threads ; ++i ) {
+      pThreads[i]->Join();
+      delete pThreads[i];
+   }
+
+   m_pLogger->SetAsync(false);
+
+   ASSERT_TRUE(ReadBack(Threads));
+   EXPECT_EQ((btUnsigned64bitInt)Threads * Count, m_Lines + m_pLogger->GetDropped());
+   EXPECT_EQ(m_pLogger->GetDropped(), m_Dropped);
+}
+
+TEST_F(Logger_f, aal0883)
+{
+   // Switching between the modes loses nothing that was not counted, lines longer than the
+   // line buffer are truncated but still end the line, and Log(const char *) works in
+   // both modes.
+
+   btUnsignedInt i;
+
+   for ( i = 0 ; i < 6 ; ++i ) {
+      m_pLogger->SetAsync(1 == ( i & 1 ));
+      LogLines(i, 100);
+   }
+
+   // A line begun in asynchronous mode and finished after switching back.
+   m_pLogger->SetAsync(true);
+   std::ostringstream &oss = m_pLogger->GetOss(LOG_INFO);
+   m_pLogger->SetAsync(false);
+   m_pLogger->Log(LOG_INFO, oss << "thread 6 line 0 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef end" << std::endl);
+
+   m_pLogger->SetAsync(true);
+   m_pLogger->Log(LOG_INFO, "thread 6 line 1 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef end\n");
+   m_pLogger->SetAsync(false);
+   m_pLogger->Log(LOG_INFO, "thread 6 line 2 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef end\n");
+
+   ASSERT_TRUE(ReadBack(7));
+   EXPECT_EQ((btUnsigned64bitInt)603, m_Lines + m_pLogger->GetDropped());
+
+   // Long lines.
+   m_pLogger->SetAsync(true);
+   const std::string sLong(10000, 'x');
+   AAL_ANY_LOGP(m_pLogger, LOG_INFO, LM_Any, sLong << std::endl);
+   AAL_ANY_LOGP(m_pLogger, LOG_INFO, LM_Any, "after" << std::endl);
+   m_pLogger->SetAsync(false);
+
+   std::ifstream ifs(m_sFile.c_str());
+   std::string   sLine;
+   std::string   sPrev;
+   while ( std::getline(ifs, sLine) ) {
+      if ( ( 0 == sLine.compare(0, 5, "after") ) && ( 0 == m_pLogger->GetDropped() ) ) {
+         EXPECT_LT(sPrev.length(), sLong.length());
+         EXPECT_GT(sPrev.length(), (size_t)1000);
+         EXPECT_EQ(std::string::npos, sPrev.find_first_not_of('x'));
+      }
+      sPrev = sLine;
+   }
+   EXPECT_EQ("after", sPrev);
+}
+
+TEST_F(Logger_f, aal0884)
+{
+   // Microbenchmark: cost to the logging thread of a line that is masked off, logged
+   // synchronously, and logged asynchronously, from one thread and from four.
+
+   const btUnsignedInt Count = 20000;
+   const btUnsignedInt Threads[] = { 1, 4 };
+   btUnsignedInt       t;
+
+   m_pLogger->SetFlush(false);
+
+   for ( t = 0 ; t < sizeof(Threads) / sizeof(Threads[0]) ; ++t ) {
+      const btUnsignedInt n = Threads[t];
+      const char         *Modes[] = { "disabled", "sync", "async" };
+      btUnsignedInt       m;
+
+      for ( m = 0 ; m < 3 ; ++m ) {
+         LoggerThreadArgs Args[4];
+         OSLThread       *pThreads[4];
+         btUnsignedInt    i;
+
+         if ( 0 == m ) {
+            m_pLogger->RemoveFromMask(LM_Any);
+         } else {
+            m_pLogger->AddToMask(LM_Any, LOG_INFO);
+         }
+         m_pLogger->SetAsync(2 == m);
+         btUnsigned64bitInt Dropped = m_pLogger->GetDropped();
+
+         Timer t0;
+         if ( 1 == n ) {
+            LogLines(0, Count);
+         } else {
+            for ( i = 0 ; i < n ; ++i ) {
+               Args[i].m_pFixture = this;
+               Args[i].m_Thread   = i;
+               Args[i].m_Count    = Count / n;
+               pThreads[i] = new OSLThread(Logger_f::LoggerThread, OSLThread::THREADPRIORITY_NORMAL, &Args[i]);
+            }
+            for ( i = 0 ; i < n ; ++i ) {
+               pThreads[i]->Join();
+               delete pThreads[i];
+            }
+         }
+         Timer t1;
+
+         m_pLogger->SetAsync(false);
+         Timer t2;
+
+         double logged  = 0.0;
+         double drained = 0.0;
+         (t1 - t0).AsNanoSeconds(logged);
+         (t2 - t1).AsNanoSeconds(drained);
+
+         MSG(n << " thread(s), " << Modes[m] << ": " << logged / Count << " ns/line, drain " <<
+             drained / 1000000.0 << " ms, dropped " << ( m_pLogger->GetDropped() - Dropped ));
+      }
+   }
+}
@@ -94,3 +94,136 @@ TEST_F(MessageDelivery_f, aal0708)
    YIELD_WHILE(1 == i);
 }
 
+// Records its sequence number on its target's list, after waiting on pWait, if any.
+class TargetedD : public IDispatchable
+{
+public:
+   TargetedD(btObjectType Target, std::vector<btUnsignedInt> &List, CriticalSection &Lock,
+             btUnsignedInt Seq, CSemaphore *pWait=NULL) :
+      m_Target(Target),
+      m_List(List),
+      m_Lock(Lock),
+      m_Seq(Seq),
+      m_pWait(pWait)
+   {}
+   virtual btObjectType DeliveryTarget() const { return m_Target; }
+   virtual void operator() ()
+   {
+      if ( NULL != m_pWait ) {
+         m_pWait->Wait();
+      }
+      {
+         AutoLock(&m_Lock);
+         m_List.push_back(m_Seq);
+      }
+      delete this;
+   }
+
+protected:
+   btObjectType                m_Target;
+   std::vector<btUnsignedInt> &m_List;
+   CriticalSection            &m_Lock;
+   btUnsignedInt               m_Seq;
+   CSemaphore                 *m_pWait;
+};
+
+class MessageDeliveryThreads : public _MessageDelivery
+{
+public:
+   btUnsignedInt DispatcherFor(btObjectType Target) const { return Dispatcher(Target); }
+};
+
+TEST_F(MessageDelivery_f, aal0855)
+{
+   // _MessageDelivery::SetDeliveryThreads() accepts 1 .. MaxDeliveryThreads threads.
+   // With several threads, the dispatchables for each IDispatchable::DeliveryTarget()
+   // are delivered in the order they were scheduled.
+
+   EXPECT_EQ(1, m_pMDS->DeliveryThreads());
+   EXPECT_FALSE(m_pMDS->SetDeliveryThreads(0));
+   EXPECT_FALSE(m_pMDS->SetDeliveryThreads(_MessageDelivery::MaxDeliveryThreads + 1));
+   EXPECT_EQ(1, m_pMDS->DeliveryThreads());
+
+   ASSERT_TRUE(m_pMDS->SetDeliveryThreads(4));
+   EXPECT_EQ(4, m_pMDS->DeliveryThreads());
+
+   const btUnsignedInt Targets = 16;
+   const btUnsignedInt Items   = 200;
+
+   btByte                     targets[Targets][64];
+   std::vector<btUnsignedInt> lists[Targets + 1];
+   CriticalSection            lock;
+
+   btUnsignedInt i;
+   btUnsignedInt t;
+   for ( i = 0 ; i < Items ; ++i ) {
+      for ( t = 0 ; t < Targets ; ++t ) {
+         EXPECT_TRUE(scheduleMessage(new TargetedD(targets[t], lists[t], lock, i)));
+      }
+      // No target.
+      EXPECT_TRUE(scheduleMessage(new TargetedD(NULL, lists[Targets], lock, i)));
+   }
+
+   StopMessageDelivery();
+
+   for ( t = 0 ; t <= Targets ; ++t ) {
+      ASSERT_EQ(Items, lists[t].size()) << t;
+      for ( i = 0 ; i < Items ; ++i ) {
+         ASSERT_EQ(i, lists[t][i]) << t;
+      }
+   }
+
+   // Resizing keeps delivering.
+   StartMessageDelivery();
+   ASSERT_TRUE(m_pMDS->SetDeliveryThreads(2));
+   EXPECT_TRUE(scheduleMessage(new TargetedD(targets[0], lists[0], lock, Items)));
+   StopMessageDelivery();
+   EXPECT_EQ(Items + 1, lists[0].size());
+}
+
+TEST(MessageDelivery, aal0856)
+{
+   // A blocked delivery to one target does not hold up the deliveries to a target
+   // that is served by another thread.
+
+   MessageDeliveryThreads mds;
+   ASSERT_TRUE(mds.SetDeliveryThreads(4));
+
+   btByte        targets[64][64];
+   btUnsignedInt a = 0;
+   btUnsignedInt b;
+   for ( b = 1 ; b < 64 ; ++b ) {
+      if ( mds.DispatcherFor(targets[a]) != mds.DispatcherFor(targets[b]) ) {
+         break;
+      }
+   }
+   ASSERT_LT(b, 64);
+
+   std::vector<btUnsignedInt> lista;
+   std::vector<btUnsignedInt> listb;
+   CriticalSection            lock;
+   CSemaphore                 sem;
+   ASSERT_TRUE(sem.Create(0, 1));
+
+   EXPECT_TRUE(mds.scheduleMessage(new TargetedD(targets[a], lista, lock, 0, &sem)));
+   EXPECT_TRUE(mds.scheduleMessage(new TargetedD(targets[a], lista, lock, 1)));
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 10 ; ++i ) {
+      EXPECT_TRUE(mds.scheduleMessage(new TargetedD(targets[b], listb, lock, i)));
+   }
+
+   YIELD_WHILE(listb.size() < 10);
+   {
+      AutoLock(&lock);
+      EXPECT_EQ(0, lista.size());
+   }
+
+   EXPECT_TRUE(sem.Post(1));
+   mds.StopMessageDelivery();
+
+   ASSERT_EQ(2, lista.size());
+   EXPECT_EQ(0, lista[0]);
+   EXPECT_EQ(1, lista[1]);
+}
+
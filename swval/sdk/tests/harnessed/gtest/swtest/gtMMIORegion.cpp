@@ -0,0 +1,217 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/utils/ALIMMIORegion.h"
+#include "aalsdk/osal/Timer.h"
+
+// The first 64-byte aligned address in p, for the wide stores.
+static btUnsigned64bitInt * Align64(btUnsigned64bitInt *p)
+{
+   return reinterpret_cast<btUnsigned64bitInt *>((reinterpret_cast<btUIntPtr>(p) + 63) & ~(btUIntPtr)63);
+}
+
+// IALIMMIO over a plain memory buffer, counting the accesses that reach it through
+// the interface.
+class MemoryALIMMIO : public IALIMMIO
+{
+public:
+   enum { Length = 0x1000 };
+
+   MemoryALIMMIO(btBool Direct) :
+      m_Direct(Direct),
+      m_Calls(0),
+      m_Batches(0),
+      m_Region(Align64(m_Storage))
+   {
+      memset(m_Region, 0, Length);
+   }
+
+   virtual btVirtAddr   mmioGetAddress( void ) { return reinterpret_cast<btVirtAddr>(m_Region); }
+   virtual btCSROffset  mmioGetLength( void )  { return Length;   }
+   virtual btBool       mmioIsDirect( void )   { return m_Direct; }
+
+   virtual btBool mmioRead32(const btCSROffset Offset, btUnsigned32bitInt * const pValue)
+   {
+      ++m_Calls;
+      *pValue = *reinterpret_cast<btUnsigned32bitInt *>(mmioGetAddress() + Offset);
+      return true;
+   }
+   virtual btBool mmioWrite32(const btCSROffset Offset, const btUnsigned32bitInt Value)
+   {
+      ++m_Calls;
+      *reinterpret_cast<btUnsigned32bitInt *>(mmioGetAddress() + Offset) = Value;
+      return true;
+   }
+   virtual btBool mmioRead64(const btCSROffset Offset, btUnsigned64bitInt * const pValue)
+   {
+      ++m_Calls;
+      *pValue = *reinterpret_cast<btUnsigned64bitInt *>(mmioGetAddress() + Offset);
+      return true;
+   }
+   virtual btBool mmioWrite64(const btCSROffset Offset, const btUnsigned64bitInt Value)
+   {
+      ++m_Calls;
+      *reinterpret_cast<btUnsigned64bitInt *>(mmioGetAddress() + Offset) = Value;
+      return true;
+   }
+   virtual btBool mmioWriteBatch(const ali_mmio_op * const pOps, const btUnsignedInt Count)
+   {
+      btUnsignedInt i;
+      ++m_Batches;
+      for ( i = 0 ; i < Count ; ++i ) {
+         EXPECT_EQ(ali_mmio_width64, pOps[i].Width);
+         *reinterpret_cast<btUnsigned64bitInt *>(mmioGetAddress() + pOps[i].Offset) = pOps[i].Value;
+      }
+      return true;
+   }
+   virtual btBool mmioReadBatch(ali_mmio_op * const pOps, const btUnsignedInt Count) { return false; }
+
+   virtual btBool mmioGetFeatureAddress(btVirtAddr *, NamedValueSet const &, NamedValueSet &) { return false; }
+   virtual btBool mmioGetFeatureAddress(btVirtAddr *, NamedValueSet const &)                  { return false; }
+   virtual btBool mmioGetFeatureOffset(btCSROffset *, NamedValueSet const &, NamedValueSet &) { return false; }
+   virtual btBool mmioGetFeatureOffset(btCSROffset *, NamedValueSet const &)                  { return false; }
+
+   btUnsigned64bitInt At64(btCSROffset Offset) const
+   {
+      return m_Region[Offset / sizeof(btUnsigned64bitInt)];
+   }
+
+   btBool             m_Direct;
+   btUnsignedInt      m_Calls;
+   btUnsignedInt      m_Batches;
+   btUnsigned64bitInt m_Storage[(Length + 64) / sizeof(btUnsigned64bitInt)];
+   btUnsigned64bitInt *m_Region;
+};
+
+class MMIORegion_f : public ::testing::TestWithParam< btBool >
+{
+public:
+   MMIORegion_f() :
+      m_MMIO(true)
+   {}
+
+   virtual void SetUp() { m_MMIO.m_Direct = GetParam(); }
+
+   MemoryALIMMIO m_MMIO;
+};
+
+TEST_P(MMIORegion_f, aal0835)
+{
+   // MMIORegion::read<>() and write<>() access the register at the given offset, at
+   // the given width, directly when IALIMMIO::mmioIsDirect() and through the
+   // interface otherwise.
+
+   MMIORegion r(&m_MMIO);
+   ASSERT_TRUE(r.IsOK());
+   EXPECT_EQ(GetParam(), r.IsDirect());
+   EXPECT_EQ((btCSROffset)MemoryALIMMIO::Length, r.Length());
+   EXPECT_EQ(&m_MMIO, r.Service());
+
+   r.write<btUnsigned64bitInt, 0x100>(0x0123456789abcdefULL);
+   r.write<btUnsigned32bitInt, 0x108>(0xdecafbad);
+   r.write<btUnsigned32bitInt>(0x10c, 0xfeedface);
+
+   EXPECT_EQ(0x0123456789abcdefULL, m_MMIO.At64(0x100));
+   EXPECT_EQ(0xfeedfacedecafbadULL, m_MMIO.At64(0x108));
+
+   EXPECT_EQ(0x0123456789abcdefULL, (r.read<btUnsigned64bitInt, 0x100>()));
+   EXPECT_EQ(0x89abcdef,            (r.read<btUnsigned32bitInt, 0x100>()));
+   EXPECT_EQ(0x01234567,            (r.read<btUnsigned32bitInt, 0x104>()));
+   EXPECT_EQ(0xfeedface,            r.read<btUnsigned32bitInt>(0x10c));
+
+   EXPECT_EQ(GetParam() ? 0 : 7, m_MMIO.m_Calls);
+}
+
+TEST_P(MMIORegion_f, aal0836)
+{
+   // MMIORegion::write256() and write512() store 32 and 64 bytes in place. Through
+   // the interface, each is one mmioWriteBatch() of 64-bit writes.
+
+   MMIORegion r(&m_MMIO);
+   ASSERT_TRUE(r.IsOK());
+
+   btUnsigned64bitInt  storage[16];
+   btUnsigned64bitInt *src = Align64(storage);
+   btUnsignedInt       i;
+   for ( i = 0 ; i < 8 ; ++i ) {
+      src[i] = 0x1111111111111111ULL * (i + 1);
+   }
+
+   r.write256(0x200, src);
+   r.write512(0x240, src);
+   r.writeFence();
+
+   for ( i = 0 ; i < 4 ; ++i ) {
+      EXPECT_EQ(src[i], m_MMIO.At64(0x200 + i * 8)) << i;
+   }
+   EXPECT_EQ(0, m_MMIO.At64(0x220));
+   for ( i = 0 ; i < 8 ; ++i ) {
+      EXPECT_EQ(src[i], m_MMIO.At64(0x240 + i * 8)) << i;
+   }
+   EXPECT_EQ(0, m_MMIO.At64(0x280));
+
+   EXPECT_EQ(GetParam() ? 0 : 2, m_MMIO.m_Batches);
+}
+
+TEST_P(MMIORegion_f, aal0837)
+{
+   // An MMIORegion is not OK if it has no IALIMMIO, or if the region is shorter than
+   // the span the caller asks for.
+
+   MMIORegion none;
+   EXPECT_FALSE(none.IsOK());
+   EXPECT_FALSE(none.IsDirect());
+
+   MMIORegion null(NULL);
+   EXPECT_FALSE(null.IsOK());
+
+   MMIORegion fits(&m_MMIO, MemoryALIMMIO::Length);
+   EXPECT_TRUE(fits.IsOK());
+   EXPECT_EQ(GetParam(), fits.IsDirect());
+
+   MMIORegion tooshort(&m_MMIO, MemoryALIMMIO::Length + 1);
+   EXPECT_FALSE(tooshort.IsOK());
+   EXPECT_FALSE(tooshort.IsDirect());
+   EXPECT_EQ(0, tooshort.Length());
+
+   // Copies share the region.
+   MMIORegion copy(fits);
+   copy.write<btUnsigned32bitInt, 0x10>(0xabcd);
+   EXPECT_EQ(0xabcd, (fits.read<btUnsigned32bitInt, 0x10>()));
+}
+
+TEST_P(MMIORegion_f, aal0838)
+{
+   // Microbenchmark: a 32-bit register write through MMIORegion, against the same
+   // write through IALIMMIO::mmioWrite32().
+
+   const btUnsignedInt Writes = 10000000;
+   IALIMMIO   *pMMIO = &m_MMIO;
+   MMIORegion  r(pMMIO);
+   btUnsignedInt i;
+
+   Timer start;
+   for ( i = 0 ; i < Writes ; ++i ) {
+      r.write<btUnsigned32bitInt, 0x138>(i);
+   }
+   Timer mid;
+   for ( i = 0 ; i < Writes ; ++i ) {
+      pMMIO->mmioWrite32(0x138, i);
+   }
+   Timer end;
+
+   EXPECT_EQ(Writes - 1, (r.read<btUnsigned32bitInt, 0x138>()));
+
+   double region = 0.0;
+   double virt   = 0.0;
+   (mid - start).AsNanoSeconds(region);
+   (end - mid).AsNanoSeconds(virt);
+
+   MSG((GetParam() ? "direct" : "indirect") << " region: MMIORegion " << region / Writes <<
+       " ns/write, IALIMMIO " << virt / Writes << " ns/write");
+}
+
+INSTANTIATE_TEST_CASE_P(My, MMIORegion_f, ::testing::Bool());
+
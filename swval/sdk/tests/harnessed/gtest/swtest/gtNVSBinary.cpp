@@ -0,0 +1,521 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/AALNVSBinary.h"
+#include "aalsdk/AALNVSMarshaller.h"
+#include "aalsdk/osal/Timer.h"
+#include "aalsdk/osal/Env.h"
+#include <vector>
+
+// Encoded NVS in 8-byte aligned storage, as NVSView requires.
+class BinaryNVS
+{
+public:
+   BinaryNVS(const INamedValueSet &nvs) :
+      m_Len(NVSBinarySize(nvs)),
+      m_Storage((size_t)(m_Len + 7) / 8)
+   {
+      btWSSize used = 0;
+      EXPECT_EQ(ENamedValuesOK, NVSToBinary(nvs, Buf(), m_Len, &used));
+      EXPECT_EQ(m_Len, used);
+   }
+
+   btByte     * Buf()       { return reinterpret_cast<btByte *>(&m_Storage[0]); }
+   btWSSize     Len() const { return m_Len; }
+
+protected:
+   btWSSize                          m_Len;
+   std::vector< btUnsigned64bitInt > m_Storage;
+};
+
+class NVSBinary_f : public ::testing::Test
+{
+public:
+   NVSBinary_f() :
+      m_Seed(0)
+   {}
+
+   virtual void SetUp() { m_Seed = GlobalTestConfig::GetInstance().RandSeed(); }
+
+   btUnsigned32bitInt Rand(btUnsigned32bitInt mod) { return GetRand(&m_Seed) % mod; }
+
+   std::string RandString()
+   {
+      // Printable characters, including the space and newline that the text format
+      // has to carry through its own delimiters.
+      static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789 \n{}-";
+      std::string s;
+      btUnsignedInt n = Rand(24);
+      while ( n-- ) {
+         s += chars[Rand(sizeof(chars) - 1)];
+      }
+      return s;
+   }
+
+   // Adds Name=<random value of a random type> to nvs. Floats are small multiples of
+   // 1/64 so that every value compares equal to itself.
+   template <typename K>
+   void AddRandom(NamedValueSet &nvs, K Name, btUnsignedInt Depth)
+   {
+      const btUnsigned32bitInt n = 1 + Rand(12);
+      btUnsigned32bitInt       i;
+
+      switch ( Rand(( Depth < 3 ) ? 18 : 17) ) {
+         case  0 : nvs.Add(Name, (btBool)(Rand(2) ? true : false));                               break;
+         case  1 : nvs.Add(Name, (btByte)Rand(256));                                              break;
+         case  2 : nvs.Add(Name, (bt32bitInt)GetRand(&m_Seed));                                   break;
+         case  3 : nvs.Add(Name, (btUnsigned32bitInt)GetRand(&m_Seed));                           break;
+         case  4 : nvs.Add(Name, (bt64bitInt)(((btUnsigned64bitInt)GetRand(&m_Seed) << 32) | GetRand(&m_Seed))); break;
+         case  5 : nvs.Add(Name, ((btUnsigned64bitInt)GetRand(&m_Seed) << 32) | GetRand(&m_Seed)); break;
+         case  6 : nvs.Add(Name, (btFloat)((bt32bitInt)Rand(100000) - 50000) / 64.0f);            break;
+         case  7 : nvs.Add(Name, reinterpret_cast<btObjectType>((btUIntPtr)GetRand(&m_Seed)));   break;
+         case  8 : nvs.Add(Name, RandString().c_str());                                          break;
+
+         case  9 : {
+            std::vector<btByte> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = (btByte)Rand(256); }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 10 : {
+            std::vector<bt32bitInt> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = (bt32bitInt)GetRand(&m_Seed); }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 11 : {
+            std::vector<btUnsigned32bitInt> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = GetRand(&m_Seed); }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 12 : {
+            std::vector<bt64bitInt> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = -(bt64bitInt)GetRand(&m_Seed) << 16; }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 13 : {
+            std::vector<btUnsigned64bitInt> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = (btUnsigned64bitInt)GetRand(&m_Seed) << 24; }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 14 : {
+            std::vector<btFloat> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = (btFloat)Rand(100000) / 64.0f; }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 15 : {
+            std::vector<std::string> s(n);
+            std::vector<btString>    a(n);
+            for ( i = 0 ; i < n ; ++i ) {
+               s[i] = RandString();
+               a[i] = const_cast<btString>(s[i].c_str());
+            }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 16 : {
+            std::vector<btObjectType> a(n);
+            for ( i = 0 ; i < n ; ++i ) { a[i] = reinterpret_cast<btObjectType>((btUIntPtr)GetRand(&m_Seed)); }
+            nvs.Add(Name, &a[0], n);
+         } break;
+         case 17 : {
+            NamedValueSet sub;
+            Fill(sub, Depth + 1);
+            nvs.Add(Name, &sub);
+         } break;
+      }
+   }
+
+   void Fill(NamedValueSet &nvs, btUnsignedInt Depth=0)
+   {
+      btUnsignedInt n = 1 + Rand(( 0 == Depth ) ? 24 : 6);
+      btUnsignedInt i;
+      for ( i = 0 ; i < n ; ++i ) {
+         if ( Rand(2) ) {
+            AddRandom(nvs, (btNumberKey)(i * 1000 + Rand(1000)), Depth);
+         } else {
+            std::ostringstream oss;
+            oss << "key " << i << ( Rand(4) ? "" : "\nline" );
+            AddRandom(nvs, oss.str().c_str(), Depth);
+         }
+      }
+   }
+
+   // Every name of nvs reads back the same through v, in place.
+   template <typename K>
+   void ExpectSame(const NVSView &v, const INamedValueSet &nvs, K Name)
+   {
+      eBasicTypes t  = btUnknownType_t;
+      eBasicTypes vt = btUnknownType_t;
+      btWSSize    n  = 0;
+      btWSSize    vn = 0;
+      btWSSize    i;
+
+      ASSERT_TRUE(v.Has(Name));
+      ASSERT_EQ(ENamedValuesOK, nvs.Type(Name, &t));
+      ASSERT_EQ(ENamedValuesOK, v.Type(Name, &vt));
+      ASSERT_EQ(t, vt);
+      ASSERT_EQ(ENamedValuesOK, nvs.GetSize(Name, &n));
+      ASSERT_EQ(ENamedValuesOK, v.GetSize(Name, &vn));
+      ASSERT_EQ(n, vn);
+
+#define NVSBINARY_EXPECT_SCALAR(__t) case __t##_t : {             \
+   __t a, b;                                                         \
+   nvs.Get(Name, &a);                                                \
+   EXPECT_EQ(ENamedValuesOK, v.Get(Name, &b));                       \
+   EXPECT_EQ(a, b);                                                  \
+} break
+
+#define NVSBINARY_EXPECT_ARRAY(__t) case __t##Array_t : {         \
+   __t *a = NULL; const __t *b = NULL;                               \
+   nvs.Get(Name, &a);                                                \
+   EXPECT_EQ(ENamedValuesOK, v.GetArray(Name, &b));                  \
+   for ( i = 0 ; i < n ; ++i ) { EXPECT_EQ(a[i], b[i]) << i; }       \
+} break
+
+      switch ( t ) {
+         NVSBINARY_EXPECT_SCALAR(btBool);
+         NVSBINARY_EXPECT_SCALAR(btByte);
+         NVSBINARY_EXPECT_SCALAR(bt32bitInt);
+         NVSBINARY_EXPECT_SCALAR(btUnsigned32bitInt);
+         NVSBINARY_EXPECT_SCALAR(bt64bitInt);
+         NVSBINARY_EXPECT_SCALAR(btUnsigned64bitInt);
+         NVSBINARY_EXPECT_SCALAR(btFloat);
+         NVSBINARY_EXPECT_SCALAR(btObjectType);
+
+         case btString_t : {
+            btcString a = NULL;
+            btcString b = NULL;
+            nvs.Get(Name, &a);
+            EXPECT_EQ(ENamedValuesOK, v.Get(Name, &b));
+            EXPECT_STREQ(a, b);
+         } break;
+
+         case btNamedValueSet_t : {
+            INamedValueSet const *a = NULL;
+            NVSView               b;
+            nvs.Get(Name, &a);
+            EXPECT_EQ(ENamedValuesOK, v.Get(Name, &b));
+            ExpectSame(b, *a);
+         } break;
+
+         NVSBINARY_EXPECT_ARRAY(btByte);
+         NVSBINARY_EXPECT_ARRAY(bt32bitInt);
+         NVSBINARY_EXPECT_ARRAY(btUnsigned32bitInt);
+         NVSBINARY_EXPECT_ARRAY(bt64bitInt);
+         NVSBINARY_EXPECT_ARRAY(btUnsigned64bitInt);
+         NVSBINARY_EXPECT_ARRAY(btFloat);
+
+         case btStringArray_t : {
+            btStringArray a = NULL;
+            btcString     b = NULL;
+            nvs.Get(Name, &a);
+            for ( i = 0 ; i < n ; ++i ) {
+               EXPECT_EQ(ENamedValuesOK, v.GetElement(Name, (btUnsignedInt)i, &b));
+               EXPECT_STREQ(a[i], b) << i;
+            }
+            EXPECT_EQ(ENamedValuesIndexOutOfRange, v.GetElement(Name, (btUnsignedInt)n, &b));
+         } break;
+
+         case btObjectArray_t : {
+            btObjectArray a = NULL;
+            btObjectType  b = NULL;
+            nvs.Get(Name, &a);
+            for ( i = 0 ; i < n ; ++i ) {
+               EXPECT_EQ(ENamedValuesOK, v.GetElement(Name, (btUnsignedInt)i, &b));
+               EXPECT_EQ(a[i], b) << i;
+            }
+         } break;
+
+         default : ADD_FAILURE() << t;
+      }
+   }
+
+   void ExpectSame(const NVSView &v, const INamedValueSet &nvs)
+   {
+      btUnsignedInt n  = 0;
+      btUnsignedInt vn = 0;
+      btUnsignedInt i;
+
+      ASSERT_TRUE(v.IsOK());
+      nvs.GetNumNames(&n);
+      EXPECT_EQ(ENamedValuesOK, v.GetNumNames(&vn));
+      ASSERT_EQ(n, vn);
+
+      for ( i = 0 ; i < n ; ++i ) {
+         eNameTypes nt;
+         nvs.GetNameType(i, &nt);
+         if ( btNumberKey_t == nt ) {
+            btNumberKey Name = 0;
+            nvs.GetName(i, &Name);
+            ExpectSame(v, nvs, Name);
+         } else {
+            btStringKey Name = NULL;
+            nvs.GetName(i, &Name);
+            ExpectSame(v, nvs, Name);
+         }
+      }
+   }
+
+   btUnsigned32bitInt m_Seed;
+};
+
+TEST_F(NVSBinary_f, aal0873)
+{
+   // Random NVS's, with every value type, number and string keys, and nested NVS's,
+   // survive the binary round trip exactly, and agree with the text round trip.
+   // The text writer leaves its stream in hex once it has written a btByteArray, and
+   // the reader can not parse negative signed values written in hex, so the text
+   // round trip is itself lossy for some NVS's; those are compared by their text
+   // only, and counted.
+
+   btUnsignedInt iter;
+   btUnsignedInt lossy = 0;
+   for ( iter = 0 ; iter < 200 ; ++iter ) {
+      NamedValueSet nvs;
+      Fill(nvs);
+
+      BinaryNVS bin(nvs);
+      ASSERT_LT((btWSSize)0, bin.Len());
+      EXPECT_TRUE(IsNVSBinary(bin.Buf(), bin.Len()));
+
+      NamedValueSet frombin;
+      ASSERT_EQ(ENamedValuesOK, NVSFromBinary(frombin, bin.Buf(), bin.Len())) << iter;
+      EXPECT_TRUE(frombin == nvs) << iter;
+      EXPECT_TRUE(nvs == frombin) << iter;
+
+      std::string text(nvs.ToStr());
+      EXPECT_EQ(text, frombin.ToStr()) << iter;
+
+      // The text reader stops at the end of the buffer, with ENamedValuesEndOfFile.
+      NamedValueSet fromtext;
+      ENamedValues  e = fromtext.FromStr(text);
+      ASSERT_TRUE(( ENamedValuesOK == e ) || ( ENamedValuesEndOfFile == e )) << iter << " " << e;
+
+      if ( !( fromtext == nvs ) ) {
+         ++lossy;
+         continue;
+      }
+
+      // Where the text round trip is exact, the NVS it gives encodes to the same bytes.
+      EXPECT_TRUE(fromtext == frombin) << iter;
+      BinaryNVS again(fromtext);
+      ASSERT_EQ(bin.Len(), again.Len()) << iter;
+      EXPECT_EQ(0, memcmp(bin.Buf(), again.Buf(), (size_t)bin.Len())) << iter;
+   }
+   EXPECT_LT(lossy, iter);
+   MSG(lossy << " of " << iter << " text round trips were lossy");
+}
+
+TEST_F(NVSBinary_f, aal0874)
+{
+   // NVSView answers every query of an encoded NVS in place: scalars and nested Sets
+   // by value, strings and arrays as pointers into the buffer.
+
+   btUnsignedInt iter;
+   for ( iter = 0 ; iter < 100 ; ++iter ) {
+      NamedValueSet nvs;
+      Fill(nvs);
+
+      BinaryNVS bin(nvs);
+      NVSView   v(bin.Buf(), bin.Len());
+      ExpectSame(v, nvs);
+   }
+
+   NamedValueSet nvs;
+   btUnsigned32bitInt u32[3] = { 1, 2, 3 };
+   nvs.Add((btNumberKey)5, u32, 3);
+   nvs.Add("name", "value");
+   BinaryNVS bin(nvs);
+   NVSView   v(bin.Buf(), bin.Len());
+   ASSERT_TRUE(v.IsOK());
+
+   const btUnsigned32bitInt *pu32 = NULL;
+   btcString                 s    = NULL;
+   ASSERT_EQ(ENamedValuesOK, v.GetArray((btNumberKey)5, &pu32));
+   ASSERT_EQ(ENamedValuesOK, v.Get("name", &s));
+   EXPECT_TRUE(reinterpret_cast<const btByte *>(pu32) > bin.Buf());
+   EXPECT_TRUE(reinterpret_cast<const btByte *>(pu32) < bin.Buf() + bin.Len());
+   EXPECT_TRUE(s > bin.Buf());
+   EXPECT_TRUE(s < bin.Buf() + bin.Len());
+
+   // Lookups of missing names and of the wrong type fail as INamedValueSet's do.
+   bt32bitInt i32 = 0;
+   EXPECT_FALSE(v.Has("nope"));
+   EXPECT_FALSE(v.Has((btNumberKey)6));
+   EXPECT_EQ(ENamedValuesNameNotFound, v.Get("nope", &i32));
+   EXPECT_EQ(ENamedValuesBadType, v.Get("name", &i32));
+   EXPECT_EQ(ENamedValuesBadType, v.Get((btNumberKey)5, &s));
+   EXPECT_EQ(ENamedValuesInvalidReadToNull, v.Get("name", (btcString *)NULL));
+   EXPECT_EQ(ENamedValuesIndexOutOfRange, v.GetNameType(2, NULL));
+}
+
+TEST_F(NVSBinary_f, aal0875)
+{
+   // Truncated and corrupted buffers are rejected, or decode to something, without
+   // reading outside of the buffer. A misaligned buffer is refused by NVSView but
+   // decoded by NVSFromBinary().
+
+   NamedValueSet nvs;
+   Fill(nvs);
+   BinaryNVS bin(nvs);
+
+   btWSSize len;
+   for ( len = 0 ; len < bin.Len() ; ++len ) {
+      std::vector< btUnsigned64bitInt > trunc((size_t)(len + 7) / 8 + 1);
+      memcpy(&trunc[0], bin.Buf(), (size_t)len);
+
+      NVSView v(&trunc[0], len);
+      EXPECT_FALSE(v.IsOK()) << len;
+
+      NamedValueSet out;
+      EXPECT_NE(ENamedValuesOK, NVSFromBinary(out, &trunc[0], len)) << len;
+   }
+
+   btUnsignedInt iter;
+   btUnsignedInt accepted = 0;
+   for ( iter = 0 ; iter < 5000 ; ++iter ) {
+      std::vector< btUnsigned64bitInt > bad((size_t)(bin.Len() + 7) / 8);
+      btByte *p = reinterpret_cast<btByte *>(&bad[0]);
+      memcpy(p, bin.Buf(), (size_t)bin.Len());
+
+      btUnsignedInt flips = 1 + Rand(4);
+      while ( flips-- ) {
+         p[Rand((btUnsigned32bitInt)bin.Len())] ^= (btByte)(1 + Rand(255));
+      }
+
+      NVSView v(p, bin.Len());
+      NamedValueSet out;
+      ENamedValues  e = NVSFromBinary(out, p, bin.Len());
+      if ( v.IsOK() ) {
+         // A corruption that leaves the structure intact (a value, or padding) must
+         // still give a view whose walk stays in the buffer.
+         ++accepted;
+         NamedValueSet copy;
+         v.CopyTo(copy);
+      } else {
+         EXPECT_NE(ENamedValuesOK, e) << iter;
+      }
+   }
+   MSG(accepted << " of " << iter << " corrupted buffers were well-formed");
+
+   // Wrong magic and wrong version.
+   std::vector< btUnsigned64bitInt > hdr((size_t)(bin.Len() + 7) / 8);
+   memcpy(&hdr[0], bin.Buf(), (size_t)bin.Len());
+   reinterpret_cast<btByte *>(&hdr[0])[4] = NVS_BINARY_VERSION + 1;
+   EXPECT_FALSE(IsNVSBinary(&hdr[0], bin.Len()));
+   reinterpret_cast<btByte *>(&hdr[0])[4] = NVS_BINARY_VERSION;
+   EXPECT_TRUE(IsNVSBinary(&hdr[0], bin.Len()));
+   reinterpret_cast<btByte *>(&hdr[0])[0] ^= 0xff;
+   EXPECT_FALSE(IsNVSBinary(&hdr[0], bin.Len()));
+
+   // Misaligned.
+   std::vector< btUnsigned64bitInt > mis((size_t)(bin.Len() + 7) / 8 + 1);
+   btByte *pmis = reinterpret_cast<btByte *>(&mis[0]) + 3;
+   memcpy(pmis, bin.Buf(), (size_t)bin.Len());
+   NVSView v(pmis, bin.Len());
+   EXPECT_FALSE(v.IsOK());
+   NamedValueSet out;
+   EXPECT_EQ(ENamedValuesOK, NVSFromBinary(out, pmis, bin.Len()));
+   EXPECT_TRUE(out == nvs);
+
+   // Too deep to encode.
+   NamedValueSet deep;
+   deep.Add("leaf", (btUnsigned32bitInt)0);
+   btUnsignedInt d;
+   for ( d = 0 ; d <= NVS_BINARY_MAX_DEPTH ; ++d ) {
+      NamedValueSet outer;
+      outer.Add("inner", &deep);
+      deep = outer;
+   }
+   EXPECT_EQ((btWSSize)0, NVSBinarySize(deep));
+}
+
+TEST_F(NVSBinary_f, aal0876)
+{
+   // NVSMarshaller sends text, or the binary form when AAL_NVS_WIRE is "binary".
+   // NVSUnMarshaller, and any NamedValueSet built from a buffer, accept both.
+
+   NVSMarshaller m;
+   m.Add("name", "value");
+   m.Add((btNumberKey)7, (bt64bitInt)-7);
+
+   btWSSize  len = 0;
+   btcString buf = m.pmsgp(&len);
+   ASSERT_NE((btcString)NULL, buf);
+   EXPECT_FALSE(IsNVSBinary(buf, len));
+
+   ASSERT_TRUE(Environment::GetObj()->Set("AAL_NVS_WIRE", "binary"));
+   buf = m.pmsgp(&len);
+   Environment::GetObj()->Set("AAL_NVS_WIRE", "text");
+   ASSERT_NE((btcString)NULL, buf);
+   EXPECT_TRUE(IsNVSBinary(buf, len));
+
+   NVSUnMarshaller u;
+   u.importmsg(buf, len);
+   btcString  s   = NULL;
+   bt64bitInt i64 = 0;
+   EXPECT_EQ(ENamedValuesOK, u.Get("name", &s));
+   EXPECT_STREQ("value", s);
+   EXPECT_EQ(ENamedValuesOK, u.Get((btNumberKey)7, &i64));
+   EXPECT_EQ(-7, i64);
+
+   NamedValueSet nvs;
+   nvs.Add("name", "text");
+   std::string text(nvs.ToStr());
+   u.importmsg(text.c_str(), text.length());
+   EXPECT_EQ(ENamedValuesOK, u.Get("name", &s));
+   EXPECT_STREQ("text", s);
+   EXPECT_EQ(ENamedValuesNameNotFound, u.Get((btNumberKey)7, &i64));
+
+   BinaryNVS     bin(nvs);
+   NamedValueSet frombuf(bin.Buf(), bin.Len());
+   EXPECT_TRUE(frombuf == nvs);
+}
+
+TEST_F(NVSBinary_f, aal0877)
+{
+   // Microbenchmark: marshal and unmarshal a manifest-sized NVS through the text and
+   // the binary forms, and look a name up in place.
+
+   NamedValueSet nvs;
+   Fill(nvs);
+   nvs.Add("lookup", (btUnsigned64bitInt)42);
+
+   const btUnsignedInt Iters = 2000;
+   btUnsignedInt       i;
+   btUnsigned64bitInt  val   = 0;
+
+   Timer t0;
+   for ( i = 0 ; i < Iters ; ++i ) {
+      NamedValueSet out;
+      std::string   text(nvs.ToStr());
+      out.FromStr(const_cast<char *>(text.c_str()), text.length());
+   }
+   Timer t1;
+   for ( i = 0 ; i < Iters ; ++i ) {
+      NamedValueSet out;
+      BinaryNVS     bin(nvs);
+      NVSFromBinary(out, bin.Buf(), bin.Len());
+   }
+   Timer t2;
+   BinaryNVS bin(nvs);
+   for ( i = 0 ; i < Iters ; ++i ) {
+      NVSView v(bin.Buf(), bin.Len());
+      v.Get("lookup", &val);
+   }
+   Timer t3;
+
+   EXPECT_EQ(42, val);
+
+   double text   = 0.0;
+   double binary = 0.0;
+   double view   = 0.0;
+   (t1 - t0).AsNanoSeconds(text);
+   (t2 - t1).AsNanoSeconds(binary);
+   (t3 - t2).AsNanoSeconds(view);
+
+   MSG(bin.Len() << " bytes binary, " << nvs.ToStr().length() << " bytes text");
+   MSG("round trip: text " << text / Iters / 1000.0 << " us, binary " << binary / Iters / 1000.0 <<
+       " us; validate + lookup in place " << view / Iters / 1000.0 << " us");
+}
+
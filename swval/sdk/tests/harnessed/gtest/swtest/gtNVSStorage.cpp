@@ -0,0 +1,258 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
+#include <map>
+
+class NVSStorage_f : public ::testing::Test
+{
+public:
+   NVSStorage_f() :
+      m_Seed(0)
+   {}
+
+   virtual void SetUp() { m_Seed = GlobalTestConfig::GetInstance().RandSeed(); }
+
+   btUnsigned32bitInt Rand(btUnsigned32bitInt mod) { return GetRand(&m_Seed) % mod; }
+
+   static std::string StringKey(btUnsignedInt i)
+   {
+      std::ostringstream oss;
+      oss << "name" << i;
+      return oss.str();
+   }
+
+   // Every name of the reference is in nvs, in key order, with its value.
+   void ExpectSame(const NamedValueSet &nvs)
+   {
+      btUnsignedInt n = 0;
+      btUnsignedInt i;
+
+      EXPECT_EQ(ENamedValuesOK, nvs.GetNumNames(&n));
+      ASSERT_EQ(m_iRef.size() + m_sRef.size(), n);
+
+      btUnsigned64bitInt val;
+      btNumberKey        iName;
+      btStringKey        sName;
+
+      std::map<btNumberKey, btUnsigned64bitInt>::const_iterator iitr = m_iRef.begin();
+      for ( i = 0 ; i < m_iRef.size() ; ++i, ++iitr ) {
+         EXPECT_EQ(ENamedValuesOK, nvs.GetName(i, &iName));
+         EXPECT_EQ(iitr->first, iName);
+         EXPECT_TRUE(nvs.Has(iName));
+         EXPECT_EQ(ENamedValuesOK, nvs.Get(iName, &val));
+         EXPECT_EQ(iitr->second, val);
+      }
+
+      std::map<std::string, btUnsigned64bitInt>::const_iterator sitr = m_sRef.begin();
+      for ( ; i < n ; ++i, ++sitr ) {
+         EXPECT_EQ(ENamedValuesOK, nvs.GetName(i, &sName));
+         EXPECT_STREQ(sitr->first.c_str(), sName);
+         EXPECT_TRUE(nvs.Has(sName));
+         EXPECT_EQ(ENamedValuesOK, nvs.Get(sName, &val));
+         EXPECT_EQ(sitr->second, val);
+      }
+   }
+
+   // Random names, a few of them repeated, added in random order.
+   void Fill(NamedValueSet &nvs, btUnsignedInt Names)
+   {
+      btUnsignedInt i;
+      for ( i = 0 ; i < Names ; ++i ) {
+         btUnsigned64bitInt val = GetRand(&m_Seed);
+         if ( Rand(2) ) {
+            btNumberKey Name = Rand(2 * Names);
+            EXPECT_EQ(m_iRef.end() == m_iRef.find(Name) ? ENamedValuesOK : ENamedValuesDuplicateName,
+                      nvs.Add(Name, val));
+            m_iRef.insert(std::make_pair(Name, val));
+         } else {
+            std::string Name = StringKey(Rand(2 * Names));
+            EXPECT_EQ(m_sRef.end() == m_sRef.find(Name) ? ENamedValuesOK : ENamedValuesDuplicateName,
+                      nvs.Add(Name.c_str(), val));
+            m_sRef.insert(std::make_pair(Name, val));
+         }
+      }
+   }
+
+   btUnsigned32bitInt                         m_Seed;
+   std::map<btNumberKey, btUnsigned64bitInt> m_iRef;
+   std::map<std::string, btUnsigned64bitInt> m_sRef;
+};
+
+TEST_F(NVSStorage_f, aal0878)
+{
+   // Sets that grow through and shrink back across the small-set size keep their names
+   // in key order, and copies, ==, and Subset agree with the reference.
+
+   btUnsignedInt Names;
+   for ( Names = 0 ; Names <= 96 ; Names += 1 + Rand(6) ) {
+      m_iRef.clear();
+      m_sRef.clear();
+
+      NamedValueSet nvs;
+      Fill(nvs, Names);
+      ExpectSame(nvs);
+
+      NamedValueSet copy(nvs);
+      EXPECT_TRUE(copy == nvs);
+      EXPECT_TRUE(nvs.Subset(copy));
+
+      NamedValueSet assigned;
+      assigned.Add("stale", (btUnsigned64bitInt)1);
+      assigned = nvs;
+      EXPECT_TRUE(assigned == nvs);
+
+      // Delete about half of the names, in random order.
+      btUnsignedInt n = (btUnsignedInt)m_iRef.size();
+      while ( n-- ) {
+         std::map<btNumberKey, btUnsigned64bitInt>::iterator itr = m_iRef.begin();
+         std::advance(itr, Rand((btUnsignedInt)m_iRef.size()));
+         if ( Rand(2) ) {
+            EXPECT_EQ(ENamedValuesOK, nvs.Delete(itr->first));
+            EXPECT_EQ(ENamedValuesNameNotFound, nvs.Delete(itr->first));
+            m_iRef.erase(itr);
+         }
+      }
+      n = (btUnsignedInt)m_sRef.size();
+      while ( n-- ) {
+         std::map<std::string, btUnsigned64bitInt>::iterator itr = m_sRef.begin();
+         std::advance(itr, Rand((btUnsignedInt)m_sRef.size()));
+         if ( Rand(2) ) {
+            EXPECT_EQ(ENamedValuesOK, nvs.Delete(itr->first.c_str()));
+            EXPECT_FALSE(nvs.Has(itr->first.c_str()));
+            m_sRef.erase(itr);
+         }
+      }
+      ExpectSame(nvs);
+
+      EXPECT_TRUE(nvs.Subset(copy));
+      EXPECT_EQ(m_iRef.size() + m_sRef.size() == (size_t)Names, nvs == copy);
+      if ( !(nvs == copy) ) {
+         EXPECT_FALSE(copy.Subset(nvs));
+      }
+
+      // Refill; the deleted names can be added again.
+      Fill(nvs, Names);
+      ExpectSame(nvs);
+
+      EXPECT_EQ(ENamedValuesOK, nvs.Empty());
+      m_iRef.clear();
+      m_sRef.clear();
+      ExpectSame(nvs);
+   }
+}
+
+TEST_F(NVSStorage_f, aal0879)
+{
+   // A string name returned by GetName() remains valid while other names are added and
+   // deleted, including while the set grows past the small-set size.
+
+   NamedValueSet nvs;
+   btStringKey   first = NULL;
+   btUnsignedInt i;
+
+   ASSERT_EQ(ENamedValuesOK, nvs.Add("m", (btUnsigned32bitInt)0));
+   ASSERT_EQ(ENamedValuesOK, nvs.GetName(0, &first));
+   ASSERT_STREQ("m", first);
+
+   for ( i = 0 ; i < 256 ; ++i ) {
+      std::string Name = StringKey(i);
+      EXPECT_EQ(ENamedValuesOK, nvs.Add(Name.c_str(), (btUnsigned32bitInt)i));
+      if ( 0 == i % 3 ) {
+         EXPECT_EQ(ENamedValuesOK, nvs.Delete(Name.c_str()));
+      }
+   }
+
+   EXPECT_STREQ("m", first);
+   EXPECT_TRUE(nvs.Has(first));
+   EXPECT_EQ(ENamedValuesOK, nvs.Delete(first));
+}
+
+TEST_F(NVSStorage_f, aal0880)
+{
+   // Microbenchmark: Add, Get, copy, ==, and Subset on sets of a typical control-path
+   // size and on larger ones.
+
+   const btUnsignedInt Sizes[] = { 4, 12, 24, 64, 256 };
+   btUnsignedInt       s;
+
+   for ( s = 0 ; s < sizeof(Sizes) / sizeof(Sizes[0]) ; ++s ) {
+      const btUnsignedInt Names = Sizes[s];
+      const btUnsignedInt Iters = 40000 / Names;
+      btUnsignedInt       i;
+      btUnsignedInt       j;
+
+      std::vector<std::string> sNames(Names);
+      for ( j = 0 ; j < Names ; ++j ) {
+         // Added out of key order.
+         sNames[j] = StringKey((j * 7919) % Names);
+      }
+
+      NamedValueSet      nvs;
+      btUnsigned64bitInt val = 0;
+      btUnsigned64bitInt sum = 0;
+      btUnsignedInt      hits = 0;
+
+      Timer t0;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         NamedValueSet tmp;
+         for ( j = 0 ; j < Names ; ++j ) {
+            tmp.Add(sNames[j].c_str(), (btUnsigned64bitInt)j);
+         }
+      }
+      Timer t1;
+
+      for ( j = 0 ; j < Names ; ++j ) {
+         nvs.Add(sNames[j].c_str(), (btUnsigned64bitInt)j);
+      }
+
+      Timer t2;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         for ( j = 0 ; j < Names ; ++j ) {
+            nvs.Get(sNames[j].c_str(), &val);
+            sum += val;
+         }
+      }
+      Timer t3;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         NamedValueSet copy(nvs);
+      }
+      Timer t4;
+
+      NamedValueSet copy(nvs);
+      NamedValueSet half;
+      for ( j = 0 ; j < Names ; j += 2 ) {
+         half.Add(sNames[j].c_str(), (btUnsigned64bitInt)j);
+      }
+
+      Timer t5;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         if ( copy == nvs ) { ++hits; }
+      }
+      Timer t6;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         if ( half.Subset(nvs) ) { ++hits; }
+      }
+      Timer t7;
+
+      EXPECT_EQ((btUnsigned64bitInt)Iters * Names * (Names - 1) / 2, sum);
+      EXPECT_EQ(2 * Iters, hits);
+
+      double add    = 0.0;
+      double get    = 0.0;
+      double cpy    = 0.0;
+      double eq     = 0.0;
+      double subset = 0.0;
+      (t1 - t0).AsNanoSeconds(add);
+      (t3 - t2).AsNanoSeconds(get);
+      (t4 - t3).AsNanoSeconds(cpy);
+      (t6 - t5).AsNanoSeconds(eq);
+      (t7 - t6).AsNanoSeconds(subset);
+
+      MSG(Names << " names: Add " << add / Iters / Names << " ns/name, Get " <<
+          get / Iters / Names << " ns/name, copy " << cpy / Iters / 1000.0 << " us, == " <<
+          eq / Iters / 1000.0 << " us, Subset " << subset / Iters / 1000.0 << " us");
+   }
+}
@@ -0,0 +1,193 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/ObjectPool.h"
+#include "aalsdk/osal/ThreadGroup.h"
+#include "aalsdk/osal/Timer.h"
+
+// Counts itself when dispatched, then deletes itself, as the runtime's dispatchables do.
+class StormD : public IDispatchable
+{
+public:
+   StormD(CriticalSection &Lock, btUnsignedInt &Count) :
+      m_Lock(Lock),
+      m_Count(Count)
+   {}
+   virtual void operator() ()
+   {
+      {
+         AutoLock(&m_Lock);
+         ++m_Count;
+      }
+      delete this;
+   }
+
+protected:
+   CriticalSection &m_Lock;
+   btUnsignedInt   &m_Count;
+   btUnsigned64bitInt m_Payload[4];
+};
+
+// StormD, allocated from the heap as every dispatchable was before ObjectPool.
+class HeapStormD : public StormD
+{
+public:
+   HeapStormD(CriticalSection &Lock, btUnsignedInt &Count) :
+      StormD(Lock, Count)
+   {}
+
+   static void * operator new(size_t Size)    { return ::operator new(Size); }
+   static void   operator delete(void *p)     { ::operator delete(p);        }
+};
+
+class ObjectPool_f : public ::testing::Test
+{
+public:
+   ObjectPool_f() :
+      m_Count(0)
+   {}
+
+   virtual void SetUp()    { m_Count = 0; }
+
+   // Allocates Items dispatchables of type D on this thread, and has them dispatched
+   // (and deleted) on the thread group's worker, keeping at most about Window of them
+   // in flight. Returns ns/item.
+   template <typename D>
+   double Storm(btUnsignedInt Items, btUnsignedInt Window, btUnsigned64bitInt &HeapAllocs)
+   {
+      OSLThreadGroup tg(1);
+      btUnsignedInt  i;
+
+      m_Count = 0;
+      const btUnsigned64bitInt before = ObjectPool::HeapAllocations();
+
+      Timer start;
+      for ( i = 0 ; i < Items ; ++i ) {
+         EXPECT_TRUE(tg.Add(new D(m_Lock, m_Count)));
+         if ( 0 == ( i % 256 ) ) {
+            YIELD_WHILE(i + 1 - CountIs() > Window);
+         }
+      }
+      YIELD_WHILE(CountIs() < Items);
+      Timer end;
+
+      HeapAllocs = ObjectPool::HeapAllocations() - before;
+
+      double ns = 0.0;
+      (end - start).AsNanoSeconds(ns);
+      return ns / Items;
+   }
+
+   btUnsignedInt CountIs()
+   {
+      AutoLock(&m_Lock);
+      return m_Count;
+   }
+
+   CriticalSection m_Lock;
+   btUnsignedInt   m_Count;
+};
+
+TEST_F(ObjectPool_f, aal0860)
+{
+   // ObjectPool::Free() makes a block the next one allocated, on the same thread, for
+   // any size in its size class. Sizes beyond ObjectPool::MaxObjectSize come from the
+   // heap, and freeing NULL is harmless.
+
+   void *p = ObjectPool::Allocate(40);
+   ASSERT_NONNULL(p);
+   memset(p, 0xa5, 40);
+   ObjectPool::Free(p, 40);
+
+   void *q = ObjectPool::Allocate(33);
+   EXPECT_EQ(p, q);
+   ObjectPool::Free(q, 33);
+
+   void *r = ObjectPool::Allocate(64);
+   EXPECT_NE(p, r);
+   ObjectPool::Free(r, 64);
+
+   void *big = ObjectPool::Allocate(ObjectPool::MaxObjectSize + 1, std::nothrow);
+   ASSERT_NONNULL(big);
+   memset(big, 0, ObjectPool::MaxObjectSize + 1);
+   ObjectPool::Free(big, ObjectPool::MaxObjectSize + 1);
+
+   ObjectPool::Free(NULL, 40);
+
+   // Blocks overflow the thread's cache and come back again.
+   std::vector<void *> v;
+   btUnsignedInt i;
+   for ( i = 0 ; i < 10 * ObjectPool::ThreadCacheDepth ; ++i ) {
+      v.push_back(ObjectPool::Allocate(100));
+      memset(v.back(), (int)i, 100);
+   }
+   for ( i = 0 ; i < v.size() ; ++i ) {
+      ObjectPool::Free(v[i], 100);
+   }
+   const btUnsigned64bitInt before = ObjectPool::HeapAllocations();
+   for ( i = 0 ; i < v.size() ; ++i ) {
+      v[i] = ObjectPool::Allocate(100);
+   }
+   for ( i = 0 ; i < v.size() ; ++i ) {
+      ObjectPool::Free(v[i], 100);
+   }
+   EXPECT_EQ(before, ObjectPool::HeapAllocations());
+}
+
+TEST_F(ObjectPool_f, aal0861)
+{
+   // Once warmed up, creating and deleting events, interface tables included, does
+   // not reach the heap.
+
+   CAASBase base;
+   TransactionID tid;
+   btUnsignedInt i;
+
+   for ( i = 0 ; i < 100 ; ++i ) {
+      CTransactionEvent *pEvent = new CTransactionEvent(&base, tid);
+      EXPECT_TRUE(pEvent->Has(iidTranEvent));
+      pEvent->Delete();
+
+      CExceptionTransactionEvent *pEx = new CExceptionTransactionEvent(&base, tid, errAllocationFailure, reasUnknown, "storm");
+      EXPECT_TRUE(pEx->Has(iidExTranEvent));
+      pEx->Delete();
+   }
+
+   const btUnsigned64bitInt before = ObjectPool::HeapAllocations();
+
+   for ( i = 0 ; i < 10000 ; ++i ) {
+      CTransactionEvent *pEvent = new CTransactionEvent(&base, tid);
+      ASSERT_TRUE(pEvent->IsOK());
+      ASSERT_TRUE(pEvent->Has(iidTranEvent));
+      pEvent->Delete();
+
+      CExceptionTransactionEvent *pEx = new CExceptionTransactionEvent(&base, tid, errAllocationFailure, reasUnknown, "storm");
+      ASSERT_TRUE(pEx->Has(iidExTranEvent));
+      pEx->Delete();
+   }
+
+   EXPECT_EQ(before, ObjectPool::HeapAllocations());
+}
+
+TEST_F(ObjectPool_f, aal0862)
+{
+   // Benchmark: a storm of dispatchables created on one thread and deleted on another,
+   // from ObjectPool and from the heap.
+
+   const btUnsignedInt Items  = 1000000;
+   const btUnsignedInt Window = 1024;
+   btUnsigned64bitInt  pooledHeap = 0;
+   btUnsigned64bitInt  heapHeap   = 0;
+
+   double pooled = Storm<StormD>(Items, Window, pooledHeap);
+   double heap   = Storm<HeapStormD>(Items, Window, heapHeap);
+
+   // The creating thread refills its cache with the blocks the worker hands back, so
+   // only about Window blocks ever come from the heap.
+   EXPECT_LT(pooledHeap, (btUnsigned64bitInt)Items / 10);
+
+   MSG("pooled " << pooled << " ns/item (" << pooledHeap << " heap allocations), heap " <<
+       heap << " ns/item (" << Items << " heap allocations)");
+}
@@ -5,6 +5,7 @@
 #include "gtCommon.h"
 
 #include "dbg_csemaphore.h"
+#include "aalsdk/osal/Timer.h"
 
 TEST(OSAL_Sem, aal0031)
 {
@@ -2240,3 +2241,141 @@ TEST_P(SemWait, CountUp)
 INSTANTIATE_TEST_CASE_P(MySem, SemWait,
                         ::testing::Range(1, 100, 5));
 
+
+
+class OSAL_Sem_Perf_f : public ::testing::TestWithParam< btUnsignedInt >
+{
+protected:
+   enum { Producers = 4, Consumers = 2, PostsPerProducer = 50000, RoundTrips = 20000 };
+
+   OSAL_Sem_Perf_f() :
+      m_Consumed(0)
+   {}
+
+   virtual void SetUp()
+   {
+      m_Consumed = 0;
+      ASSERT_TRUE(m_Sem.Create(0, INT_MAX));
+      ASSERT_TRUE(m_Pong.Create(0, 1));
+      m_Sem.SpinBeforeSleep(GetParam());
+      m_Pong.SpinBeforeSleep(GetParam());
+   }
+   virtual void TearDown()
+   {
+      m_Sem.Destroy();
+      m_Pong.Destroy();
+   }
+
+   static void Producer(OSLThread * , void * );
+   static void Consumer(OSLThread * , void * );
+   static void Ponger(OSLThread * , void * );
+
+   CSemaphore             m_Sem;
+   CSemaphore             m_Pong;
+   volatile btUnsignedInt m_Consumed;
+};
+
+void OSAL_Sem_Perf_f::Producer(OSLThread * , void *pContext)
+{
+   OSAL_Sem_Perf_f *pTC = static_cast<OSAL_Sem_Perf_f *>(pContext);
+   btUnsignedInt i;
+   for ( i = 0 ; i < PostsPerProducer ; ++i ) {
+      EXPECT_TRUE(pTC->m_Sem.Post(1));
+   }
+}
+
+void OSAL_Sem_Perf_f::Consumer(OSLThread * , void *pContext)
+{
+   OSAL_Sem_Perf_f *pTC = static_cast<OSAL_Sem_Perf_f *>(pContext);
+   btUnsignedInt i;
+   for ( i = 0 ; i < ( Producers * PostsPerProducer ) / Consumers ; ++i ) {
+      if ( !pTC->m_Sem.Wait(10000) ) {
+         ADD_FAILURE() << "Wait() timed out after " << i << " counts";
+         return;
+      }
+      __sync_fetch_and_add(&pTC->m_Consumed, 1);
+   }
+}
+
+void OSAL_Sem_Perf_f::Ponger(OSLThread * , void *pContext)
+{
+   OSAL_Sem_Perf_f *pTC = static_cast<OSAL_Sem_Perf_f *>(pContext);
+   btUnsignedInt i;
+   for ( i = 0 ; i < RoundTrips ; ++i ) {
+      ASSERT_TRUE(pTC->m_Sem.Wait());
+      ASSERT_TRUE(pTC->m_Pong.Post(1));
+   }
+}
+
+TEST_P(OSAL_Sem_Perf_f, aal0865)
+{
+   // Concurrent Post() and Wait() callers neither lose nor duplicate counts, whether
+   // waiters spin before sleeping or not. Reports the aggregate throughput.
+
+   OSLThread    *pThrs[Producers + Consumers];
+   btUnsignedInt i;
+
+   Timer start;
+   for ( i = 0 ; i < Consumers ; ++i ) {
+      pThrs[i] = new OSLThread(OSAL_Sem_Perf_f::Consumer, OSLThread::THREADPRIORITY_NORMAL, this);
+   }
+   for ( i = 0 ; i < Producers ; ++i ) {
+      pThrs[Consumers + i] = new OSLThread(OSAL_Sem_Perf_f::Producer, OSLThread::THREADPRIORITY_NORMAL, this);
+   }
+   for ( i = 0 ; i < Producers + Consumers ; ++i ) {
+      pThrs[i]->Join();
+      delete pThrs[i];
+   }
+   Timer end;
+
+   EXPECT_EQ((btUnsignedInt)( Producers * PostsPerProducer ), m_Consumed);
+
+   btInt cur = -1;
+   btInt max = 0;
+   EXPECT_TRUE(m_Sem.CurrCounts(cur, max));
+   EXPECT_EQ(0, cur);
+   EXPECT_EQ(0, m_Sem.NumWaiters());
+
+   double ns = 0.0;
+   (end - start).AsNanoSeconds(ns);
+   MSG("spins " << GetParam() << ": " << ns / ( Producers * PostsPerProducer ) << " ns per Post()/Wait() pair, " <<
+       Producers << " posters, " << Consumers << " waiters");
+}
+
+TEST_P(OSAL_Sem_Perf_f, aal0866)
+{
+   // Microbenchmark: Post()/Wait() on one thread, where Wait() never sleeps, and a
+   // two-thread ping-pong, where it always has to.
+
+   const btUnsignedInt Ops = 1000000;
+   btUnsignedInt i;
+
+   Timer start;
+   for ( i = 0 ; i < Ops ; ++i ) {
+      m_Sem.Post(1);
+      m_Sem.Wait();
+   }
+   Timer mid;
+
+   OSLThread *pThr = new OSLThread(OSAL_Sem_Perf_f::Ponger, OSLThread::THREADPRIORITY_NORMAL, this);
+   Timer ping;
+   for ( i = 0 ; i < RoundTrips ; ++i ) {
+      ASSERT_TRUE(m_Sem.Post(1));
+      ASSERT_TRUE(m_Pong.Wait());
+   }
+   Timer end;
+   pThr->Join();
+   delete pThr;
+
+   double uncontended = 0.0;
+   double roundtrip   = 0.0;
+   (mid - start).AsNanoSeconds(uncontended);
+   (end - ping).AsNanoSeconds(roundtrip);
+
+   MSG("spins " << GetParam() << ": uncontended " << uncontended / Ops << " ns per Post()/Wait(), ping-pong " <<
+       roundtrip / RoundTrips << " ns per round trip");
+}
+
+INSTANTIATE_TEST_CASE_P(My, OSAL_Sem_Perf_f,
+                        ::testing::Values(0, 1000));
+
@@ -3,9 +3,11 @@
 # include <config.h>
 #endif // HAVE_CONFIG_H
 #include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
 
 #ifdef __AAL_LINUX__
 # include <time.h>       // struct timespec, nanosleep()
+# include <sched.h>      // sched_getaffinity()
 #endif // __AAL_LINUX__
 
 
@@ -1573,3 +1575,212 @@ TEST_F(OSAL_Thread_f, aal0202)
 #endif // __AAL_WINDOWS__
 }
 
+
+static void ThrNothing(OSLThread * , void * ) {}
+
+TEST_F(OSAL_Thread_f, aal0868)
+{
+   // Microbenchmark: OSLThread creation and Join(), one thread at a time.
+
+   const btUnsignedInt Threads = 2000;
+   btUnsignedInt i;
+
+   Timer start;
+   for ( i = 0 ; i < Threads ; ++i ) {
+      OSLThread *pThr = new OSLThread(ThrNothing, OSLThread::THREADPRIORITY_NORMAL, this);
+      ASSERT_TRUE(pThr->IsOK());
+      pThr->Join();
+      delete pThr;
+   }
+   Timer end;
+
+   double ns = 0.0;
+   (end - start).AsNanoSeconds(ns);
+   MSG(ns / Threads / 1000.0 << " us per OSLThread create + Join()");
+}
+
+
+TEST(OSAL_ThreadPlacement, aal0869)
+{
+   // CpuSet::FromList() parses the Linux cpulist format, rejecting malformed lists and
+   // CPUs past CpuSet::MaxCpus, and CpuSet::ToList() formats it back, merging ranges.
+
+   CpuSet s;
+   EXPECT_TRUE(s.IsEmpty());
+   EXPECT_EQ(std::string(""), s.ToList());
+
+   EXPECT_TRUE(s.FromList("0-3,8,10-11\n"));
+   EXPECT_EQ(7, s.Count());
+   EXPECT_TRUE(s.Has(0));
+   EXPECT_TRUE(s.Has(3));
+   EXPECT_FALSE(s.Has(4));
+   EXPECT_TRUE(s.Has(8));
+   EXPECT_TRUE(s.Has(11));
+   EXPECT_EQ(std::string("0-3,8,10-11"), s.ToList());
+
+   EXPECT_TRUE(s.FromList("5,4,6,1023"));
+   EXPECT_EQ(std::string("4-6,1023"), s.ToList());
+
+   s.Remove(5);
+   EXPECT_EQ(std::string("4,6,1023"), s.ToList());
+
+   CpuSet t;
+   EXPECT_TRUE(t.FromList("4,6,1023"));
+   EXPECT_TRUE(s == t);
+
+   EXPECT_FALSE(s.FromList("1024"));
+   EXPECT_TRUE(s.IsEmpty());
+   EXPECT_FALSE(s.FromList("3-1"));
+   EXPECT_FALSE(s.FromList("1,,2"));
+   EXPECT_FALSE(s.FromList("1-"));
+   EXPECT_FALSE(s.FromList("a"));
+   EXPECT_FALSE(s.FromList(NULL));
+}
+
+TEST(OSAL_ThreadPlacement, aal0870)
+{
+   // ThreadPlacement::FromString() accepts the AALRUNTIME_CONFIG_THREAD_PLACEMENT forms,
+   // and ThreadPlacement::Resolve() binds only when there are CPUs to bind to.
+
+   ThreadPlacement p;
+   CpuSet          cpus;
+   btInt           node = 7;
+
+   EXPECT_EQ(ThreadPlacement::Anywhere, p.GetPolicy());
+   EXPECT_FALSE(p.Resolve(cpus, node));
+   EXPECT_TRUE(cpus.IsEmpty());
+   EXPECT_EQ(-1, node);
+
+   EXPECT_TRUE(p.FromString("cpus:0,2-3"));
+   EXPECT_EQ(ThreadPlacement::OnCpus, p.GetPolicy());
+   EXPECT_EQ(std::string("cpus:0,2-3"), p.ToString());
+   EXPECT_TRUE(p.Resolve(cpus, node));
+   EXPECT_EQ(std::string("0,2-3"), cpus.ToList());
+   EXPECT_EQ(-1, node);
+
+   EXPECT_TRUE(p.FromString("node:1"));
+   EXPECT_EQ(ThreadPlacement::OnNode, p.GetPolicy());
+   EXPECT_EQ(std::string("node:1"), p.ToString());
+
+   EXPECT_TRUE(p.FromString("near-device"));
+   EXPECT_EQ(ThreadPlacement::NearDevice, p.GetPolicy());
+   EXPECT_EQ(std::string("near-device"), p.ToString());
+
+   EXPECT_TRUE(p.FromString("anywhere"));
+   EXPECT_EQ(ThreadPlacement::Anywhere, p.GetPolicy());
+
+   // Rejected strings leave the placement alone.
+   EXPECT_TRUE(p.FromString("node:0"));
+   EXPECT_FALSE(p.FromString("node:"));
+   EXPECT_FALSE(p.FromString("node:x"));
+   EXPECT_FALSE(p.FromString("cpus:"));
+   EXPECT_FALSE(p.FromString("cpus:2-1"));
+   EXPECT_FALSE(p.FromString("nearby"));
+   EXPECT_FALSE(p.FromString(NULL));
+   EXPECT_EQ(std::string("node:0"), p.ToString());
+
+   // A node that doesn't exist doesn't resolve.
+   EXPECT_FALSE(ThreadPlacement(ThreadPlacement::OnNode, 1023).Resolve(cpus, node));
+   EXPECT_EQ(-1, node);
+
+   // The SDK default starts out anywhere.
+   EXPECT_EQ(ThreadPlacement::Anywhere, ThreadPlacement::SDKDefault().GetPolicy());
+}
+
+#ifdef __AAL_LINUX__
+// Records the CPUs the thread may run on.
+static void ThrAffinity(OSLThread * , void *pContext)
+{
+   cpu_set_t *pcs = reinterpret_cast<cpu_set_t *>(pContext);
+   CPU_ZERO(pcs);
+   sched_getaffinity(0, sizeof(*pcs), pcs);
+}
+
+TEST(OSAL_ThreadPlacement, aal0871)
+{
+   // An OSLThread created with a ThreadPlacement runs only on the CPUs the placement
+   // resolves to. One created without a placement inherits its creator's affinity.
+
+   cpu_set_t mine;
+   CPU_ZERO(&mine);
+   ASSERT_EQ(0, sched_getaffinity(0, sizeof(mine), &mine));
+
+   cpu_set_t cs;
+   CpuSet    cpu0;
+   cpu0.Add(0);
+
+   OSLThread *pThr = new OSLThread(ThrAffinity, OSLThread::THREADPRIORITY_NORMAL, &cs, ThreadPlacement(cpu0));
+   ASSERT_TRUE(pThr->IsOK());
+   pThr->Join();
+   delete pThr;
+
+   EXPECT_EQ(1, CPU_COUNT(&cs));
+   EXPECT_TRUE(CPU_ISSET(0, &cs));
+
+   pThr = new OSLThread(ThrAffinity, OSLThread::THREADPRIORITY_NORMAL, &cs);
+   ASSERT_TRUE(pThr->IsOK());
+   pThr->Join();
+   delete pThr;
+
+   EXPECT_TRUE(CPU_EQUAL(&mine, &cs));
+
+   // node:0, where the machine has a node 0.
+   CpuSet node0;
+   if ( ThreadPlacement::NodeCpus(0, node0) ) {
+      pThr = new OSLThread(ThrAffinity, OSLThread::THREADPRIORITY_NORMAL, &cs, ThreadPlacement(ThreadPlacement::OnNode, 0));
+      ASSERT_TRUE(pThr->IsOK());
+      pThr->Join();
+      delete pThr;
+
+      btUnsignedInt i;
+      for ( i = 0 ; i < CPU_SETSIZE ; ++i ) {
+         EXPECT_EQ(node0.Has(i), 0 != CPU_ISSET(i, &cs)) << i;
+      }
+   }
+}
+
+class ThrAffinityDisp : public IDispatchable
+{
+public:
+   ThrAffinityDisp(cpu_set_t *pcs) : m_pcs(pcs) {}
+   void operator() ()
+   {
+      ThrAffinity(NULL, m_pcs);
+      delete this;
+   }
+protected:
+   cpu_set_t *m_pcs;
+};
+
+TEST(OSAL_ThreadPlacement, aal0872)
+{
+   // Every worker of an OSLThreadGroup created with a ThreadPlacement runs on its CPUs.
+
+   CpuSet cpu0;
+   cpu0.Add(0);
+
+   const btUnsignedInt Workers = 3;
+   cpu_set_t           cs[Workers * 4];
+   btUnsignedInt       i;
+
+   OSLThreadGroup *pGroup = new OSLThreadGroup(Workers,
+                                               Workers,
+                                               OSLThread::THREADPRIORITY_NORMAL,
+                                               AAL_INFINITE_WAIT,
+                                               OSLThreadGroup::SharedQueue,
+                                               ThreadPlacement(cpu0));
+   ASSERT_TRUE(pGroup->IsOK());
+
+   for ( i = 0 ; i < sizeof(cs) / sizeof(cs[0]) ; ++i ) {
+      EXPECT_TRUE(pGroup->Add(new ThrAffinityDisp(&cs[i])));
+   }
+   EXPECT_TRUE(pGroup->Drain());
+   delete pGroup;
+
+   for ( i = 0 ; i < sizeof(cs) / sizeof(cs[0]) ; ++i ) {
+      EXPECT_EQ(1, CPU_COUNT(&cs[i])) << i;
+      EXPECT_TRUE(CPU_ISSET(0, &cs[i])) << i;
+   }
+}
+#endif // __AAL_LINUX__
+
@@ -0,0 +1,421 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtThreadGroup.h"
+#include "aalsdk/osal/Timer.h"
+
+// Counts its executions, and the distinct threads that executed it.
+class CountD : public IDispatchable
+{
+public:
+   CountD(CriticalSection &Lock, AAL::btUnsignedInt &Count, std::set<AAL::btTID> *pThreads=NULL) :
+      m_Lock(Lock),
+      m_Count(Count),
+      m_pThreads(pThreads)
+   {}
+   virtual void operator() ()
+   {
+      AutoLock(&m_Lock);
+      ++m_Count;
+      if ( NULL != m_pThreads ) {
+         m_pThreads->insert(GetThreadID());
+      }
+      delete this;
+   }
+
+protected:
+   CriticalSection      &m_Lock;
+   AAL::btUnsignedInt   &m_Count;
+   std::set<AAL::btTID> *m_pThreads;
+};
+
+// Records its id in execution order.
+class RecordD : public IDispatchable
+{
+public:
+   RecordD(CriticalSection &Lock, std::vector<AAL::btUnsignedInt> &Order, AAL::btUnsignedInt Id) :
+      m_Lock(Lock),
+      m_Order(Order),
+      m_Id(Id)
+   {}
+   virtual void operator() ()
+   {
+      AutoLock(&m_Lock);
+      m_Order.push_back(m_Id);
+      delete this;
+   }
+
+protected:
+   CriticalSection                 &m_Lock;
+   std::vector<AAL::btUnsignedInt> &m_Order;
+   AAL::btUnsignedInt               m_Id;
+};
+
+// Recursive fan-out: each item of depth d > 0 adds Width items of depth d - 1 to the
+// thread group that runs it; leaves spin a little, then count themselves.
+class FanOutD : public IDispatchable
+{
+public:
+   FanOutD(OSLThreadGroup *pTG, AAL::btUnsignedInt Depth, AAL::btUnsignedInt Width,
+           CriticalSection &Lock, AAL::btUnsignedInt &Leaves, AAL::btUnsignedInt SpinLeaf=0) :
+      m_pTG(pTG),
+      m_Depth(Depth),
+      m_Width(Width),
+      m_Lock(Lock),
+      m_Leaves(Leaves),
+      m_SpinLeaf(SpinLeaf)
+   {}
+   virtual void operator() ()
+   {
+      if ( 0 == m_Depth ) {
+         volatile AAL::btUnsignedInt spin;
+         for ( spin = 0 ; spin < m_SpinLeaf ; ++spin ) {
+            ;
+         }
+         AutoLock(&m_Lock);
+         ++m_Leaves;
+      } else {
+         AAL::btUnsignedInt i;
+         for ( i = 0 ; i < m_Width ; ++i ) {
+            EXPECT_TRUE(m_pTG->Add(new FanOutD(m_pTG, m_Depth - 1, m_Width, m_Lock, m_Leaves, m_SpinLeaf)));
+         }
+      }
+      delete this;
+   }
+
+protected:
+   OSLThreadGroup     *m_pTG;
+   AAL::btUnsignedInt  m_Depth;
+   AAL::btUnsignedInt  m_Width;
+   CriticalSection    &m_Lock;
+   AAL::btUnsignedInt &m_Leaves;
+   AAL::btUnsignedInt  m_SpinLeaf;
+};
+
+// Adds Count RecordD's, ids 0 .. Count - 1, to the thread group that runs it.
+class AddRecordsD : public IDispatchable
+{
+public:
+   AddRecordsD(OSLThreadGroup *pTG, CriticalSection &Lock, std::vector<AAL::btUnsignedInt> &Order,
+               AAL::btUnsignedInt Count) :
+      m_pTG(pTG),
+      m_Lock(Lock),
+      m_Order(Order),
+      m_Count(Count)
+   {}
+   virtual void operator() ()
+   {
+      AAL::btUnsignedInt i;
+      for ( i = 0 ; i < m_Count ; ++i ) {
+         EXPECT_TRUE(m_pTG->Add(new RecordD(m_Lock, m_Order, i)));
+      }
+      delete this;
+   }
+
+protected:
+   OSLThreadGroup                  *m_pTG;
+   CriticalSection                 &m_Lock;
+   std::vector<AAL::btUnsignedInt> &m_Order;
+   AAL::btUnsignedInt               m_Count;
+};
+
+class OSAL_ThreadGroupWS_f : public ::testing::TestWithParam< AAL::btUnsignedInt >
+{
+protected:
+   OSAL_ThreadGroupWS_f() :
+      m_pGroup(NULL),
+      m_Count(0),
+      m_Leaves(0)
+   {}
+
+   virtual void SetUp()
+   {
+      m_Count  = 0;
+      m_Leaves = 0;
+      m_Threads.clear();
+      m_Order.clear();
+   }
+   virtual void TearDown()
+   {
+      if ( NULL != m_pGroup ) {
+         delete m_pGroup;
+         m_pGroup = NULL;
+      }
+
+      unsigned i;
+      for ( i = 0 ; i < sizeof(m_Sems) / sizeof(m_Sems[0]) ; ++i ) {
+         m_Sems[i].Destroy();
+      }
+   }
+
+   OSLThreadGroup * Create(AAL::btUnsignedInt Thrs,
+                           OSLThreadGroup::Scheduling eScheduling=OSLThreadGroup::WorkStealing)
+   {
+      return m_pGroup = new OSLThreadGroup(Thrs,
+                                           Thrs,
+                                           OSLThread::THREADPRIORITY_NORMAL,
+                                           AAL_INFINITE_WAIT,
+                                           eScheduling);
+   }
+
+   OSLThreadGroup                 *m_pGroup;
+   CriticalSection                 m_Lock;
+   AAL::btUnsignedInt              m_Count;
+   AAL::btUnsignedInt              m_Leaves;
+   std::set<AAL::btTID>            m_Threads;
+   std::vector<AAL::btUnsignedInt> m_Order;
+   CSemaphore                      m_Sems[2];
+};
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0849)
+{
+   // Every work item added from outside a WorkStealing OSLThreadGroup is executed exactly
+   // once. Drain() empties every worker's queues.
+
+   const AAL::btUnsignedInt Thrs  = GetParam();
+   const AAL::btUnsignedInt Items = 10000;
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_TRUE(g->IsOK());
+   EXPECT_EQ(Thrs, g->GetNumThreads());
+
+   AAL::btUnsignedInt i;
+   for ( i = 0 ; i < Items ; ++i ) {
+      ASSERT_TRUE(g->Add(new CountD(m_Lock, m_Count, &m_Threads)));
+   }
+
+   EXPECT_TRUE(g->Drain());
+   EXPECT_EQ(0, g->GetNumWorkItems());
+
+   // Once drained, the thread group accepts work again.
+   EXPECT_TRUE(g->Add(new CountD(m_Lock, m_Count)));
+   EXPECT_TRUE(g->Drain());
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+   EXPECT_EQ(Items + 1, m_Count);
+   EXPECT_EQ(0, g->GetNumThreads());
+}
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0850)
+{
+   // Work items added by a worker go to that worker's own deque and are executed newest
+   // first. Work items spawned recursively from within the thread group are all executed
+   // before Drain() and Join() return.
+
+   const AAL::btUnsignedInt Thrs = GetParam();
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_TRUE(g->IsOK());
+
+   if ( 1 == Thrs ) {
+      // With no thieves, the order is exactly LIFO.
+      ASSERT_TRUE(g->Add(new AddRecordsD(g, m_Lock, m_Order, 8)));
+      EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+
+      ASSERT_EQ(8, m_Order.size());
+      AAL::btUnsignedInt i;
+      for ( i = 0 ; i < 8 ; ++i ) {
+         EXPECT_EQ(7 - i, m_Order[i]);
+      }
+
+      delete m_pGroup;
+      g = Create(Thrs);
+      ASSERT_TRUE(g->IsOK());
+   }
+
+   // 8^4 leaves.
+   ASSERT_TRUE(g->Add(new FanOutD(g, 4, 8, m_Lock, m_Leaves)));
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+   EXPECT_EQ(4096, m_Leaves);
+}
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0851)
+{
+   // Stop() deletes the work items still queued in any worker's deque or inbox, without
+   // executing them, and rejects Add()'s until Start().
+
+   const AAL::btUnsignedInt Thrs = GetParam();
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_TRUE(g->IsOK());
+
+   ASSERT_TRUE(m_Sems[0].Create(0, INT_MAX));
+   ASSERT_TRUE(m_Sems[1].Create(0, INT_MAX));
+
+   // Park every worker.
+   PostThenWaitD **parked = new PostThenWaitD *[Thrs];
+   AAL::btUnsignedInt i;
+   for ( i = 0 ; i < Thrs ; ++i ) {
+      parked[i] = new PostThenWaitD(m_Sems[0], m_Sems[1]);
+      ASSERT_TRUE(g->Add(parked[i]));
+   }
+   for ( i = 0 ; i < Thrs ; ++i ) {
+      EXPECT_TRUE(m_Sems[0].Wait());
+   }
+
+   for ( i = 0 ; i < 100 ; ++i ) {
+      ASSERT_TRUE(g->Add(new CountD(m_Lock, m_Count)));
+   }
+   EXPECT_EQ(100, g->GetNumWorkItems());
+
+   g->Stop();
+   EXPECT_EQ(0, g->GetNumWorkItems());
+
+   CountD *pRejected = new CountD(m_Lock, m_Count);
+   EXPECT_FALSE(g->Add(pRejected));
+   delete pRejected;
+
+   EXPECT_TRUE(m_Sems[1].Post(Thrs));
+
+   EXPECT_TRUE(g->Start());
+   ASSERT_TRUE(g->Add(new CountD(m_Lock, m_Count)));
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+   EXPECT_EQ(1, m_Count);
+
+   for ( i = 0 ; i < Thrs ; ++i ) {
+      delete parked[i];
+   }
+   delete[] parked;
+}
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0852)
+{
+   // A worker's deque is stolen from by idle workers: the children that one work item
+   // adds are executed by more than one thread.
+
+   const AAL::btUnsignedInt Thrs = GetParam();
+   if ( Thrs < 2 ) {
+      return;
+   }
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_TRUE(g->IsOK());
+
+   class AddSlowCountsD : public IDispatchable
+   {
+   public:
+      AddSlowCountsD(OSLThreadGroup *pTG, IDispatchable **pItems, AAL::btUnsignedInt Count) :
+         m_pTG(pTG),
+         m_pItems(pItems),
+         m_Count(Count)
+      {}
+      virtual void operator() ()
+      {
+         AAL::btUnsignedInt i;
+         for ( i = 0 ; i < m_Count ; ++i ) {
+            EXPECT_TRUE(m_pTG->Add(m_pItems[i]));
+         }
+         delete this;
+      }
+      OSLThreadGroup     *m_pTG;
+      IDispatchable     **m_pItems;
+      AAL::btUnsignedInt  m_Count;
+   };
+
+   class SleepThenCountD : public CountD
+   {
+   public:
+      SleepThenCountD(CriticalSection &Lock, AAL::btUnsignedInt &Count, std::set<AAL::btTID> *pThreads) :
+         CountD(Lock, Count, pThreads)
+      {}
+      virtual void operator() ()
+      {
+         SleepMilli(1);
+         CountD::operator() ();
+      }
+   };
+
+   const AAL::btUnsignedInt Children = 64;
+   IDispatchable *children[Children];
+   AAL::btUnsignedInt i;
+   for ( i = 0 ; i < Children ; ++i ) {
+      children[i] = new SleepThenCountD(m_Lock, m_Count, &m_Threads);
+   }
+
+   ASSERT_TRUE(g->Add(new AddSlowCountsD(g, children, Children)));
+
+   // (Join() now would let the idle workers exit, leaving no thieves.)
+   YIELD_WHILE(m_Count < Children);
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+
+   EXPECT_EQ(Children, m_Count);
+   EXPECT_LT(1, m_Threads.size());
+}
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0853)
+{
+   // A self-referential Drain() executes the items spread across the workers, and a
+   // self-referential Join() completes the thread group.
+
+   const AAL::btUnsignedInt Thrs = GetParam();
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_TRUE(g->IsOK());
+
+   class AddThenDrainD : public IDispatchable
+   {
+   public:
+      AddThenDrainD(OSLThreadGroup *pTG, CriticalSection &Lock, AAL::btUnsignedInt &Count) :
+         m_pTG(pTG),
+         m_Lock(Lock),
+         m_Count(Count)
+      {}
+      virtual void operator() ()
+      {
+         AAL::btUnsignedInt i;
+         for ( i = 0 ; i < 100 ; ++i ) {
+            EXPECT_TRUE(m_pTG->Add(new CountD(m_Lock, m_Count)));
+         }
+         EXPECT_TRUE(m_pTG->Drain());
+
+         OSLThreadGroup *pTG = m_pTG;
+         delete this;
+         pTG->Join(AAL_INFINITE_WAIT); // does not return.
+      }
+      OSLThreadGroup     *m_pTG;
+      CriticalSection    &m_Lock;
+      AAL::btUnsignedInt &m_Count;
+   };
+
+   ASSERT_TRUE(g->Add(new AddThenDrainD(g, m_Lock, m_Count)));
+
+   YIELD_WHILE(g->GetNumThreads() > 0);
+   EXPECT_EQ(100, m_Count);
+}
+
+TEST_P(OSAL_ThreadGroupWS_f, aal0854)
+{
+   // Microbenchmark: a recursive fan-out of small work items, WorkStealing against
+   // SharedQueue.
+
+   const AAL::btUnsignedInt Thrs  = GetParam();
+   const AAL::btUnsignedInt Depth = 5;
+   const AAL::btUnsignedInt Width = 10;   // 100k leaves
+   double ns[2] = { 0.0, 0.0 };
+
+   OSLThreadGroup::Scheduling sched[2] = { OSLThreadGroup::SharedQueue, OSLThreadGroup::WorkStealing };
+   AAL::btUnsignedInt s;
+   for ( s = 0 ; s < 2 ; ++s ) {
+      OSLThreadGroup *g = Create(Thrs, sched[s]);
+      ASSERT_TRUE(g->IsOK());
+
+      m_Leaves = 0;
+
+      Timer start;
+      ASSERT_TRUE(g->Add(new FanOutD(g, Depth, Width, m_Lock, m_Leaves, 200)));
+      EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+      Timer end;
+
+      EXPECT_EQ(100000, m_Leaves);
+      (end - start).AsNanoSeconds(ns[s]);
+
+      delete m_pGroup;
+      m_pGroup = NULL;
+   }
+
+   MSG(Thrs << " threads: SharedQueue " << ns[0] / 111111 << " ns/item, WorkStealing " <<
+       ns[1] / 111111 << " ns/item");
+}
+
+INSTANTIATE_TEST_CASE_P(My, OSAL_ThreadGroupWS_f, ::testing::Values(1, 2, 4, 8));
+
@@ -3,6 +3,7 @@
 # include <config.h>
 #endif // HAVE_CONFIG_H
 #include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -465,3 +466,153 @@ TEST(TransactionIDTest, aal0782)
    EXPECT_TRUE(lhs == rhs);
 }
 
+
+class TransactionIDStress_f : public ::testing::TestWithParam< btUnsignedInt >
+{
+public:
+   enum { MaxThreads = 8 };
+
+   TransactionIDStress_f() :
+      m_PerThread(0),
+      m_Running(0),
+      m_Go(false)
+   {}
+
+   // Each thread records the system assigned IDs of PerThread default-constructed
+   //  TransactionID's.
+   struct Worker
+   {
+      TransactionIDStress_f *m_pFixture;
+      std::vector<btID>      m_IDs;
+   };
+
+   static void Thr(OSLThread * , void *pArg)
+   {
+      Worker                *w = reinterpret_cast<Worker *>(pArg);
+      TransactionIDStress_f *f = w->m_pFixture;
+      btUnsignedInt          i;
+
+      w->m_IDs.reserve(f->m_PerThread);
+
+      {
+         AutoLock(&f->m_Lock);
+         ++f->m_Running;
+      }
+      YIELD_WHILE(!f->m_Go);
+
+      for ( i = 0 ; i < f->m_PerThread ; ++i ) {
+         TransactionID tid;
+         w->m_IDs.push_back(tid.ID());
+      }
+   }
+
+   // Runs GetParam() workers of PerThread TransactionID's each, returning the wall
+   //  clock ns per TransactionID, across all of them.
+   double Run(btUnsignedInt PerThread)
+   {
+      const btUnsignedInt Threads = GetParam();
+      OSLThread          *pThrs[MaxThreads];
+      btUnsignedInt       t;
+
+      m_PerThread = PerThread;
+      m_Running   = 0;
+      m_Go        = false;
+
+      for ( t = 0 ; t < Threads ; ++t ) {
+         m_Workers[t].m_pFixture = this;
+         m_Workers[t].m_IDs.clear();
+         pThrs[t] = new OSLThread(TransactionIDStress_f::Thr, OSLThread::THREADPRIORITY_NORMAL, &m_Workers[t]);
+         EXPECT_TRUE(pThrs[t]->IsOK());
+      }
+
+      YIELD_WHILE(Running() < Threads);
+
+      Timer start;
+      m_Go = true;
+      for ( t = 0 ; t < Threads ; ++t ) {
+         pThrs[t]->Join();
+      }
+      Timer end;
+
+      for ( t = 0 ; t < Threads ; ++t ) {
+         delete pThrs[t];
+      }
+
+      double ns = 0.0;
+      (end - start).AsNanoSeconds(ns);
+      return ns / ( (double)Threads * PerThread );
+   }
+
+   btUnsignedInt Running()
+   {
+      AutoLock(&m_Lock);
+      return m_Running;
+   }
+
+   btUnsignedInt   m_PerThread;
+   btUnsignedInt   m_Running;
+   volatile btBool m_Go;
+   CriticalSection m_Lock;
+   Worker          m_Workers[MaxThreads];
+};
+
+TEST_P(TransactionIDStress_f, aal0863)
+{
+   // System assigned TransactionID ID's are unique across threads, and increase
+   // within each thread.
+
+   Run(100000);
+
+   std::set<btID> all;
+   btUnsignedInt  t;
+   btUnsignedInt  i;
+   for ( t = 0 ; t < GetParam() ; ++t ) {
+      std::vector<btID> const &ids = m_Workers[t].m_IDs;
+      ASSERT_EQ(m_PerThread, ids.size());
+      for ( i = 0 ; i < ids.size() ; ++i ) {
+         if ( i > 0 ) {
+            ASSERT_LT(ids[i - 1], ids[i]) << "thread " << t;
+         }
+         all.insert(ids[i]);
+      }
+   }
+
+   EXPECT_EQ((size_t)GetParam() * m_PerThread, all.size());
+}
+
+TEST_P(TransactionIDStress_f, aal0864)
+{
+   // Throughput: system assigned TransactionID construction on GetParam() threads,
+   // and single-threaded copy and compare.
+
+   double ctor = Run(1000000);
+
+   const btUnsignedInt N = 10000000;
+   CAASBase            base;
+   TransactionID       src(&base);
+   TransactionID       dst;
+   btUnsignedInt       equal = 0;
+   btUnsignedInt       i;
+
+   Timer start;
+   for ( i = 0 ; i < N ; ++i ) {
+      dst = src;
+      if ( dst == src ) {
+         ++equal;
+      }
+      dst.ID(i);
+      if ( dst == src ) {
+         ++equal;
+      }
+   }
+   Timer end;
+
+   EXPECT_LE(N, equal);
+
+   double copy = 0.0;
+   (end - start).AsNanoSeconds(copy);
+
+   MSG(GetParam() << " threads: " << ctor << " ns/TransactionID(), copy + 2 compares " << copy / N << " ns");
+}
+
+INSTANTIATE_TEST_CASE_P(My, TransactionIDStress_f, ::testing::Values(1, 2, 4, 8));
@@ -0,0 +1,292 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/utils/UMsgRing.h"
+#include "aalsdk/osal/Timer.h"
+#include <set>
+
+// IALIUMsg over a plain memory buffer, laid out as the driver lays out the UMsg region
+// (one line per page + 1 cache line), counting the calls made through the interface.
+class MemoryALIUMsg : public IALIUMsg, public CriticalSection
+{
+public:
+   enum {
+      Number = 8,
+      Stride = 4096 + 64
+   };
+
+   MemoryALIUMsg(btBool Direct) :
+      m_Direct(Direct),
+      m_GetNumber(0),
+      m_GetAddress(0),
+      m_Triggers(0),
+      m_Bits(0),
+      m_LastValue(0),
+      m_pLastUMsg(NULL),
+      m_Region(reinterpret_cast<btVirtAddr>((reinterpret_cast<btUIntPtr>(m_Storage) + 63) & ~(btUIntPtr)63))
+   {
+      memset(m_Region, 0, Number * Stride);
+   }
+
+   virtual btUnsignedInt umsgGetNumber( void ) { ++m_GetNumber; return Number; }
+   virtual btVirtAddr    umsgGetAddress( const btUnsignedInt UMsgNumber )
+   {
+      ++m_GetAddress;
+      return ( UMsgNumber < Number ) ? m_Region + UMsgNumber * Stride : NULL;
+   }
+   virtual void          umsgTrigger64( const btVirtAddr pUMsg, const btUnsigned64bitInt Value )
+   {
+      AutoLock(this);
+      ++m_Triggers;
+      m_Bits      |= (btUnsigned32bitInt)Value;
+      m_LastValue  = Value;
+      m_pLastUMsg  = pUMsg;
+   }
+   virtual btBool        umsgIsDirect( void ) { return m_Direct; }
+   virtual bool          umsgSetAttributes( NamedValueSet const & ) { return true; }
+
+   btUnsigned64bitInt QWord(btUnsignedInt UMsg, btUnsignedInt i) const
+   {
+      return reinterpret_cast<const btUnsigned64bitInt *>(m_Region + UMsg * Stride)[i];
+   }
+
+   btBool             m_Direct;
+   btUnsignedInt      m_GetNumber;
+   btUnsignedInt      m_GetAddress;
+   btUnsignedInt      m_Triggers;
+   btUnsigned32bitInt m_Bits;
+   btUnsigned64bitInt m_LastValue;
+   btVirtAddr         m_pLastUMsg;
+   btByte             m_Storage[Number * Stride + 64];
+   btVirtAddr         m_Region;
+};
+
+class UMsgRing_f : public ::testing::TestWithParam< btBool >
+{
+public:
+   UMsgRing_f() :
+      m_UMsg(true),
+      m_Threads(0)
+   {}
+
+   virtual void SetUp() { m_UMsg.m_Direct = GetParam(); }
+
+   static void ThreadDoorbell(OSLThread *pThread, void *pContext);
+   static void Notifier(OSLThread *pThread, void *pContext);
+
+   MemoryALIUMsg           m_UMsg;
+   UMsgRing                m_Ring;
+   CriticalSection         m_Lock;
+   btUnsignedInt           m_Threads;
+   std::set<btUnsignedInt> m_Doorbells;
+};
+
+void UMsgRing_f::ThreadDoorbell(OSLThread *pThread, void *pContext)
+{
+   UMsgRing_f   *pTest = reinterpret_cast<UMsgRing_f *>(pContext);
+   btUnsignedInt d     = pTest->m_Ring.ThreadDoorbell();
+
+   EXPECT_EQ(d, pTest->m_Ring.ThreadDoorbell());
+
+   AutoLock(&pTest->m_Lock);
+   pTest->m_Doorbells.insert(d);
+}
+
+// Each thread notifies doorbell 0 with its own bit, many times.
+void UMsgRing_f::Notifier(OSLThread *pThread, void *pContext)
+{
+   UMsgRing_f        *pTest = reinterpret_cast<UMsgRing_f *>(pContext);
+   btUnsigned32bitInt bit;
+   {
+      AutoLock(&pTest->m_Lock);
+      bit = 1 << pTest->m_Threads++;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 10000 ; ++i ) {
+      pTest->m_Ring.Notify(0, bit);
+   }
+}
+
+TEST_P(UMsgRing_f, aal0844)
+{
+   // UMsgRing::Init() obtains the number and address of the UMsgs once. Nothing after
+   // it goes through IALIUMsg, except umsgTrigger64() when the UMsgs are not direct.
+
+   UMsgRing none;
+   EXPECT_FALSE(none.IsOK());
+   EXPECT_FALSE(none.Init(NULL));
+
+   ASSERT_TRUE(m_Ring.Init(&m_UMsg));
+   EXPECT_TRUE(m_Ring.IsOK());
+   EXPECT_EQ(GetParam(), m_Ring.IsDirect());
+   EXPECT_EQ((btUnsignedInt)MemoryALIUMsg::Number, m_Ring.Doorbells());
+   EXPECT_EQ(1, m_UMsg.m_GetNumber);
+   EXPECT_EQ((btUnsignedInt)MemoryALIUMsg::Number, m_UMsg.m_GetAddress);
+
+   EXPECT_FALSE(m_Ring.Init(&m_UMsg));
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 100 ; ++i ) {
+      EXPECT_TRUE(m_Ring.Notify(i % m_Ring.Doorbells(), 1));
+   }
+   EXPECT_EQ(1, m_UMsg.m_GetNumber);
+   EXPECT_EQ((btUnsignedInt)MemoryALIUMsg::Number, m_UMsg.m_GetAddress);
+   EXPECT_EQ(GetParam() ? 0 : 100, m_UMsg.m_Triggers);
+
+   UMsgRing two;
+   ASSERT_TRUE(two.Init(&m_UMsg, 2));
+   EXPECT_EQ(2, two.Doorbells());
+}
+
+TEST_P(UMsgRing_f, aal0845)
+{
+   // Bits posted to a doorbell are sent together by the next Flush(), as one line
+   // carrying the doorbell's write sequence number. A Flush() with nothing pending
+   // sends nothing.
+
+   ASSERT_TRUE(m_Ring.Init(&m_UMsg));
+
+   m_Ring.Post(3, 0x1);
+   m_Ring.Post(3, 0x4);
+   m_Ring.Post(3, 0x4);
+   m_Ring.Post(3, 0x100);
+   EXPECT_EQ(4, m_Ring.Posts(3));
+   EXPECT_EQ(0, m_Ring.Rings(3));
+
+   EXPECT_TRUE(m_Ring.Flush(3));
+   EXPECT_FALSE(m_Ring.Flush(3));
+   EXPECT_EQ(1, m_Ring.Rings(3));
+
+   const btUnsigned64bitInt first = UMsgRing::LineValue(1, 0x105);
+   if ( GetParam() ) {
+      EXPECT_EQ(first, m_UMsg.QWord(3, 0));
+      btUnsignedInt i;
+      for ( i = 1 ; i < UMsgRing::LineQWords ; ++i ) {
+         EXPECT_EQ(0, m_UMsg.QWord(3, i)) << i;
+      }
+      EXPECT_EQ(0, m_UMsg.m_Triggers);
+   } else {
+      EXPECT_EQ(1,     m_UMsg.m_Triggers);
+      EXPECT_EQ(first, m_UMsg.m_LastValue);
+      EXPECT_EQ(m_UMsg.m_Region + 3 * MemoryALIUMsg::Stride, m_UMsg.m_pLastUMsg);
+   }
+
+   // The same bits again make a different line.
+   EXPECT_TRUE(m_Ring.Notify(3, 0x105));
+   const btUnsigned64bitInt second = UMsgRing::LineValue(2, 0x105);
+   EXPECT_NE(first, second);
+   EXPECT_EQ(second, GetParam() ? m_UMsg.QWord(3, 0) : m_UMsg.m_LastValue);
+
+   // Other doorbells are untouched.
+   EXPECT_EQ(0, m_Ring.Posts(2));
+   EXPECT_EQ(0, m_UMsg.QWord(2, 0));
+
+   m_Ring.ResetCounters();
+   EXPECT_EQ(0, m_Ring.Posts(3));
+   EXPECT_EQ(0, m_Ring.Rings(3));
+}
+
+TEST_P(UMsgRing_f, aal0846)
+{
+   // UMsgRing::ThreadDoorbell() gives each thread a doorbell of its own, as long as
+   // there are enough, and the same one on every call.
+
+   ASSERT_TRUE(m_Ring.Init(&m_UMsg));
+
+   const btUnsignedInt T = MemoryALIUMsg::Number;
+   OSLThread          *pThrs[T];
+   btUnsignedInt       i;
+
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i] = new OSLThread(UMsgRing_f::ThreadDoorbell,
+                               OSLThread::THREADPRIORITY_NORMAL,
+                               this);
+      EXPECT_TRUE(pThrs[i]->IsOK());
+   }
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i]->Join();
+      delete pThrs[i];
+   }
+
+   EXPECT_EQ(T, m_Doorbells.size());
+
+   // A thread's doorbell is per ring.
+   UMsgRing two;
+   ASSERT_TRUE(two.Init(&m_UMsg, 2));
+   EXPECT_GT(2, two.ThreadDoorbell());
+   EXPECT_EQ(two.ThreadDoorbell(), two.ThreadDoorbell());
+   EXPECT_EQ(m_Ring.ThreadDoorbell(), m_Ring.ThreadDoorbell());
+}
+
+TEST_P(UMsgRing_f, aal0847)
+{
+   // Threads notifying the same doorbell concurrently lose no bits: every bit posted
+   // is in some line written, and no line is written without bits.
+
+   ASSERT_TRUE(m_Ring.Init(&m_UMsg));
+
+   const btUnsignedInt T = 8;
+   OSLThread          *pThrs[T];
+   btUnsignedInt       i;
+
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i] = new OSLThread(UMsgRing_f::Notifier,
+                               OSLThread::THREADPRIORITY_NORMAL,
+                               this);
+      EXPECT_TRUE(pThrs[i]->IsOK());
+   }
+   for ( i = 0 ; i < T ; ++i ) {
+      pThrs[i]->Join();
+      delete pThrs[i];
+   }
+
+   EXPECT_EQ(T * 10000, m_Ring.Posts(0));
+   EXPECT_GE(m_Ring.Posts(0), m_Ring.Rings(0));
+   EXPECT_LT(0, m_Ring.Rings(0));
+   EXPECT_FALSE(m_Ring.Flush(0));
+
+   if ( !GetParam() ) {
+      EXPECT_EQ((btUnsigned32bitInt)0xff, m_UMsg.m_Bits);
+      EXPECT_EQ(m_Ring.Rings(0), m_UMsg.m_Triggers);
+   }
+
+   MSG((GetParam() ? "direct" : "indirect") << ": " << m_Ring.Posts(0) << " posts, " <<
+       m_Ring.Rings(0) << " UMsgs");
+}
+
+TEST_P(UMsgRing_f, aal0848)
+{
+   // Microbenchmark: UMsgRing::Notify() of the thread's doorbell, against
+   // IALIUMsg::umsgTrigger64() of a cached address.
+
+   const btUnsignedInt Notifies = 1000000;
+   btUnsignedInt       i;
+
+   ASSERT_TRUE(m_Ring.Init(&m_UMsg));
+   btVirtAddr pUMsg = m_UMsg.umsgGetAddress(0);
+   IALIUMsg  *pIf   = &m_UMsg;
+
+   Timer start;
+   for ( i = 0 ; i < Notifies ; ++i ) {
+      m_Ring.Notify(1);
+   }
+   Timer mid;
+   for ( i = 0 ; i < Notifies ; ++i ) {
+      pIf->umsgTrigger64(pUMsg, i);
+   }
+   Timer end;
+
+   double ring = 0.0;
+   double trig = 0.0;
+   (mid - start).AsNanoSeconds(ring);
+   (end - mid).AsNanoSeconds(trig);
+
+   MSG((GetParam() ? "direct" : "indirect") << ": UMsgRing " << ring / Notifies <<
+       " ns/notify, umsgTrigger64 " << trig / Notifies << " ns/trigger");
+}
+
+INSTANTIATE_TEST_CASE_P(My, UMsgRing_f, ::testing::Bool());
+
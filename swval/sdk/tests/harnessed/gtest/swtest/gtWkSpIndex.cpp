@@ -0,0 +1,235 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/utils/AALWorkSpaceUtilities.h"
+#include "aalsdk/osal/Timer.h"
+
+// Workspaces are laid out at synthetic addresses (nothing is dereferenced), one per
+// Stride bytes, each Len bytes long, leaving a hole between consecutive workspaces.
+static const btUnsigned64bitInt Base   = 0x100000000ULL;
+static const btWSSize           Len    = 0x3000;
+static const btWSSize           Stride = 0x4000;
+static const btPhysAddr         IOVA   = 0x80000000ULL;
+
+class WorkSpaceIndex_f : public ::testing::Test
+{
+public:
+   WorkSpaceIndex_f() {}
+
+   virtual void SetUp()    { m_Seed = 0xdeadbeef; }
+   virtual void TearDown() { m_Ref.clear();       }
+
+   btVirtAddr Ptr(btUnsigned32bitInt i) const
+   {
+      return reinterpret_cast<btVirtAddr>(Base + (btUnsigned64bitInt)i * Stride);
+   }
+   btPhysAddr Phys(btUnsigned32bitInt i) const
+   {
+      // Deliberately not monotonic in i, so that a lookup that picks the wrong
+      // workspace can not produce the right answer by accident.
+      return IOVA + (btPhysAddr)((i * 7919) % 100003) * Stride;
+   }
+
+   void Populate(btUnsigned32bitInt n)
+   {
+      btUnsigned32bitInt i;
+      for ( i = 0 ; i < n ; ++i ) {
+         ASSERT_TRUE(m_Index.Add(Ptr(i), Len, Phys(i), (btWSID)i));
+         m_Ref[Ptr(i)] = Phys(i);
+      }
+   }
+
+   // The lookup that CHWALIAFU::bufferGetIOVA() used to do: exact find, then a
+   // linear walk of the map.
+   btPhysAddr LinearGetIOVA(btVirtAddr p) const
+   {
+      std::map<btVirtAddr, btPhysAddr>::const_iterator itr = m_Ref.find(p);
+      if ( itr != m_Ref.end() ) {
+         return itr->second;
+      }
+      for ( itr = m_Ref.begin() ; itr != m_Ref.end() ; ++itr ) {
+         if ( p < itr->first + Len ) {
+            return itr->second + (p - itr->first);
+         }
+      }
+      return 0;
+   }
+
+   // A random address somewhere inside one of the first n workspaces.
+   btVirtAddr RandomInterior(btUnsigned32bitInt n)
+   {
+      btUnsigned32bitInt i   = GetRand(&m_Seed) % n;
+      btWSSize           off = GetRand(&m_Seed) % Len;
+      return Ptr(i) + off;
+   }
+
+   // Time Lookups GetIOVA() calls on random interior pointers into n workspaces,
+   // returning the mean cost of one lookup in nanoseconds.
+   double TimeIndexed(btUnsigned32bitInt n, btUnsigned32bitInt Lookups)
+   {
+      btUnsigned32bitInt i;
+      btPhysAddr         sum = 0;
+
+      Timer start;
+      for ( i = 0 ; i < Lookups ; ++i ) {
+         sum += m_Index.GetIOVA(RandomInterior(n));
+      }
+      Timer end;
+
+      EXPECT_NE((btPhysAddr)0, sum);
+
+      double ns = 0.0;
+      (end - start).AsNanoSeconds(ns);
+      return ns / Lookups;
+   }
+
+   double TimeLinear(btUnsigned32bitInt n, btUnsigned32bitInt Lookups)
+   {
+      btUnsigned32bitInt i;
+      btPhysAddr         sum = 0;
+
+      Timer start;
+      for ( i = 0 ; i < Lookups ; ++i ) {
+         sum += LinearGetIOVA(RandomInterior(n));
+      }
+      Timer end;
+
+      EXPECT_NE((btPhysAddr)0, sum);
+
+      double ns = 0.0;
+      (end - start).AsNanoSeconds(ns);
+      return ns / Lookups;
+   }
+
+   void Benchmark(btUnsigned32bitInt n, btUnsigned32bitInt IndexedLookups, btUnsigned32bitInt LinearLookups)
+   {
+      Populate(n);
+      ASSERT_EQ(n, m_Index.Size());
+
+      double idx = TimeIndexed(n, IndexedLookups);
+      double lin = TimeLinear(n, LinearLookups);
+
+      // Repeated lookups inside one workspace are served from the per-thread cache.
+      btVirtAddr         p   = Ptr(n / 2);
+      btPhysAddr         sum = 0;
+      btUnsigned32bitInt i;
+      Timer start;
+      for ( i = 0 ; i < IndexedLookups ; ++i ) {
+         sum += m_Index.GetIOVA(p + (i % Len));
+      }
+      Timer end;
+      EXPECT_NE((btPhysAddr)0, sum);
+      double hit = 0.0;
+      (end - start).AsNanoSeconds(hit);
+      hit /= IndexedLookups;
+
+      MSG(n << " workspaces: indexed " << idx << " ns/lookup, cached " << hit <<
+          " ns/lookup, linear walk " << lin << " ns/lookup");
+   }
+
+   WorkSpaceIndex                   m_Index;
+   std::map<btVirtAddr, btPhysAddr> m_Ref;
+   btUnsigned32bitInt               m_Seed;
+};
+
+TEST_F(WorkSpaceIndex_f, aal0822)
+{
+   // WorkSpaceIndex::GetIOVA() translates workspace bases and interior pointers
+   // by their offset into the containing workspace, and returns 0 for pointers
+   // below the first workspace, in the holes between workspaces, and past the last.
+
+   Populate(16);
+
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < 16 ; ++i ) {
+      EXPECT_EQ(Phys(i),           m_Index.GetIOVA(Ptr(i)));
+      EXPECT_EQ(Phys(i) + 1,       m_Index.GetIOVA(Ptr(i) + 1));
+      EXPECT_EQ(Phys(i) + Len - 1, m_Index.GetIOVA(Ptr(i) + Len - 1));
+      EXPECT_EQ(0,                 m_Index.GetIOVA(Ptr(i) + Len));
+      EXPECT_EQ(0,                 m_Index.GetIOVA(Ptr(i) + Stride - 1));
+   }
+
+   EXPECT_EQ(0, m_Index.GetIOVA(Ptr(0) - 1));
+   EXPECT_EQ(0, m_Index.GetIOVA(NULL));
+
+   WorkSpaceIndex::WkSp wksp;
+   EXPECT_TRUE(m_Index.Lookup(Ptr(3) + 5, &wksp));
+   EXPECT_EQ(Ptr(3),     wksp.m_ptr);
+   EXPECT_EQ(Len,        wksp.m_len);
+   EXPECT_EQ(Phys(3),    wksp.m_iova);
+   EXPECT_EQ((btWSID)3,  wksp.m_wsid);
+
+   EXPECT_TRUE(m_Index.Find(Ptr(3), &wksp));
+   EXPECT_FALSE(m_Index.Find(Ptr(3) + 5, &wksp));
+}
+
+TEST_F(WorkSpaceIndex_f, aal0823)
+{
+   // WorkSpaceIndex::Add() rejects NULL, zero-length, and overlapping workspaces.
+   // WorkSpaceIndex::Remove() accepts only workspace bases, and a removed workspace
+   // is no longer found, even by a thread whose last lookup hit it.
+
+   Populate(4);
+
+   EXPECT_FALSE(m_Index.Add(NULL, Len, IOVA, 99));
+   EXPECT_FALSE(m_Index.Add(Ptr(1) + Len, 0, IOVA, 99));
+   EXPECT_FALSE(m_Index.Add(Ptr(1), Len, IOVA, 99));
+   EXPECT_FALSE(m_Index.Add(Ptr(1) + 1, 1, IOVA, 99));
+   EXPECT_FALSE(m_Index.Add(Ptr(1) - 1, 2, IOVA, 99));
+   EXPECT_FALSE(m_Index.Add(Ptr(1) + Len, Stride - Len + 1, IOVA, 99));
+   EXPECT_TRUE(m_Index.Add(Ptr(1) + Len, Stride - Len, IOVA, 99));
+   EXPECT_EQ(5, m_Index.Size());
+
+   // Prime this thread's cache with workspace 2.
+   EXPECT_EQ(Phys(2) + 8, m_Index.GetIOVA(Ptr(2) + 8));
+
+   EXPECT_FALSE(m_Index.Remove(Ptr(2) + 8));
+
+   WorkSpaceIndex::WkSp wksp;
+   EXPECT_TRUE(m_Index.Remove(Ptr(2), &wksp));
+   EXPECT_EQ(Ptr(2),    wksp.m_ptr);
+   EXPECT_EQ((btWSID)2, wksp.m_wsid);
+   EXPECT_FALSE(m_Index.Remove(Ptr(2)));
+
+   EXPECT_EQ(0, m_Index.GetIOVA(Ptr(2) + 8));
+   EXPECT_EQ(4, m_Index.Size());
+
+   // The hole can be reused.
+   EXPECT_TRUE(m_Index.Add(Ptr(2), Len, IOVA, 2));
+   EXPECT_EQ(IOVA + 8, m_Index.GetIOVA(Ptr(2) + 8));
+}
+
+TEST_F(WorkSpaceIndex_f, aal0824)
+{
+   // For random interior pointers into 1000 workspaces, WorkSpaceIndex::GetIOVA()
+   // agrees with the linear walk, wherever the linear walk is correct.
+
+   Populate(1000);
+
+   btUnsigned32bitInt i;
+   for ( i = 0 ; i < 10000 ; ++i ) {
+      btVirtAddr p = RandomInterior(1000);
+      ASSERT_EQ(LinearGetIOVA(p), m_Index.GetIOVA(p)) << (void *)p;
+   }
+}
+
+TEST_F(WorkSpaceIndex_f, aal0825)
+{
+   // Microbenchmark: 10 workspaces.
+   Benchmark(10, 1000000, 1000000);
+}
+
+TEST_F(WorkSpaceIndex_f, aal0826)
+{
+   // Microbenchmark: 1k workspaces.
+   Benchmark(1000, 1000000, 10000);
+}
+
+TEST_F(WorkSpaceIndex_f, aal0827)
+{
+   // Microbenchmark: 100k workspaces.
+   Benchmark(100000, 1000000, 100);
+}
+